@@ -300,10 +300,6 @@ main(int argc, char** argv) {
     thriftThreadMgr->setNamePrefix("ThriftCpuPool");
     thriftThreadMgr->start();
 
-    // Create event publisher to handle event subscription
-    eventPublisher = std::make_unique<PlatformPublisher>(
-        context, PlatformPublisherUrl{FLAGS_platform_pub_url});
-
     // Create Netlink Protocol object in a new thread
     nlProtocolSocketEventLoop = std::make_unique<fbzmq::ZmqEventLoop>();
     nlProtocolSocket = std::make_unique<openr::fbnl::NetlinkProtocolSocket>(
@@ -319,6 +315,14 @@ main(int argc, char** argv) {
     allThreads.emplace_back(std::move(nlProtocolSocketThread));
 
     nlEventLoop = std::make_unique<fbzmq::ZmqEventLoop>();
+
+    // Create event publisher to handle event subscription. It publishes
+    // netlink events and its heartbeats from netlink event loop.
+    eventPublisher = std::make_unique<PlatformPublisher>(
+        context,
+        PlatformPublisherUrl{FLAGS_platform_pub_url},
+        nlEventLoop.get());
+
     nlSocket = std::make_shared<openr::fbnl::NetlinkSocket>(
         nlEventLoop.get(), eventPublisher.get(), std::move(nlProtocolSocket));
     // Subscribe selected network events
@@ -413,7 +417,9 @@ main(int argc, char** argv) {
           FLAGS_config_store_filepath,
           context,
           std::chrono::milliseconds(FLAGS_persistent_store_initial_backoff_ms),
-          std::chrono::milliseconds(FLAGS_persistent_store_max_backoff_ms)));
+          std::chrono::milliseconds(FLAGS_persistent_store_max_backoff_ms),
+          false /* dryrun */,
+          FLAGS_enable_persistent_store_log_format));
 
   const PersistentStoreUrl configStoreInProcUrl{
       moduleTypeToEvl.at(OpenrModuleType::PERSISTENT_STORE)->inprocCmdUrl};
@@ -597,7 +603,9 @@ main(int argc, char** argv) {
             FLAGS_enable_flood_optimization,
             FLAGS_enable_spark2,
             FLAGS_spark2_increase_hello_interval,
-            areas));
+            areas,
+            std::chrono::milliseconds(FLAGS_spark2_liveness_time_ms),
+            static_cast<uint8_t>(FLAGS_spark2_liveness_multiplier)));
   }
 
   // Static list of prefixes to announce into the network as long as OpenR is
@@ -689,6 +697,20 @@ main(int argc, char** argv) {
     LOG(FATAL) << "Regex compile failed";
   }
 
+  folly::Optional<FlapDampeningConfig> linkFlapDampening;
+  if (FLAGS_link_flap_dampening) {
+    linkFlapDampening = FlapDampeningConfig();
+    linkFlapDampening->halfLife =
+        std::chrono::milliseconds(FLAGS_link_flap_dampening_half_life_ms);
+    linkFlapDampening->flapPenalty = FLAGS_link_flap_dampening_penalty;
+    linkFlapDampening->suppressThreshold =
+        FLAGS_link_flap_dampening_suppress_threshold;
+    linkFlapDampening->reuseThreshold =
+        FLAGS_link_flap_dampening_reuse_threshold;
+    linkFlapDampening->maxSuppressTime =
+        std::chrono::milliseconds(FLAGS_link_flap_dampening_max_suppress_ms);
+  }
+
   // Create link monitor instance.
   startEventLoop(
       allThreads,
@@ -726,7 +748,9 @@ main(int argc, char** argv) {
           kvHoldTime,
           std::chrono::milliseconds(FLAGS_link_flap_initial_backoff_ms),
           std::chrono::milliseconds(FLAGS_link_flap_max_backoff_ms),
-          std::chrono::milliseconds(FLAGS_kvstore_key_ttl_ms)));
+          std::chrono::milliseconds(FLAGS_kvstore_key_ttl_ms),
+          FLAGS_per_adjacency_keys,
+          std::move(linkFlapDampening)));
 
   // Wait for the above two threads to start and run before running
   // SPF in Decision module.  This is to make sure the Decision module
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#ifndef BLOCK_RANGE_ALLOCATOR_H_
+#error This file may only be included from BlockRangeAllocator.h
+#endif
+
+////////// Implementation details for BlockRangeAllocator.h /////////////
+
+namespace openr {
+
+template <typename T>
+BlockRangeAllocator<T>::BlockRangeAllocator(
+    const std::string& nodeName,
+    const std::string& keyPrefix,
+    KvStoreClient* const kvStoreClient,
+    const T blockSize,
+    std::function<void(folly::Optional<std::pair<T, T>>)> callback,
+    const std::chrono::milliseconds minBackoffDur /* = 50ms */,
+    const std::chrono::milliseconds maxBackoffDur /* = 2s */,
+    const bool overrideOwner /* = true */,
+    const std::function<bool(T)> checkValueInUseCb,
+    const std::chrono::milliseconds rangeAllocTtl)
+    : blockSize_(blockSize),
+      callback_(std::move(callback)),
+      checkValueInUseCb_(std::move(checkValueInUseCb)) {
+  CHECK_GT(blockSize_, 0) << "Invalid block size.";
+
+  // block is in use if any of its values is
+  std::function<bool(T)> checkBlockInUseCb{nullptr};
+  if (checkValueInUseCb_) {
+    checkBlockInUseCb = [this](T blockIndex) noexcept->bool {
+      const auto block = toBlock(blockIndex).value();
+      for (T val = block.first;; ++val) {
+        if (checkValueInUseCb_(val)) {
+          return true;
+        }
+        if (val == block.second) {
+          return false;
+        }
+      }
+    };
+  }
+
+  rangeAllocator_ = std::make_unique<RangeAllocator<T>>(
+      nodeName,
+      keyPrefix,
+      kvStoreClient,
+      [this](folly::Optional<T> maybeBlockIndex) noexcept {
+        callback_(toBlock(maybeBlockIndex));
+      },
+      minBackoffDur,
+      maxBackoffDur,
+      overrideOwner,
+      std::move(checkBlockInUseCb),
+      rangeAllocTtl);
+}
+
+template <typename T>
+void
+BlockRangeAllocator<T>::startAllocator(
+    const std::pair<T, T> allocRange, const folly::Optional<T> maybeInitValue) {
+  CHECK_LE(allocRange.first, allocRange.second) << "Invalid range.";
+  // number of whole blocks in range, computed without range size which may
+  // overflow T
+  const T numBlocks = (allocRange.second - allocRange.first) / blockSize_ +
+      ((allocRange.second - allocRange.first) % blockSize_ + 1) / blockSize_;
+  CHECK_GT(numBlocks, 0) << "Range is smaller than block size.";
+  allocRange_ = allocRange;
+
+  // prefer block containing initial value, RangeAllocator takes care of
+  // clamping it to block index range
+  folly::Optional<T> maybeInitBlockIndex;
+  if (maybeInitValue.hasValue()) {
+    maybeInitBlockIndex = *maybeInitValue < allocRange_.first
+        ? 0
+        : (*maybeInitValue - allocRange_.first) / blockSize_;
+  }
+
+  rangeAllocator_->startAllocator(
+      std::make_pair(T{0}, numBlocks - 1), maybeInitBlockIndex);
+}
+
+template <typename T>
+folly::Optional<std::pair<T, T>>
+BlockRangeAllocator<T>::toBlock(
+    const folly::Optional<T> maybeBlockIndex) const {
+  if (not maybeBlockIndex.hasValue()) {
+    return folly::none;
+  }
+  const T first = allocRange_.first + *maybeBlockIndex * blockSize_;
+  return std::make_pair(first, first + (blockSize_ - 1));
+}
+
+} // namespace openr
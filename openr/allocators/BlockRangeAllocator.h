@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <folly/Optional.h>
+
+#include <openr/allocators/RangeAllocator.h>
+#include <openr/kvstore/KvStoreClient.h>
+
+namespace openr {
+
+template <typename T = uint32_t>
+class BlockRangeAllocator {
+ public:
+  static_assert(std::is_integral<T>::value, "T is not an integral type");
+
+  /**
+   * BlockRangeAllocator elects a unique block of `blockSize` contiguous values
+   * from within the range in one go, instead of running `blockSize` instances
+   * of RangeAllocator each battling for single value.
+   *
+   * Range is split into aligned blocks of `blockSize` values (trailing values
+   * not filling a whole block are never allocated) and index of a block is
+   * elected with RangeAllocator. Hence a block is carried by single KvStore
+   * key and collision semantics, backoff and override behavior are same as
+   * of RangeAllocator. All allocators sharing `keyPrefix` must use same
+   * `blockSize`, and must not share it with single value RangeAllocator.
+   *
+   * callback: tells you of new allocated block as inclusive range of values
+   * checkValueInUseCb: block is considered in use if any of its values is
+   */
+  BlockRangeAllocator(
+      const std::string& nodeName,
+      const std::string& keyPrefix,
+      KvStoreClient* const kvStoreClient,
+      const T blockSize,
+      std::function<void(folly::Optional<std::pair<T, T>>)> callback,
+      const std::chrono::milliseconds minBackoffDur =
+          std::chrono::milliseconds(50),
+      const std::chrono::milliseconds maxBackoffDur = std::chrono::seconds(2),
+      const bool overrideOwner = true,
+      const std::function<bool(T)> checkValueInUseCb = nullptr,
+      const std::chrono::milliseconds rangeAllocTtl =
+          Constants::kRangeAllocTtl);
+
+  /**
+   * user must call this to start allocation
+   * allocRange: the range from which to allocate blocks (range is inclusive)
+   * maybeInitValue: preferred block is the one containing this value
+   */
+  void startAllocator(
+      const std::pair<T /* min */, T /* max */> allocRange,
+      const folly::Optional<T> maybeInitValue);
+
+  /**
+   * Allocated block stored locally if any.
+   */
+  folly::Optional<std::pair<T, T>>
+  getBlock() const {
+    return toBlock(rangeAllocator_->getValue());
+  }
+
+  // Allocated block stored in kvstore if any. Must be called after
+  // `startAllocator` as blocks are relative to range.
+  folly::Optional<std::pair<T, T>>
+  getBlockFromKvStore() const {
+    return toBlock(rangeAllocator_->getValueFromKvStore());
+  }
+
+  // check if all blocks of the range have been allocated
+  bool
+  isRangeConsumed() const {
+    return rangeAllocator_->isRangeConsumed();
+  }
+
+ private:
+  /**
+   * Non-copyable and non-movable
+   */
+  BlockRangeAllocator(BlockRangeAllocator const&) = delete;
+  BlockRangeAllocator& operator=(BlockRangeAllocator const&) = delete;
+
+  // Range of values covered by block at given index
+  folly::Optional<std::pair<T, T>> toBlock(
+      const folly::Optional<T> maybeBlockIndex) const;
+
+  // Number of values in a block
+  const T blockSize_;
+
+  // Callback function to let user know of newly allocated block
+  const std::function<void(folly::Optional<std::pair<T, T>>)> callback_{
+      nullptr};
+
+  // callback to check if value already exists
+  const std::function<bool(T)> checkValueInUseCb_{nullptr};
+
+  // Range from which blocks are allocated
+  std::pair<T /* min */, T /* max */> allocRange_;
+
+  // Allocator electing block index
+  std::unique_ptr<RangeAllocator<T>> rangeAllocator_;
+};
+
+} // namespace openr
+
+#define BLOCK_RANGE_ALLOCATOR_H_
+#include "BlockRangeAllocator-inl.h"
+#undef BLOCK_RANGE_ALLOCATOR_H_
@@ -54,7 +54,26 @@ RangeAllocator<T>::RangeAllocator(
       overrideOwner_(overrideOwner),
       backoff_(minBackoffDur, maxBackoffDur),
       checkValueInUseCb_(std::move(checkValueInUseCb)),
-      rangeAllocTtl_(rangeAllocTtl) {}
+      rangeAllocTtl_(rangeAllocTtl) {
+  // Track owners of all values. Subscribe before initial dump so that no
+  // update gets missed, updates received later supersede the dump.
+  keyPrefixSubscription_ = kvStoreClient_->subscribeKeyPrefix(
+      keyPrefix_,
+      [this](
+          const std::string& key,
+          folly::Optional<thrift::Value> thriftVal) noexcept {
+        updateValueOwner(key, thriftVal);
+      });
+  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(keyPrefix_);
+  if (maybeKeyMap) {
+    for (const auto& kv : *maybeKeyMap) {
+      updateValueOwner(kv.first, kv.second);
+    }
+  } else {
+    LOG(ERROR) << "RangeAllocator: failed to dump keys with prefix "
+               << keyPrefix_ << ": " << maybeKeyMap.error().errString;
+  }
+}
 
 template <typename T>
 RangeAllocator<T>::~RangeAllocator() {
@@ -66,6 +85,7 @@ RangeAllocator<T>::~RangeAllocator() {
   }
 
   // Unsubscribe from KvStoreClient if we have been to
+  kvStoreClient_->unsubscribeKeyPrefix(keyPrefixSubscription_);
   if (myValue_) {
     const auto myKey = createKey(*myValue_);
     kvStoreClient_->unsubscribeKey(myKey);
@@ -109,7 +129,7 @@ RangeAllocator<T>::startAllocator(
   }
   allocRangeSize_ = allocRange_.second - allocRange_.first + 1;
 
-  // Subscribe to changes in KvStore
+  // Schedule first allocation
   VLOG(2) << "RangeAllocator: Created. Scheduling first tryAllocate. "
           << "Node: " << nodeName_ << ", Prefix: " << keyPrefix_;
   timeoutToken_ = eventLoop_->scheduleTimeout(
@@ -120,12 +140,9 @@ RangeAllocator<T>::startAllocator(
 template <typename T>
 bool
 RangeAllocator<T>::isRangeConsumed() const {
-  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(keyPrefix_);
-  CHECK(maybeKeyMap) << maybeKeyMap.error().errString;
   T count = 0;
-  for (const auto& kv : *maybeKeyMap) {
-    const auto val = details::binaryToPrimitive<T>(kv.second.value.value());
-    if (val >= allocRange_.first && val <= allocRange_.second) {
+  for (const auto& kv : valueOwners_) {
+    if (kv.first >= allocRange_.first && kv.first <= allocRange_.second) {
       ++count;
     }
   }
@@ -136,18 +153,33 @@ RangeAllocator<T>::isRangeConsumed() const {
 template <typename T>
 folly::Optional<T>
 RangeAllocator<T>::getValueFromKvStore() const {
-  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(keyPrefix_);
-  CHECK(maybeKeyMap) << maybeKeyMap.error().errString;
-  for (const auto& kv : *maybeKeyMap) {
-    if (kv.second.originatorId == nodeName_) {
-      const auto val = details::binaryToPrimitive<T>(kv.second.value.value());
-      CHECK_EQ(kv.first, createKey(val));
-      return val;
+  for (const auto& kv : valueOwners_) {
+    if (kv.second == nodeName_) {
+      return kv.first;
     }
   }
   return folly::none;
 }
 
+template <typename T>
+void
+RangeAllocator<T>::updateValueOwner(
+    const std::string& key,
+    const folly::Optional<thrift::Value>& thriftVal) noexcept {
+  // value is encoded in key, which is all we have on expiry
+  const auto maybeVal =
+      folly::tryTo<T>(folly::StringPiece(key).subpiece(keyPrefix_.size()));
+  if (maybeVal.hasError()) {
+    VLOG(2) << "RangeAllocator: ignoring key " << key;
+    return;
+  }
+  if (thriftVal.hasValue()) {
+    valueOwners_[*maybeVal] = thriftVal->originatorId;
+  } else {
+    valueOwners_.erase(*maybeVal);
+  }
+}
+
 template <typename T>
 void
 RangeAllocator<T>::tryAllocate(const T newVal) noexcept {
@@ -247,24 +279,14 @@ RangeAllocator<T>::scheduleAllocate(const T seedVal) noexcept {
   std::uniform_int_distribution<T> dist(allocRange_.first, allocRange_.second);
   auto newVal = dist(gen);
 
-  const auto maybeKeyMap = kvStoreClient_->dumpAllWithPrefix(keyPrefix_);
-  CHECK(maybeKeyMap) << maybeKeyMap.error().errString;
-  const auto valOwners =
-      folly::gen::from(*maybeKeyMap) |
-      folly::gen::map([](std::pair<std::string, thrift::Value> const& kv) {
-        return std::make_pair(
-            details::binaryToPrimitive<T>(kv.second.value.value()),
-            kv.second.originatorId);
-      }) |
-      folly::gen::as<
-          std::unordered_map<T /* value */, std::string /* owner */>>();
-
-  // look for a value I can own
+  // look for a value I can own. Owners are tracked locally, so unless range
+  // is nearly consumed this takes few lookups.
   T i;
   for (i = 0; i < allocRangeSize_; ++i) {
-    const auto it = valOwners.find(newVal);
+    const auto it = valueOwners_.find(newVal);
     // not owned yet or owned by higher originator if override is allowed
-    if (it == valOwners.end() or (overrideOwner_ and nodeName_ >= it->second)) {
+    if (it == valueOwners_.end() or
+        (overrideOwner_ and nodeName_ >= it->second)) {
       if (!checkValueInUseCb_ or !checkValueInUseCb_(newVal)) {
         // found
         break;
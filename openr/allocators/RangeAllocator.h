@@ -10,13 +10,14 @@
 #include <chrono>
 #include <random>
 #include <string>
+#include <unordered_map>
 
 #include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/async/ZmqTimeout.h>
+#include <folly/Conv.h>
 #include <folly/Format.h>
 #include <folly/Optional.h>
 #include <folly/Random.h>
-#include <folly/gen/Base.h>
 
 #include <openr/common/ExponentialBackoff.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
@@ -39,6 +40,9 @@ class RangeAllocator {
    * - Try electing it via KvStore. Higher originatorId wins.
    * - If we fail we should try again with another random number
    * - To ease up re-tries we use ExponentialBackoff
+   * - Owner of every value is tracked locally from KvStore publications (one
+   *   dump at start and incremental updates afterwards) so that choosing
+   *   next candidate doesn't require dumping all keys from KvStore
    *
    * callback: tells you of new allocated value.
    * overrideOwner:  allow a higher originator ID to grab a key from an existing
@@ -82,10 +86,11 @@ class RangeAllocator {
     return myValue_;
   }
 
-  // Allocated value stored in kvstore if any
+  // Allocated value stored in kvstore if any, as per locally tracked owners
   folly::Optional<T> getValueFromKvStore() const;
 
-  // check if the whole range has been allocated
+  // check if the whole range has been allocated, as per locally tracked
+  // owners
   bool isRangeConsumed() const;
 
  private:
@@ -115,6 +120,14 @@ class RangeAllocator {
   void keyValUpdated(
       const std::string& key, const thrift::Value& thriftVal) noexcept;
 
+  /**
+   * Invoked for every update/expiry of a key with our prefix. Keeps
+   * `valueOwners_` in sync with KvStore.
+   */
+  void updateValueOwner(
+      const std::string& key,
+      const folly::Optional<thrift::Value>& thriftVal) noexcept;
+
   /**
    * Utility function to create KvStore key for the value.
    */
@@ -157,6 +170,13 @@ class RangeAllocator {
   // Currently allocated value
   folly::Optional<T> myValue_;
 
+  // Owner of every value advertised in KvStore with our prefix, incl. ones
+  // outside of our range
+  std::unordered_map<T /* value */, std::string /* owner */> valueOwners_;
+
+  // Subscription keeping `valueOwners_` up to date
+  KvStoreClient::KeyPrefixSubscription keyPrefixSubscription_{0};
+
   // Currently requested value
   folly::Optional<T> myRequestedValue_;
 
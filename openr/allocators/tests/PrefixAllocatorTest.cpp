@@ -91,6 +91,7 @@ class PrefixAllocatorFixture : public ::testing::TestWithParam<bool> {
     // Erase previous configs (if any)
     configStoreClient_->erase("prefix-allocator-config");
     configStoreClient_->erase("prefix-manager-config");
+    configStoreClient_->erase("prefix-manager-config-delta");
 
     mockServiceHandler_ = std::make_shared<MockSystemServiceHandler>();
     server_ = std::make_shared<apache::thrift::ThriftServer>();
@@ -16,6 +16,7 @@
 #include <gtest/gtest.h>
 #include <sodium.h>
 
+#include <openr/allocators/BlockRangeAllocator.h>
 #include <openr/allocators/RangeAllocator.h>
 #include <openr/kvstore/KvStoreWrapper.h>
 
@@ -137,6 +138,27 @@ class RangeAllocatorFixture : public ::testing::TestWithParam<bool> {
     return std::move(allocators);
   }
 
+  // Run event loop until allocator processed publications still in flight
+  // and sees whole range consumed, or deadline passes
+  template <typename T>
+  void
+  waitForRangeConsumed(RangeAllocator<T> const& allocator) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    std::function<void()> check = [&]() {
+      if (allocator.isRangeConsumed() or
+          std::chrono::steady_clock::now() > deadline) {
+        eventLoop.stop();
+        return;
+      }
+      eventLoop.scheduleTimeout(
+          std::chrono::milliseconds(1), [&]() noexcept { check(); });
+    };
+    eventLoop.runInEventLoop([&]() noexcept { check(); });
+    eventLoop.run();
+    EXPECT_TRUE(allocator.isRangeConsumed());
+  }
+
   // ZMQ Context for IO processing
   fbzmq::Context zmqContext;
 
@@ -240,6 +262,65 @@ TEST_P(RangeAllocatorFixture, NoSeed) {
   }
 }
 
+/**
+ * Run block allocators with same seed value. Each must end up with a distinct
+ * aligned block of values, allocated via single key.
+ */
+TEST_P(RangeAllocatorFixture, BlockNoSeed) {
+  const uint32_t blockSize = 4;
+  const uint32_t start = 61;
+  // two blocks per client plus few trailing values not forming a block
+  const uint32_t end = start + kNumClients * blockSize * 2 + 2;
+
+  std::map<int /* client id */, std::pair<uint32_t, uint32_t>> allocation;
+  std::vector<std::unique_ptr<BlockRangeAllocator<uint32_t>>> allocators;
+  for (size_t i = 0; i < clients.size(); i++) {
+    auto allocator = std::make_unique<BlockRangeAllocator<uint32_t>>(
+        createClientName(i),
+        "block:",
+        clients[i].get(),
+        blockSize,
+        [&, i](folly::Optional<std::pair<uint32_t, uint32_t>> block) noexcept {
+          if (not block) {
+            allocation.erase(i);
+            return;
+          }
+          ASSERT_GE(block->first, start);
+          ASSERT_LE(block->second, end);
+          ASSERT_EQ(blockSize - 1, block->second - block->first);
+          ASSERT_EQ(0, (block->first - start) % blockSize);
+          allocation[i] = *block;
+
+          // Terminate once every client has got a distinct block
+          if (allocation.size() != kNumClients) {
+            return;
+          }
+          std::set<uint32_t> blockStarts;
+          for (auto const& kv : allocation) {
+            blockStarts.insert(kv.second.first);
+          }
+          if (blockStarts.size() == kNumClients) {
+            LOG(INFO) << "We got everything, stopping eventLoop.";
+            eventLoop.stop();
+          }
+        },
+        std::chrono::milliseconds(10) /* min backoff */,
+        std::chrono::milliseconds(100) /* max backoff */,
+        overrideOwner /* override allowed */);
+    allocator->startAllocator({start, end}, folly::none);
+    allocators.emplace_back(std::move(allocator));
+  }
+
+  eventLoop.run();
+
+  for (size_t i = 0; i < allocators.size(); ++i) {
+    EXPECT_FALSE(allocators[i]->isRangeConsumed());
+    ASSERT_NE(allocation.end(), allocation.find(i));
+    EXPECT_EQ(allocation[i], allocators[i]->getBlock());
+    EXPECT_EQ(allocation[i], allocators[i]->getBlockFromKvStore());
+  }
+}
+
 /**
  * Run allocators with no seed but the range doesn't have enough allocation
  * space. In this case allocators with higher IDs will succeed and other
@@ -313,7 +394,7 @@ TEST_P(RangeAllocatorFixture, InsufficentRange) {
 
   eventLoop.run();
 
-  EXPECT_TRUE(allocators.front()->isRangeConsumed());
+  waitForRangeConsumed(*allocators.front());
 
   VLOG(2) << "=============== Allocation Table ===============";
   for (auto const& kv : allocation) {
@@ -344,7 +425,7 @@ TEST_P(RangeAllocatorFixture, InsufficentRange) {
   VLOG(2) << "Continuing eventLoop...";
   eventLoop.run();
 
-  EXPECT_TRUE(allocators.front()->isRangeConsumed());
+  waitForRangeConsumed(*allocators.front());
 
   VLOG(2) << "=============== Allocation Table ===============";
   for (auto const& kv : allocation) {
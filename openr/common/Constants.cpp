@@ -14,6 +14,7 @@ constexpr folly::StringPiece Constants::kAdjDbMarker;
 constexpr folly::StringPiece Constants::kErrorResponse;
 constexpr folly::StringPiece Constants::kEventLogCategory;
 constexpr folly::StringPiece Constants::kFibTimeMarker;
+constexpr folly::StringPiece Constants::kFilteredPubUrlSuffix;
 constexpr folly::StringPiece Constants::kGlobalCmdLocalIdTemplate;
 constexpr folly::StringPiece Constants::kGlobalSubIdTemplate;
 constexpr folly::StringPiece Constants::kNodeLabelRangePrefix;
@@ -48,7 +49,11 @@ constexpr int32_t Constants::kSparkMcastPort;
 constexpr int32_t Constants::kSystemAgentPort;
 constexpr int64_t Constants::kDefaultAdjWeight;
 constexpr int64_t Constants::kTtlInfinity;
+constexpr size_t Constants::kFibMaxRouteTableWalks;
+constexpr size_t Constants::kFibRouteTablePageSize;
+constexpr size_t Constants::kMaxKeysPerKeySet;
 constexpr size_t Constants::kNumTimeSeries;
+constexpr std::chrono::milliseconds Constants::kFilteredPubResyncInterval;
 constexpr std::chrono::milliseconds Constants::kFloodPendingPublication;
 constexpr std::chrono::milliseconds Constants::kHealthCheckInterval;
 constexpr std::chrono::milliseconds Constants::kInitialBackoff;
@@ -59,6 +64,7 @@ constexpr std::chrono::milliseconds Constants::kMaxBackoff;
 constexpr std::chrono::milliseconds Constants::kMaxTtlUpdateInterval;
 constexpr std::chrono::milliseconds Constants::kPersistentStoreInitialBackoff;
 constexpr std::chrono::milliseconds Constants::kPersistentStoreMaxBackoff;
+constexpr std::chrono::milliseconds Constants::kPersistentStoreWriteBehindDelay;
 constexpr std::chrono::milliseconds Constants::kPlatformConnTimeout;
 constexpr std::chrono::milliseconds Constants::kPlatformProcTimeout;
 constexpr std::chrono::milliseconds Constants::kPollTimeout;
@@ -74,11 +80,14 @@ constexpr std::chrono::milliseconds Constants::kTtlInfInterval;
 constexpr std::chrono::milliseconds Constants::kTtlThreshold;
 constexpr std::chrono::milliseconds Constants::kLongPollReqHoldTime;
 constexpr std::chrono::seconds Constants::kConvergenceMaxDuration;
+constexpr std::chrono::seconds Constants::kFibRouteTableWalkTtl;
 constexpr std::chrono::seconds Constants::kKeepAliveIntvl;
 constexpr std::chrono::seconds Constants::kKeepAliveTime;
 constexpr std::chrono::seconds Constants::kMemoryThresholdTime;
 constexpr std::chrono::seconds Constants::kMonitorSubmitInterval;
 constexpr std::chrono::seconds Constants::kNetlinkSyncThrottleInterval;
+constexpr std::chrono::seconds Constants::kPlatformHeartbeatInterval;
+constexpr std::chrono::seconds Constants::kPlatformSafetySyncInterval;
 constexpr std::chrono::seconds Constants::kPlatformSyncInterval;
 constexpr std::chrono::seconds Constants::kPlatformThriftIdleTimeout;
 constexpr std::chrono::seconds Constants::kStoreSyncInterval;
@@ -79,6 +79,10 @@ class Constants {
   static constexpr std::chrono::milliseconds kPersistentStoreInitialBackoff{
       100};
   static constexpr std::chrono::milliseconds kPersistentStoreMaxBackoff{5000};
+  // how long write-behind PersistentStoreClient holds on to stores before
+  // writing them out, coalescing repeated stores of same key
+  static constexpr std::chrono::milliseconds kPersistentStoreWriteBehindDelay{
+      100};
 
   //
   // KvStore specific
@@ -155,6 +159,13 @@ class Constants {
   // time interval to sync between Open/R and Platform
   static constexpr std::chrono::seconds kPlatformSyncInterval{60};
 
+  // time interval to sync between Open/R and Platform when Platform sends
+  // heartbeats, which already reveal missed events
+  static constexpr std::chrono::seconds kPlatformSafetySyncInterval{600};
+
+  // time interval between heartbeats of PlatformPublisher
+  static constexpr std::chrono::seconds kPlatformHeartbeatInterval{1};
+
   // Timeout duration for which if a client connection has no activity, then it
   // will be dropped. We keep it 3 * kPlatformSyncInterval so that thrift
   // connection between OpenR and platform service remains up forever under
@@ -162,6 +173,13 @@ class Constants {
   static constexpr std::chrono::seconds kPlatformThriftIdleTimeout{
       Constants::kPlatformSyncInterval * 3};
 
+  // Paginated Fib route table retrieval. Upper bound on routes in one page,
+  // time after which a unicast route table walk not accessed is dropped and
+  // number of concurrent walks (each may pin a copy of route cache)
+  static constexpr size_t kFibRouteTablePageSize{10000};
+  static constexpr std::chrono::seconds kFibRouteTableWalkTtl{60};
+  static constexpr size_t kFibMaxRouteTableWalks{8};
+
   // Duration for throttling full sync of network state from kernel via netlink
   static constexpr std::chrono::seconds kNetlinkSyncThrottleInterval{3};
 
@@ -185,6 +203,10 @@ class Constants {
   // Kvstore timer for flooding pending publication
   static constexpr std::chrono::milliseconds kFloodPendingPublication{100};
 
+  // Kvstore timer for republishing filtered publications which hit high
+  // water mark of local subscriber
+  static constexpr std::chrono::milliseconds kFilteredPubResyncInterval{100};
+
   // KvStore database TTLs
   static constexpr std::chrono::milliseconds kKvStoreDbTtl{5min};
 
@@ -194,6 +216,9 @@ class Constants {
   // delimiter separating prefix and name in kvstore key
   static constexpr folly::StringPiece kPrefixNameSeparator{":"};
 
+  // suffix of local KvStore pub url publishing changes per key
+  static constexpr folly::StringPiece kFilteredPubUrlSuffix{"-filtered"};
+
   // KvStore key markers
   static constexpr folly::StringPiece kAdjDbMarker{"adj:"};
   static constexpr folly::StringPiece kPrefixDbMarker{"prefix:"};
@@ -218,6 +243,8 @@ class Constants {
 
   // max interval to update TTL for each key in kvstore w/ finite TTL
   static constexpr std::chrono::milliseconds kMaxTtlUpdateInterval{2h};
+  // max number of key-vals sent to KvStore in single KEY_SET request
+  static constexpr size_t kMaxKeysPerKeySet{1024};
   // TTL infinity, never expires
   // int version
   static constexpr int64_t kTtlInfinity{INT32_MIN};
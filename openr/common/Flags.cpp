@@ -95,6 +95,11 @@ DEFINE_bool(enable_prefix_alloc, false, "Enable automatic prefix allocation");
 DEFINE_int32(alloc_prefix_len, 128, "Allocated prefix length");
 DEFINE_bool(static_prefix_alloc, false, "Perform static prefix allocation");
 DEFINE_bool(per_prefix_keys, false, "Create per IP prefix keys in Kvstore");
+DEFINE_bool(
+    per_adjacency_keys,
+    false,
+    "Create per adjacency keys in KvStore instead of single adjacency "
+    "database key per node");
 DEFINE_bool(
     set_loopback_address,
     false,
@@ -212,6 +217,16 @@ DEFINE_int32(
     5,
     "How long (in seconds) to keep neighbor adjacency without receiving "
     "any heartbeat packet in stable state.");
+DEFINE_int32(
+    spark2_liveness_time_ms,
+    0,
+    "Liveness packet interval (in milliseconds) for fast failure detection "
+    "of established neighbors. Set to 0 to disable.");
+DEFINE_int32(
+    spark2_liveness_multiplier,
+    3,
+    "Number of liveness packets which can be missed before neighbor is "
+    "declared down.");
 DEFINE_int32(
     health_checker_ping_interval_s,
     10,
@@ -254,6 +269,33 @@ DEFINE_int32(
     link_flap_max_backoff_ms,
     60000,
     "Max backoff to dampen link flaps (in millseconds)");
+DEFINE_bool(
+    link_flap_dampening,
+    false,
+    "Dampen link flaps with penalty based dampening instead of exponential "
+    "backoff. Occasional flaps are absorbed, persistently flapping links are "
+    "suppressed until stable.");
+DEFINE_int32(
+    link_flap_dampening_half_life_ms,
+    15000,
+    "Time for accumulated link flap penalty to decay to half (in "
+    "milliseconds)");
+DEFINE_int32(
+    link_flap_dampening_penalty,
+    1000,
+    "Penalty added to link with every flap");
+DEFINE_int32(
+    link_flap_dampening_suppress_threshold,
+    2000,
+    "Link is suppressed once its flap penalty goes above this");
+DEFINE_int32(
+    link_flap_dampening_reuse_threshold,
+    750,
+    "Suppressed link is used again once its flap penalty decays below this");
+DEFINE_int32(
+    link_flap_dampening_max_suppress_ms,
+    60000,
+    "Max time link stays suppressed after its last flap (in milliseconds)");
 DEFINE_bool(
     enable_perf_measurement,
     true,
@@ -357,6 +399,12 @@ DEFINE_int32(
     persistent_store_max_backoff_ms,
     openr::Constants::kPersistentStoreMaxBackoff.count(),
     "Max backoff to save DB to file (in millseconds)");
+DEFINE_bool(
+    enable_persistent_store_log_format,
+    false,
+    "Write config store file as checksummed log. File written in this format "
+    "can't be read by releases before it, it is converted back on startup "
+    "with this option disabled");
 DEFINE_bool(enable_flood_optimization, false, "Enable flooding optimization");
 DEFINE_bool(is_flood_root, false, "set myself as flooding root or not");
 // TODO this option will be deprecated in near future, this is just for safely
@@ -46,6 +46,7 @@ DECLARE_bool(enable_prefix_alloc);
 DECLARE_int32(alloc_prefix_len);
 DECLARE_bool(static_prefix_alloc);
 DECLARE_bool(per_prefix_keys);
+DECLARE_bool(per_adjacency_keys);
 
 DECLARE_bool(set_loopback_address);
 DECLARE_bool(override_loopback_addr);
@@ -90,6 +91,12 @@ DECLARE_int32(zmq_context_threads);
 
 DECLARE_int32(link_flap_initial_backoff_ms);
 DECLARE_int32(link_flap_max_backoff_ms);
+DECLARE_bool(link_flap_dampening);
+DECLARE_int32(link_flap_dampening_half_life_ms);
+DECLARE_int32(link_flap_dampening_penalty);
+DECLARE_int32(link_flap_dampening_suppress_threshold);
+DECLARE_int32(link_flap_dampening_reuse_threshold);
+DECLARE_int32(link_flap_dampening_max_suppress_ms);
 
 DECLARE_bool(enable_perf_measurement);
 
@@ -125,6 +132,7 @@ DECLARE_string(tls_acceptable_peers);
 
 DECLARE_int32(persistent_store_initial_backoff_ms);
 DECLARE_int32(persistent_store_max_backoff_ms);
+DECLARE_bool(enable_persistent_store_log_format);
 
 DECLARE_bool(enable_flood_optimization);
 DECLARE_bool(is_flood_root);
@@ -138,6 +146,8 @@ DECLARE_int32(spark2_heartbeat_time_s);
 DECLARE_int32(spark2_handshake_time_ms);
 DECLARE_int32(spark2_negotiate_hold_time_s);
 DECLARE_int32(spark2_heartbeat_hold_time_s);
+DECLARE_int32(spark2_liveness_time_ms);
+DECLARE_int32(spark2_liveness_multiplier);
 
 DECLARE_bool(prefix_fwd_type_mpls);
 DECLARE_bool(prefix_algo_type_ksp2_ed_ecmp);
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/common/FlapDampener.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+namespace {
+
+double
+toHalfLives(
+    std::chrono::steady_clock::duration duration,
+    std::chrono::milliseconds halfLife) {
+  return std::chrono::duration<double, std::milli>(duration).count() /
+      halfLife.count();
+}
+
+} // namespace
+
+FlapDampener::FlapDampener(FlapDampeningConfig const& config)
+    : config_(config),
+      maxPenalty_(
+          config.reuseThreshold *
+          std::exp2(toHalfLives(config.maxSuppressTime, config.halfLife))) {
+  CHECK_GT(config_.halfLife.count(), 0);
+  CHECK_GT(config_.reuseThreshold, 0);
+  CHECK_LT(config_.reuseThreshold, config_.suppressThreshold);
+  CHECK_LE(config_.suppressThreshold, maxPenalty_)
+      << "Entity would never get suppressed with max suppress time of "
+      << config_.maxSuppressTime.count() << "ms";
+}
+
+double
+FlapDampener::getPenalty(Clock::time_point now) const {
+  if (penalty_ == 0 or now <= lastUpdate_) {
+    return penalty_;
+  }
+  return penalty_ *
+      std::exp2(-toHalfLives(now - lastUpdate_, config_.halfLife));
+}
+
+bool
+FlapDampener::reportFlap(Clock::time_point now) {
+  const bool wasSuppressed = isSuppressed(now);
+  penalty_ = std::min(getPenalty(now) + config_.flapPenalty, maxPenalty_);
+  lastUpdate_ = now;
+  ++numFlaps_;
+
+  if (not wasSuppressed and penalty_ > config_.suppressThreshold) {
+    suppressed_ = true;
+    ++numSuppressions_;
+    return true;
+  }
+  return false;
+}
+
+bool
+FlapDampener::isSuppressed(Clock::time_point now) {
+  if (suppressed_ and getPenalty(now) < config_.reuseThreshold) {
+    suppressed_ = false;
+  }
+  return suppressed_;
+}
+
+std::chrono::milliseconds
+FlapDampener::getTimeUntilReuse(Clock::time_point now) const {
+  const auto penalty = getPenalty(now);
+  if (not suppressed_ or penalty < config_.reuseThreshold) {
+    return std::chrono::milliseconds(0);
+  }
+  // penalty * 2^(-t / halfLife) = reuseThreshold, rounded up so that entity
+  // is reusable when woken up at the returned time
+  const auto halfLives = std::log2(penalty / config_.reuseThreshold);
+  return std::chrono::milliseconds(
+      static_cast<int64_t>(std::ceil(halfLives * config_.halfLife.count())) +
+      1);
+}
+
+} // namespace openr
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace openr {
+
+struct FlapDampeningConfig {
+  // Penalty added with every flap
+  uint32_t flapPenalty{1000};
+  // Entity gets suppressed once its penalty goes above this
+  uint32_t suppressThreshold{2000};
+  // Suppressed entity is usable again once its penalty decays below this
+  uint32_t reuseThreshold{750};
+  // Time it takes for penalty to decay to half
+  std::chrono::milliseconds halfLife{15000};
+  // Upper bound on how long entity stays suppressed after its last flap.
+  // Penalty is capped accordingly.
+  std::chrono::milliseconds maxSuppressTime{60000};
+};
+
+/**
+ * Route flap dampening style (RFC 2439) suppression of flapping entity, e.g.
+ * interface.
+ *
+ * Every flap adds `flapPenalty` to accumulated penalty which decays
+ * exponentially with `halfLife`. Entity gets suppressed when penalty goes
+ * above `suppressThreshold` and stays so until it decays below
+ * `reuseThreshold`. Unlike plain exponential backoff, occasional flaps are
+ * absorbed without suppression, while persistently flapping entity is kept
+ * out of service until it is stable for a while.
+ *
+ * Decay is computed lazily from time of last update, there are no timers.
+ * Callers which need to act once entity is usable again schedule single
+ * wakeup using `getTimeUntilReuse()`.
+ */
+class FlapDampener final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit FlapDampener(FlapDampeningConfig const& config);
+
+  // Account flap. Returns true if it got entity suppressed.
+  bool reportFlap(Clock::time_point now = Clock::now());
+
+  // Is entity suppressed. Lifts suppression once penalty decayed enough.
+  bool isSuppressed(Clock::time_point now = Clock::now());
+
+  // Remaining time until suppressed entity is usable again, 0 if it is not
+  // suppressed
+  std::chrono::milliseconds getTimeUntilReuse(
+      Clock::time_point now = Clock::now()) const;
+
+  // Current penalty, decayed to `now`
+  double getPenalty(Clock::time_point now = Clock::now()) const;
+
+  uint64_t
+  getNumFlaps() const {
+    return numFlaps_;
+  }
+
+  uint64_t
+  getNumSuppressions() const {
+    return numSuppressions_;
+  }
+
+ private:
+  const FlapDampeningConfig config_;
+
+  // Penalty at which entity is suppressed for exactly maxSuppressTime
+  const double maxPenalty_{0};
+
+  double penalty_{0};
+  Clock::time_point lastUpdate_;
+  bool suppressed_{false};
+
+  uint64_t numFlaps_{0};
+  uint64_t numSuppressions_{0};
+};
+
+} // namespace openr
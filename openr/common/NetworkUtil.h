@@ -107,8 +107,18 @@ toIPAddress(const thrift::BinaryAddress& addr) {
 
 inline folly::CIDRNetwork
 toIPNetwork(const thrift::IpPrefix& prefix, bool applyMask = true) {
-  return folly::IPAddress::createNetwork(
-      toIPAddress(prefix.prefixAddress).str(), prefix.prefixLength, applyMask);
+  // same validation as folly::IPAddress::createNetwork without formatting
+  // address to string and parsing it back
+  const auto addr = toIPAddress(prefix.prefixAddress);
+  if (prefix.prefixLength < 0 or
+      static_cast<size_t>(prefix.prefixLength) > addr.bitCount()) {
+    throw folly::IPAddressFormatException(folly::sformat(
+        "CIDR value '{}' is > network bit count '{}'",
+        prefix.prefixLength,
+        addr.bitCount()));
+  }
+  const auto plen = static_cast<uint8_t>(prefix.prefixLength);
+  return folly::CIDRNetwork(applyMask ? addr.mask(plen) : addr, plen);
 }
 
 inline thrift::IpPrefix
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/common/StreamingHistogram.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <folly/lang/Bits.h>
+#include <glog/logging.h>
+
+namespace openr {
+
+constexpr size_t StreamingHistogram::kSubBucketBits;
+constexpr size_t StreamingHistogram::kSubBuckets;
+constexpr size_t StreamingHistogram::kMaxBits;
+constexpr size_t StreamingHistogram::kNumBuckets;
+
+StreamingHistogram::StreamingHistogram(uint32_t decayInterval)
+    : decayInterval_(decayInterval) {
+  CHECK_GT(decayInterval_, 0);
+}
+
+size_t
+StreamingHistogram::getBucketIndex(int64_t value) {
+  if (value < static_cast<int64_t>(kSubBuckets)) {
+    return std::max<int64_t>(value, 0);
+  }
+  const size_t msb = folly::findLastSet(static_cast<uint64_t>(value)) - 1;
+  if (msb >= kMaxBits) {
+    return kNumBuckets - 1;
+  }
+  const size_t shift = msb - kSubBucketBits;
+  const size_t subBucket = (value >> shift) & (kSubBuckets - 1);
+  return kSubBuckets + shift * kSubBuckets + subBucket;
+}
+
+int64_t
+StreamingHistogram::getBucketLowerBound(size_t index) {
+  CHECK_LT(index, kNumBuckets);
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const size_t shift = (index - kSubBuckets) / kSubBuckets;
+  const size_t subBucket = (index - kSubBuckets) % kSubBuckets;
+  return static_cast<int64_t>(kSubBuckets + subBucket) << shift;
+}
+
+void
+StreamingHistogram::addValue(int64_t value) {
+  value = std::max<int64_t>(value, 0);
+  if (samplesSinceDecay_ == decayInterval_) {
+    decay();
+  }
+
+  ++counts_[getBucketIndex(value)];
+  ++numSamples_;
+  ++totalSamples_;
+  ++samplesSinceDecay_;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+}
+
+int64_t
+StreamingHistogram::getPercentile(double percentile) const {
+  if (numSamples_ == 0) {
+    return 0;
+  }
+
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+  const uint64_t rank = std::max<uint64_t>(
+      1, std::ceil(percentile / 100.0 * static_cast<double>(numSamples_)));
+  if (rank >= numSamples_) {
+    return max_;
+  }
+  uint64_t seen{0};
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts_[i];
+    if (seen < rank) {
+      continue;
+    }
+    // report middle of bucket, but never beyond what was actually seen
+    const auto lower = getBucketLowerBound(i);
+    const auto upper =
+        i + 1 < kNumBuckets ? getBucketLowerBound(i + 1) - 1 : max_;
+    const auto estimate = lower + (upper - lower) / 2;
+    return std::min(std::max(estimate, min_), max_);
+  }
+  return max_;
+}
+
+void
+StreamingHistogram::decay() {
+  // exact min and max are gone with samples, narrow them to bounds of
+  // buckets still holding any
+  numSamples_ = 0;
+  int64_t newMin = std::numeric_limits<int64_t>::max();
+  int64_t newMax = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts_[i] /= 2;
+    if (counts_[i] == 0) {
+      continue;
+    }
+    numSamples_ += counts_[i];
+    newMin = std::min(newMin, std::max(min_, getBucketLowerBound(i)));
+    newMax = i + 1 < kNumBuckets
+        ? std::min(max_, getBucketLowerBound(i + 1) - 1)
+        : max_;
+  }
+  samplesSinceDecay_ = 0;
+  min_ = newMin;
+  max_ = newMax;
+}
+
+} // namespace openr
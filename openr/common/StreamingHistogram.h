@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace openr {
+
+/**
+ * Fixed size histogram of non-negative values to estimate percentiles of a
+ * stream of samples, e.g. RTT of a neighbor.
+ *
+ * Buckets are log-linear: every power of two range is split in
+ * `kSubBuckets` equal buckets, hence relative error of an estimate is at most
+ * 1 / kSubBuckets no matter how large values get. Values beyond 2^kMaxBits
+ * are accounted in the last bucket.
+ *
+ * Counts of all buckets are halved every `decayInterval` samples so that
+ * percentiles follow recent distribution rather than whole history. Min and
+ * max are exact until first decay and bucket granular afterwards.
+ */
+class StreamingHistogram final {
+ public:
+  static constexpr size_t kSubBucketBits{2};
+  static constexpr size_t kSubBuckets{1 << kSubBucketBits};
+  static constexpr size_t kMaxBits{40};
+  static constexpr size_t kNumBuckets{
+      kSubBuckets + (kMaxBits - kSubBucketBits) * kSubBuckets};
+
+  explicit StreamingHistogram(uint32_t decayInterval = 256);
+
+  void addValue(int64_t value);
+
+  // Estimate of value at given percentile (0-100) of samples currently in
+  // histogram. Returns 0 if there are none.
+  int64_t getPercentile(double percentile) const;
+
+  int64_t
+  getMin() const {
+    return numSamples_ ? min_ : 0;
+  }
+
+  int64_t
+  getMax() const {
+    return numSamples_ ? max_ : 0;
+  }
+
+  // number of samples currently accounted in histogram, after decay
+  uint64_t
+  getNumSamples() const {
+    return numSamples_;
+  }
+
+  // number of samples ever added
+  uint64_t
+  getTotalSamples() const {
+    return totalSamples_;
+  }
+
+  static size_t getBucketIndex(int64_t value);
+
+  // smallest value falling into bucket at `index`
+  static int64_t getBucketLowerBound(size_t index);
+
+ private:
+  void decay();
+
+  const uint32_t decayInterval_{0};
+
+  std::array<uint32_t, kNumBuckets> counts_{};
+  uint64_t numSamples_{0};
+  uint64_t totalSamples_{0};
+  uint32_t samplesSinceDecay_{0};
+  int64_t min_{std::numeric_limits<int64_t>::max()};
+  int64_t max_{0};
+};
+
+} // namespace openr
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/common/TimerWheel.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+std::unique_ptr<TimerWheel::Timeout>
+TimerWheel::Timeout::make(TimerWheel* wheel, std::function<void()> callback) {
+  return std::unique_ptr<Timeout>(new Timeout(wheel, std::move(callback)));
+}
+
+TimerWheel::Timeout::Timeout(
+    TimerWheel* wheel, std::function<void()> callback)
+    : wheel_(wheel),
+      callback_(std::make_shared<const std::function<void()>>(
+          std::move(callback))) {
+  CHECK(wheel_);
+}
+
+TimerWheel::Timeout::~Timeout() {
+  cancelTimeout();
+}
+
+void
+TimerWheel::Timeout::scheduleTimeout(
+    std::chrono::milliseconds timeout, bool isPeriodic) {
+  period_ = timeout;
+  isPeriodic_ = isPeriodic;
+  wheel_->schedule(*this, timeout);
+}
+
+void
+TimerWheel::Timeout::cancelTimeout() {
+  if (isScheduled_) {
+    wheel_->cancel(*this);
+  }
+}
+
+bool
+TimerWheel::Timeout::isScheduled() const {
+  return isScheduled_;
+}
+
+TimerWheel::TimerWheel(
+    fbzmq::ZmqEventLoop* evl,
+    std::chrono::milliseconds tickInterval,
+    size_t numSlots)
+    : evl_(evl),
+      tickInterval_(tickInterval),
+      startTime_(std::chrono::steady_clock::now()),
+      slots_(numSlots),
+      lastAdvanceTime_(startTime_) {
+  CHECK_GT(tickInterval_.count(), 0);
+  CHECK_GT(numSlots, 0);
+
+  if (evl_) {
+    tickTimer_ = fbzmq::ZmqTimeout::make(evl_, [this]() noexcept {
+      advance(std::chrono::steady_clock::now());
+    });
+  }
+}
+
+TimerWheel::~TimerWheel() {
+  // Detach remaining timeouts so that they don't call back into us
+  for (auto& slot : slots_) {
+    while (!slot.empty()) {
+      slot.front().isScheduled_ = false;
+      slot.pop_front();
+    }
+  }
+  while (!firing_.empty()) {
+    firing_.front().isScheduled_ = false;
+    firing_.pop_front();
+  }
+}
+
+int64_t
+TimerWheel::toTick(std::chrono::steady_clock::time_point time) const {
+  return (time - startTime_) / tickInterval_;
+}
+
+void
+TimerWheel::schedule(Timeout& timeout, std::chrono::milliseconds delay) {
+  cancel(timeout);
+
+  // Round expiry up to next tick boundary, timeouts never fire early. Expiry
+  // is always in future of last processed tick so that a timeout scheduled
+  // from a callback can't fire within same `advance()`
+  const auto now =
+      std::max(std::chrono::steady_clock::now(), lastAdvanceTime_);
+  const auto elapsed = now + delay - startTime_;
+  const auto tickNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(tickInterval_);
+  const auto elapsedNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+  const int64_t expireTick = std::max(
+      (elapsedNs.count() + tickNs.count() - 1) / tickNs.count(),
+      currentTick_ + 1);
+
+  timeout.expireTick_ = expireTick;
+  timeout.isScheduled_ = true;
+  slots_[expireTick % slots_.size()].push_back(timeout);
+  ++numScheduled_;
+
+  if (tickTimer_ and (tickTimerTick_ < 0 or expireTick < tickTimerTick_)) {
+    armTickTimer(expireTick);
+  }
+}
+
+void
+TimerWheel::cancel(Timeout& timeout) {
+  if (not timeout.isScheduled_) {
+    return;
+  }
+  timeout.hook_.unlink();
+  timeout.isScheduled_ = false;
+  --numScheduled_;
+}
+
+size_t
+TimerWheel::advance(std::chrono::steady_clock::time_point now) {
+  // Event loop timer (if any) has fired or is about to be re-armed below
+  tickTimerTick_ = -1;
+
+  lastAdvanceTime_ = std::max(lastAdvanceTime_, now);
+  const auto targetTick = toTick(lastAdvanceTime_);
+  size_t numFired{0};
+  if (targetTick > currentTick_) {
+    // Visit every slot at most once, even if we are more than a revolution
+    // behind. Timeouts not yet due stay in their slot for next revolution
+    const auto numTicks = std::min<int64_t>(
+        targetTick - currentTick_, static_cast<int64_t>(slots_.size()));
+    for (int64_t i = 1; i <= numTicks; ++i) {
+      auto& slot = slots_[(currentTick_ + i) % slots_.size()];
+      for (auto it = slot.begin(); it != slot.end();) {
+        auto& timeout = *it;
+        if (timeout.expireTick_ > targetTick) {
+          ++it;
+          continue;
+        }
+        it = slot.erase(it);
+        firing_.push_back(timeout);
+      }
+    }
+    currentTick_ = targetTick;
+
+    // Fire expired timeouts in order of expiry. Callbacks are free to
+    // schedule, cancel or destroy any timeout, including ones in `firing_`
+    while (not firing_.empty()) {
+      auto& timeout = firing_.front();
+      firing_.pop_front();
+      timeout.isScheduled_ = false;
+      --numScheduled_;
+
+      // Hold on to callback as it may destroy its own timeout
+      auto callback = timeout.callback_;
+      if (timeout.isPeriodic_) {
+        schedule(timeout, timeout.period_);
+      }
+      (*callback)();
+      ++numFired;
+    }
+  }
+
+  scheduleNextTick();
+  return numFired;
+}
+
+void
+TimerWheel::scheduleNextTick() {
+  if (not tickTimer_) {
+    return;
+  }
+  if (numScheduled_ == 0) {
+    tickTimer_->cancelTimeout();
+    tickTimerTick_ = -1;
+    return;
+  }
+
+  // Skip over empty slots
+  int64_t nextTick = currentTick_ + 1;
+  for (size_t i = 1; i <= slots_.size(); ++i) {
+    if (not slots_[(currentTick_ + i) % slots_.size()].empty()) {
+      nextTick = currentTick_ + i;
+      break;
+    }
+  }
+  if (tickTimerTick_ >= 0 and tickTimerTick_ <= nextTick) {
+    return;
+  }
+
+  armTickTimer(nextTick);
+}
+
+void
+TimerWheel::armTickTimer(int64_t tick) {
+  const auto delayToTick =
+      startTime_ + tick * tickInterval_ - std::chrono::steady_clock::now();
+  if (tickTimer_->isScheduled()) {
+    tickTimer_->cancelTimeout();
+  }
+  tickTimer_->scheduleTimeout(std::max(
+      std::chrono::milliseconds(0),
+      std::chrono::ceil<std::chrono::milliseconds>(delayToTick)));
+  tickTimerTick_ = tick;
+}
+
+} // namespace openr
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <fbzmq/async/ZmqTimeout.h>
+#include <folly/IntrusiveList.h>
+
+namespace openr {
+
+/**
+ * Hashed timing wheel multiplexing any number of timeouts on top of a single
+ * event loop timer.
+ *
+ * Time is divided in ticks of `tickInterval`. A timeout expiring at tick `t`
+ * is kept in slot `t % numSlots`, so scheduling and cancelling are O(1) and
+ * each tick only looks at timeouts of one slot, no matter how many are
+ * scheduled in total. Timeouts are rounded up to tick boundary, hence the
+ * wheel is meant for protocol timers (hello, hold, keep-alive) where a few
+ * milliseconds don't matter but their numbers do.
+ *
+ * Event loop timer is only armed while there are scheduled timeouts and
+ * skips over empty slots.
+ *
+ * NOTE: Not thread safe. Wheel and all its timeouts must be used from the
+ * thread of event loop driving it.
+ */
+class TimerWheel final {
+ public:
+  /**
+   * Drop in replacement for fbzmq::ZmqTimeout driven by a TimerWheel.
+   * Destroying a timeout cancels it, including from within callbacks of
+   * other timeouts expiring at same tick.
+   */
+  class Timeout final {
+   public:
+    static std::unique_ptr<Timeout> make(
+        TimerWheel* wheel, std::function<void()> callback);
+
+    ~Timeout();
+
+    Timeout(Timeout const&) = delete;
+    Timeout& operator=(Timeout const&) = delete;
+
+    // (Re)schedule timeout. Periodic timeouts are re-armed from the time
+    // callback is invoked, same as fbzmq::ZmqTimeout
+    void scheduleTimeout(
+        std::chrono::milliseconds timeout, bool isPeriodic = false);
+
+    void cancelTimeout();
+
+    bool isScheduled() const;
+
+   private:
+    friend class TimerWheel;
+
+    Timeout(TimerWheel* wheel, std::function<void()> callback);
+
+    TimerWheel* const wheel_{nullptr};
+    // shared so that callback survives its timeout being destroyed by it
+    const std::shared_ptr<const std::function<void()>> callback_;
+
+    // absolute tick at which timeout expires
+    int64_t expireTick_{0};
+    std::chrono::milliseconds period_{0};
+    bool isPeriodic_{false};
+    bool isScheduled_{false};
+
+    // links timeout in one of wheel's slots or in list of firing timeouts
+    folly::IntrusiveListHook hook_;
+  };
+
+  /**
+   * @param evl           Event loop driving the wheel. If nullptr wheel must
+   *                      be driven manually by calling `advance()`
+   * @param tickInterval  Resolution of the wheel
+   * @param numSlots      Number of slots. Timeouts further than
+   *                      `tickInterval * numSlots` in future stay in their
+   *                      slot for more than one revolution of the wheel
+   */
+  TimerWheel(
+      fbzmq::ZmqEventLoop* evl,
+      std::chrono::milliseconds tickInterval,
+      size_t numSlots = kDefaultNumSlots);
+
+  ~TimerWheel();
+
+  TimerWheel(TimerWheel const&) = delete;
+  TimerWheel& operator=(TimerWheel const&) = delete;
+
+  /**
+   * Move wheel forward up to `now` and invoke callbacks of all timeouts
+   * expired by then. Returns number of callbacks invoked.
+   *
+   * Time of the wheel never goes backwards; if `now` is ahead of the clock,
+   * timeouts scheduled afterwards are relative to it. This allows driving
+   * the wheel with simulated time in tests and benchmarks.
+   */
+  size_t advance(std::chrono::steady_clock::time_point now);
+
+  size_t
+  getNumScheduled() const {
+    return numScheduled_;
+  }
+
+  std::chrono::milliseconds
+  getTickInterval() const {
+    return tickInterval_;
+  }
+
+  static constexpr size_t kDefaultNumSlots{512};
+
+ private:
+  using TimeoutList = folly::IntrusiveList<Timeout, &Timeout::hook_>;
+
+  void schedule(Timeout& timeout, std::chrono::milliseconds delay);
+
+  void cancel(Timeout& timeout);
+
+  // tick which `time` falls in
+  int64_t toTick(std::chrono::steady_clock::time_point time) const;
+
+  // Arm event loop timer for next tick having any timeout in its slot
+  void scheduleNextTick();
+
+  // Arm event loop timer to fire at beginning of `tick`
+  void armTickTimer(int64_t tick);
+
+  fbzmq::ZmqEventLoop* const evl_{nullptr};
+  const std::chrono::milliseconds tickInterval_;
+  const std::chrono::steady_clock::time_point startTime_;
+
+  std::vector<TimeoutList> slots_;
+
+  // Timeouts expired at current tick and yet to be fired
+  TimeoutList firing_;
+
+  // Last tick processed by `advance()` and time it was called with
+  int64_t currentTick_{0};
+  std::chrono::steady_clock::time_point lastAdvanceTime_;
+
+  size_t numScheduled_{0};
+
+  // Event loop timer and tick it is armed for, if any
+  std::unique_ptr<fbzmq::ZmqTimeout> tickTimer_{nullptr};
+  int64_t tickTimerTick_{-1};
+};
+
+} // namespace openr
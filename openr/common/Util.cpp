@@ -14,6 +14,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cctype>
+
 namespace openr {
 
 // create RE2 set for the list of key prefixes
@@ -57,34 +60,89 @@ PrefixKey::PrefixKey(
     : node_(node),
       prefix_(prefix),
       prefixArea_(area),
-      prefixKeyString_(folly::sformat(
-          "{}{}:{}:[{}/{}]",
-          Constants::kPrefixDbMarker.toString(),
+      prefixKeyString_(folly::to<std::string>(
+          Constants::kPrefixDbMarker,
           node_,
+          ":",
           prefixArea_,
+          ":[",
           prefix_.first.str(),
-          prefix_.second)) {}
+          "/",
+          static_cast<int>(prefix_.second),
+          "]")) {}
 
 folly::Expected<PrefixKey, std::string>
 PrefixKey::fromStr(const std::string& key) {
-  int plen{0};
-  std::string area{};
-  std::string node{};
-  std::string ipstr{};
-  folly::CIDRNetwork ipaddress;
-  auto patt = RE2::FullMatch(key, getPrefixRE2(), &node, &area, &ipstr, &plen);
-  if (!patt) {
+  // Equivalent of matching `getPrefixRE2()`, hand rolled as prefix keys get
+  // parsed for every prefix publication
+  const auto invalidKey = [&key]() {
     return folly::makeUnexpected(folly::sformat("Invalid key format {}", key));
+  };
+  // <cctype> functions take unsigned char values only, hence the cast
+  const auto allOf = [](folly::StringPiece str, bool (*pred)(unsigned char)) {
+    return std::all_of(str.begin(), str.end(), [pred](char c) {
+      return pred(static_cast<unsigned char>(c));
+    });
+  };
+  const auto isNodeChar = [](unsigned char c) -> bool {
+    return std::isalnum(c) or c == '.' or c == '-' or c == '_';
+  };
+  const auto isAreaChar = [](unsigned char c) -> bool {
+    return std::isalnum(c) != 0;
+  };
+  const auto isAddrChar = [](unsigned char c) -> bool {
+    return std::isxdigit(c) or c == '.' or c == ':';
+  };
+  const auto isDigit = [](unsigned char c) -> bool {
+    return std::isdigit(c) != 0;
+  };
+
+  folly::StringPiece rest(key);
+  if (not rest.removePrefix(Constants::kPrefixDbMarker)) {
+    return invalidKey();
+  }
+
+  // <node>:<area>:
+  const auto nodeLen = rest.find(':');
+  if (nodeLen == folly::StringPiece::npos) {
+    return invalidKey();
+  }
+  const auto node = rest.subpiece(0, nodeLen);
+  rest.advance(nodeLen + 1);
+  const auto areaLen = rest.find(':');
+  if (areaLen == folly::StringPiece::npos) {
+    return invalidKey();
+  }
+  const auto area = rest.subpiece(0, areaLen);
+  rest.advance(areaLen + 1);
+  if (node.empty() or not allOf(node, isNodeChar) or area.empty() or
+      not allOf(area, isAreaChar)) {
+    return invalidKey();
+  }
+
+  // [<IPAddr>/<plen>]
+  if (not rest.removePrefix('[') or not rest.removeSuffix(']')) {
+    return invalidKey();
+  }
+  const auto slashPos = rest.rfind('/');
+  if (slashPos == folly::StringPiece::npos) {
+    return invalidKey();
+  }
+  const auto addr = rest.subpiece(0, slashPos);
+  const auto plen = rest.subpiece(slashPos + 1);
+  if (addr.empty() or not allOf(addr, isAddrChar) or plen.empty() or
+      plen.size() > 3 or not allOf(plen, isDigit)) {
+    return invalidKey();
   }
 
-  try {
-    ipaddress =
-        folly::IPAddress::createNetwork(folly::sformat("{}/{}", ipstr, plen));
-  } catch (const folly::IPAddressFormatException& e) {
-    LOG(INFO) << "Exception in converting to Prefix. " << e.what();
+  auto ipaddress = folly::IPAddress::tryCreateNetwork(rest);
+  if (ipaddress.hasError()) {
+    LOG(INFO) << "Exception in converting to Prefix: " << rest;
     return folly::makeUnexpected(std::string("Invalid IP address in key"));
   }
-  return PrefixKey(node, ipaddress, area);
+  // Key is formatted again as address and length may be written in
+  // non-canonical form, e.g. unmasked or with leading zeros
+  return PrefixKey(node.str(), ipaddress.value(), area.str());
 }
 
 std::string
@@ -112,6 +170,31 @@ PrefixKey::getIpPrefix() const {
   return toIpPrefix(prefix_);
 }
 
+PerAdjacencyKey::PerAdjacencyKey(
+    std::string const& node,
+    std::string const& otherNode,
+    std::string const& ifName)
+    : node_(node),
+      otherNode_(otherNode),
+      ifName_(ifName),
+      adjacencyKeyString_(folly::sformat(
+          "{}{}:{}:{}",
+          Constants::kAdjDbMarker.toString(),
+          node_,
+          otherNode_,
+          ifName_)) {}
+
+folly::Expected<PerAdjacencyKey, std::string>
+PerAdjacencyKey::fromStr(const std::string& key) {
+  std::string node{};
+  std::string otherNode{};
+  std::string ifName{};
+  if (!RE2::FullMatch(key, getAdjacencyRE2(), &node, &otherNode, &ifName)) {
+    return folly::makeUnexpected(folly::sformat("Invalid key format {}", key));
+  }
+  return PerAdjacencyKey(node, otherNode, ifName);
+}
+
 int
 executeShellCommand(const std::string& command) {
   int ret = system(command.c_str());
@@ -993,11 +1076,14 @@ getNodeNameFromKey(const std::string& key) {
   std::string prefix, nodeName;
   auto prefixKey = PrefixKey::fromStr(key);
   if (prefixKey.hasValue()) {
-    nodeName = prefixKey.value().getNodeName();
-  } else {
-    folly::split(
-        Constants::kPrefixNameSeparator.toString(), key, prefix, nodeName);
+    return prefixKey.value().getNodeName();
+  }
+  auto adjacencyKey = PerAdjacencyKey::fromStr(key);
+  if (adjacencyKey.hasValue()) {
+    return adjacencyKey.value().getNodeName();
   }
+  folly::split(
+      Constants::kPrefixNameSeparator.toString(), key, prefix, nodeName);
   return nodeName;
 }
 
@@ -63,7 +63,8 @@ class PrefixKey {
       folly::CIDRNetwork const& prefix,
       const std::string& area = thrift::KvStore_constants::kDefaultArea());
 
-  // construct PrefixKey object from a give key string
+  // construct PrefixKey object from a give key string. Parses key without
+  // regex and address without string round trip. Returned key is canonical.
   static folly::Expected<PrefixKey, std::string> fromStr(
       const std::string& key);
 
@@ -107,6 +108,61 @@ class PrefixKey {
   std::string prefixKeyString_;
 };
 
+/**
+ * PerAdjacencyKey class to form and parse per adjacency keys. Node advertising
+ * its adjacencies with per adjacency keys floods each of them under its own
+ * `adj:<node>:<otherNode>:<ifName>` key, while `adj:<node>` only carries node
+ * attributes.
+ */
+class PerAdjacencyKey {
+ public:
+  PerAdjacencyKey(
+      std::string const& node,
+      std::string const& otherNode,
+      std::string const& ifName);
+
+  // construct PerAdjacencyKey object from a give key string
+  static folly::Expected<PerAdjacencyKey, std::string> fromStr(
+      const std::string& key);
+
+  std::string const&
+  getNodeName() const {
+    return node_;
+  }
+
+  std::string const&
+  getOtherNodeName() const {
+    return otherNode_;
+  }
+
+  std::string const&
+  getIfName() const {
+    return ifName_;
+  }
+
+  // return adjacency key string to be used to flood to kvstore
+  std::string const&
+  getAdjacencyKey() const {
+    return adjacencyKeyString_;
+  }
+
+  static const RE2&
+  getAdjacencyRE2() {
+    static const RE2 adjacencyKeyPattern{folly::sformat(
+        "{}(?P<node>[a-zA-Z\\d\\.\\-\\_]+):"
+        "(?P<otherNode>[a-zA-Z\\d\\.\\-\\_]+):"
+        "(?P<ifName>.+)",
+        Constants::kAdjDbMarker.toString())};
+    return adjacencyKeyPattern;
+  }
+
+ private:
+  std::string node_;
+  std::string otherNode_;
+  std::string ifName_;
+  std::string adjacencyKeyString_;
+};
+
 /**
  * Utility function to execute shell command and return true/false as
  * indication of it's success
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/FlapDampener.h>
+
+namespace openr {
+
+namespace {
+FlapDampeningConfig
+getConfig() {
+  FlapDampeningConfig config;
+  config.flapPenalty = 1000;
+  config.suppressThreshold = 2000;
+  config.reuseThreshold = 750;
+  config.halfLife = std::chrono::seconds(10);
+  config.maxSuppressTime = std::chrono::seconds(40);
+  return config;
+}
+} // namespace
+
+TEST(FlapDampenerTest, Decay) {
+  FlapDampener dampener(getConfig());
+  const auto start = FlapDampener::Clock::now();
+  EXPECT_EQ(0, dampener.getPenalty(start));
+
+  EXPECT_FALSE(dampener.reportFlap(start));
+  EXPECT_EQ(1000, dampener.getPenalty(start));
+  EXPECT_NEAR(500, dampener.getPenalty(start + std::chrono::seconds(10)), 1);
+  EXPECT_NEAR(250, dampener.getPenalty(start + std::chrono::seconds(20)), 1);
+
+  // single flap is absorbed
+  EXPECT_FALSE(dampener.isSuppressed(start));
+  EXPECT_EQ(std::chrono::milliseconds(0), dampener.getTimeUntilReuse(start));
+  EXPECT_EQ(1, dampener.getNumFlaps());
+  EXPECT_EQ(0, dampener.getNumSuppressions());
+}
+
+TEST(FlapDampenerTest, SuppressAndReuse) {
+  FlapDampener dampener(getConfig());
+  auto now = FlapDampener::Clock::now();
+
+  // penalty 1000 -> 1500 -> 2500, third flap gets it suppressed
+  EXPECT_FALSE(dampener.reportFlap(now));
+  now += std::chrono::seconds(10);
+  EXPECT_FALSE(dampener.reportFlap(now));
+  EXPECT_FALSE(dampener.isSuppressed(now));
+  EXPECT_TRUE(dampener.reportFlap(now));
+  EXPECT_TRUE(dampener.isSuppressed(now));
+  EXPECT_NEAR(2500, dampener.getPenalty(now), 1);
+
+  // further flaps keep it suppressed without counting new suppression
+  EXPECT_FALSE(dampener.reportFlap(now));
+  EXPECT_EQ(4, dampener.getNumFlaps());
+  EXPECT_EQ(1, dampener.getNumSuppressions());
+
+  // 3500 decays to 750 in log2(3500 / 750) half lives, ~22.2s
+  const auto timeUntilReuse = dampener.getTimeUntilReuse(now);
+  EXPECT_NEAR(22224, timeUntilReuse.count(), 10);
+  EXPECT_TRUE(
+      dampener.isSuppressed(now + timeUntilReuse - std::chrono::seconds(1)));
+  EXPECT_FALSE(dampener.isSuppressed(now + timeUntilReuse));
+  EXPECT_EQ(
+      std::chrono::milliseconds(0),
+      dampener.getTimeUntilReuse(now + timeUntilReuse));
+
+  // suppression stays lifted while penalty is between reuse and suppress
+  // thresholds
+  now += timeUntilReuse;
+  EXPECT_FALSE(dampener.reportFlap(now));
+  EXPECT_FALSE(dampener.isSuppressed(now));
+  EXPECT_TRUE(dampener.reportFlap(now));
+  EXPECT_EQ(2, dampener.getNumSuppressions());
+}
+
+TEST(FlapDampenerTest, MaxSuppressTime) {
+  FlapDampener dampener(getConfig());
+  const auto now = FlapDampener::Clock::now();
+
+  // no matter how much it flaps, it is suppressed for at most max suppress
+  // time after last flap
+  for (int i = 0; i < 100; ++i) {
+    dampener.reportFlap(now);
+  }
+  EXPECT_TRUE(dampener.isSuppressed(now));
+  EXPECT_NEAR(750 * 16, dampener.getPenalty(now), 1);
+  EXPECT_NEAR(40000, dampener.getTimeUntilReuse(now).count(), 2);
+  EXPECT_FALSE(dampener.isSuppressed(now + std::chrono::milliseconds(40001)));
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/StreamingHistogram.h>
+
+namespace openr {
+
+TEST(StreamingHistogramTest, Buckets) {
+  // one bucket per value below kSubBuckets
+  for (int64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(i, StreamingHistogram::getBucketIndex(i));
+    EXPECT_EQ(i, StreamingHistogram::getBucketLowerBound(i));
+  }
+
+  // every power of two is split in kSubBuckets buckets
+  EXPECT_EQ(4, StreamingHistogram::getBucketIndex(4));
+  EXPECT_EQ(7, StreamingHistogram::getBucketIndex(7));
+  EXPECT_EQ(8, StreamingHistogram::getBucketIndex(8));
+  EXPECT_EQ(8, StreamingHistogram::getBucketIndex(9));
+  EXPECT_EQ(9, StreamingHistogram::getBucketIndex(10));
+  EXPECT_EQ(8, StreamingHistogram::getBucketLowerBound(8));
+  EXPECT_EQ(10, StreamingHistogram::getBucketLowerBound(9));
+
+  // lower bound of every bucket maps back to it and buckets are contiguous
+  for (size_t i = 0; i < StreamingHistogram::kNumBuckets; ++i) {
+    const auto lower = StreamingHistogram::getBucketLowerBound(i);
+    EXPECT_EQ(i, StreamingHistogram::getBucketIndex(lower));
+    if (i > 0) {
+      EXPECT_EQ(i - 1, StreamingHistogram::getBucketIndex(lower - 1));
+    }
+  }
+
+  // negative and huge values are clamped
+  EXPECT_EQ(0, StreamingHistogram::getBucketIndex(-10));
+  EXPECT_EQ(
+      StreamingHistogram::kNumBuckets - 1,
+      StreamingHistogram::getBucketIndex(int64_t(1) << 50));
+}
+
+TEST(StreamingHistogramTest, Percentiles) {
+  StreamingHistogram histogram(100000);
+  EXPECT_EQ(0, histogram.getNumSamples());
+  EXPECT_EQ(0, histogram.getPercentile(50));
+  EXPECT_EQ(0, histogram.getMin());
+  EXPECT_EQ(0, histogram.getMax());
+
+  for (int64_t i = 1; i <= 10000; ++i) {
+    histogram.addValue(i);
+  }
+  EXPECT_EQ(10000, histogram.getNumSamples());
+  EXPECT_EQ(1, histogram.getMin());
+  EXPECT_EQ(10000, histogram.getMax());
+
+  // estimates are within relative error of bucket width
+  for (double pct : {10.0, 50.0, 90.0, 99.0}) {
+    const double expected = pct * 100;
+    EXPECT_NEAR(expected, histogram.getPercentile(pct), expected / 4);
+  }
+  EXPECT_EQ(1, histogram.getPercentile(0));
+  EXPECT_EQ(10000, histogram.getPercentile(100));
+
+  // single value is reported exactly
+  StreamingHistogram single;
+  single.addValue(1234);
+  EXPECT_EQ(1234, single.getPercentile(50));
+  EXPECT_EQ(1234, single.getPercentile(99));
+}
+
+TEST(StreamingHistogramTest, Decay) {
+  StreamingHistogram histogram(100);
+  for (int i = 0; i < 1000; ++i) {
+    histogram.addValue(1000);
+  }
+  EXPECT_EQ(1000, histogram.getPercentile(50));
+
+  // shift in distribution takes over after a few decay intervals
+  for (int i = 0; i < 500; ++i) {
+    histogram.addValue(10000);
+  }
+  EXPECT_EQ(1500, histogram.getTotalSamples());
+  EXPECT_GT(200, histogram.getNumSamples());
+  EXPECT_NEAR(10000, histogram.getPercentile(50), 10000 / 4);
+  EXPECT_NEAR(10000, histogram.getMax(), 10000 / 4);
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <future>
+#include <thread>
+
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <fbzmq/async/ZmqTimeout.h>
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/init/Init.h>
+#include <glog/logging.h>
+#include <openr/common/TimerWheel.h>
+
+namespace {
+// Same resolution as Spark uses
+const std::chrono::milliseconds kTick{10};
+// Spark defaults for keep-alive and hold time
+const std::chrono::milliseconds kKeepAliveTime{2000};
+const std::chrono::milliseconds kHoldTime{6000};
+} // namespace
+
+namespace openr {
+
+/**
+ * Timers of a neighbor as in Spark. `helloRx` simulates hellos received from
+ * neighbor every keep-alive interval, each of them re-arming hold timer.
+ */
+struct NeighborTimers {
+  std::unique_ptr<TimerWheel::Timeout> holdTimer;
+  std::unique_ptr<TimerWheel::Timeout> helloRx;
+};
+
+static std::vector<NeighborTimers>
+createNeighbors(TimerWheel& wheel, size_t numNeighbors) {
+  std::vector<NeighborTimers> neighbors(numNeighbors);
+  for (auto& neighbor : neighbors) {
+    neighbor.holdTimer = TimerWheel::Timeout::make(&wheel, []() {});
+    neighbor.holdTimer->scheduleTimeout(kHoldTime);
+
+    auto holdTimer = neighbor.holdTimer.get();
+    neighbor.helloRx = TimerWheel::Timeout::make(
+        &wheel, [holdTimer]() { holdTimer->scheduleTimeout(kHoldTime); });
+    // hello interval of each neighbor is jittered by 20% like in Spark
+    const auto base = kKeepAliveTime.count();
+    const std::chrono::milliseconds helloInterval(
+        base * 4 / 5 + folly::Random::rand32(base * 2 / 5));
+    neighbor.helloRx->scheduleTimeout(helloInterval, true /* isPeriodic */);
+  }
+  return neighbors;
+}
+
+/**
+ * Benchmark cost of a single tick of wheel in steady state
+ * 1. Create timers for `numNeighbors` neighbors
+ * 2. Run simulated time for a hold time so that hellos are spread evenly
+ * 3. Advance wheel by one tick per iteration
+ */
+static void
+BM_TimerWheelTick(uint32_t iters, size_t numNeighbors) {
+  auto suspender = folly::BenchmarkSuspender();
+  TimerWheel wheel(nullptr, kTick);
+  auto neighbors = createNeighbors(wheel, numNeighbors);
+
+  auto now = std::chrono::steady_clock::now();
+  for (int i = 0; i < kHoldTime / kTick; ++i) {
+    now += kTick;
+    wheel.advance(now);
+  }
+  CHECK_EQ(2 * numNeighbors, wheel.getNumScheduled());
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; ++i) {
+    now += kTick;
+    wheel.advance(now);
+  }
+  suspender.rehire(); // Stop measuring time again
+}
+
+/**
+ * Benchmark cost of re-arming hold timers of all neighbors
+ */
+static void
+BM_TimerWheelReschedule(uint32_t iters, size_t numNeighbors) {
+  auto suspender = folly::BenchmarkSuspender();
+  TimerWheel wheel(nullptr, kTick);
+  auto neighbors = createNeighbors(wheel, numNeighbors);
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; ++i) {
+    for (auto& neighbor : neighbors) {
+      neighbor.holdTimer->scheduleTimeout(kHoldTime);
+    }
+  }
+  suspender.rehire(); // Stop measuring time again
+}
+
+/**
+ * Same as BM_TimerWheelReschedule with a fbzmq::ZmqTimeout per neighbor,
+ * as Spark used to have
+ */
+static void
+BM_ZmqTimeoutReschedule(uint32_t iters, size_t numNeighbors) {
+  auto suspender = folly::BenchmarkSuspender();
+  fbzmq::ZmqEventLoop evl;
+  std::thread evlThread([&]() { evl.run(); });
+  evl.waitUntilRunning();
+
+  // timeouts must be scheduled from event loop thread
+  auto runInLoop = [&evl](std::function<void()> fn) {
+    std::promise<void> done;
+    evl.runInEventLoop([&]() {
+      fn();
+      done.set_value();
+    });
+    done.get_future().wait();
+  };
+
+  std::vector<std::unique_ptr<fbzmq::ZmqTimeout>> holdTimers;
+  runInLoop([&]() {
+    for (size_t i = 0; i < numNeighbors; ++i) {
+      holdTimers.emplace_back(fbzmq::ZmqTimeout::make(&evl, []() noexcept {}));
+      holdTimers.back()->scheduleTimeout(kHoldTime);
+    }
+  });
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; ++i) {
+    runInLoop([&]() {
+      for (auto& holdTimer : holdTimers) {
+        holdTimer->scheduleTimeout(kHoldTime);
+      }
+    });
+  }
+  suspender.rehire(); // Stop measuring time again
+
+  runInLoop([&]() { holdTimers.clear(); });
+  evl.stop();
+  evlThread.join();
+}
+
+// The parameter is the number of neighbors
+BENCHMARK_PARAM(BM_TimerWheelTick, 100);
+BENCHMARK_PARAM(BM_TimerWheelTick, 1000);
+BENCHMARK_PARAM(BM_TimerWheelTick, 10000);
+BENCHMARK_PARAM(BM_TimerWheelTick, 100000);
+BENCHMARK_DRAW_LINE();
+BENCHMARK_PARAM(BM_TimerWheelReschedule, 100);
+BENCHMARK_PARAM(BM_TimerWheelReschedule, 1000);
+BENCHMARK_PARAM(BM_TimerWheelReschedule, 10000);
+BENCHMARK_DRAW_LINE();
+BENCHMARK_PARAM(BM_ZmqTimeoutReschedule, 100);
+BENCHMARK_PARAM(BM_ZmqTimeoutReschedule, 1000);
+BENCHMARK_PARAM(BM_ZmqTimeoutReschedule, 10000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <future>
+#include <thread>
+
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/TimerWheel.h>
+
+using namespace std::chrono_literals;
+
+namespace openr {
+
+namespace {
+const std::chrono::milliseconds kTick{10};
+} // namespace
+
+TEST(TimerWheelTest, ScheduleAndCancel) {
+  TimerWheel wheel(nullptr, kTick);
+  const auto start = std::chrono::steady_clock::now();
+
+  int numCalls{0};
+  auto timeout1 = TimerWheel::Timeout::make(&wheel, [&]() { ++numCalls; });
+  auto timeout2 = TimerWheel::Timeout::make(&wheel, [&]() { ++numCalls; });
+  EXPECT_FALSE(timeout1->isScheduled());
+
+  timeout1->scheduleTimeout(50ms);
+  timeout2->scheduleTimeout(50ms);
+  EXPECT_TRUE(timeout1->isScheduled());
+  EXPECT_EQ(2, wheel.getNumScheduled());
+
+  // Nothing expires before its time
+  EXPECT_EQ(0, wheel.advance(start + 30ms));
+  EXPECT_EQ(0, numCalls);
+
+  // Cancelled timeout doesn't fire
+  timeout2->cancelTimeout();
+  EXPECT_FALSE(timeout2->isScheduled());
+  EXPECT_EQ(1, wheel.getNumScheduled());
+
+  EXPECT_EQ(1, wheel.advance(start + 100ms));
+  EXPECT_EQ(1, numCalls);
+  EXPECT_FALSE(timeout1->isScheduled());
+  EXPECT_EQ(0, wheel.getNumScheduled());
+
+  // Rescheduling moves expiry
+  timeout1->scheduleTimeout(50ms);
+  timeout1->scheduleTimeout(200ms);
+  EXPECT_EQ(1, wheel.getNumScheduled());
+  EXPECT_EQ(0, wheel.advance(start + 200ms));
+  EXPECT_EQ(1, wheel.advance(start + 400ms));
+  EXPECT_EQ(2, numCalls);
+
+  // Destroyed timeout doesn't fire
+  timeout1->scheduleTimeout(50ms);
+  timeout1.reset();
+  EXPECT_EQ(0, wheel.getNumScheduled());
+  EXPECT_EQ(0, wheel.advance(start + 500ms));
+}
+
+TEST(TimerWheelTest, Periodic) {
+  TimerWheel wheel(nullptr, kTick);
+  const auto start = std::chrono::steady_clock::now();
+
+  int numCalls{0};
+  auto timeout = TimerWheel::Timeout::make(&wheel, [&]() { ++numCalls; });
+  timeout->scheduleTimeout(100ms, true /* isPeriodic */);
+
+  // Periodic timeout is re-armed relative to time it fired at, rounded up
+  // to tick boundary
+  for (int i = 1; i <= 5; ++i) {
+    EXPECT_EQ(1, wheel.advance(start + i * (100ms + 2 * kTick)));
+    EXPECT_EQ(i, numCalls);
+    EXPECT_TRUE(timeout->isScheduled());
+  }
+
+  timeout->cancelTimeout();
+  EXPECT_EQ(0, wheel.advance(start + 1s));
+  EXPECT_EQ(5, numCalls);
+}
+
+TEST(TimerWheelTest, LongTimeout) {
+  // Timeouts longer than a revolution of the wheel
+  TimerWheel wheel(nullptr, kTick, 8 /* numSlots */);
+  const auto start = std::chrono::steady_clock::now();
+
+  int numCalls{0};
+  auto timeout = TimerWheel::Timeout::make(&wheel, [&]() { ++numCalls; });
+  timeout->scheduleTimeout(500ms);
+
+  for (int i = 1; i < 49; ++i) {
+    EXPECT_EQ(0, wheel.advance(start + i * kTick));
+  }
+  EXPECT_EQ(1, wheel.advance(start + 520ms));
+  EXPECT_EQ(1, numCalls);
+
+  // Big jump in time fires everything expired in between
+  std::vector<std::unique_ptr<TimerWheel::Timeout>> timeouts;
+  for (int i = 0; i < 100; ++i) {
+    timeouts.emplace_back(
+        TimerWheel::Timeout::make(&wheel, [&]() { ++numCalls; }));
+    timeouts.back()->scheduleTimeout(i * 7ms);
+  }
+  EXPECT_EQ(100, wheel.advance(start + 10s));
+  EXPECT_EQ(101, numCalls);
+  EXPECT_EQ(0, wheel.getNumScheduled());
+}
+
+TEST(TimerWheelTest, ModifyFromCallback) {
+  TimerWheel wheel(nullptr, kTick);
+  const auto start = std::chrono::steady_clock::now();
+
+  std::unique_ptr<TimerWheel::Timeout> timeout1, timeout2, timeout3;
+  int numCalls1{0}, numCalls2{0}, numCalls3{0};
+
+  // timeout1 destroys timeout2 expiring at same tick and reschedules itself
+  timeout1 = TimerWheel::Timeout::make(&wheel, [&]() {
+    ++numCalls1;
+    timeout2.reset();
+    timeout1->scheduleTimeout(100ms);
+  });
+  timeout2 = TimerWheel::Timeout::make(&wheel, [&]() { ++numCalls2; });
+
+  // timeout3 destroys itself
+  timeout3 = TimerWheel::Timeout::make(&wheel, [&]() {
+    ++numCalls3;
+    timeout3.reset();
+  });
+
+  timeout1->scheduleTimeout(50ms);
+  timeout2->scheduleTimeout(50ms);
+  timeout3->scheduleTimeout(50ms);
+
+  EXPECT_EQ(2, wheel.advance(start + 100ms));
+  EXPECT_EQ(1, numCalls1);
+  EXPECT_EQ(0, numCalls2);
+  EXPECT_EQ(1, numCalls3);
+  EXPECT_EQ(nullptr, timeout2);
+  EXPECT_EQ(nullptr, timeout3);
+
+  // Rescheduled from callback, fires again later
+  EXPECT_TRUE(timeout1->isScheduled());
+  EXPECT_EQ(1, wheel.advance(start + 300ms));
+  EXPECT_EQ(2, numCalls1);
+}
+
+TEST(TimerWheelTest, EventLoopDriven) {
+  fbzmq::ZmqEventLoop evl;
+  std::thread evlThread([&]() { evl.run(); });
+  evl.waitUntilRunning();
+
+  std::unique_ptr<TimerWheel> wheel;
+  std::vector<std::unique_ptr<TimerWheel::Timeout>> timeouts;
+  std::promise<void> done;
+  int numCalls{0};
+
+  const auto start = std::chrono::steady_clock::now();
+  evl.runInEventLoop([&]() {
+    wheel = std::make_unique<TimerWheel>(&evl, kTick);
+    for (int i = 0; i < 10; ++i) {
+      timeouts.emplace_back(TimerWheel::Timeout::make(wheel.get(), [&]() {
+        if (++numCalls == 10) {
+          done.set_value();
+        }
+      }));
+      timeouts.back()->scheduleTimeout(i * 25ms);
+    }
+  });
+
+  done.get_future().wait();
+  EXPECT_LE(225ms, std::chrono::steady_clock::now() - start);
+
+  std::promise<void> cleanedUp;
+  evl.runInEventLoop([&]() {
+    EXPECT_EQ(0, wheel->getNumScheduled());
+    timeouts.clear();
+    wheel.reset();
+    cleanedUp.set_value();
+  });
+  cleanedUp.get_future().wait();
+  evl.stop();
+  evlThread.join();
+  EXPECT_EQ(10, numCalls);
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
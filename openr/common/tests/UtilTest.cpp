@@ -212,6 +212,21 @@ TEST(UtilTest, PrefixKeyTest) {
   k1.shouldPass = false;
   strToItems.push_back(k1);
 
+  // this should fail, no prefix length
+  k1.pkey = "prefix:nodename.0.0:99:[0.0.0.0]";
+  k1.shouldPass = false;
+  strToItems.push_back(k1);
+
+  // this should fail, prefix length out of range
+  k1.pkey = "prefix:nodename.0.0:99:[0.0.0.0/33]";
+  k1.shouldPass = false;
+  strToItems.push_back(k1);
+
+  // this should fail, no node name
+  k1.pkey = "prefix::99:[0.0.0.0/19]";
+  k1.shouldPass = false;
+  strToItems.push_back(k1);
+
   for (const auto& keys : strToItems) {
     auto prefixStr = PrefixKey::fromStr(keys.pkey);
     if (keys.shouldPass) {
@@ -257,7 +272,62 @@ TEST(UtilTest, PrefixKeyTest) {
         folly::sformat("{}/{}", keys.addr.str(), keys.plen));
     auto prefixStr = PrefixKey(keys.node, ipaddress, keys.area);
     EXPECT_EQ(prefixStr.getPrefixKey(), keys.pkey);
+
+    // same key out of binary prefix
+    auto ipPrefix = toIpPrefix(
+        folly::CIDRNetwork{keys.addr, static_cast<uint8_t>(keys.plen)});
+    EXPECT_EQ(ipaddress, toIPNetwork(ipPrefix));
+    EXPECT_EQ(
+        keys.pkey,
+        PrefixKey(keys.node, toIPNetwork(ipPrefix), keys.area).getPrefixKey());
+
+    // and back
+    auto parsed = PrefixKey::fromStr(keys.pkey);
+    ASSERT_TRUE(parsed.hasValue());
+    EXPECT_EQ(ipaddress, parsed->getCIDRNetwork());
+    EXPECT_EQ(keys.pkey, parsed->getPrefixKey());
   }
+
+  // non-canonical key parses into canonical one
+  auto parsed = PrefixKey::fromStr("prefix:node1:0:[10.1.1.1/024]");
+  ASSERT_TRUE(parsed.hasValue());
+  EXPECT_EQ("prefix:node1:0:[10.1.1.0/24]", parsed->getPrefixKey());
+  parsed = PrefixKey::fromStr("prefix:node1:0:[FC00:0::1/064]");
+  ASSERT_TRUE(parsed.hasValue());
+  EXPECT_EQ("prefix:node1:0:[fc00::/64]", parsed->getPrefixKey());
+
+  // non-ascii characters are rejected
+  EXPECT_FALSE(PrefixKey::fromStr("prefix:n\xe9:0:[10.1.1.0/24]").hasValue());
+  EXPECT_FALSE(PrefixKey::fromStr("prefix:node1:\xff:[::/0]").hasValue());
+
+  // unmasked network is kept as is on request, invalid prefix length throws
+  auto ipPrefix = toIpPrefix(folly::CIDRNetwork{folly::IPAddress("::1"), 64});
+  EXPECT_EQ("::1", toIPNetwork(ipPrefix, false).first.str());
+  EXPECT_EQ("::", toIPNetwork(ipPrefix).first.str());
+  ipPrefix.prefixLength = 129;
+  EXPECT_THROW(toIPNetwork(ipPrefix), folly::IPAddressFormatException);
+}
+
+TEST(UtilTest, AdjacencyKeyTest) {
+  const PerAdjacencyKey key("node-1", "node_2", "po1011");
+  EXPECT_EQ("adj:node-1:node_2:po1011", key.getAdjacencyKey());
+
+  auto parsed = PerAdjacencyKey::fromStr(key.getAdjacencyKey());
+  ASSERT_TRUE(parsed.hasValue());
+  EXPECT_EQ("node-1", parsed->getNodeName());
+  EXPECT_EQ("node_2", parsed->getOtherNodeName());
+  EXPECT_EQ("po1011", parsed->getIfName());
+
+  // interface names may have colons in them
+  parsed = PerAdjacencyKey::fromStr("adj:node1:node2:eth0:1");
+  ASSERT_TRUE(parsed.hasValue());
+  EXPECT_EQ("node2", parsed->getOtherNodeName());
+  EXPECT_EQ("eth0:1", parsed->getIfName());
+
+  // adjacency database key of node is not an adjacency key
+  EXPECT_FALSE(PerAdjacencyKey::fromStr("adj:node1").hasValue());
+  EXPECT_FALSE(PerAdjacencyKey::fromStr("adj:node1:node2").hasValue());
+  EXPECT_FALSE(PerAdjacencyKey::fromStr("prefix:node1:node2:if1").hasValue());
 }
 
 TEST(UtilTest, GetNodeNameFromKeyTest) {
@@ -266,6 +336,9 @@ TEST(UtilTest, GetNodeNameFromKeyTest) {
 
   const std::string s2{"prefix:nodename.0.0:10:[0.0.0.0/0]"};
   EXPECT_EQ("nodename.0.0", getNodeNameFromKey(s2));
+
+  const std::string s3{"adj:node1:node2:if_1_2"};
+  EXPECT_EQ("node1", getNodeNameFromKey(s3));
 }
 
 // test getNthPrefix()
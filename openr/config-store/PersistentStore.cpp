@@ -7,10 +7,18 @@
 
 #include "PersistentStore.h"
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <chrono>
+#include <cstdio>
 
+#include <folly/Exception.h>
 #include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/hash/Checksum.h>
 #include <folly/io/IOBuf.h>
+#include <folly/system/MemoryMapping.h>
 
 #include <openr/common/Util.h>
 
@@ -18,7 +26,53 @@ using std::exception;
 
 namespace {
 
-static const long kDbFlushRatio = 10000;
+// Log is compacted once it is at least this large and holds this many times
+// more bytes than compacted log would
+const int64_t kLogCompactionMinBytes = 1024 * 1024;
+const int64_t kLogCompactionRatio = 2;
+
+// Compacted log is written next to the log and renamed over it when complete
+const std::string kCompactionFileSuffix{".compact"};
+
+// Log record header, length and checksum of encoded PersistentObject
+const size_t kLogRecordHeaderSize = 2 * sizeof(uint32_t);
+
+// Size of record of a key with given data, in log or Tlv format
+int64_t
+getLogRecordSize(
+    const std::string& key, const std::string& data, bool logFormat) {
+  return (logFormat ? kLogRecordHeaderSize : 0) + sizeof(uint8_t) +
+      sizeof(uint32_t) + key.size() + sizeof(uint32_t) + data.size();
+}
+
+folly::StringPiece
+getFormatMarker(bool logFormat) {
+  return logFormat ? kLogFormatMarker : kTlvFormatMarker;
+}
+
+uint32_t
+getChecksum(const folly::IOBuf& ioBuf) {
+  uint32_t checksum = ~0U;
+  for (const auto& range : ioBuf) {
+    checksum = folly::crc32c(range.data(), range.size(), checksum);
+  }
+  return checksum;
+}
+
+// Write whole IoBuf chain to file at its current offset
+folly::Expected<folly::Unit, std::string>
+writeIoBufToFile(const folly::File& file, folly::IOBuf& ioBuf) noexcept {
+  try {
+    const auto data = ioBuf.coalesce();
+    folly::checkUnixError(
+        folly::writeFull(file.fd(), data.data(), data.size()), "write failed");
+    folly::checkUnixError(folly::fdatasyncNoInt(file.fd()), "fdatasync failed");
+  } catch (std::exception const& e) {
+    return folly::makeUnexpected<std::string>(
+        folly::exceptionStr(e).toStdString());
+  }
+  return folly::Unit();
+}
 
 } // anonymous namespace
 
@@ -30,11 +84,13 @@ PersistentStore::PersistentStore(
     fbzmq::Context& context,
     std::chrono::milliseconds saveInitialBackoff,
     std::chrono::milliseconds saveMaxBackoff,
-    bool dryrun)
+    bool dryrun,
+    bool logFormat)
     : OpenrEventLoop(
           nodeName, thrift::OpenrModuleType::PERSISTENT_STORE, context),
       storageFilePath_(storageFilePath),
-      dryrun_(dryrun) {
+      dryrun_(dryrun),
+      logFormat_(logFormat) {
   if (saveInitialBackoff != 0ms or saveMaxBackoff != 0ms) {
     // Create timer and backoff mechanism only if backoff is requested
     saveDbTimerBackoff_ =
@@ -54,15 +110,36 @@ PersistentStore::PersistentStore(
   }
 
   // Load initial database. On failure we will just report error and continue
-  // with empty database
+  // with empty database. Unreadable file is kept aside rather than appended
+  // to.
   if (not loadDatabaseFromDisk()) {
     LOG(ERROR) << "Failed to load config-database from file: "
                << storageFilePath_;
+    if (not dryrun_) {
+      ::rename(
+          storageFilePath_.c_str(), (storageFilePath_ + ".corrupt").c_str());
+    }
+  }
+  for (const auto& keyVal : database_.keyVals) {
+    liveBytes_ += getLogRecordSize(keyVal.first, keyVal.second, logFormat_);
+  }
+
+  if (not dryrun_ and not logFile_) {
+    openLogFile();
   }
 }
 
 PersistentStore::~PersistentStore() {
-  saveDatabaseToDisk();
+  if (not pObjects_.empty()) {
+    savePersistentObjectToDisk();
+  }
+
+  // Result of compaction, if any, won't be picked up by stopped event loop.
+  // Log it was started from is complete on its own.
+  if (compactionThread_.joinable()) {
+    compactionThread_.join();
+    ::unlink((storageFilePath_ + kCompactionFileSuffix).c_str());
+  }
 }
 
 folly::Expected<fbzmq::Message, fbzmq::Error>
@@ -80,7 +157,18 @@ PersistentStore::processRequestMsg(fbzmq::Message&& requestMsg) {
   PersistentObject pObject;
   switch (request->requestType) {
   case thrift::StoreRequestType::STORE: {
+    // Nothing to write if key already has this value, whoever stored it
+    auto it = database_.keyVals.find(request->key);
+    if (it != database_.keyVals.end() and it->second == request->data) {
+      response.success = true;
+      return fbzmq::Message::fromThriftObj(response, serializer_);
+    }
+
     // Override previous value if any
+    if (it != database_.keyVals.end()) {
+      liveBytes_ -= getLogRecordSize(it->first, it->second, logFormat_);
+    }
+    liveBytes_ += getLogRecordSize(request->key, request->data, logFormat_);
     database_.keyVals[request->key] = request->data;
     pObject = toPersistentObject(ActionType::ADD, request->key, request->data);
     response.success = true;
@@ -94,7 +182,12 @@ PersistentStore::processRequestMsg(fbzmq::Message&& requestMsg) {
     break;
   }
   case thrift::StoreRequestType::ERASE: {
-    response.success = database_.keyVals.erase(request->key) > 0;
+    auto it = database_.keyVals.find(request->key);
+    response.success = it != database_.keyVals.end();
+    if (response.success) {
+      liveBytes_ -= getLogRecordSize(it->first, it->second, logFormat_);
+      database_.keyVals.erase(it);
+    }
     pObject = toPersistentObject(ActionType::DEL, request->key, request->data);
     break;
   }
@@ -126,90 +219,254 @@ PersistentStore::processRequestMsg(fbzmq::Message&& requestMsg) {
 
 bool
 PersistentStore::savePersistentObjectToDisk() noexcept {
-  if (not dryrun_) {
-    // Write PersistentObject to ioBuf
-    std::vector<PersistentObject> newObjects;
-    newObjects = std::move(pObjects_);
-
-    auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
-
-    for (auto& pObject : newObjects) {
-      auto buf = encodePersistentObject(pObject);
-      if (buf.hasError()) {
-        LOG(ERROR) << "Failed to encode PersistentObject to ioBuf. Error: "
-                   << folly::exceptionStr(buf.error());
-        return false;
-      }
-      queue.append(std::move(**buf));
-    }
+  if (dryrun_) {
+    VLOG(1) << "Skipping writing to disk in dryrun mode";
+    pObjects_.clear();
+    numOfWritesToDisk_++;
+    return true;
+  }
+  if (pObjects_.empty()) {
+    return true;
+  }
 
-    // Append IoBuf to disk
-    auto ioBuf = queue.move();
-    auto success = writeIoBufToDisk(ioBuf, WriteType::APPEND);
-    if (success.hasError()) {
-      LOG(ERROR) << "Failed to write PersistentObject to file '"
-                 << storageFilePath_
-                 << "'. Error: " << folly::exceptionStr(success.error());
+  // All objects accumulated since last save are appended with single write
+  // and fdatasync
+  auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
+  for (const auto& pObject : pObjects_) {
+    auto buf = encodeRecord(pObject, logFormat_);
+    if (buf.hasError()) {
+      LOG(ERROR) << "Failed to encode PersistentObject to ioBuf. Error: "
+                 << buf.error();
       return false;
     }
+    queue.append(std::move(*buf));
+  }
 
-    numOfNewWritesToDisk_++;
-
-    // Write the whole database to disk periodically
-    if (numOfNewWritesToDisk_ >= kDbFlushRatio) {
-      numOfNewWritesToDisk_ = 0;
-      const auto startTs = std::chrono::steady_clock::now();
-      if (not saveDatabaseToDisk()) {
-        return false;
-      }
-      LOG(INFO) << "Updated database on disk. Took "
-                << std::chrono::duration_cast<std::chrono::milliseconds>(
-                       std::chrono::steady_clock::now() - startTs)
-                       .count()
-                << "ms";
-    }
-  } else {
-    VLOG(1) << "Skipping writing to disk in dryrun mode";
+  // Objects are kept around for retry on failure
+  auto success = appendToLog(queue.move());
+  if (success.hasError()) {
+    LOG(ERROR) << "Failed to write PersistentObject to file '"
+               << storageFilePath_ << "'. Error: " << success.error();
+    return false;
   }
+  pObjects_.clear();
   numOfWritesToDisk_++;
 
+  maybeStartCompaction();
   return true;
 }
 
 bool
-PersistentStore::saveDatabaseToDisk() noexcept {
-  std::unique_ptr<folly::IOBuf> ioBuf;
-  // If database is empty, write 'kTlvFormatMarker' to disk and return
-  if (database_.keyVals.size() == 0) {
-    ioBuf = folly::IOBuf::copyBuffer(
-        kTlvFormatMarker.data(), kTlvFormatMarker.size());
+PersistentStore::openLogFile() noexcept {
+  try {
+    folly::File file(storageFilePath_, O_RDWR | O_APPEND | O_CREAT, 0666);
+    struct stat fileStat;
+    folly::checkUnixError(::fstat(file.fd(), &fileStat), "fstat failed");
+    const auto formatMarker = getFormatMarker(logFormat_);
+    if (fileStat.st_size > 0) {
+      // Never append records to file in other format
+      std::string marker(formatMarker.size(), '\0');
+      if (folly::preadFull(file.fd(), &marker[0], marker.size(), 0) !=
+              static_cast<ssize_t>(marker.size()) or
+          marker != formatMarker) {
+        throw std::runtime_error("file is not in expected format");
+      }
+    } else {
+      auto marker =
+          folly::IOBuf::copyBuffer(formatMarker.data(), formatMarker.size());
+      auto success = writeIoBufToFile(file, *marker);
+      if (success.hasError()) {
+        throw std::runtime_error(success.error());
+      }
+      fileStat.st_size = formatMarker.size();
+      numOfBytesWrittenToDisk_ += formatMarker.size();
+    }
+    logFile_ = std::move(file);
+    logBytes_ = fileStat.st_size;
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to open file '" << storageFilePath_
+               << "' for appending. Error: " << folly::exceptionStr(e);
+    return false;
+  }
+  return true;
+}
+
+folly::Expected<folly::Unit, std::string>
+PersistentStore::appendToLog(std::unique_ptr<folly::IOBuf> ioBuf) noexcept {
+  // Start over with fresh log if existing one can't be appended to. Records
+  // being appended are in it already, appending them again is harmless.
+  if (not logFile_ and not saveDatabaseToDisk()) {
+    return folly::makeUnexpected<std::string>("log file is not open");
+  }
+
+  const int64_t length = ioBuf->computeChainDataLength();
+  auto success = writeIoBufToFile(logFile_, *ioBuf);
+  if (success.hasError()) {
+    // Drop partially written records, replay would otherwise stop at them
+    // and miss everything appended later
+    folly::ftruncateNoInt(logFile_.fd(), logBytes_);
+    return success;
+  }
+  logBytes_ += length;
+  numOfBytesWrittenToDisk_ += length;
+
+  // Compacted log is going to miss these, they are appended to it later
+  if (compactionThread_.joinable()) {
+    compactionTail_.append(std::move(ioBuf));
+  }
+  return folly::Unit();
+}
+
+void
+PersistentStore::maybeStartCompaction() noexcept {
+  if (compactionThread_.joinable() or logBytes_ < kLogCompactionMinBytes or
+      logBytes_ < kLogCompactionRatio * liveBytes_) {
+    return;
+  }
+
+  VLOG(1) << "Compacting log of " << logBytes_ << " bytes, " << liveBytes_
+          << " bytes of it live";
+  // Only copying database is done on event loop, encoding and writing it out
+  // is done on compaction thread
+  const auto startTs = std::chrono::steady_clock::now();
+  compactionThread_ =
+      std::thread([this, database = database_, startTs]() noexcept {
+        auto result = writeSnapshotToDisk(
+            storageFilePath_ + kCompactionFileSuffix, database, logFormat_);
+        runInEventLoop([this, result = std::move(result), startTs]() noexcept {
+          finishCompaction(result, startTs);
+        });
+      });
+}
+
+void
+PersistentStore::finishCompaction(
+    folly::Expected<int64_t, std::string> const& result,
+    std::chrono::steady_clock::time_point startTs) noexcept {
+  compactionThread_.join();
+  auto tail = compactionTail_.move();
+
+  const auto compactionFilePath = storageFilePath_ + kCompactionFileSuffix;
+  folly::Expected<folly::Unit, std::string> success = folly::Unit();
+  if (result.hasError()) {
+    success = folly::makeUnexpected(result.error());
   } else {
-    // Append kTlvFormatMarker to queue
-    auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
-    queue.append(kTlvFormatMarker.data(), kTlvFormatMarker.size());
-
-    // Encode database_ and append to queue
-    for (auto& keyPair : database_.keyVals) {
-      PersistentObject pObject;
-      pObject =
-          toPersistentObject(ActionType::ADD, keyPair.first, keyPair.second);
-
-      auto buf = encodePersistentObject(pObject);
-      if (buf.hasError()) {
-        LOG(ERROR) << "Failed to encode PersistentObject to ioBuf. Error:  "
-                   << folly::exceptionStr(buf.error());
-        return false;
+    success = replaceLog(compactionFilePath, *result, std::move(tail));
+  }
+  if (success.hasError()) {
+    // Log stays as it is, compaction is retried with next write
+    LOG(ERROR) << "Failed to compact file '" << storageFilePath_
+               << "'. Error: " << success.error();
+    ::unlink(compactionFilePath.c_str());
+    return;
+  }
+
+  numOfCompactions_++;
+  LOG(INFO) << "Compacted database on disk to " << logBytes_ << " bytes. Took "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - startTs)
+                   .count()
+            << "ms";
+}
+
+folly::Expected<int64_t, std::string>
+PersistentStore::writeSnapshotToDisk(
+    const std::string& filePath,
+    const thrift::StoreDatabase& database,
+    bool logFormat) noexcept {
+  auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
+  const auto marker = getFormatMarker(logFormat);
+  queue.append(marker.data(), marker.size());
+  for (const auto& keyVal : database.keyVals) {
+    PersistentObject pObject;
+    pObject.type = ActionType::ADD;
+    pObject.key = keyVal.first;
+    pObject.data = keyVal.second;
+    auto buf = encodeRecord(pObject, logFormat);
+    if (buf.hasError()) {
+      return folly::makeUnexpected(buf.error());
+    }
+    queue.append(std::move(*buf));
+  }
+
+  auto ioBuf = queue.move();
+  const int64_t length = ioBuf->computeChainDataLength();
+  try {
+    folly::File file(filePath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    auto success = writeIoBufToFile(file, *ioBuf);
+    if (success.hasError()) {
+      return folly::makeUnexpected(success.error());
+    }
+  } catch (std::exception const& e) {
+    return folly::makeUnexpected<std::string>(
+        folly::exceptionStr(e).toStdString());
+  }
+  return length;
+}
+
+folly::Expected<folly::Unit, std::string>
+PersistentStore::replaceLog(
+    const std::string& compactionFilePath,
+    int64_t compactedBytes,
+    std::unique_ptr<folly::IOBuf> tail) noexcept {
+  try {
+    folly::File file(compactionFilePath, O_WRONLY | O_APPEND);
+    int64_t tailBytes{0};
+    if (tail) {
+      tailBytes = tail->computeChainDataLength();
+      auto success = writeIoBufToFile(file, *tail);
+      if (success.hasError()) {
+        return success;
       }
-      queue.append(std::move(*buf));
     }
-    // Write queue to disk
-    ioBuf = queue.move();
+    folly::checkUnixError(
+        ::rename(compactionFilePath.c_str(), storageFilePath_.c_str()),
+        "rename failed");
+
+    // Compacted log is the log from here on, whatever happens next. Its
+    // descriptor stays valid across rename, keep appending through it.
+    logFile_ = std::move(file);
+    logBytes_ = compactedBytes + tailBytes;
+    numOfBytesWrittenToDisk_ += compactedBytes + tailBytes;
+  } catch (std::exception const& e) {
+    return folly::makeUnexpected<std::string>(
+        folly::exceptionStr(e).toStdString());
   }
 
-  auto success = writeIoBufToDisk(ioBuf, WriteType::WRITE);
+  // Make rename durable, directory entry is what points to new log. Either
+  // log holds every record appended so far, so failure only risks finding
+  // the old one after power loss and isn't failure of compaction.
+  try {
+    const auto slash = storageFilePath_.rfind('/');
+    folly::File dir(
+        slash == std::string::npos ? std::string(".")
+                                   : storageFilePath_.substr(0, slash + 1),
+        O_RDONLY);
+    if (folly::fsyncNoInt(dir.fd()) != 0) {
+      LOG(WARNING) << "Failed to fsync directory of '" << storageFilePath_
+                   << "'. Error: " << folly::errnoStr(errno);
+    }
+  } catch (std::exception const& e) {
+    LOG(WARNING) << "Failed to fsync directory of '" << storageFilePath_
+                 << "'. Error: " << folly::exceptionStr(e);
+  }
+  return folly::Unit();
+}
+
+bool
+PersistentStore::saveDatabaseToDisk() noexcept {
+  const auto compactionFilePath = storageFilePath_ + kCompactionFileSuffix;
+  auto result = writeSnapshotToDisk(compactionFilePath, database_, logFormat_);
+  folly::Expected<folly::Unit, std::string> success = folly::Unit();
+  if (result.hasError()) {
+    success = folly::makeUnexpected(result.error());
+  } else {
+    success = replaceLog(compactionFilePath, *result, nullptr);
+  }
   if (success.hasError()) {
     LOG(ERROR) << "Failed to write database to file '" << storageFilePath_
-               << "'. Error: " << folly::exceptionStr(success.error());
+               << "'. Error: " << success.error();
+    ::unlink(compactionFilePath.c_str());
     return false;
   }
   return true;
@@ -224,37 +481,74 @@ PersistentStore::loadDatabaseFromDisk() noexcept {
     return true;
   }
 
-  // Read data from file
-  std::string fileData{""};
-  if (not folly::readFile(storageFilePath_.c_str(), fileData)) {
-    LOG(ERROR) << "Failed to read file contents from '" << storageFilePath_
-               << "'. Error (" << errno << "): " << folly::errnoStr(errno);
-    return false;
-  }
+  try {
+    // Replay straight from page cache instead of reading file into memory
+    folly::File file(storageFilePath_);
+    struct stat fileStat;
+    folly::checkUnixError(::fstat(file.fd(), &fileStat), "fstat failed");
+    if (fileStat.st_size == 0) {
+      return true;
+    }
+    folly::MemoryMapping mapping(std::move(file));
+    const auto fileData = mapping.range();
+
+    // Create IoBuf and cursor for loading data from disk
+    auto ioBuf = folly::IOBuf::wrapBuffer(fileData.data(), fileData.size());
+    const auto contents = folly::StringPiece(fileData);
+
+    // Log format, converted back to Tlv one if it isn't enabled (downgrade)
+    if (contents.startsWith(kLogFormatMarker)) {
+      const auto validBytes = loadDatabaseLogFormat(ioBuf);
+      if (dryrun_) {
+        return true;
+      }
+      if (validBytes < fileData.size()) {
+        // Records past first bad one may still be valid, keep copy of whole
+        // file around for inspection before dropping them
+        const auto corruptFilePath = storageFilePath_ + ".corrupt";
+        LOG(WARNING) << "Dropping " << fileData.size() - validBytes
+                     << " bytes of torn or corrupted records at the end of '"
+                     << storageFilePath_ << "', copied it to '"
+                     << corruptFilePath << "'";
+        if (not folly::writeFile(contents, corruptFilePath.c_str())) {
+          LOG(ERROR) << "Failed to copy '" << storageFilePath_ << "' to '"
+                     << corruptFilePath << "'";
+        }
+      }
+      if (not logFormat_) {
+        saveDatabaseToDisk();
+      } else if (validBytes < fileData.size()) {
+        folly::checkUnixError(
+            ::truncate(storageFilePath_.c_str(), validBytes),
+            "truncate failed");
+      }
+      return true;
+    }
 
-  // Create IoBuf and cursor for loading data from disk
-  auto ioBuf = folly::IOBuf::wrapBuffer(fileData.c_str(), fileData.size());
-  folly::io::Cursor cursor(ioBuf.get());
+    // Tlv format, converted to log one if it is enabled
+    if (contents.startsWith(kTlvFormatMarker)) {
+      auto tlvSuccess = loadDatabaseTlvFormat(ioBuf);
+      if (tlvSuccess.hasError()) {
+        LOG(ERROR) << "Failed to read Tlv-format file contents from '"
+                   << storageFilePath_ << "'. Error: " << tlvSuccess.error();
+        return false;
+      }
+      if (not dryrun_ and logFormat_) {
+        saveDatabaseToDisk();
+      }
+      return true;
+    }
 
-  // Read 'kTlvFormatMarker' from ioBuf
-  if (not cursor.canAdvance(kTlvFormatMarker.size()) or
-      cursor.readFixedString(kTlvFormatMarker.size()) != kTlvFormatMarker) {
-    // Load old Format and write TlvFormat
+    // Load old Format and write log format
     auto oldSuccess = loadDatabaseOldFormat(ioBuf);
     if (oldSuccess.hasError()) {
       LOG(ERROR) << "Failed to read old-format file contents from '"
-                 << storageFilePath_
-                 << "'. Error: " << folly::exceptionStr(oldSuccess.error());
+                 << storageFilePath_ << "'. Error: " << oldSuccess.error();
       return false;
     }
-    return true;
-  }
-  // Load TlvFormat
-  auto tlvSuccess = loadDatabaseTlvFormat(ioBuf);
-  if (tlvSuccess.hasError()) {
-    LOG(ERROR) << "Failed to read Tlv-format file contents from '"
-               << storageFilePath_
-               << "'. Error: " << folly::exceptionStr(tlvSuccess.error());
+  } catch (std::exception const& e) {
+    LOG(ERROR) << "Failed to read file contents from '" << storageFilePath_
+               << "'. Error: " << folly::exceptionStr(e);
     return false;
   }
   return true;
@@ -268,8 +562,10 @@ PersistentStore::loadDatabaseOldFormat(
     thrift::StoreDatabase newDatabase;
     serializer_.deserialize(ioBuf.get(), newDatabase);
     database_ = std::move(newDatabase);
-    // Write Tlv format to disk
-    saveDatabaseToDisk();
+    // Write log format to disk
+    if (not dryrun_) {
+      saveDatabaseToDisk();
+    }
   } catch (std::exception const& e) {
     return folly::makeUnexpected<std::string>(
         folly::exceptionStr(e).toStdString());
@@ -316,31 +612,41 @@ PersistentStore::loadDatabaseTlvFormat(
   return folly::Unit();
 }
 
-// Write over or append IoBuf to disk atomically
-folly::Expected<folly::Unit, std::string>
-PersistentStore::writeIoBufToDisk(
-    const std::unique_ptr<folly::IOBuf>& ioBuf, WriteType writeType) noexcept {
-  std::string fileData("");
-  try {
-    ioBuf->coalesce();
-    fileData = ioBuf->moveToFbString().toStdString();
+size_t
+PersistentStore::loadDatabaseLogFormat(
+    const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept {
+  // Marker is checked by caller
+  folly::io::Cursor cursor(ioBuf.get());
+  cursor.skip(kLogFormatMarker.size());
+  size_t validBytes = cursor.getCurrentPosition();
 
-    if (writeType == WriteType::WRITE) {
-      // Write over
-      folly::writeFileAtomic(storageFilePath_, fileData, 0666);
-    } else {
-      // Append to file
-      folly::writeFile(
-          fileData,
-          storageFilePath_.c_str(),
-          O_WRONLY | O_APPEND | O_CREAT,
-          0666);
+  thrift::StoreDatabase newDatabase;
+  while (true) {
+    auto optionalObject = decodeLogRecord(cursor);
+    if (optionalObject.hasError()) {
+      LOG(WARNING) << "Stopping replay of '" << storageFilePath_
+                   << "' at offset " << validBytes
+                   << ". Error: " << optionalObject.error();
+      break;
+    }
+
+    // Read finish
+    if (not optionalObject->hasValue()) {
+      break;
+    }
+    validBytes = cursor.getCurrentPosition();
+    auto pObject = std::move(optionalObject->value());
+
+    // Add/Delete persistentObject to/from 'newDatabase'
+    if (pObject.type == ActionType::ADD) {
+      newDatabase.keyVals[pObject.key] =
+          pObject.data.has_value() ? std::move(pObject.data.value()) : "";
+    } else if (pObject.type == ActionType::DEL) {
+      newDatabase.keyVals.erase(pObject.key);
     }
-  } catch (std::exception const& e) {
-    return folly::makeUnexpected<std::string>(
-        folly::exceptionStr(e).toStdString());
   }
-  return folly::Unit();
+  database_ = std::move(newDatabase);
+  return validBytes;
 }
 
 // A made up encoding of a PersistentObject.
@@ -405,6 +711,62 @@ PersistentStore::decodePersistentObject(folly::io::Cursor& cursor) noexcept {
   }
 }
 
+// PersistentObject prefixed with its length and CRC32C, which tells torn or
+// corrupted record apart from valid one on replay
+folly::Expected<std::unique_ptr<folly::IOBuf>, std::string>
+PersistentStore::encodeLogRecord(const PersistentObject& pObject) noexcept {
+  auto payload = encodePersistentObject(pObject);
+  if (payload.hasError()) {
+    return payload;
+  }
+
+  auto buf = folly::IOBuf::create(kLogRecordHeaderSize);
+  folly::io::Appender appender(buf.get(), 0);
+  try {
+    appender.writeBE<uint32_t>((*payload)->computeChainDataLength());
+    appender.writeBE<uint32_t>(getChecksum(**payload));
+  } catch (const exception& e) {
+    return folly::makeUnexpected<std::string>(
+        folly::exceptionStr(e).toStdString());
+  }
+  buf->prependChain(std::move(*payload));
+  return buf;
+}
+
+folly::Expected<std::unique_ptr<folly::IOBuf>, std::string>
+PersistentStore::encodeRecord(
+    const PersistentObject& pObject, bool logFormat) noexcept {
+  return logFormat ? encodeLogRecord(pObject) : encodePersistentObject(pObject);
+}
+
+folly::Expected<folly::Optional<PersistentObject>, std::string>
+PersistentStore::decodeLogRecord(folly::io::Cursor& cursor) noexcept {
+  // If nothing can be read, return
+  if (not cursor.canAdvance(1)) {
+    return folly::none;
+  }
+
+  std::unique_ptr<folly::IOBuf> payload;
+  try {
+    const auto length = cursor.readBE<uint32_t>();
+    const auto checksum = cursor.readBE<uint32_t>();
+    cursor.clone(payload, length);
+    if (getChecksum(*payload) != checksum) {
+      return folly::makeUnexpected<std::string>("checksum mismatch");
+    }
+  } catch (std::out_of_range& e) {
+    return folly::makeUnexpected<std::string>("truncated record");
+  }
+
+  folly::io::Cursor payloadCursor(payload.get());
+  auto optionalObject = decodePersistentObject(payloadCursor);
+  if (optionalObject.hasValue() and
+      (not optionalObject->hasValue() or payloadCursor.canAdvance(1))) {
+    return folly::makeUnexpected<std::string>("malformed record");
+  }
+  return optionalObject;
+}
+
 // Create a PersistentObject and assign value to it.
 PersistentObject
 PersistentStore::toPersistentObject(
@@ -9,10 +9,14 @@
 
 #include <chrono>
 #include <string>
+#include <thread>
 
 #include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/async/ZmqTimeout.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/File.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBufQueue.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/Constants.h>
@@ -23,7 +27,7 @@
 
 namespace {
 constexpr folly::StringPiece kTlvFormatMarker{"TlvFormatMarker"};
-enum WriteType { APPEND = 1, WRITE = 2 };
+constexpr folly::StringPiece kLogFormatMarker{"OpenrLogFormatV1"};
 
 } // anonymous namespace
 
@@ -46,6 +50,20 @@ struct PersistentObject {
  * `storageFilePath`: Describe the path of file in file system where data will
  * be stored/retrieved from (in binary format).
  *
+ * File is a log of checksummed records, each being addition or removal of a
+ * key. Changes accumulated during save backoff are appended with single write
+ * and fdatasync (group commit), so cost of write is proportional to size of
+ * change rather than of database. Once log grows well beyond size of live
+ * data it is compacted on background thread, off the event loop. On startup
+ * log is replayed from memory mapped file, torn or corrupted tail (e.g. write
+ * interrupted by crash) is dropped. Files in older formats are converted on
+ * load.
+ *
+ * Log format is written only if `logFormat` is set, otherwise records are
+ * appended in Tlv format which older releases read, and log format file is
+ * converted back to it on load. This keeps downgrade possible until log
+ * format is default.
+ *
  * You can interact with this module via ZMQ-Socket APIs described in
  * PersistentStore.thrift file via `REP` socket.
  *
@@ -65,9 +83,11 @@ class PersistentStore : public OpenrEventLoop {
           Constants::kPersistentStoreInitialBackoff,
       std::chrono::milliseconds saveMaxBackoff =
           Constants::kPersistentStoreMaxBackoff,
-      bool dryrun = false);
+      bool dryrun = false,
+      bool logFormat = false);
 
-  // Destructor will try to save DB to disk before destroying the object
+  // Destructor will try to write pending changes to disk before destroying
+  // the object
   ~PersistentStore() override;
 
   uint64_t
@@ -75,22 +95,41 @@ class PersistentStore : public OpenrEventLoop {
     return numOfWritesToDisk_;
   }
 
+  uint64_t
+  getNumOfCompactions() const {
+    return numOfCompactions_;
+  }
+
+  // Bytes written to disk, including compacted logs
+  uint64_t
+  getNumOfBytesWrittenToDisk() const {
+    return numOfBytesWrittenToDisk_;
+  }
+
   // Encode a PersistentObject, this can be private method, but for unit test,
   // we make it public
   static folly::Expected<std::unique_ptr<folly::IOBuf>, std::string>
   encodePersistentObject(const PersistentObject& pObject) noexcept;
   // Decode a PersistentObject, this can be private method, but for test,
   // we make it public
-  folly::Expected<folly::Optional<PersistentObject>, std::string>
+  static folly::Expected<folly::Optional<PersistentObject>, std::string>
   decodePersistentObject(folly::io::Cursor& cursor) noexcept;
 
+  // Encode/decode a PersistentObject as log record, i.e. prefixed with its
+  // length and checksum. Public for unit test.
+  static folly::Expected<std::unique_ptr<folly::IOBuf>, std::string>
+  encodeLogRecord(const PersistentObject& pObject) noexcept;
+  static folly::Expected<folly::Optional<PersistentObject>, std::string>
+  decodeLogRecord(folly::io::Cursor& cursor) noexcept;
+
  private:
   // Function to process pending request on reqSocket_
   folly::Expected<fbzmq::Message, fbzmq::Error> processRequestMsg(
       fbzmq::Message&& request) override;
 
   // Function to save/load `database_` to local disk. Returns true on success
-  // else false. Doesn't throw exception.
+  // else false. Doesn't throw exception. Saving rewrites the whole log, it is
+  // only used where blocking is fine (startup and shutdown).
   bool saveDatabaseToDisk() noexcept;
   bool loadDatabaseFromDisk() noexcept;
 
@@ -102,12 +141,47 @@ class PersistentStore : public OpenrEventLoop {
   folly::Expected<folly::Unit, std::string> loadDatabaseTlvFormat(
       const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept;
 
+  // Replay log from disk. Returns number of leading bytes holding valid
+  // records, anything beyond is torn or corrupted.
+  size_t loadDatabaseLogFormat(
+      const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept;
+
   // Function to save Persistent Object to local disk.
   bool savePersistentObjectToDisk() noexcept;
 
-  // Write IoBuf ro local disk
-  folly::Expected<folly::Unit, std::string> writeIoBufToDisk(
-      const std::unique_ptr<folly::IOBuf>& ioBuf, WriteType writeType) noexcept;
+  // Open log for appending, starting new one if file is empty
+  bool openLogFile() noexcept;
+
+  // Append records to log and make them durable
+  folly::Expected<folly::Unit, std::string> appendToLog(
+      std::unique_ptr<folly::IOBuf> ioBuf) noexcept;
+
+  // Write `database` as compacted log to `filePath`. Returns number of bytes
+  // written. Doesn't touch any state of the store, it is run on compaction
+  // thread.
+  static folly::Expected<int64_t, std::string> writeSnapshotToDisk(
+      const std::string& filePath,
+      const thrift::StoreDatabase& database,
+      bool logFormat) noexcept;
+
+  // Replace log with compacted one at `compactionFilePath`, with `tail`
+  // appended to it
+  folly::Expected<folly::Unit, std::string> replaceLog(
+      const std::string& compactionFilePath,
+      int64_t compactedBytes,
+      std::unique_ptr<folly::IOBuf> tail) noexcept;
+
+  // Compact log on background thread if it has grown large enough
+  void maybeStartCompaction() noexcept;
+
+  // Pick up result of background compaction, on event loop
+  void finishCompaction(
+      folly::Expected<int64_t, std::string> const& result,
+      std::chrono::steady_clock::time_point startTs) noexcept;
+
+  // Encode PersistentObject as log record or in Tlv format
+  static folly::Expected<std::unique_ptr<folly::IOBuf>, std::string>
+  encodeRecord(const PersistentObject& pObject, bool logFormat) noexcept;
 
   // Function to create a PersistentObject.
   PersistentObject toPersistentObject(
@@ -116,8 +190,11 @@ class PersistentStore : public OpenrEventLoop {
   // Keeps track of number of writes of Database to disk
   std::atomic<std::uint64_t> numOfWritesToDisk_{0};
 
-  // Keeps track of number of writes of PersistentObject to disk
-  std::atomic<std::uint64_t> numOfNewWritesToDisk_{0};
+  // Keeps track of number of compactions of log
+  std::atomic<std::uint64_t> numOfCompactions_{0};
+
+  // Keeps track of number of bytes written to disk
+  std::atomic<std::uint64_t> numOfBytesWrittenToDisk_{0};
 
   // Location on disk where data will be synced up. A file will be created
   // if doesn't exists.
@@ -126,6 +203,9 @@ class PersistentStore : public OpenrEventLoop {
   // Dryrun to avoid disk writes in UTs
   bool dryrun_{false};
 
+  // Write log format rather than Tlv one
+  const bool logFormat_{false};
+
   // Timer for saving database to disk
   std::unique_ptr<fbzmq::ZmqTimeout> saveDbTimer_;
   std::unique_ptr<ExponentialBackoff<std::chrono::milliseconds>>
@@ -140,6 +220,18 @@ class PersistentStore : public OpenrEventLoop {
 
   // Define a persistent object
   std::vector<PersistentObject> pObjects_;
+
+  // Log file opened for appending, and its size
+  folly::File logFile_;
+  int64_t logBytes_{0};
+
+  // Size of log records of entries in `database_`, i.e. of compacted log
+  int64_t liveBytes_{0};
+
+  // Background compaction, if any is in progress, along with records
+  // appended to log after its snapshot was taken
+  std::thread compactionThread_;
+  folly::IOBufQueue compactionTail_{folly::IOBufQueue::cacheChainLength()};
 };
 
 } // namespace openr
@@ -12,11 +12,53 @@
 namespace openr {
 
 PersistentStoreClient::PersistentStoreClient(
-    const PersistentStoreUrl& socketUrl, fbzmq::Context& context)
-    : context_(context), reqSocketUrl_(socketUrl) {}
+    const PersistentStoreUrl& socketUrl,
+    fbzmq::Context& context,
+    fbzmq::ZmqEventLoop* eventLoop,
+    std::chrono::milliseconds writeBehindDelay)
+    : context_(context),
+      reqSocketUrl_(socketUrl),
+      writeBehindDelay_(writeBehindDelay) {
+  if (eventLoop) {
+    flushTimer_ = fbzmq::ZmqTimeout::make(eventLoop, [this]() noexcept {
+      if (not flushPendingStores()) {
+        flushTimer_->scheduleTimeout(writeBehindDelay_);
+      }
+    });
+  }
+}
+
+PersistentStoreClient::~PersistentStoreClient() {
+  LOG_IF(ERROR, not pendingStores_.empty())
+      << "Dropping " << pendingStores_.size()
+      << " stores not written out to PersistentStore";
+}
+
+bool
+PersistentStoreClient::flushPendingStores() noexcept {
+  // NOTE: move out so that failed stores can be put back
+  auto pendingStores = std::move(pendingStores_);
+  pendingStores_.clear();
+
+  bool success{true};
+  for (auto& kv : pendingStores) {
+    auto ret = storeSync(kv.first, kv.second);
+    if (ret.hasValue() and ret.value()) {
+      continue;
+    }
+    LOG(ERROR) << "Failed to write key " << kv.first << " to PersistentStore. "
+               << (ret.hasError() ? ret.error().errString : "");
+    pendingStores_.emplace(kv.first, std::move(kv.second));
+    success = false;
+  }
+  return success;
+}
 
 folly::Expected<bool, fbzmq::Error>
 PersistentStoreClient::erase(std::string const& key) noexcept {
+  // Key which is only pending is erased as far as callers are concerned
+  const bool wasPending = pendingStores_.erase(key) > 0;
+
   thrift::StoreRequest request(
       apache::thrift::FRAGILE,
       thrift::StoreRequestType::ERASE,
@@ -26,7 +68,7 @@ PersistentStoreClient::erase(std::string const& key) noexcept {
   auto response = requestReply(request);
   if (response.hasValue()) {
     CHECK_EQ(key, response->key);
-    return response->success;
+    return response->success or wasPending;
   }
 
   return folly::makeUnexpected(response.error());
@@ -35,6 +77,26 @@ PersistentStoreClient::erase(std::string const& key) noexcept {
 folly::Expected<bool, fbzmq::Error>
 PersistentStoreClient::storeInternal(
     std::string const& key, std::string const& data) noexcept {
+  // Synchronous store supersedes pending one of same key
+  pendingStores_.erase(key);
+  return storeSync(key, data);
+}
+
+void
+PersistentStoreClient::storeWriteBehind(
+    std::string const& key, std::string const& data) noexcept {
+  CHECK(flushTimer_) << "Write-behind store needs client with event loop";
+
+  // Coalesce with pending store of same key
+  pendingStores_[key] = data;
+  if (not flushTimer_->isScheduled()) {
+    flushTimer_->scheduleTimeout(writeBehindDelay_);
+  }
+}
+
+folly::Expected<bool, fbzmq::Error>
+PersistentStoreClient::storeSync(
+    std::string const& key, std::string const& data) noexcept {
   thrift::StoreRequest request(
       apache::thrift::FRAGILE, thrift::StoreRequestType::STORE, key, data);
 
@@ -47,6 +109,12 @@ PersistentStoreClient::storeInternal(
 
 folly::Expected<std::string, fbzmq::Error>
 PersistentStoreClient::loadInternal(std::string const& key) noexcept {
+  // Pending value is what PersistentStore will have shortly
+  auto pendingIt = pendingStores_.find(key);
+  if (pendingIt != pendingStores_.end()) {
+    return pendingIt->second;
+  }
+
   thrift::StoreRequest request(
       apache::thrift::FRAGILE,
       thrift::StoreRequestType::LOAD,
@@ -7,21 +7,55 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
+#include <unordered_map>
 
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <fbzmq/async/ZmqTimeout.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/Expected.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
+#include <openr/common/Constants.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/if/gen-cpp2/PersistentStore_types.h>
 
 namespace openr {
 
+/**
+ * Client to load/store/erase keys in PersistentStore.
+ *
+ * Stores are synchronous and acked only once PersistentStore has the value.
+ * Call sites which can live with losing latest value on crash can opt into
+ * `storeThriftObjWriteBehind` if client was given `eventLoop`. Such stores
+ * return right away and are written out `writeBehindDelay` later from the
+ * event loop, with repeated stores of a key in between coalesced into one
+ * write. Loads see pending values. Client must only be used from event loop
+ * thread then, and owner must `flushPendingStores()` before stopping.
+ *
+ * Either way, PersistentStore skips writing value key already has to disk.
+ */
 class PersistentStoreClient {
  public:
   PersistentStoreClient(
-      const PersistentStoreUrl& socketUrl, fbzmq::Context& context);
+      const PersistentStoreUrl& socketUrl,
+      fbzmq::Context& context,
+      fbzmq::ZmqEventLoop* eventLoop = nullptr,
+      std::chrono::milliseconds writeBehindDelay =
+          Constants::kPersistentStoreWriteBehindDelay);
+
+  // Pending stores not flushed by now are lost, PersistentStore may be gone
+  ~PersistentStoreClient();
+
+  // Write out pending stores right away. Returns false if any of them failed,
+  // failed ones remain pending and are retried later.
+  bool flushPendingStores() noexcept;
+
+  size_t
+  getNumPendingStores() const {
+    return pendingStores_.size();
+  }
 
   //
   // Load/Store thrift object types
@@ -37,6 +71,18 @@ class PersistentStoreClient {
             reinterpret_cast<const char*>(msg->data().data()), msg->size()));
   }
 
+  // Store which is written out later, see class comment
+  template <typename ThriftType>
+  void
+  storeThriftObjWriteBehind(
+      std::string const& key, ThriftType const& value) noexcept {
+    auto msg = fbzmq::Message::fromThriftObj(value, serializer_);
+    storeWriteBehind(
+        key,
+        std::string(
+            reinterpret_cast<const char*>(msg->data().data()), msg->size()));
+  }
+
   template <typename ThriftType>
   folly::Expected<ThriftType, fbzmq::Error>
   loadThriftObj(std::string const& key) noexcept {
@@ -104,6 +150,12 @@ class PersistentStoreClient {
   //
   folly::Expected<bool, fbzmq::Error> storeInternal(
       std::string const& key, std::string const& data) noexcept;
+  void storeWriteBehind(
+      std::string const& key, std::string const& data) noexcept;
+  // write key to PersistentStore right away
+  folly::Expected<bool, fbzmq::Error> storeSync(
+      std::string const& key, std::string const& data) noexcept;
+
   folly::Expected<std::string, fbzmq::Error> loadInternal(
       std::string const& key) noexcept;
 
@@ -118,6 +170,11 @@ class PersistentStoreClient {
 
   // Thrift CompactSerializer for send/recv of thrift objects over reqSocket_
   apache::thrift::CompactSerializer serializer_;
+
+  // Write-behind state. Timer is only set when writes are deferred.
+  const std::chrono::milliseconds writeBehindDelay_;
+  std::unique_ptr<fbzmq::ZmqTimeout> flushTimer_;
+  std::unordered_map<std::string, std::string> pendingStores_;
 };
 
 } // namespace openr
@@ -5,16 +5,54 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <unistd.h>
+
+#include <limits>
+#include <thread>
+
 #include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
 #include <folly/Random.h>
 #include <folly/init/Init.h>
+#include <openr/common/StreamingHistogram.h>
 #include <openr/config-store/PersistentStoreClient.h>
 #include <openr/config-store/PersistentStoreWrapper.h>
 
+/**
+ * Defines a benchmark that allows users to record customized counter during
+ * benchmarking and passes parameters to it. Custom name must be given to
+ * each set of parameters.
+ */
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FB_STRINGIZE(name) "(" FB_STRINGIZE(param_name) ")",             \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
 namespace {
 // kIterations <= n: change this to 10 singce n starts from 10,
 // n is in BENCHMARK_PARAM(BM_PersistentStoreWrite, n)
 uint32_t kIterations = 10;
+
+// Size of values of keys preloaded into store
+const size_t kValueSize = 64;
+
+// Number of keys being updated over and over, like LinkMonitor and
+// PrefixManager do
+const uint32_t kNumOfHotKeys = 4;
+
+std::string
+getFilePath(const std::string& name) {
+  return folly::sformat(
+      "/tmp/aq_persistent_store_benchmark_{}_{}",
+      name,
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
 } // namespace
 
 namespace openr {
@@ -161,6 +199,254 @@ BM_PersistentStoreCreateDestroy(uint32_t iters, size_t numOfStringKeys) {
   }
 }
 
+/**
+ * Contents of store file with `numOfKeys` keys, in log or Tlv format. Every
+ * key is written `numOfRecordsPerKey` times, so file is that many times
+ * larger than compacted one.
+ */
+std::string
+getStoreFileData(
+    uint32_t numOfKeys, uint32_t numOfRecordsPerKey, bool logFormat) {
+  std::string fileData =
+      logFormat ? kLogFormatMarker.str() : kTlvFormatMarker.str();
+  PersistentObject pObject;
+  pObject.type = ActionType::ADD;
+  for (uint32_t round = 0; round < numOfRecordsPerKey; ++round) {
+    for (uint32_t i = 0; i < numOfKeys; ++i) {
+      pObject.key = folly::sformat("key-{}", i);
+      pObject.data = std::string(kValueSize, 'a' + round % 26);
+      auto buf = logFormat ? PersistentStore::encodeLogRecord(pObject)
+                           : PersistentStore::encodePersistentObject(pObject);
+      CHECK(buf.hasValue()) << buf.error();
+      for (const auto& range : **buf) {
+        fileData.append(
+            reinterpret_cast<const char*>(range.data()), range.size());
+      }
+    }
+  }
+  return fileData;
+}
+
+/**
+ * Write store file of `numOfKeys` keys straight to disk, skipping the store
+ */
+void
+writeStoreFile(
+    const std::string& filePath, uint32_t numOfKeys, bool logFormat) {
+  CHECK(folly::writeFile(
+      getStoreFileData(numOfKeys, 1, logFormat), filePath.c_str()));
+}
+
+/**
+ * PersistentStore on given file in log or Tlv format, running in its own
+ * thread
+ */
+class RunningStore {
+ public:
+  RunningStore(
+      fbzmq::Context& context,
+      const std::string& filePath,
+      std::chrono::milliseconds saveInitialBackoff,
+      std::chrono::milliseconds saveMaxBackoff,
+      bool logFormat)
+      : store(std::make_unique<PersistentStore>(
+            "1",
+            filePath,
+            context,
+            saveInitialBackoff,
+            saveMaxBackoff,
+            false /* dryrun */,
+            logFormat)),
+        storeThread([this]() { store->run(); }) {
+    store->waitUntilRunning();
+    client = std::make_unique<PersistentStoreClient>(
+        PersistentStoreUrl{store->inprocCmdUrl}, context);
+  }
+
+  ~RunningStore() {
+    client.reset();
+    store->stop();
+    storeThread.join();
+  }
+
+  std::unique_ptr<PersistentStore> store;
+  std::thread storeThread;
+  std::unique_ptr<PersistentStoreClient> client;
+};
+
+/**
+ * Benchmark for write amplification, i.e. bytes written to disk per update
+ * 1. Preload keys into store
+ * 2. Update randomly chosen keys with new values of `valueSize` bytes. Every
+ *    update is written to disk before response, compactions included.
+ * 3. Report bytes written to disk per update along with logical size of it
+ */
+void
+BM_PersistentStoreWriteAmplification(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfKeys,
+    size_t valueSize,
+    bool logFormat) {
+  auto suspender = folly::BenchmarkSuspender();
+  fbzmq::Context context;
+  const auto filePath = getFilePath("write_amplification");
+  writeStoreFile(filePath, numOfKeys, logFormat);
+
+  uint64_t bytesWritten{0};
+  uint64_t logicalBytes{0};
+  uint64_t numOfCompactions{0};
+  {
+    // No backoff, every update is written on its own
+    RunningStore runningStore(
+        context,
+        filePath,
+        std::chrono::milliseconds(0),
+        std::chrono::milliseconds(0),
+        logFormat);
+    const std::vector<std::string> values{
+        std::string(valueSize, 'x'), std::string(valueSize, 'y')};
+    std::vector<std::string> keys;
+    for (uint32_t i = 0; i < iters; ++i) {
+      keys.emplace_back(
+          folly::sformat("key-{}", folly::Random::rand32(numOfKeys)));
+      logicalBytes += keys.back().size() + valueSize;
+    }
+    const auto startBytes = runningStore.store->getNumOfBytesWrittenToDisk();
+
+    suspender.dismiss(); // Start measuring benchmark time
+    for (uint32_t i = 0; i < iters; ++i) {
+      runningStore.client->store(keys[i], values[i % 2]);
+    }
+    suspender.rehire(); // Stop measuring time again
+
+    // Wait for compaction, if any, to get accounted
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    bytesWritten =
+        runningStore.store->getNumOfBytesWrittenToDisk() - startBytes;
+    numOfCompactions = runningStore.store->getNumOfCompactions();
+  }
+  ::unlink(filePath.c_str());
+
+  iters = iters == 0 ? 1 : iters;
+  counters["bytes_per_update"] = bytesWritten / iters;
+  counters["logical_bytes_per_update"] = logicalBytes / iters;
+  counters["compactions"] = numOfCompactions;
+}
+
+/**
+ * Benchmark for latency of STORE requests under steady churn of few hot keys
+ * 1. Preload `numOfKeys` keys into store
+ * 2. Keep updating `kNumOfHotKeys` keys, with default save backoffs
+ * 3. Report percentiles of request latency along with bytes written to disk
+ *    per update. Latency includes time event loop is blocked by writes and
+ *    compactions.
+ */
+void
+BM_PersistentStoreHotKeyChurn(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfKeys,
+    bool logFormat) {
+  auto suspender = folly::BenchmarkSuspender();
+  fbzmq::Context context;
+  const auto filePath = getFilePath("hot_key_churn");
+  writeStoreFile(filePath, numOfKeys, logFormat);
+
+  StreamingHistogram latencies(std::numeric_limits<uint32_t>::max());
+  uint64_t bytesWritten{0};
+  {
+    RunningStore runningStore(
+        context,
+        filePath,
+        Constants::kPersistentStoreInitialBackoff,
+        Constants::kPersistentStoreMaxBackoff,
+        logFormat);
+    const std::vector<std::string> values{
+        std::string(kValueSize, 'x'), std::string(kValueSize, 'y')};
+    std::vector<std::string> hotKeys;
+    for (uint32_t i = 0; i < kNumOfHotKeys; ++i) {
+      hotKeys.emplace_back(folly::sformat("key-{}", i));
+    }
+    const auto startBytes = runningStore.store->getNumOfBytesWrittenToDisk();
+
+    suspender.dismiss(); // Start measuring benchmark time
+    for (uint32_t i = 0; i < iters; ++i) {
+      const auto startTs = std::chrono::steady_clock::now();
+      runningStore.client->store(
+          hotKeys[i % kNumOfHotKeys], values[(i / kNumOfHotKeys) % 2]);
+      latencies.addValue(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - startTs)
+              .count());
+    }
+    suspender.rehire(); // Stop measuring time again
+
+    // Wait for pending updates to get written
+    std::this_thread::sleep_for(2 * Constants::kPersistentStoreInitialBackoff);
+    bytesWritten =
+        runningStore.store->getNumOfBytesWrittenToDisk() - startBytes;
+  }
+  ::unlink(filePath.c_str());
+
+  iters = iters == 0 ? 1 : iters;
+  counters["p50_us"] = latencies.getPercentile(50);
+  counters["p99_us"] = latencies.getPercentile(99);
+  counters["max_us"] = latencies.getMax();
+  counters["bytes_per_update"] = bytesWritten / iters;
+}
+
+/**
+ * Benchmark for loading database on startup
+ * 1. Write file of `numOfKeys` keys in log or Tlv format, each key written
+ *    `numOfRecordsPerKey` times
+ * 2. Optionally append torn record to it, as left by crash in the middle of
+ *    write
+ * 3. Create store, which replays the file. Torn log is copied to .corrupt
+ *    and truncated right before torn record, while torn Tlv file is moved to
+ *    .corrupt whole and store starts empty.
+ */
+void
+BM_PersistentStoreRecovery(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfKeys,
+    uint32_t numOfRecordsPerKey,
+    bool torn,
+    bool logFormat) {
+  auto suspender = folly::BenchmarkSuspender();
+  fbzmq::Context context;
+  const auto filePath = getFilePath("recovery");
+  auto fileData = getStoreFileData(numOfKeys, numOfRecordsPerKey, logFormat);
+  const auto fileBytes = fileData.size();
+  if (torn) {
+    // Header of 64KB record, only few bytes of it made it to disk
+    fileData.append(std::string("\x00\x01\x00\x00\x12\x34\x56\x78torn", 12));
+  }
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    // Store drops torn record, start every run from same file
+    if (torn or i == 0) {
+      CHECK(folly::writeFile(fileData, filePath.c_str()));
+    }
+
+    suspender.dismiss(); // Start measuring benchmark time
+    auto store = std::make_unique<PersistentStore>(
+        "1",
+        filePath,
+        context,
+        std::chrono::milliseconds(0),
+        std::chrono::milliseconds(0),
+        false /* dryrun */,
+        logFormat);
+    suspender.rehire(); // Stop measuring time again
+  }
+  ::unlink(filePath.c_str());
+  ::unlink((filePath + ".corrupt").c_str());
+
+  counters["file_bytes"] = fileBytes;
+}
+
 // The parameter is the number of keys already written to store
 // before benchmarking the time.
 BENCHMARK_PARAM(BM_PersistentStoreWrite, 10);
@@ -178,6 +464,189 @@ BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 100);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 1000);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 10000);
 
+// Parameters are number of keys in store, size of updated values and
+// whether store is in log format (otherwise Tlv, the default)
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Log_Keys_100_Value_64,
+    100,
+    64,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Log_Keys_10000_Value_64,
+    10000,
+    64,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Log_Keys_100_Value_4096,
+    100,
+    4096,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Log_Keys_10000_Value_4096,
+    10000,
+    4096,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Tlv_Keys_100_Value_64,
+    100,
+    64,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Tlv_Keys_10000_Value_64,
+    10000,
+    64,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Tlv_Keys_100_Value_4096,
+    100,
+    4096,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification,
+    counters,
+    Tlv_Keys_10000_Value_4096,
+    10000,
+    4096,
+    false);
+
+// Parameters are number of keys in store besides hot ones and whether
+// store is in log format
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreHotKeyChurn, counters, Log_Keys_100, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreHotKeyChurn, counters, Log_Keys_10000, 10000, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreHotKeyChurn, counters, Log_Keys_100000, 100000, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreHotKeyChurn, counters, Tlv_Keys_100, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreHotKeyChurn, counters, Tlv_Keys_10000, 10000, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreHotKeyChurn, counters, Tlv_Keys_100000, 100000, false);
+
+// Parameters are number of keys, records per key, whether file ends with
+// torn record and whether it is in log format
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Log_Compacted_10000,
+    10000,
+    1,
+    false,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Log_Compacted_100000,
+    100000,
+    1,
+    false,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Log_Compacted_1000000,
+    1000000,
+    1,
+    false,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Log_Uncompacted_100000,
+    100000,
+    10,
+    false,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery, counters, Log_Torn_10000, 10000, 1, true, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Log_Torn_100000,
+    100000,
+    1,
+    true,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Log_Torn_1000000,
+    1000000,
+    1,
+    true,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Tlv_Compacted_10000,
+    10000,
+    1,
+    false,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Tlv_Compacted_100000,
+    100000,
+    1,
+    false,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Tlv_Compacted_1000000,
+    1000000,
+    1,
+    false,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Tlv_Uncompacted_100000,
+    100000,
+    10,
+    false,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Tlv_Torn_10000,
+    10000,
+    1,
+    true,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Tlv_Torn_100000,
+    100000,
+    1,
+    true,
+    false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreRecovery,
+    counters,
+    Tlv_Torn_1000000,
+    1000000,
+    1,
+    true,
+    false);
+
 } // namespace openr
 
 int
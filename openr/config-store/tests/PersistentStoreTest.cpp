@@ -5,9 +5,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <unistd.h>
+
+#include <functional>
+#include <future>
 #include <thread>
 #include <utility>
 
+#include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/FileUtil.h>
 #include <folly/Random.h>
@@ -33,11 +38,15 @@ loadDatabaseFromDisk(
   auto ioBuf = folly::IOBuf::wrapBuffer(fileData.c_str(), fileData.size());
   folly::io::Cursor cursor(ioBuf.get());
 
-  // Read 'kTlvFormatMarker'
-  cursor.readFixedString(kTlvFormatMarker.size());
+  // Read 'kLogFormatMarker' or 'kTlvFormatMarker'
+  const bool logFormat =
+      folly::StringPiece(fileData).startsWith(kLogFormatMarker);
+  cursor.readFixedString(
+      logFormat ? kLogFormatMarker.size() : kTlvFormatMarker.size());
   // Iteratively read persistentObject from disk
   while (true) {
-    auto optionalObject = store->decodePersistentObject(cursor);
+    auto optionalObject = logFormat ? store->decodeLogRecord(cursor)
+                                    : store->decodePersistentObject(cursor);
     if (optionalObject.hasError()) {
       LOG(ERROR) << optionalObject.error();
     }
@@ -245,6 +254,320 @@ TEST(PersistentStoreTest, LoadStoreEraseTest) {
   EXPECT_EQ(database, databaseStore);
 }
 
+TEST(PersistentStoreTest, LogRecoveryTest) {
+  fbzmq::Context context;
+
+  auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const std::string filePath{
+      folly::sformat("/tmp/aq_persistent_store_log_recovery_test_{}", tid)};
+  ::unlink(filePath.c_str());
+
+  std::unique_ptr<PersistentStore> store;
+  std::unique_ptr<std::thread> storeThread;
+  std::unique_ptr<PersistentStoreClient> client;
+  auto startStore = [&](bool logFormat) {
+    // No backoff, every request is written to disk before response
+    store = std::make_unique<PersistentStore>(
+        folly::sformat("1-{}", tid),
+        filePath,
+        context,
+        std::chrono::milliseconds(0),
+        std::chrono::milliseconds(0),
+        false /* dryrun */,
+        logFormat);
+    storeThread = std::make_unique<std::thread>([&]() { store->run(); });
+    store->waitUntilRunning();
+    client = std::make_unique<PersistentStoreClient>(
+        PersistentStoreUrl{store->inprocCmdUrl}, context);
+  };
+  auto stopStore = [&]() {
+    client.reset();
+    store->stop();
+    storeThread->join();
+    storeThread.reset();
+    store.reset();
+  };
+
+  //
+  // Records of file in Tlv format are converted to log
+  //
+  PersistentObject pObject;
+  pObject.type = ActionType::ADD;
+  pObject.key = "key1";
+  pObject.data = "val1";
+  auto buf = PersistentStore::encodePersistentObject(pObject);
+  ASSERT_FALSE(buf.hasError());
+  std::string tlvData = kTlvFormatMarker.str();
+  tlvData.append(
+      reinterpret_cast<const char*>((*buf)->data()), (*buf)->length());
+  ASSERT_TRUE(folly::writeFile(tlvData, filePath.c_str()));
+
+  startStore(true);
+  EXPECT_EQ("val1", client->load<std::string>("key1").value());
+  EXPECT_TRUE(client->store("key2", std::string("val2")).value());
+  stopStore();
+
+  std::string fileData;
+  ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+  EXPECT_EQ(0, fileData.find(kLogFormatMarker.str()));
+
+  //
+  // Torn record at the end of log is dropped, records before it are intact
+  // and new ones are appended after them
+  //
+  const std::string validData = fileData;
+  fileData.append(std::string("\x00\x00\x00\x20torn", 8));
+  ASSERT_TRUE(folly::writeFile(fileData, filePath.c_str()));
+
+  startStore(true);
+  EXPECT_EQ("val1", client->load<std::string>("key1").value());
+  EXPECT_EQ("val2", client->load<std::string>("key2").value());
+  EXPECT_TRUE(client->store("key3", std::string("val3")).value());
+  stopStore();
+
+  startStore(true);
+  EXPECT_EQ("val3", client->load<std::string>("key3").value());
+  stopStore();
+
+  //
+  // Corrupted record is dropped along with everything after it, whole file
+  // is copied aside first
+  //
+  const auto corruptFilePath = filePath + ".corrupt";
+  ::unlink(corruptFilePath.c_str());
+  ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+  ASSERT_LT(validData.size(), fileData.size());
+  fileData[fileData.size() - 1] ^= 0xff;
+  ASSERT_TRUE(folly::writeFile(fileData, filePath.c_str()));
+
+  startStore(true);
+  EXPECT_EQ("val2", client->load<std::string>("key2").value());
+  EXPECT_TRUE(client->load<std::string>("key3").hasError());
+  stopStore();
+
+  std::string corruptData;
+  ASSERT_TRUE(folly::readFile(corruptFilePath.c_str(), corruptData));
+  EXPECT_EQ(fileData, corruptData);
+  ::unlink(corruptFilePath.c_str());
+
+  //
+  // Log is converted back to Tlv format, which older releases read, unless
+  // log format is enabled
+  //
+  startStore(false);
+  EXPECT_EQ("val2", client->load<std::string>("key2").value());
+  EXPECT_TRUE(client->store("key4", std::string("val4")).value());
+  stopStore();
+
+  ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+  EXPECT_EQ(0, fileData.find(kTlvFormatMarker.str()));
+  auto database = loadDatabaseFromDisk(filePath, store);
+  EXPECT_EQ(3, database.keyVals.size());
+  EXPECT_EQ("val4", database.keyVals.at("key4"));
+
+  startStore(false);
+  EXPECT_EQ("val1", client->load<std::string>("key1").value());
+  EXPECT_EQ("val4", client->load<std::string>("key4").value());
+  stopStore();
+
+  ::unlink(filePath.c_str());
+}
+
+TEST(PersistentStoreTest, LogCompactionTest) {
+  fbzmq::Context context;
+
+  auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const std::string filePath{
+      folly::sformat("/tmp/aq_persistent_store_log_compaction_test_{}", tid)};
+  ::unlink(filePath.c_str());
+
+  auto store = std::make_unique<PersistentStore>(
+      folly::sformat("1-{}", tid),
+      filePath,
+      context,
+      std::chrono::milliseconds(0),
+      std::chrono::milliseconds(0),
+      false /* dryrun */,
+      true /* logFormat */);
+  std::thread storeThread([&]() { store->run(); });
+  store->waitUntilRunning();
+  PersistentStoreClient client(
+      PersistentStoreUrl{store->inprocCmdUrl}, context);
+
+  // Keep overwriting same keys till log grows large enough to get compacted
+  const std::string value(10 * 1024, 'v');
+  uint32_t index = 0;
+  while (store->getNumOfCompactions() == 0) {
+    ASSERT_LT(index, 10000);
+    EXPECT_TRUE(
+        client.store(folly::sformat("key-{}", index % 10), value).value());
+    ++index;
+  }
+  EXPECT_TRUE(client.store("key-last", std::string("last")).value());
+
+  store->stop();
+  storeThread.join();
+  store.reset();
+
+  // Log was at least 1MB when it got compacted, mostly live records are left
+  std::string fileData;
+  ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+  EXPECT_GT(1024 * 1024, fileData.size());
+
+  auto database = loadDatabaseFromDisk(filePath, store);
+  EXPECT_EQ(11, database.keyVals.size());
+  EXPECT_EQ(value, database.keyVals.at("key-0"));
+  EXPECT_EQ("last", database.keyVals.at("key-last"));
+
+  ::unlink(filePath.c_str());
+}
+
+TEST(PersistentStoreTest, WriteBehindTest) {
+  fbzmq::Context context;
+
+  auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const std::string filePath{
+      folly::sformat("/tmp/aq_persistent_store_write_behind_test_{}", tid)};
+
+  auto store = std::make_unique<PersistentStore>(
+      folly::sformat("1-{}", tid), filePath, context);
+  std::thread storeThread([&]() { store->run(); });
+  store->waitUntilRunning();
+
+  const PersistentStoreUrl sockUrl{store->inprocCmdUrl};
+  PersistentStoreClient syncClient(sockUrl, context);
+
+  // Write-behind client must be used from its event loop
+  fbzmq::ZmqEventLoop evl;
+  std::thread evlThread([&]() { evl.run(); });
+  evl.waitUntilRunning();
+  auto runInLoop = [&](std::function<void()> fn) {
+    std::promise<void> done;
+    evl.runInEventLoop([&]() {
+      fn();
+      done.set_value();
+    });
+    done.get_future().wait();
+  };
+
+  auto makeDb = [](uint32_t i) {
+    return thrift::StoreDatabase(
+        apache::thrift::FRAGILE, {{"value", std::to_string(i)}});
+  };
+
+  // Long delay so that nothing is written unless flushed explicitly
+  std::unique_ptr<PersistentStoreClient> client;
+  runInLoop([&]() {
+    client = std::make_unique<PersistentStoreClient>(
+        sockUrl, context, &evl, std::chrono::hours(1));
+
+    // Repeated stores are coalesced and visible to own loads right away
+    for (uint32_t i = 0; i < 10; ++i) {
+      client->storeThriftObjWriteBehind("key1", makeDb(i));
+    }
+    EXPECT_EQ(1, client->getNumPendingStores());
+    EXPECT_EQ(
+        makeDb(9),
+        client->loadThriftObj<thrift::StoreDatabase>("key1").value());
+  });
+  EXPECT_TRUE(syncClient.loadThriftObj<thrift::StoreDatabase>("key1")
+                  .hasError());
+
+  runInLoop([&]() {
+    EXPECT_TRUE(client->flushPendingStores());
+    EXPECT_EQ(0, client->getNumPendingStores());
+
+    // Changing and reverting value before it is written leaves single store
+    // of the value PersistentStore has already
+    client->storeThriftObjWriteBehind("key1", makeDb(10));
+    client->storeThriftObjWriteBehind("key1", makeDb(9));
+    EXPECT_EQ(1, client->getNumPendingStores());
+    EXPECT_TRUE(client->flushPendingStores());
+    EXPECT_EQ(0, client->getNumPendingStores());
+  });
+  EXPECT_EQ(
+      makeDb(9),
+      syncClient.loadThriftObj<thrift::StoreDatabase>("key1").value());
+
+  // Synchronous store is durable once acked and supersedes pending one
+  runInLoop([&]() {
+    client->storeThriftObjWriteBehind("key1", makeDb(11));
+    EXPECT_TRUE(client->storeThriftObj("key1", makeDb(12)).value());
+    EXPECT_EQ(0, client->getNumPendingStores());
+  });
+  EXPECT_EQ(
+      makeDb(12),
+      syncClient.loadThriftObj<thrift::StoreDatabase>("key1").value());
+
+  // Erase of key which is only pending reports it as found
+  runInLoop([&]() {
+    client->storeThriftObjWriteBehind("key2", makeDb(2));
+    EXPECT_TRUE(client->erase("key2").value());
+    EXPECT_EQ(0, client->getNumPendingStores());
+  });
+  EXPECT_TRUE(syncClient.loadThriftObj<thrift::StoreDatabase>("key2")
+                  .hasError());
+
+  // Pending stores not flushed by owner are dropped on destruction, without
+  // talking to PersistentStore
+  runInLoop([&]() {
+    client->storeThriftObjWriteBehind("key3", makeDb(3));
+    client.reset();
+  });
+  EXPECT_TRUE(syncClient.loadThriftObj<thrift::StoreDatabase>("key3")
+                  .hasError());
+
+  evl.stop();
+  evlThread.join();
+  store->stop();
+  storeThread.join();
+}
+
+TEST(PersistentStoreTest, UnchangedValueTest) {
+  fbzmq::Context context;
+
+  auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  const std::string filePath{
+      folly::sformat("/tmp/aq_persistent_store_unchanged_test_{}", tid)};
+  ::unlink(filePath.c_str());
+
+  // No backoff, every request is written to disk before response
+  auto store = std::make_unique<PersistentStore>(
+      folly::sformat("1-{}", tid),
+      filePath,
+      context,
+      std::chrono::milliseconds(0),
+      std::chrono::milliseconds(0));
+  std::thread storeThread([&]() { store->run(); });
+  store->waitUntilRunning();
+
+  const PersistentStoreUrl sockUrl{store->inprocCmdUrl};
+  PersistentStoreClient client1(sockUrl, context);
+  PersistentStoreClient client2(sockUrl, context);
+
+  // Value key already has is not written again, whoever stores it
+  EXPECT_TRUE(client1.store("key1", std::string("val1")).value());
+  EXPECT_EQ(1, store->getNumOfDbWritesToDisk());
+  EXPECT_TRUE(client1.store("key1", std::string("val1")).value());
+  EXPECT_TRUE(client2.store("key1", std::string("val1")).value());
+  EXPECT_EQ(1, store->getNumOfDbWritesToDisk());
+
+  // Values stored or erased by other clients are not mistaken for own ones
+  EXPECT_TRUE(client2.store("key1", std::string("val2")).value());
+  EXPECT_TRUE(client1.store("key1", std::string("val1")).value());
+  EXPECT_EQ(3, store->getNumOfDbWritesToDisk());
+  EXPECT_EQ("val1", client2.load<std::string>("key1").value());
+
+  EXPECT_TRUE(client2.erase("key1").value());
+  EXPECT_TRUE(client1.store("key1", std::string("val1")).value());
+  EXPECT_EQ(5, store->getNumOfDbWritesToDisk());
+  EXPECT_EQ("val1", client2.load<std::string>("key1").value());
+
+  store->stop();
+  storeThread.join();
+  ::unlink(filePath.c_str());
+}
+
 } // namespace openr
 
 int
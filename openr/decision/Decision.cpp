@@ -176,6 +176,7 @@ class SpfSolver::SpfSolverImpl {
         bgpUseIgpMetric_(bgpUseIgpMetric) {
     // Initialize stat keys
     tData_.addStatExportType("decision.adj_db_update", fbzmq::COUNT);
+    tData_.addStatExportType("decision.adj_key_update", fbzmq::COUNT);
     tData_.addStatExportType(
         "decision.incompatible_forwarding_type", fbzmq::COUNT);
     tData_.addStatExportType("decision.missing_loopback_addr", fbzmq::SUM);
@@ -201,6 +202,15 @@ class SpfSolver::SpfSolverImpl {
 
   bool hasHolds() const;
 
+  std::pair<
+      bool /* topology has changed*/,
+      bool /* route attributes has changed (nexthop addr, node/adj label */>
+  updateAdjacency(
+      const std::string& nodeName,
+      const std::string& otherNodeName,
+      const std::string& ifName,
+      folly::Optional<thrift::Adjacency> const& adj);
+
   // returns true if the AdjacencyDatabase existed
   bool deleteAdjacencyDatabase(const std::string& nodeName);
 
@@ -342,6 +352,13 @@ class SpfSolver::SpfSolverImpl {
   // returns the hop count of the furthest node connected to nodeName
   Metric getMaxHopsToNode(const std::string& nodeName);
 
+  // apply `update` of nodeName's adjacencies to linkState_ with hold TTLs
+  // for ordered FIB, if enabled. `update` is called with hold up and hold
+  // down TTLs and returns result of LinkState update.
+  template <typename UpdateFn>
+  std::pair<bool, bool> updateNodeAdjacencies(
+      const std::string& nodeName, UpdateFn&& update);
+
   LinkState linkState_;
 
   PrefixState prefixState_;
@@ -379,16 +396,43 @@ std::pair<
     bool /* route attributes has changed (nexthop addr, node/adj label */>
 SpfSolver::SpfSolverImpl::updateAdjacencyDatabase(
     thrift::AdjacencyDatabase const& newAdjacencyDb) {
+  tData_.addStatValue("decision.adj_db_update", 1, fbzmq::COUNT);
+  return updateNodeAdjacencies(
+      newAdjacencyDb.thisNodeName,
+      [&](LinkStateMetric holdUpTtl, LinkStateMetric holdDownTtl) {
+        return linkState_.updateAdjacencyDatabase(
+            newAdjacencyDb, holdUpTtl, holdDownTtl);
+      });
+}
+
+std::pair<
+    bool /* topology has changed*/,
+    bool /* route attributes has changed (nexthop addr, node/adj label */>
+SpfSolver::SpfSolverImpl::updateAdjacency(
+    const std::string& nodeName,
+    const std::string& otherNodeName,
+    const std::string& ifName,
+    folly::Optional<thrift::Adjacency> const& adj) {
+  tData_.addStatValue("decision.adj_key_update", 1, fbzmq::COUNT);
+  return updateNodeAdjacencies(
+      nodeName, [&](LinkStateMetric holdUpTtl, LinkStateMetric holdDownTtl) {
+        return linkState_.updateAdjacency(
+            nodeName, otherNodeName, ifName, adj, holdUpTtl, holdDownTtl);
+      });
+}
+
+template <typename UpdateFn>
+std::pair<bool, bool>
+SpfSolver::SpfSolverImpl::updateNodeAdjacencies(
+    const std::string& nodeName, UpdateFn&& update) {
   LinkStateMetric holdUpTtl = 0, holdDownTtl = 0;
   if (enableOrderedFib_) {
-    holdUpTtl = getMyHopsToNode(newAdjacencyDb.thisNodeName);
-    holdDownTtl = getMaxHopsToNode(newAdjacencyDb.thisNodeName) - holdUpTtl;
+    holdUpTtl = getMyHopsToNode(nodeName);
+    holdDownTtl = getMaxHopsToNode(nodeName) - holdUpTtl;
   }
-  tData_.addStatValue("decision.adj_db_update", 1, fbzmq::COUNT);
-  auto rc = linkState_.updateAdjacencyDatabase(
-      newAdjacencyDb, holdUpTtl, holdDownTtl);
+  auto rc = update(holdUpTtl, holdDownTtl);
   // temporary hack needed to keep UTs happy
-  rc.second = rc.second && myNodeName_ == newAdjacencyDb.thisNodeName;
+  rc.second = rc.second && myNodeName_ == nodeName;
   return rc;
 }
 
@@ -1552,6 +1596,18 @@ SpfSolver::updateAdjacencyDatabase(
   return impl_->updateAdjacencyDatabase(newAdjacencyDb);
 }
 
+// update single adjacency of the given router
+std::pair<
+    bool /* topology has changed*/,
+    bool /* route attributes has changed (nexthop addr, node/adj label */>
+SpfSolver::updateAdjacency(
+    const std::string& nodeName,
+    const std::string& otherNodeName,
+    const std::string& ifName,
+    folly::Optional<thrift::Adjacency> const& adj) {
+  return impl_->updateAdjacency(nodeName, otherNodeName, ifName, adj);
+}
+
 bool
 SpfSolver::hasHolds() const {
   return impl_->hasHolds();
@@ -1849,6 +1905,31 @@ Decision::updateNodePrefixDatabase(
   return nodePrefixDb;
 }
 
+std::pair<
+    bool /* topology has changed*/,
+    bool /* route attributes has changed (nexthop addr, node/adj label */>
+Decision::updateNodeAdjacencyDatabase(
+    const std::string& key, const thrift::AdjacencyDatabase& adjacencyDb) {
+  auto adjacencyKey = PerAdjacencyKey::fromStr(key);
+  if (!adjacencyKey.hasValue()) {
+    return spfSolver_->updateAdjacencyDatabase(adjacencyDb);
+  }
+
+  folly::Optional<thrift::Adjacency> adj;
+  if (!adjacencyDb.deleteAdjacency.value_or(false) &&
+      adjacencyDb.adjacencies.size()) {
+    LOG_IF(ERROR, adjacencyDb.adjacencies.size() > 1)
+        << "Received more than one adjacency, only the first adjacency is "
+        << "processed";
+    adj = adjacencyDb.adjacencies.at(0);
+  }
+  return spfSolver_->updateAdjacency(
+      adjacencyKey->getNodeName(),
+      adjacencyKey->getOtherNodeName(),
+      adjacencyKey->getIfName(),
+      adj);
+}
+
 ProcessPublicationResult
 Decision::processPublication(thrift::Publication const& thriftPub) {
   ProcessPublicationResult res;
@@ -1879,7 +1960,7 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
             fbzmq::util::readThriftObjStr<thrift::AdjacencyDatabase>(
                 rawVal.value.value(), serializer_);
         CHECK_EQ(nodeName, adjacencyDb.thisNodeName);
-        auto rc = spfSolver_->updateAdjacencyDatabase(adjacencyDb);
+        auto rc = updateNodeAdjacencyDatabase(key, adjacencyDb);
         if (rc.first) {
           res.adjChanged = true;
           pendingAdjUpdates_.addUpdate(myNodeName_, adjacencyDb.perfEvents);
@@ -1933,6 +2014,24 @@ Decision::processPublication(thrift::Publication const& thriftPub) {
         Constants::kPrefixNameSeparator.toString(), key, prefix, nodeName);
 
     if (key.find(adjacencyDbMarker_) == 0) {
+      auto adjacencyKey = PerAdjacencyKey::fromStr(key);
+      if (adjacencyKey.hasValue()) {
+        // withdraw single adjacency of the node
+        auto rc = spfSolver_->updateAdjacency(
+            adjacencyKey->getNodeName(),
+            adjacencyKey->getOtherNodeName(),
+            adjacencyKey->getIfName(),
+            folly::none);
+        if (rc.first) {
+          res.adjChanged = true;
+          pendingAdjUpdates_.addUpdate(myNodeName_, folly::none);
+        }
+        if (rc.second) {
+          res.prefixesChanged = true;
+          pendingPrefixUpdates_.addUpdate(myNodeName_, folly::none);
+        }
+        continue;
+      }
       if (spfSolver_->deleteAdjacencyDatabase(nodeName)) {
         res.adjChanged = true;
         pendingAdjUpdates_.addUpdate(myNodeName_, folly::none);
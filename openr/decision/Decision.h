@@ -133,6 +133,17 @@ class SpfSolver {
 
   bool hasHolds() const;
 
+  // update single adjacency of the given router advertised under per
+  // adjacency key, `adj` of none withdraws it
+  std::pair<
+      bool /* topology has changed */,
+      bool /* route attributes has changed (nexthop addr, node/adj label */>
+  updateAdjacency(
+      const std::string& nodeName,
+      const std::string& otherNodeName,
+      const std::string& ifName,
+      folly::Optional<thrift::Adjacency> const& adj);
+
   // delete a node's adjacency database
   // return true if this has caused any change in graph
   bool deleteAdjacencyDatabase(const std::string& nodeName);
@@ -299,6 +310,14 @@ class Decision : public OpenrEventLoop {
   thrift::PrefixDatabase updateNodePrefixDatabase(
       const std::string& key, const thrift::PrefixDatabase& prefixDb);
 
+  // apply adjacency database advertised under `key`, either whole database
+  // of node or single adjacency of node advertising per adjacency keys
+  std::pair<
+      bool /* topology has changed */,
+      bool /* route attributes has changed (nexthop addr, node/adj label */>
+  updateNodeAdjacencyDatabase(
+      const std::string& key, const thrift::AdjacencyDatabase& adjacencyDb);
+
   // this node's name and the key markers
   const std::string myNodeName_;
   // the prefix we use to find the adjacency database announcements
@@ -505,11 +505,24 @@ LinkState::updateAdjacencyDatabase(
   // replace
   adjacencyDatabases_[nodeName] = newAdjacencyDb;
 
+  // node advertising per adjacency keys only sends its attributes here,
+  // fill in adjacencies we have from their keys
+  if (newAdjacencyDb.perAdjacencyKey.value_or(false)) {
+    auto& adjacencies = adjacencyDatabases_.at(nodeName).adjacencies;
+    adjacencies.clear();
+    auto it = perKeyAdjacencies_.find(nodeName);
+    if (it != perKeyAdjacencies_.end()) {
+      for (auto const& kv : it->second) {
+        adjacencies.emplace_back(kv.second);
+      }
+    }
+  }
+
   // for comparing old and new state, we order the links based on the tuple
   // <nodeName1, iface1, nodeName2, iface2>, this allows us to easily discern
   // topology changes in the single loop below
   auto oldLinks = orderedLinksFromNode(nodeName);
-  auto newLinks = getOrderedLinkSet(newAdjacencyDb);
+  auto newLinks = getOrderedLinkSet(adjacencyDatabases_.at(nodeName));
 
   // fill these sets with the appropriate links
   std::unordered_set<Link> linksUp;
@@ -634,6 +647,44 @@ LinkState::updateAdjacencyDatabase(
   return std::make_pair(topoChanged, routeAttrChanged);
 }
 
+std::pair<
+    bool /* topology has changed*/,
+    bool /* route attributes has changed (nexthop addr, node/adj label */>
+LinkState::updateAdjacency(
+    const std::string& nodeName,
+    const std::string& otherNodeName,
+    const std::string& ifName,
+    folly::Optional<thrift::Adjacency> const& adj,
+    LinkStateMetric holdUpTtl,
+    LinkStateMetric holdDownTtl) {
+  VLOG(1) << (adj.hasValue() ? "Updating" : "Withdrawing") << " adjacency "
+          << nodeName << ":" << ifName << " -> " << otherNodeName;
+
+  auto& nodeAdjacencies = perKeyAdjacencies_[nodeName];
+  const auto adjId = std::make_pair(otherNodeName, ifName);
+  if (adj.hasValue()) {
+    nodeAdjacencies[adjId] = adj.value();
+  } else {
+    nodeAdjacencies.erase(adjId);
+  }
+  if (nodeAdjacencies.empty()) {
+    perKeyAdjacencies_.erase(nodeName);
+  }
+
+  // nothing to apply until node's own key tells us it uses per adjacency
+  // keys
+  auto it = adjacencyDatabases_.find(nodeName);
+  if (it == adjacencyDatabases_.end() ||
+      !it->second.perAdjacencyKey.value_or(false)) {
+    return std::make_pair(false, false);
+  }
+
+  // NOTE: copy on purpose, adjacencies are filled in from perKeyAdjacencies_
+  auto adjacencyDb = it->second;
+  adjacencyDb.adjacencies.clear();
+  return updateAdjacencyDatabase(adjacencyDb, holdUpTtl, holdDownTtl);
+}
+
 bool
 LinkState::deleteAdjacencyDatabase(const std::string& nodeName) {
   VLOG(1) << "Deleting adjacency database for node " << nodeName;
@@ -7,12 +7,16 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <folly/Optional.h>
+
 #include <openr/if/gen-cpp2/Lsdb_types.h>
 #include <openr/if/gen-cpp2/Network_types.h>
 
@@ -222,6 +226,21 @@ class LinkState {
       LinkStateMetric holdUpTtl,
       LinkStateMetric holdDownTtl);
 
+  // Merge single adjacency advertised by `nodeName` under per adjacency key
+  // into its adjacency database, `adj` of none withdraws it. Change is applied
+  // right away if node's adjacency database is in per adjacency key format,
+  // and once it is otherwise
+  std::pair<
+      bool /* topology has changed */,
+      bool /* route attributes has changed (nexthop addr, node/adj label */>
+  updateAdjacency(
+      const std::string& nodeName,
+      const std::string& otherNodeName,
+      const std::string& ifName,
+      folly::Optional<thrift::Adjacency> const& adj,
+      LinkStateMetric holdUpTtl,
+      LinkStateMetric holdDownTtl);
+
   // delete a node's adjacency database
   // return true if this has caused any change in graph
   bool deleteAdjacencyDatabase(const std::string& nodeName);
@@ -256,6 +275,15 @@ class LinkState {
   std::unordered_map<std::string, thrift::AdjacencyDatabase>
       adjacencyDatabases_;
 
+  // adjacencies received under per adjacency keys from each node, merged
+  // into its AdjacencyDatabase
+  std::unordered_map<
+      std::string /* nodeName */,
+      std::map<
+          std::pair<std::string /* otherNodeName */, std::string /* ifName */>,
+          thrift::Adjacency>>
+      perKeyAdjacencies_;
+
 }; // class LinkState
 } // namespace openr
 
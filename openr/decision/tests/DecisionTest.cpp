@@ -3819,6 +3819,25 @@ class DecisionTestFixture : public ::testing::Test {
         0 /* hash */);
   }
 
+  // value of node's key or of its adjacency key in per adjacency key format
+  thrift::Value
+  createPerAdjacencyValue(
+      const string& node,
+      int64_t version,
+      const vector<thrift::Adjacency>& adjs,
+      bool deleteAdjacency = false) {
+    auto adjDB = createAdjDb(node, adjs, 0);
+    adjDB.perAdjacencyKey = true;
+    adjDB.deleteAdjacency = deleteAdjacency;
+    return createThriftValue(
+        version,
+        node,
+        fbzmq::util::writeThriftObjStr(adjDB, serializer),
+        Constants::kTtlInfinity /* ttl */,
+        0 /* ttl version */,
+        0 /* hash */);
+  }
+
   thrift::Value
   createPrefixValue(
       const string& node,
@@ -4944,6 +4963,89 @@ TEST_F(DecisionTestFixture, PerPrefixKeyExpiry) {
   EXPECT_EQ(routeDb1, routeDb2);
 }
 
+// Node 2 advertises its parallel adjacencies to 1 under per adjacency keys.
+// Each of them is merged into node's adjacency database, and withdrawal or
+// expiry of a key takes down only that adjacency.
+TEST_F(DecisionTestFixture, PerAdjacencyKeys) {
+  auto adj12_1 =
+      createAdjacency("2", "1/2-1", "2/1-1", "fe80::2", "192.168.0.2", 100, 0);
+  auto adj12_2 =
+      createAdjacency("2", "1/2-2", "2/1-2", "fe80::2", "192.168.0.2", 800, 0);
+  auto adj21_1 =
+      createAdjacency("1", "2/1-1", "1/2-1", "fe80::1", "192.168.0.1", 100, 0);
+  auto adj21_2 =
+      createAdjacency("1", "2/1-2", "1/2-2", "fe80::1", "192.168.0.1", 800, 0);
+  const auto key21_1 = PerAdjacencyKey("2", "1", "2/1-1").getAdjacencyKey();
+  const auto key21_2 = PerAdjacencyKey("2", "1", "2/1-2").getAdjacencyKey();
+
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12_1, adj12_2})},
+       {"adj:2", createPerAdjacencyValue("2", 1, {})},
+       {key21_1, createPerAdjacencyValue("2", 1, {adj21_1})},
+       {key21_2, createPerAdjacencyValue("2", 1, {adj21_2})},
+       {"prefix:1", createPrefixValue("1", 1, {addr1})},
+       {"prefix:2", createPrefixValue("2", 1, {addr2})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvMyRouteDb(decisionPub, "1", serializer);
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  RouteMap routeMap;
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12_1, false, 100),
+                createNextHopFromAdj(adj12_2, false, 800)}));
+
+  // withdraw adjacency via its key
+  publication = createThriftPublication(
+      {{key21_1, createPerAdjacencyValue("2", 2, {adj21_1}, true)}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb(decisionPub, "1", serializer);
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  routeMap.clear();
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12_2, false, 800)}));
+
+  // node attributes update keeps adjacencies of their own keys
+  publication = createThriftPublication(
+      {{"adj:2", createPerAdjacencyValue("2", 2, {})},
+       {key21_1, createPerAdjacencyValue("2", 3, {adj21_1})}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb(decisionPub, "1", serializer);
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  routeMap.clear();
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12_1, false, 100),
+                createNextHopFromAdj(adj12_2, false, 800)}));
+
+  // expire the other adjacency key
+  publication =
+      createThriftPublication({}, {key21_2}, {}, {}, std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvMyRouteDb(decisionPub, "1", serializer);
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  routeMap.clear();
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12_1, false, 100)}));
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -182,6 +182,50 @@ TEST(LinkStateTest, BasicOperation) {
   EXPECT_THROW(state.removeLink(l1), std::out_of_range);
 }
 
+TEST(LinkStateTest, PerAdjacencyKey) {
+  std::string n1 = "node1";
+  std::string n2 = "node2";
+  std::string n3 = "node3";
+  auto adj12 =
+      openr::createAdjacency(n2, "if1", "if2", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj13 =
+      openr::createAdjacency(n3, "if3", "if1", "fe80::3", "10.0.0.3", 1, 2, 1);
+  auto adj21 =
+      openr::createAdjacency(n1, "if2", "if1", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto adj31 =
+      openr::createAdjacency(n1, "if1", "if3", "fe80::1", "10.0.0.1", 1, 1, 1);
+
+  openr::LinkState state;
+  state.updateAdjacencyDatabase(openr::createAdjDb(n2, {adj21}, 2), 0, 0);
+  state.updateAdjacencyDatabase(openr::createAdjDb(n3, {adj31}, 3), 0, 0);
+
+  // adjacency received before node's own key is held back
+  EXPECT_FALSE(state.updateAdjacency(n1, n2, "if1", adj12, 0, 0).first);
+  EXPECT_THAT(state.linksFromNode(n1), testing::IsEmpty());
+
+  // node's attributes bring in adjacencies received so far
+  auto adjDb1 = openr::createAdjDb(n1, {}, 1);
+  adjDb1.perAdjacencyKey = true;
+  EXPECT_TRUE(state.updateAdjacencyDatabase(adjDb1, 0, 0).first);
+  EXPECT_EQ(1, state.linksFromNode(n1).size());
+
+  // adjacencies come and go one by one
+  EXPECT_TRUE(state.updateAdjacency(n1, n3, "if3", adj13, 0, 0).first);
+  EXPECT_EQ(2, state.linksFromNode(n1).size());
+  EXPECT_TRUE(state.updateAdjacency(n1, n2, "if1", folly::none, 0, 0).first);
+  EXPECT_EQ(1, state.linksFromNode(n1).size());
+  EXPECT_EQ(n3, (*state.linksFromNode(n1).begin())->getOtherNodeName(n1));
+
+  // attribute update keeps adjacencies
+  adjDb1.isOverloaded = true;
+  state.updateAdjacencyDatabase(adjDb1, 0, 0);
+  EXPECT_TRUE(state.isNodeOverloaded(n1));
+  EXPECT_EQ(1, state.linksFromNode(n1).size());
+
+  EXPECT_TRUE(state.updateAdjacency(n1, n3, "if3", folly::none, 0, 0).first);
+  EXPECT_THAT(state.linksFromNode(n1), testing::IsEmpty());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
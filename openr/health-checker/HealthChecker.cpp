@@ -219,7 +219,13 @@ HealthChecker::processKeyVal(
       return;
     }
     if (key.find(adjacencyDbMarker_) == 0) {
-      nodeInfo_[nodeName].neighbors.clear();
+      auto adjacencyKey = PerAdjacencyKey::fromStr(key);
+      if (adjacencyKey.hasValue()) {
+        processAdjacencyKey(adjacencyKey.value(), false /* isUp */);
+      } else {
+        perKeyNeighbors_.erase(nodeName);
+        nodeInfo_[nodeName].neighbors.clear();
+      }
     }
     if (key.find(prefixDbMarker_) == 0) {
       nodeInfo_[nodeName].ipAddress =
@@ -239,7 +245,13 @@ HealthChecker::processKeyVal(
         fbzmq::util::readThriftObjStr<thrift::AdjacencyDatabase>(
             val.value().value.value(), serializer_);
     CHECK_EQ(nodeName, adjacencyDb.thisNodeName);
-    processAdjDb(adjacencyDb);
+    auto adjacencyKey = PerAdjacencyKey::fromStr(key);
+    if (adjacencyKey.hasValue()) {
+      processAdjacencyKey(
+          adjacencyKey.value(), !adjacencyDb.deleteAdjacency.value_or(false));
+    } else {
+      processAdjDb(adjacencyDb);
+    }
   }
 
   if (key.find(prefixDbMarker_) == 0) {
@@ -253,6 +265,10 @@ HealthChecker::processKeyVal(
 void
 HealthChecker::processAdjDb(thrift::AdjacencyDatabase const& adjDb) {
   auto& neighbors = nodeInfo_[adjDb.thisNodeName].neighbors;
+  if (adjDb.perAdjacencyKey.value_or(false)) {
+    // adjacencies are advertised under their own keys
+    return;
+  }
   neighbors.clear();
   for (auto const& adj : adjDb.adjacencies) {
     neighbors.push_back(adj.otherNodeName);
@@ -260,6 +276,28 @@ HealthChecker::processAdjDb(thrift::AdjacencyDatabase const& adjDb) {
   updateNodesToPing();
 }
 
+void
+HealthChecker::processAdjacencyKey(
+    PerAdjacencyKey const& adjacencyKey, bool isUp) {
+  auto& keyNeighbors = perKeyNeighbors_[adjacencyKey.getNodeName()];
+  if (isUp) {
+    keyNeighbors[adjacencyKey.getAdjacencyKey()] =
+        adjacencyKey.getOtherNodeName();
+  } else {
+    keyNeighbors.erase(adjacencyKey.getAdjacencyKey());
+  }
+
+  auto& neighbors = nodeInfo_[adjacencyKey.getNodeName()].neighbors;
+  neighbors.clear();
+  for (auto const& kv : keyNeighbors) {
+    neighbors.push_back(kv.second);
+  }
+  if (keyNeighbors.empty()) {
+    perKeyNeighbors_.erase(adjacencyKey.getNodeName());
+  }
+  updateNodesToPing();
+}
+
 void
 HealthChecker::processPrefixDb(thrift::PrefixDatabase const& prefixDb) {
   // Find all valid node addresses from prefixEntries
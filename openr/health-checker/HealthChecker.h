@@ -76,6 +76,8 @@ class HealthChecker final : public OpenrEventLoop {
       std::string const& key, folly::Optional<thrift::Value> val) noexcept;
 
   void processAdjDb(thrift::AdjacencyDatabase const& adjDb);
+  // add or remove single adjacency of a node advertising per adjacency keys
+  void processAdjacencyKey(PerAdjacencyKey const& adjacencyKey, bool isUp);
   void processPrefixDb(thrift::PrefixDatabase const& prefixDb);
   void updateNodesToPing();
   void sendDatagram(
@@ -127,6 +129,12 @@ class HealthChecker final : public OpenrEventLoop {
 
   std::unordered_map<std::string, thrift::NodeHealthInfo> nodeInfo_;
 
+  // neighbors of nodes advertising per adjacency keys, keyed by adjacency key
+  std::unordered_map<
+      std::string /* NodeName */,
+      std::unordered_map<std::string /* key */, std::string /* otherNode */>>
+      perKeyNeighbors_;
+
   // DS to hold local stats/counters
   fbzmq::ThreadData tData_;
 };
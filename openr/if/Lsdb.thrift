@@ -126,6 +126,14 @@ struct AdjacencyDatabase {
 
   // Optional attribute to measure convergence performance
   5: optional PerfEvents perfEvents;
+
+  // Set to true if adjacencies are advertised with 'per adjacency key'
+  // format. Database under node's key then only carries node attributes, and
+  // one under each adjacency key carries that single adjacency
+  6: optional bool perAdjacencyKey
+
+  // flag to indicate adjacency of per adjacency key must be deleted
+  7: optional bool deleteAdjacency
 }
 
 //
@@ -87,11 +87,42 @@ enum SwitchRunState {
    LINK_EVENT = 1,
    ADDRESS_EVENT = 2,
    NEIGHBOR_EVENT = 3,
+   /*
+    * Periodic heartbeat, eventData is PlatformHeartbeat
+    */
+   HEARTBEAT_EVENT = 4,
  }
 
 struct PlatformEvent {
   1: PlatformEventType eventType;
   2: binary eventData;
+
+  /**
+   * Sequence number of the event among events of same type sent by the
+   * publisher, starting at 1 and incremented by 1 with every event. Along with
+   * publisherId it lets subscribers detect missed events (e.g. dropped by
+   * PUB socket) and only fall back to full sync to recover from those.
+   */
+  3: optional i64 seqNum;
+
+  /**
+   * Identifies publisher instance. It changes when publisher restarts and
+   * sequence numbers start over.
+   */
+  4: optional i64 publisherId;
+}
+
+/**
+ * Sent periodically by publisher, along with its publisherId, so that
+ * subscribers can tell they missed last events sent before publisher went
+ * quiet. Heartbeats aren't sequenced themselves.
+ */
+struct PlatformHeartbeat {
+  /**
+   * Sequence number of last event published, per event type. Event types not
+   * published yet are present with 0.
+   */
+  1: map<PlatformEventType, i64> seqNums;
 }
 
 exception PlatformError {
@@ -163,6 +194,21 @@ const map<i16, i16> protocolIdtoPriority = {
 }
 const i16 kUnknowProtAdminDistance = 255
 
+/**
+ * A page of route table returned by paginated route table APIs. Pass
+ * `nextCursor` in the next request to continue the walk. It is 0 once the end
+ * of the table has been reached.
+ */
+struct UnicastRouteTablePage {
+  1: list<Network.UnicastRoute> routes;
+  2: i64 nextCursor = 0;
+}
+
+struct MplsRouteTablePage {
+  1: list<Network.MplsRoute> routes;
+  2: i64 nextCursor = 0;
+}
+
 /**
  * Interface to on-box Fib.
  */
@@ -206,6 +252,16 @@ service FibService extends fb303.FacebookService {
     1: i16 clientId
   ) throws (1: PlatformError error)
 
+  // Retrieve unicast routes per client in pages of at most `limit` routes
+  // (server may cap it). Start a walk with cursor 0. All pages of a walk are
+  // served from the snapshot of the table taken on the first call. Cursors
+  // not used for a while expire and are rejected.
+  UnicastRouteTablePage getRouteTableByClientPaged(
+    1: i16 clientId,
+    2: i64 cursor,
+    3: i32 limit,
+  ) throws (1: PlatformError error)
+
   //
   // MPLS routes API
   //
@@ -231,6 +287,15 @@ service FibService extends fb303.FacebookService {
     1: i16 clientId
   ) throws (1: PlatformError error)
 
+  // Retrieve MPLS routes per client in pages of at most `limit` routes in
+  // increasing label order. Start a walk with cursor 0. Unlike unicast, pages
+  // reflect the table at the time of each call.
+  MplsRouteTablePage getMplsRouteTableByClientPaged(
+    1: i16 clientId,
+    2: i64 cursor,
+    3: i32 limit,
+  ) throws (1: PlatformError error)
+
   void registerForNeighborChanged()
     throws (1: PlatformError error) (thread='eb')
 
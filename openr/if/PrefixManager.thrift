@@ -34,3 +34,11 @@ struct PrefixManagerResponse {
   2: string message
   3: list<Lsdb.PrefixEntry> prefixes
 }
+
+// Changes of persistent prefix entries since prefix database was last written
+// out in full. Applied on top of it when loading from PersistentStore.
+struct PrefixDatabaseDelta {
+  1: list<Lsdb.PrefixEntry> updatedEntries
+  // only prefix and type are of relevance
+  2: list<Lsdb.PrefixEntry> withdrawnEntries
+}
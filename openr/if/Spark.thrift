@@ -127,6 +127,12 @@ struct SparkHelloMsg {
   7: bool solicitResponse = 0
   8: bool restarting = 0
   9: i64 sentTsInUs;
+
+  // Kernel TX timestamp of previous hello sent on this interface, along with
+  // its sentTsInUs. Lets neighbors correct RTT measured off previous hello by
+  // time it spent in sender's user space and kernel before hitting the wire
+  10: optional i64 prevSentTsInUs;
+  11: optional i64 prevKernelSentTsInUs;
 }
 
 struct SparkHeartbeatMsg {
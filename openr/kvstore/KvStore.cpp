@@ -172,6 +172,38 @@ KvStore::KvStore(
                << localPubBind.error();
   }
 
+  const auto localFilteredPubUrl = getFilteredPubUrl(localPubUrl_);
+  if (localFilteredPubUrl.hasValue()) {
+    auto& localFilteredPubSock = kvParams_.localFilteredPubSock;
+    const auto localFilteredPubHwm =
+        localFilteredPubSock.setSockOpt(ZMQ_SNDHWM, &zmqHwm, sizeof(zmqHwm));
+    if (localFilteredPubHwm.hasError()) {
+      LOG(FATAL) << "Error setting ZMQ_SNDHWM to " << zmqHwm << " "
+                 << localFilteredPubHwm.error();
+    }
+    // fail send at high water mark instead of dropping silently
+    const int noDrop = 1;
+    const auto localFilteredPubNoDrop = localFilteredPubSock.setSockOpt(
+        ZMQ_XPUB_NODROP, &noDrop, sizeof(noDrop));
+    if (localFilteredPubNoDrop.hasError()) {
+      LOG(FATAL) << "Error setting ZMQ_XPUB_NODROP to " << noDrop << " "
+                 << localFilteredPubNoDrop.error();
+    }
+    VLOG(2) << "KvStore: Binding localFilteredPubUrl '"
+            << *localFilteredPubUrl << "'";
+    const auto localFilteredPubBind =
+        localFilteredPubSock.bind(fbzmq::SocketUrl{*localFilteredPubUrl});
+    if (localFilteredPubBind.hasError()) {
+      LOG(FATAL) << "Error binding to URL '" << *localFilteredPubUrl << "' "
+                 << localFilteredPubBind.error();
+    }
+    kvParams_.hasLocalFilteredPub = true;
+    addSocket(
+        fbzmq::RawZmqSocketPtr{*localFilteredPubSock},
+        ZMQ_POLLIN,
+        [this](int) noexcept { processFilteredSubscription(); });
+  }
+
   VLOG(2) << "KvStore: Binding globalPubUrl '" << globalPubUrl_ << "'";
   const auto globalPubBind =
       globalPubSock.bind(fbzmq::SocketUrl{globalPubUrl_});
@@ -200,6 +232,41 @@ KvStore::KvStore(
   }
 }
 
+void
+KvStore::processFilteredSubscription() {
+  // Subscription message is 1 (subscribe) or 0 (unsubscribe) followed by
+  // topic. ZMQ only passes first subscribe and last unsubscribe of a topic.
+  while (true) {
+    auto maybeMsg = kvParams_.localFilteredPubSock.recvOne();
+    if (maybeMsg.hasError()) {
+      return;
+    }
+    auto const data = maybeMsg->data();
+    if (data.empty()) {
+      continue;
+    }
+    std::string topic(
+        reinterpret_cast<const char*>(data.data()) + 1, data.size() - 1);
+    VLOG(2) << "KvStore: " << (data[0] ? "Subscribe to" : "Unsubscribe from")
+            << " filtered topic '" << topic << "'";
+    if (data[0]) {
+      kvParams_.filteredPubTopics.emplace(std::move(topic));
+    } else {
+      kvParams_.filteredPubTopics.erase(topic);
+    }
+  }
+}
+
+// static, public
+folly::Optional<std::string>
+KvStore::getFilteredPubUrl(std::string const& localPubUrl) {
+  if (not folly::StringPiece(localPubUrl).startsWith("inproc://") and
+      not folly::StringPiece(localPubUrl).startsWith("ipc://")) {
+    return folly::none;
+  }
+  return localPubUrl + Constants::kFilteredPubUrlSuffix.toString();
+}
+
 // static, public
 std::unordered_map<std::string, thrift::Value>
 KvStore::mergeKeyValues(
@@ -503,6 +570,10 @@ KvStoreDb::KvStoreDb(
   ttlCountdownTimer_ = fbzmq::ZmqTimeout::make(
       evl_, [this]() noexcept { cleanupTtlCountdownQueue(); });
 
+  // Scheduled once filtered publication hits high water mark
+  filteredResyncTimer_ =
+      fbzmq::ZmqTimeout::make(evl_, [this]() noexcept { resyncFiltered(); });
+
   // Initialize stats keys
   tData_.addStatExportType("kvstore.cmd_hash_dump", fbzmq::COUNT);
   tData_.addStatExportType("kvstore.cmd_key_dump", fbzmq::COUNT);
@@ -512,6 +583,8 @@ KvStoreDb::KvStoreDb(
   tData_.addStatExportType("kvstore.cmd_peer_dump", fbzmq::COUNT);
   tData_.addStatExportType("kvstore.cmd_per_del", fbzmq::COUNT);
   tData_.addStatExportType("kvstore.expired_key_vals", fbzmq::SUM);
+  tData_.addStatExportType("kvstore.filtered_pub_drops", fbzmq::COUNT);
+  tData_.addStatExportType("kvstore.filtered_pub_resyncs", fbzmq::COUNT);
   tData_.addStatExportType("kvstore.flood_duration_ms", fbzmq::AVG);
   tData_.addStatExportType("kvstore.full_sync_duration_ms", fbzmq::AVG);
   tData_.addStatExportType("kvstore.looped_publications", fbzmq::COUNT);
@@ -778,6 +851,95 @@ KvStoreDb::addPeers(
   }
 }
 
+void
+KvStoreDb::publishFiltered(thrift::Publication const& publication) {
+  auto const& topics = kvParams_.filteredPubTopics;
+  if (topics.empty()) {
+    return;
+  }
+
+  // Subscriber of a topic receives batches of all topics it is a prefix of,
+  // so key goes out only in batch of longest subscribed topic matching it
+  std::unordered_map<std::string, thrift::Publication> batches;
+  auto const getBatch = [&](std::string const& key) -> thrift::Publication* {
+    std::string topic = key;
+    while (topics.count(topic) == 0) {
+      if (topic.empty()) {
+        return nullptr;
+      }
+      topic.pop_back();
+    }
+    auto& batch = batches[topic];
+    batch.area = publication.area;
+    return &batch;
+  };
+
+  for (auto const& kv : publication.keyVals) {
+    if (auto batch = getBatch(kv.first)) {
+      batch->keyVals.emplace(kv.first, kv.second);
+    }
+  }
+  for (auto const& key : publication.expiredKeys) {
+    if (auto batch = getBatch(key)) {
+      batch->expiredKeys.emplace_back(key);
+    }
+  }
+  for (auto const& kv : batches) {
+    sendFiltered(kv.first, kv.second);
+  }
+}
+
+void
+KvStoreDb::sendFiltered(
+    std::string const& topic, thrift::Publication const& publication) {
+  auto const ret = kvParams_.localFilteredPubSock.sendMultiple(
+      fbzmq::Message::from(topic).value(),
+      fbzmq::Message::fromThriftObj(publication, serializer_).value());
+  if (not ret.hasError()) {
+    return;
+  }
+
+  // Some subscriber of topic is lagging behind. Send current state of topic
+  // once it caught up, rather than losing updates.
+  LOG(ERROR) << "Error publishing topic '" << topic
+             << "' on filtered pub socket, will resync it: " << ret.error();
+  tData_.addStatValue("kvstore.filtered_pub_drops", 1, fbzmq::COUNT);
+  filteredResyncTopics_[topic].insert(
+      publication.expiredKeys.begin(), publication.expiredKeys.end());
+  if (not filteredResyncTimer_->isScheduled()) {
+    filteredResyncTimer_->scheduleTimeout(
+        Constants::kFilteredPubResyncInterval);
+  }
+}
+
+void
+KvStoreDb::resyncFiltered() {
+  auto resyncTopics = std::move(filteredResyncTopics_);
+  filteredResyncTopics_.clear();
+  for (auto const& kv : resyncTopics) {
+    auto const& topic = kv.first;
+    if (kvParams_.filteredPubTopics.count(topic) == 0) {
+      continue; // nobody is interested anymore
+    }
+
+    thrift::Publication publication;
+    publication.area = area_;
+    for (auto const& keyVal : kvStore_) {
+      if (keyVal.first.compare(0, topic.size(), topic) == 0) {
+        publication.keyVals.emplace(keyVal.first, keyVal.second);
+      }
+    }
+    updatePublicationTtl(publication);
+    for (auto const& key : kv.second) {
+      if (kvStore_.count(key) == 0) {
+        publication.expiredKeys.emplace_back(key);
+      }
+    }
+    tData_.addStatValue("kvstore.filtered_pub_resyncs", 1, fbzmq::COUNT);
+    sendFiltered(topic, publication);
+  }
+}
+
 // Send message via socket
 folly::Expected<size_t, fbzmq::Error>
 KvStoreDb::sendMessageToPeer(
@@ -1746,6 +1908,9 @@ KvStoreDb::floodPublication(
       fbzmq::Message::fromThriftObj(publication, serializer_).value();
   kvParams_.localPubSock.sendOne(msg);
   kvParams_.globalPubSock.sendOne(msg);
+  if (kvParams_.hasLocalFilteredPub) {
+    publishFiltered(publication);
+  }
 
   //
   // Create request and send only keyValue updates to all neighbors
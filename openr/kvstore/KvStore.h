@@ -95,6 +95,12 @@ struct KvStoreParams {
   // the socket to publish changes to kv-store
   fbzmq::Socket<ZMQ_PUB, fbzmq::ZMQ_SERVER> localPubSock;
   fbzmq::Socket<ZMQ_PUB, fbzmq::ZMQ_SERVER> globalPubSock;
+  // the socket to publish changes batched per subscribed topic, if bound.
+  // XPUB so that we learn which topics subscribers are interested in.
+  fbzmq::Socket<ZMQ_XPUB, fbzmq::ZMQ_SERVER> localFilteredPubSock;
+  bool hasLocalFilteredPub{false};
+  // topics (literal key prefixes) subscribed to on localFilteredPubSock
+  std::unordered_set<std::string> filteredPubTopics;
   // ZMQ high water
   int zmqHwm;
   // IP ToS
@@ -133,6 +139,8 @@ struct KvStoreParams {
       : nodeId(nodeid),
         localPubSock(zmqContext),
         globalPubSock(std::move(globalpubSock)),
+        localFilteredPubSock(
+            zmqContext, folly::none, folly::none, fbzmq::NonblockingFlag{true}),
         zmqHwm(zmqhwm),
         maybeIpTos(std::move(maybeipTos)),
         dbSyncInterval(dbsyncInterval),
@@ -270,6 +278,20 @@ class KvStoreDb : public DualNode {
       bool rateLimit = true,
       bool setFloodRoot = true);
 
+  // Publish publication on local filtered pub socket. Keys nobody
+  // subscribed to are skipped, the rest go out batched per longest
+  // subscribed topic matching them, so every subscriber sees a key once.
+  void publishFiltered(thrift::Publication const& publication);
+
+  // Send batch on local filtered pub socket. Batch which hits high water
+  // mark is not sent, its topic gets republished from store later instead.
+  void sendFiltered(
+      std::string const& topic, thrift::Publication const& publication);
+
+  // Republish current keys of topics whose batches hit high water mark,
+  // along with keys expired meanwhile
+  void resyncFiltered();
+
   // update Time to expire filed in Publication
   // removeAboutToExpire: knob to remove keys which are about to expire
   // and hence do not want to include them. Constants::kTtlThreshold
@@ -383,6 +405,14 @@ class KvStoreDb : public DualNode {
   // timer to send pending kvstore publication
   std::unique_ptr<fbzmq::ZmqTimeout> pendingPublicationTimer_{nullptr};
 
+  // Topics of local filtered pub socket to republish, with keys expired in
+  // batches which didn't make it out
+  std::unordered_map<std::string, std::unordered_set<std::string>>
+      filteredResyncTopics_;
+
+  // timer to republish topics in `filteredResyncTopics_`
+  std::unique_ptr<fbzmq::ZmqTimeout> filteredResyncTimer_{nullptr};
+
   // pending keys to flood publication
   // map<flood-root-id: set<keys>>
   std::
@@ -463,6 +493,14 @@ class KvStore final : public OpenrEventLoop {
   // unknown can happen if value is missing (only hash is provided)
   static int compareValues(const thrift::Value& v1, const thrift::Value& v2);
 
+  // Url of local publisher streaming changes as messages made of subscribed
+  // topic followed by publication carrying keys under that topic.
+  // Subscribers set ZMQ_SUBSCRIBE to key prefixes they care about and only
+  // receive and decode matching keys. Derived from local pub url and only
+  // available for inproc and ipc transports.
+  static folly::Optional<std::string> getFilteredPubUrl(
+      std::string const& localPubUrl);
+
  private:
   // disable copying
   KvStore(KvStore const&) = delete;
@@ -481,6 +519,9 @@ class KvStore final : public OpenrEventLoop {
   fbzmq::thrift::CounterMap getCounters();
   void submitCounters();
 
+  // Track (un)subscriptions received on local filtered pub socket
+  void processFilteredSubscription();
+
   //
   // Private variables
   //
@@ -16,6 +16,17 @@
 
 namespace openr {
 
+namespace {
+// Resolution of TTL refresh timer wheel
+const std::chrono::milliseconds kTtlTimerWheelTick{10};
+
+// Longest literal prefix of key prefix regex, usable as ZMQ topic
+std::string
+getLiteralPrefix(std::string const& keyPrefix) {
+  return keyPrefix.substr(0, keyPrefix.find_first_of(".[]()*+?{}|^$\\"));
+}
+} // namespace
+
 KvStoreClient::KvStoreClient(
     fbzmq::Context& context,
     fbzmq::ZmqEventLoop* eventLoop,
@@ -29,6 +40,8 @@ KvStoreClient::KvStoreClient(
       context_(context),
       kvStoreLocalCmdUrl_(kvStoreLocalCmdUrl),
       kvStoreLocalPubUrl_(kvStoreLocalPubUrl),
+      useFilteredPub_(
+          KvStore::getFilteredPubUrl(kvStoreLocalPubUrl).hasValue()),
       checkPersistKeyPeriod_(checkPersistKeyPeriod),
       recvTimeout_(recvTimeout),
       kvStoreCmdSock_(nullptr),
@@ -46,29 +59,34 @@ KvStoreClient::KvStoreClient(
   // Prepare sockets
   //
 
-  // Connect to subscriber endpoint
+  // Connect to subscriber endpoint. Use filtered publications if KvStore
+  // offers them and subscribe only to keys we are interested in as we go,
+  // else subscribe to everything.
+  const auto kvStorePubUrl = useFilteredPub_
+      ? KvStore::getFilteredPubUrl(kvStoreLocalPubUrl_).value()
+      : kvStoreLocalPubUrl_;
   const auto kvStoreSub =
-      kvStoreSubSock_.connect(fbzmq::SocketUrl{kvStoreLocalPubUrl_});
+      kvStoreSubSock_.connect(fbzmq::SocketUrl{kvStorePubUrl});
   if (kvStoreSub.hasError()) {
-    LOG(FATAL) << "Error binding to URL '" << kvStoreLocalPubUrl_ << "' "
+    LOG(FATAL) << "Error binding to URL '" << kvStorePubUrl << "' "
                << kvStoreSub.error();
   }
 
-  // Subscribe to everything
-  const auto kvStoreSubOpt = kvStoreSubSock_.setSockOpt(ZMQ_SUBSCRIBE, "", 0);
-  if (kvStoreSubOpt.hasError()) {
-    LOG(FATAL) << "Error setting ZMQ_SUBSCRIBE to "
-               << ""
-               << " " << kvStoreSubOpt.error();
+  if (not useFilteredPub_) {
+    const auto kvStoreSubOpt =
+        kvStoreSubSock_.setSockOpt(ZMQ_SUBSCRIBE, "", 0);
+    if (kvStoreSubOpt.hasError()) {
+      LOG(FATAL) << "Error setting ZMQ_SUBSCRIBE to "
+                 << ""
+                 << " " << kvStoreSubOpt.error();
+    }
   }
 
   // Attach socket callback
   eventLoop_->addSocket(
       fbzmq::RawZmqSocketPtr{*kvStoreSubSock_}, ZMQ_POLLIN, [&](int) noexcept {
         // Read publication from socket and process it
-        auto maybePublication =
-            kvStoreSubSock_.recvThriftObj<thrift::Publication>(
-                serializer_, recvTimeout_);
+        auto maybePublication = recvPublication();
         if (maybePublication.hasError()) {
           LOG(ERROR) << "Failed to read publication from KvStore SUB socket. "
                      << "Exception: " << maybePublication.error();
@@ -132,7 +150,8 @@ KvStoreClient::initTimers() {
         }
       });
 
-  // Create ttl timer
+  // Create ttl timer wheel and timer advertising ttl updates due
+  ttlTimerWheel_ = std::make_unique<TimerWheel>(eventLoop_, kTtlTimerWheelTick);
   ttlTimer_ = fbzmq::ZmqTimeout::make(
       eventLoop_, [this]() noexcept { advertiseTtlUpdates(); });
 
@@ -145,6 +164,59 @@ KvStoreClient::initTimers() {
   }
 }
 
+folly::Expected<thrift::Publication, fbzmq::Error>
+KvStoreClient::recvPublication() {
+  if (not useFilteredPub_) {
+    return kvStoreSubSock_.recvThriftObj<thrift::Publication>(
+        serializer_, recvTimeout_);
+  }
+
+  // publication prefixed with topic it was batched for
+  fbzmq::Message keyMsg, publicationMsg;
+  const auto ret = kvStoreSubSock_.recvMultiple(keyMsg, publicationMsg);
+  if (ret.hasError()) {
+    return folly::makeUnexpected(ret.error());
+  }
+  return publicationMsg.readThriftObj<thrift::Publication>(serializer_);
+}
+
+void
+KvStoreClient::setSubscription(std::string const& topic, bool subscribe) {
+  if (not useFilteredPub_) {
+    return;
+  }
+  const auto ret = kvStoreSubSock_.setSockOpt(
+      subscribe ? ZMQ_SUBSCRIBE : ZMQ_UNSUBSCRIBE, topic.data(), topic.size());
+  if (ret.hasError()) {
+    LOG(ERROR) << "Error " << (subscribe ? "subscribing to" : "unsubscribing")
+               << " topic '" << topic << "' " << ret.error();
+  }
+}
+
+void
+KvStoreClient::updateKeySubscription(std::string const& key) {
+  // keys we persist or refresh TTL of need to be watched as well so that we
+  // can react to someone else overriding them
+  bool isInterested = keyCallbacks_.count(key) != 0;
+  for (auto const& kv : persistedKeyVals_) {
+    isInterested = isInterested or kv.second.count(key) != 0;
+  }
+  for (auto const& kv : keyTtlRefreshes_) {
+    isInterested = isInterested or kv.second.count(key) != 0;
+  }
+
+  const bool isSubscribed = subscribedKeys_.count(key) != 0;
+  if (isInterested == isSubscribed) {
+    return;
+  }
+  if (isInterested) {
+    subscribedKeys_.insert(key);
+  } else {
+    subscribedKeys_.erase(key);
+  }
+  setSubscription(key, isInterested);
+}
+
 void
 KvStoreClient::initOpenrCtrlClient() {
   // Do not create new client if one exists already
@@ -257,8 +329,78 @@ KvStoreClient::persistKey(
   VLOG(3) << "KvStoreClient: persistKey called for key:" << key
           << " area:" << area;
 
+  // Retrieve the existing value for the key. If key is persisted before then
+  // it is the one we have cached locally else we need to fetch it from KvStore
+  folly::Optional<thrift::Value> storedValue;
+  if (persistedKeyVals_[area].count(key) == 0) {
+    auto maybeValue = getKey(key, area);
+    if (maybeValue.hasValue()) {
+      storedValue = std::move(maybeValue.value());
+    }
+  }
+
+  updatePersistedKey(key, value, ttl, area, std::move(storedValue));
+
+  // Best effort to advertise pending keys
+  advertisePendingKeys();
+  advertiseTtlUpdates();
+}
+
+void
+KvStoreClient::persistKeys(
+    std::unordered_map<std::string, std::string> const& keyVals,
+    std::chrono::milliseconds ttl /* = Constants::kTtlInfInterval */,
+    std::string const& area /* = thrift::KvStore_constants::kDefaultArea()*/) {
+  VLOG(3) << "KvStoreClient: persistKeys called for " << keyVals.size()
+          << " keys, area:" << area;
+  if (keyVals.empty()) {
+    return;
+  }
+
+  // Fetch existing values of all keys not persisted before in one go
+  const auto& persistedKeyVals = persistedKeyVals_[area];
+  std::vector<std::string> keysToFetch;
+  for (auto const& kv : keyVals) {
+    if (persistedKeyVals.count(kv.first) == 0) {
+      keysToFetch.push_back(kv.first);
+    }
+  }
+  std::unordered_map<std::string, thrift::Value> storedKeyVals;
+  if (not keysToFetch.empty()) {
+    auto maybeKeyVals = getKeys(keysToFetch, area);
+    if (maybeKeyVals.hasValue()) {
+      storedKeyVals = std::move(maybeKeyVals.value());
+    } else {
+      // Same as missing keys. Conflicting versions if any get resolved once
+      // we hear back from KvStore.
+      LOG(ERROR) << "Failed to fetch " << keysToFetch.size()
+                 << " keys from KvStore. Error: " << maybeKeyVals.error();
+    }
+  }
+
+  for (auto const& kv : keyVals) {
+    folly::Optional<thrift::Value> storedValue;
+    auto it = storedKeyVals.find(kv.first);
+    if (it != storedKeyVals.end()) {
+      storedValue = std::move(it->second);
+    }
+    updatePersistedKey(kv.first, kv.second, ttl, area, std::move(storedValue));
+  }
+
+  // Advertise all changed keys together
+  advertisePendingKeys();
+  advertiseTtlUpdates();
+}
+
+void
+KvStoreClient::updatePersistedKey(
+    std::string const& key,
+    std::string const& value,
+    std::chrono::milliseconds ttl,
+    std::string const& area,
+    folly::Optional<thrift::Value> storedValue) {
   auto& persistedKeyVals = persistedKeyVals_[area];
-  const auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  const auto& keyTtlRefreshes = keyTtlRefreshes_[area];
   auto& keysToAdvertise = keysToAdvertise_[area];
   // Look it up in the existing
   auto keyIt = persistedKeyVals.find(key);
@@ -273,21 +415,19 @@ KvStoreClient::persistKey(
       folly::none /* hash */);
   CHECK(thriftValue.value);
 
-  // Retrieve the existing value for the key. If key is persisted before then
-  // it is the one we have cached locally else we need to fetch it from KvStore
+  // Use the value we have cached locally if key is persisted before else the
+  // latest one from KvStore
   if (keyIt == persistedKeyVals.end()) {
-    // Get latest value from KvStore
-    auto maybeValue = getKey(key, area);
-    if (maybeValue.hasValue()) {
-      thriftValue = maybeValue.value();
+    if (storedValue.hasValue()) {
+      thriftValue = std::move(storedValue.value());
       // TTL update pub is never saved in kvstore
       DCHECK(thriftValue.value);
     }
   } else {
     thriftValue = keyIt->second;
-    auto ttlIt = keyTtlBackoffs.find(key);
-    if (ttlIt != keyTtlBackoffs.end()) {
-      thriftValue.ttlVersion = ttlIt->second.first.ttlVersion;
+    auto ttlIt = keyTtlRefreshes.find(key);
+    if (ttlIt != keyTtlRefreshes.end()) {
+      thriftValue.ttlVersion = ttlIt->second.value.ttlVersion;
     }
   }
 
@@ -327,9 +467,7 @@ KvStoreClient::persistKey(
   if (valueChange) {
     keysToAdvertise.insert(key);
   }
-
-  // Best effort to advertise pending keys
-  advertisePendingKeys();
+  updateKeySubscription(key);
 
   scheduleTtlUpdates(
       key,
@@ -389,6 +527,7 @@ KvStoreClient::setKey(
       ttl.count(),
       false /* advertiseImmediately */,
       area);
+  advertiseTtlUpdates();
 
   return ret;
 }
@@ -412,6 +551,7 @@ KvStoreClient::setKey(
       thriftValue.ttl,
       false /* advertiseImmediately */,
       area);
+  advertiseTtlUpdates();
 
   return ret;
 }
@@ -426,10 +566,11 @@ KvStoreClient::scheduleTtlUpdates(
     std::string const& area /* thrift::KvStore_constants::kDefaultArea() */) {
   // infinite TTL does not need update
 
-  auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  auto& keyTtlRefreshes = keyTtlRefreshes_[area];
   if (ttl == Constants::kTtlInfinity) {
     // in case ttl is finite before
-    keyTtlBackoffs.erase(key);
+    keyTtlRefreshes.erase(key);
+    updateKeySubscription(key);
     return;
   }
 
@@ -444,21 +585,29 @@ KvStoreClient::scheduleTtlUpdates(
   ttlThriftValue.value = folly::none;
   CHECK(not ttlThriftValue.value.hasValue());
 
-  // renew before Ttl expires about every ttl/3, i.e., try twice
-  // use ExponentialBackoff to track remaining time
-  keyTtlBackoffs[key] = std::make_pair(
-      ttlThriftValue,
-      ExponentialBackoff<std::chrono::milliseconds>(
-          std::chrono::milliseconds(ttl / 4),
-          std::chrono::milliseconds(ttl / 4 + 1)));
-
-  // Delay first ttl advertisement by (ttl / 4). We have just advertised key or
-  // update and would like to avoid sending unncessary immediate ttl update
-  if (not advertiseImmediately) {
-    keyTtlBackoffs.at(key).second.reportError();
+  // renew before Ttl expires about every ttl/4. All keys due in same tick of
+  // the wheel get advertised together.
+  auto& ttlRefresh = keyTtlRefreshes[key];
+  ttlRefresh.value = std::move(ttlThriftValue);
+  if (not ttlRefresh.timeout) {
+    ttlRefresh.timeout = TimerWheel::Timeout::make(
+        ttlTimerWheel_.get(), [this, area, key]() noexcept {
+          keyTtlsDue_[area].insert(key);
+          if (not ttlTimer_->isScheduled()) {
+            ttlTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+          }
+        });
   }
-
-  advertiseTtlUpdates();
+  ttlRefresh.timeout->scheduleTimeout(
+      std::chrono::milliseconds(ttl / 4), true /* periodic */);
+
+  // First ttl advertisement is delayed by (ttl / 4) by default. We have just
+  // advertised key or update and would like to avoid sending unncessary
+  // immediate ttl update
+  if (advertiseImmediately) {
+    keyTtlsDue_[area].insert(key);
+  }
+  updateKeySubscription(key);
 }
 
 void
@@ -469,8 +618,9 @@ KvStoreClient::unsetKey(
 
   persistedKeyVals_[area].erase(key);
   backoffs_.erase(key);
-  keyTtlBackoffs_[area].erase(key);
+  keyTtlRefreshes_[area].erase(key);
   keysToAdvertise_[area].erase(key);
+  updateKeySubscription(key);
 }
 
 void
@@ -507,6 +657,50 @@ KvStoreClient::clearKey(
   }
 }
 
+void
+KvStoreClient::clearKeys(
+    std::unordered_map<std::string, std::string> const& keyVals,
+    std::chrono::milliseconds ttl,
+    std::string const& area /* thrift::KvStore_constants::kDefaultArea() */) {
+  VLOG(1) << "KvStoreClient: clear keys called for " << keyVals.size()
+          << " keys";
+  if (keyVals.empty()) {
+    return;
+  }
+
+  // erase keys
+  std::vector<std::string> keys;
+  keys.reserve(keyVals.size());
+  for (auto const& kv : keyVals) {
+    unsetKey(kv.first, area);
+    keys.push_back(kv.first);
+  }
+
+  // only keys existing in KvStore need to be overwritten
+  auto maybeKeyVals = getKeys(keys, area);
+  if (maybeKeyVals.hasError()) {
+    LOG(ERROR) << "Failed to fetch " << keys.size()
+               << " keys from KvStore. Error: " << maybeKeyVals.error();
+    return;
+  }
+  auto& storedKeyVals = maybeKeyVals.value();
+  for (auto& kv : storedKeyVals) {
+    // overwrite all values, increment version, reset value to given one
+    auto& thriftValue = kv.second;
+    thriftValue.originatorId = nodeId_;
+    thriftValue.version++;
+    thriftValue.ttl = ttl.count();
+    thriftValue.ttlVersion = 0;
+    thriftValue.value = keyVals.at(kv.first);
+  }
+
+  // Advertise to KvStore
+  const auto ret = setKeysHelper(std::move(storedKeyVals), area);
+  if (!ret) {
+    LOG(ERROR) << "Error sending SET_KEY request to KvStore: " << ret.error();
+  }
+}
+
 folly::Expected<thrift::Value, fbzmq::Error>
 KvStoreClient::getKey(
     std::string const& key,
@@ -514,6 +708,25 @@ KvStoreClient::getKey(
   VLOG(3) << "KvStoreClient: getKey called for key " << key << ", area "
           << area;
 
+  auto maybeKeyVals = getKeys({key}, area);
+  if (maybeKeyVals.hasError()) {
+    return folly::makeUnexpected(maybeKeyVals.error());
+  }
+
+  auto it = maybeKeyVals->find(key);
+  if (it == maybeKeyVals->end()) {
+    return folly::makeUnexpected(fbzmq::Error(0, "key not found"));
+  }
+  return std::move(it->second);
+}
+
+folly::Expected<std::unordered_map<std::string, thrift::Value>, fbzmq::Error>
+KvStoreClient::getKeys(
+    std::vector<std::string> const& keys,
+    std::string const& area /* thrift::KvStore_constants::kDefaultArea() */) {
+  VLOG(3) << "KvStoreClient: getKeys called for " << keys.size()
+          << " keys, area " << area;
+
   // use thrift-port talking to kvstore
   if (useThriftClient_) {
     // init openrCtrlClient to talk to KvStore
@@ -526,26 +739,20 @@ KvStoreClient::getKey(
 
     thrift::Publication pub;
     try {
-      openrCtrlClient_->sync_getKvStoreKeyVals(
-          pub, std::vector<std::string>{key});
+      openrCtrlClient_->sync_getKvStoreKeyVals(pub, keys);
     } catch (const std::exception& ex) {
       LOG(ERROR) << "Failed to dump key-val from KvStore. Exception: "
                  << folly::exceptionStr(ex);
       openrCtrlClient_ = nullptr;
       return folly::makeUnexpected(fbzmq::Error(0, ex.what()));
     }
-
-    // check key existence
-    if (pub.keyVals.find(key) == pub.keyVals.end()) {
-      return folly::makeUnexpected(fbzmq::Error(0, "can't find key"));
-    }
-    return pub.keyVals.at(key);
+    return std::move(pub.keyVals);
   }
 
   // Prepare request
   thrift::KvStoreRequest request;
   thrift::KeyGetParams params;
-  params.keys.push_back(key);
+  params.keys = keys;
 
   request.cmd = thrift::Command::KEY_GET;
   request.keyGetParams = params;
@@ -564,12 +771,7 @@ KvStoreClient::getKey(
   }
   auto& publication = *maybePublication;
   VLOG(3) << "Received " << publication.keyVals.size() << " key-vals.";
-
-  auto it = publication.keyVals.find(key);
-  if (it == publication.keyVals.end()) {
-    return folly::makeUnexpected(fbzmq::Error(0, "key not found"));
-  }
-  return it->second;
+  return std::move(publication.keyVals);
 }
 
 folly::Expected<thrift::Publication, fbzmq::Error>
@@ -818,6 +1020,7 @@ KvStoreClient::subscribeKey(
   VLOG(3) << "KvStoreClient: subscribeKey called for key " << key;
   CHECK(bool(callback)) << "Callback function for " << key << " is empty";
   keyCallbacks_[key] = std::move(callback);
+  updateKeySubscription(key);
 
   if (fetchKeyValue) {
     auto maybeValue = getKey(key, area);
@@ -831,6 +1034,21 @@ KvStoreClient::subscribeKey(
 void
 KvStoreClient::subscribeKeyFilter(
     KvStoreFilters kvFilters, KeyCallback callback) {
+  unSubscribeKeyFilter();
+
+  // subscribe to literal part of every key prefix, originators get filtered
+  // on our side
+  const auto keyPrefixes = kvFilters.getKeyPrefixes();
+  if (keyPrefixes.empty()) {
+    keyPrefixFilterTopics_.emplace_back("");
+  }
+  for (auto const& keyPrefix : keyPrefixes) {
+    keyPrefixFilterTopics_.emplace_back(getLiteralPrefix(keyPrefix));
+  }
+  for (auto const& topic : keyPrefixFilterTopics_) {
+    setSubscription(topic, true);
+  }
+
   keyPrefixFilter_ = std::move(kvFilters);
   keyPrefixFilterCallback_ = std::move(callback);
   return;
@@ -838,11 +1056,44 @@ KvStoreClient::subscribeKeyFilter(
 
 void
 KvStoreClient::unSubscribeKeyFilter() {
+  for (auto const& topic : keyPrefixFilterTopics_) {
+    setSubscription(topic, false);
+  }
+  keyPrefixFilterTopics_.clear();
   keyPrefixFilterCallback_ = nullptr;
   keyPrefixFilter_ = KvStoreFilters({}, {});
   return;
 }
 
+KvStoreClient::KeyPrefixSubscription
+KvStoreClient::subscribeKeyPrefix(
+    std::string const& keyPrefix, KeyCallback callback) {
+  VLOG(3) << "KvStoreClient: subscribeKeyPrefix called for prefix "
+          << keyPrefix;
+  CHECK(bool(callback)) << "Callback function for " << keyPrefix
+                        << " is empty";
+  // NOTE: ZMQ counts subscriptions of same topic
+  setSubscription(keyPrefix, true);
+  const auto subscription = nextKeyPrefixSubscription_++;
+  keyPrefixCallbacks_.emplace(
+      subscription, std::make_pair(keyPrefix, std::move(callback)));
+  return subscription;
+}
+
+void
+KvStoreClient::unsubscribeKeyPrefix(KeyPrefixSubscription subscription) {
+  auto it = keyPrefixCallbacks_.find(subscription);
+  if (it == keyPrefixCallbacks_.end()) {
+    LOG(WARNING) << "UnsubscribeKeyPrefix called for non-existing "
+                 << "subscription " << subscription;
+    return;
+  }
+  VLOG(3) << "KvStoreClient: unsubscribeKeyPrefix called for prefix "
+          << it->second.first;
+  setSubscription(it->second.first, false);
+  keyPrefixCallbacks_.erase(it);
+}
+
 void
 KvStoreClient::unsubscribeKey(std::string const& key) {
   VLOG(3) << "KvStoreClient: unsubscribeKey called for key " << key;
@@ -850,10 +1101,15 @@ KvStoreClient::unsubscribeKey(std::string const& key) {
   if (keyCallbacks_.erase(key) == 0) {
     LOG(WARNING) << "UnsubscribeKey called for non-existing key" << key;
   }
+  updateKeySubscription(key);
 }
 
 void
 KvStoreClient::setKvCallback(KeyCallback callback) {
+  // callback for every key needs every publication
+  if (bool(callback) != bool(kvCallback_)) {
+    setSubscription("", bool(callback));
+  }
   kvCallback_ = std::move(callback);
 }
 
@@ -953,6 +1209,12 @@ KvStoreClient::processExpiredKeys(thrift::Publication const& publication) {
     if (kvCallback_) {
       kvCallback_(key, folly::none);
     }
+    /* callbacks registered for key prefix */
+    for (auto& kv : keyPrefixCallbacks_) {
+      if (folly::StringPiece(key).startsWith(kv.second.first)) {
+        kv.second.second(key, folly::none);
+      }
+    }
     /* key specific registered callback */
     auto cb = keyCallbacks_.find(key);
     if (cb != keyCallbacks_.end()) {
@@ -971,7 +1233,7 @@ KvStoreClient::processPublication(thrift::Publication const& publication) {
   }
 
   auto& persistedKeyVals = persistedKeyVals_[area];
-  auto& keyTtlBackoffs = keyTtlBackoffs_[area];
+  auto& keyTtlRefreshes = keyTtlRefreshes_[area];
   auto& keysToAdvertise = keysToAdvertise_[area];
 
   for (auto const& kv : publication.keyVals) {
@@ -991,16 +1253,17 @@ KvStoreClient::processPublication(thrift::Publication const& publication) {
     auto it = persistedKeyVals.find(key);
     auto cb = keyCallbacks_.find(key);
     // set key w/ finite TTL
-    auto sk = keyTtlBackoffs.find(key);
+    auto sk = keyTtlRefreshes.find(key);
 
     // key set but not persisted
-    if (sk != keyTtlBackoffs.end() and it == persistedKeyVals.end()) {
-      auto& setValue = sk->second.first;
+    if (sk != keyTtlRefreshes.end() and it == persistedKeyVals.end()) {
+      auto& setValue = sk->second.value;
       if (rcvdValue.version > setValue.version or
           (rcvdValue.version == setValue.version and
            rcvdValue.originatorId > setValue.originatorId)) {
         // key lost, cancel TTL update
-        keyTtlBackoffs.erase(sk);
+        keyTtlRefreshes.erase(sk);
+        updateKeySubscription(key);
       } else if (
           rcvdValue.version == setValue.version and
           rcvdValue.originatorId == setValue.originatorId and
@@ -1008,8 +1271,8 @@ KvStoreClient::processPublication(thrift::Publication const& publication) {
         // If version, value and originatorId is same then we should look up
         // ttlVersion and update local value if rcvd ttlVersion is higher
         // NOTE: We don't need to advertise the value back
-        if (sk != keyTtlBackoffs.end() and
-            sk->second.first.ttlVersion < rcvdValue.ttlVersion) {
+        if (sk != keyTtlRefreshes.end() and
+            sk->second.value.ttlVersion < rcvdValue.ttlVersion) {
           VLOG(1) << "Bumping TTL version for (key, version, originatorId) "
                   << folly::sformat(
                          "({}, {}, {})",
@@ -1025,7 +1288,13 @@ KvStoreClient::processPublication(thrift::Publication const& publication) {
 
     if (it == persistedKeyVals.end()) {
       // We need to alert callback if a key is not persisted and we
-      // received a change notification for it.
+      // received a change notification for it. Prefix callbacks go first so
+      // that key callback sees state they maintain already updated.
+      for (auto& kv : keyPrefixCallbacks_) {
+        if (folly::StringPiece(key).startsWith(kv.second.first)) {
+          kv.second.second(key, rcvdValue);
+        }
+      }
       if (cb != keyCallbacks_.end()) {
         (cb->second)(key, rcvdValue);
       }
@@ -1073,8 +1342,8 @@ KvStoreClient::processPublication(thrift::Publication const& publication) {
     }
 
     // copy ttlVersion from ttl backoff map
-    if (sk != keyTtlBackoffs.end()) {
-      currentValue.ttlVersion = sk->second.first.ttlVersion;
+    if (sk != keyTtlRefreshes.end()) {
+      currentValue.ttlVersion = sk->second.value.ttlVersion;
     }
 
     // update local ttlVersion if received higher ttlVersion.
@@ -1082,8 +1351,8 @@ KvStoreClient::processPublication(thrift::Publication const& publication) {
     // update to latest ttlVersion works fine
     if (currentValue.ttlVersion < rcvdValue.ttlVersion) {
       currentValue.ttlVersion = rcvdValue.ttlVersion;
-      if (sk != keyTtlBackoffs.end()) {
-        sk->second.first.ttlVersion = rcvdValue.ttlVersion;
+      if (sk != keyTtlRefreshes.end()) {
+        sk->second.value.ttlVersion = rcvdValue.ttlVersion;
       }
     }
 
@@ -1170,31 +1439,26 @@ KvStoreClient::advertisePendingKeys() {
 
 void
 KvStoreClient::advertiseTtlUpdates() {
-  // Build set of keys to advertise ttl updates
-  auto timeout = Constants::kMaxTtlUpdateInterval;
-
-  // advertise TTL updates for each area
-  for (auto& keyTtlBackoffsEntry : keyTtlBackoffs_) {
-    auto& keyTtlBackoffs = keyTtlBackoffsEntry.second;
-    auto& persistedKeyVals = persistedKeyVals_[keyTtlBackoffsEntry.first];
-    auto& area = keyTtlBackoffsEntry.first;
+  // advertise TTL updates due for each area, in single request per area
+  for (auto& keyTtlsDueEntry : keyTtlsDue_) {
+    auto& area = keyTtlsDueEntry.first;
+    auto& keyTtlsDue = keyTtlsDueEntry.second;
+    if (keyTtlsDue.empty()) {
+      continue;
+    }
+    auto& keyTtlRefreshes = keyTtlRefreshes_[area];
+    auto& persistedKeyVals = persistedKeyVals_[area];
 
     std::unordered_map<std::string, thrift::Value> keyVals;
 
-    for (auto& kv : keyTtlBackoffs) {
-      const auto& key = kv.first;
-      auto& backoff = kv.second.second;
-      if (not backoff.canTryNow()) {
-        VLOG(2) << "Skipping key: " << key << ", area: " << area;
-        timeout = std::min(timeout, backoff.getTimeRemainingUntilRetry());
+    for (auto const& key : keyTtlsDue) {
+      // key may have been unset or got infinite ttl since
+      auto ttlIt = keyTtlRefreshes.find(key);
+      if (ttlIt == keyTtlRefreshes.end()) {
         continue;
       }
 
-      // Apply backoff
-      backoff.reportError();
-      timeout = std::min(timeout, backoff.getTimeRemainingUntilRetry());
-
-      auto& thriftValue = kv.second.first;
+      auto& thriftValue = ttlIt->second.value;
       const auto it = persistedKeyVals.find(key);
       if (it != persistedKeyVals.end()) {
         // we may have got a newer vesion for persisted key
@@ -1219,8 +1483,9 @@ KvStoreClient::advertiseTtlUpdates() {
                  area);
       keyVals.emplace(key, thriftValue);
     }
+    keyTtlsDue.clear();
 
-    // Advertise to KvStore
+    // Advertise to KvStore. Failed updates are retried with next refresh.
     if (not keyVals.empty()) {
       const auto ret = setKeysHelper(std::move(keyVals), area);
       if (not ret) {
@@ -1229,10 +1494,6 @@ KvStoreClient::advertiseTtlUpdates() {
       }
     }
   }
-
-  // Schedule next-timeout for processing/clearing backoffs
-  VLOG(2) << "Scheduling ttl timer after " << timeout.count() << "ms.";
-  ttlTimer_->scheduleTimeout(timeout);
 }
 
 folly::Expected<folly::Unit, fbzmq::Error>
@@ -1244,6 +1505,23 @@ KvStoreClient::setKeysHelper(
     return folly::Unit();
   }
 
+  // Split large sets so that no single request/publication grows unbounded
+  if (keyVals.size() > Constants::kMaxKeysPerKeySet) {
+    std::unordered_map<std::string, thrift::Value> chunk;
+    for (auto& kv : keyVals) {
+      chunk.emplace(kv.first, std::move(kv.second));
+      if (chunk.size() < Constants::kMaxKeysPerKeySet) {
+        continue;
+      }
+      auto ret = setKeysHelper(std::move(chunk), area);
+      if (ret.hasError()) {
+        return ret;
+      }
+      chunk.clear();
+    }
+    return setKeysHelper(std::move(chunk), area);
+  }
+
   for (auto const& kv : keyVals) {
     VLOG(3) << "Advertising key: " << kv.first
             << ", version: " << kv.second.version
@@ -8,8 +8,10 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/Function.h>
 #include <folly/Optional.h>
@@ -23,6 +25,7 @@
 #include <openr/common/Constants.h>
 #include <openr/common/ExponentialBackoff.h>
 #include <openr/common/OpenrClient.h>
+#include <openr/common/TimerWheel.h>
 #include <openr/if/gen-cpp2/KvStore_constants.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
 #include <openr/kvstore/KvStore.h>
@@ -47,6 +50,9 @@ class KvStoreClient {
   using KeyCallback = folly::Function<void(
       std::string const&, folly::Optional<thrift::Value>) noexcept>;
 
+  // Handle identifying key prefix subscription
+  using KeyPrefixSubscription = uint64_t;
+
   /**
    * Creates and initializes all necessary sockets for communicating with
    * KvStore.
@@ -88,6 +94,17 @@ class KvStoreClient {
       std::chrono::milliseconds ttl = Constants::kTtlInfInterval,
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
+  /**
+   * Bulk flavour of `persistKey`. Latest versions of keys not yet persisted
+   * are fetched from KvStore in single request and all changed keys are
+   * advertised together instead of one round-trip per key.
+   */
+  void persistKeys(
+      std::unordered_map<std::string /* key */, std::string /* value */> const&
+          keyVals,
+      std::chrono::milliseconds ttl = Constants::kTtlInfInterval,
+      std::string const& area = thrift::KvStore_constants::kDefaultArea());
+
   /**
    * Advertise the key-value into KvStore with specified version. If version is
    * not specified than the one greater than the latest known will be used.
@@ -130,6 +147,16 @@ class KvStoreClient {
       std::chrono::milliseconds ttl = Constants::kTtlInfInterval,
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
+  /**
+   * Bulk flavour of `clearKey`. Keys are cleared with their respective values
+   * and current versions of all keys are fetched in single request.
+   */
+  void clearKeys(
+      std::unordered_map<std::string /* key */, std::string /* value */> const&
+          keyVals,
+      std::chrono::milliseconds ttl = Constants::kTtlInfInterval,
+      std::string const& area = thrift::KvStore_constants::kDefaultArea());
+
   /**
    * Get key from KvStore. It gets from local snapshot KeyVals of the kvstore.
    * Return error type:
@@ -140,6 +167,19 @@ class KvStoreClient {
       std::string const& key,
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
+  /**
+   * Get multiple keys from KvStore in single request. Keys not present in
+   * KvStore are omitted from returned map.
+   * Return error type:
+   *    1. zmq socket error
+   */
+  folly::Expected<
+      std::unordered_map<std::string /* key */, thrift::Value /* value */>,
+      fbzmq::Error>
+  getKeys(
+      std::vector<std::string> const& keys,
+      std::string const& area = thrift::KvStore_constants::kDefaultArea());
+
   /**
    * Dump the entries of my KV store whose keys match the given prefix
    * If the prefix is empty string, the full KV store is dumped
@@ -279,6 +319,17 @@ class KvStoreClient {
   void subscribeKeyFilter(KvStoreFilters kvFilters, KeyCallback callback);
   void unSubscribeKeyFilter();
 
+  /**
+   * APIs to subscribe/unsubscribe to value change of all keys starting with
+   * given literal prefix. Any number of subscriptions can be made, to same
+   * prefix as well, each with its own callback. Subscription is identified
+   * by returned handle. Callbacks are invoked in order of subscription, with
+   * `folly::none` on key expiry.
+   */
+  KeyPrefixSubscription subscribeKeyPrefix(
+      std::string const& keyPrefix, KeyCallback callback);
+  void unsubscribeKeyPrefix(KeyPrefixSubscription subscription);
+
   /**
    * APIs to send Add/Del peer command to KvStore.
    * Return error type:
@@ -312,6 +363,24 @@ class KvStoreClient {
   }
 
  private:
+  /**
+   * Receive publication from KvStore SUB socket, either full publication or
+   * topic batch from filtered pub socket
+   */
+  folly::Expected<thrift::Publication, fbzmq::Error> recvPublication();
+
+  /**
+   * (Un)subscribe to ZMQ topic on filtered pub socket. No-op if we are
+   * subscribed to everything.
+   */
+  void setSubscription(std::string const& topic, bool subscribe);
+
+  /**
+   * Subscribe to publications of key if we have any interest in it (callback,
+   * persisted or TTL refreshed key), unsubscribe otherwise
+   */
+  void updateKeySubscription(std::string const& key);
+
   /**
    * Process timeout is called when timeout expires.
    */
@@ -345,9 +414,22 @@ class KvStoreClient {
       std::chrono::milliseconds ttl = Constants::kTtlInfInterval,
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
+  /**
+   * Update cached value of persisted key and schedule its advertisement and
+   * TTL updates without sending anything yet. `storedValue` is latest value
+   * in KvStore, used only if key was not persisted before.
+   */
+  void updatePersistedKey(
+      std::string const& key,
+      std::string const& value,
+      std::chrono::milliseconds ttl,
+      std::string const& area,
+      folly::Optional<thrift::Value> storedValue);
+
   /**
    * Utility function to SET keys in KvStore. Will throw an exception if things
-   * goes wrong.
+   * goes wrong. Large sets are split in chunks of
+   * `Constants::kMaxKeysPerKeySet` keys.
    */
   folly::Expected<folly::Unit, fbzmq::Error> setKeysHelper(
       std::unordered_map<std::string, thrift::Value> keyVals,
@@ -371,7 +453,8 @@ class KvStoreClient {
   void advertisePendingKeys();
 
   /**
-   * Helper function to schedule TTL update advertisement
+   * Helper function to schedule periodic TTL update advertisement, every
+   * ttl/4. Caller is expected to invoke `advertiseTtlUpdates` afterwards.
    */
   void scheduleTtlUpdates(
       std::string const& key,
@@ -382,7 +465,7 @@ class KvStoreClient {
       std::string const& area = thrift::KvStore_constants::kDefaultArea());
 
   /**
-   * Helper function to advertise TTL update
+   * Helper function to advertise TTL updates of all keys due
    */
   void advertiseTtlUpdates();
 
@@ -445,6 +528,10 @@ class KvStoreClient {
   const std::string kvStoreLocalCmdUrl_{""};
   const std::string kvStoreLocalPubUrl_{""};
 
+  // Receive only publications of keys we are interested in from KvStore's
+  // filtered pub socket, instead of every publication
+  const bool useFilteredPub_{false};
+
   // periodic timer to check existence of persist key in kv store
   folly::Optional<std::chrono::milliseconds> checkPersistKeyPeriod_{
       folly::none};
@@ -480,21 +567,44 @@ class KvStoreClient {
   // callback for updates from keys filtered with provided filter
   KeyCallback keyPrefixFilterCallback_{nullptr};
 
+  // Key prefix subscriptions to their prefix and callback function
+  std::map<
+      KeyPrefixSubscription,
+      std::pair<std::string /* prefix */, KeyCallback>>
+      keyPrefixCallbacks_;
+
+  // Handle of next key prefix subscription
+  KeyPrefixSubscription nextKeyPrefixSubscription_{0};
+
   // backoff associated with each key for re-advertisements
   std::unordered_map<
       std::string /* key */,
       ExponentialBackoff<std::chrono::milliseconds>>
       backoffs_;
 
-  // backoff associated with each key for freshing TTL
+  // Timer wheel driving TTL refresh of all keys. Refresh cost scales with
+  // number of keys due rather than number of keys with finite TTL.
+  std::unique_ptr<TimerWheel> ttlTimerWheel_;
+
+  // TTL refresh state of a key: value (without payload) advertised with
+  // bumped ttlVersion and periodic timeout marking key due for refresh
+  struct TtlRefresh {
+    thrift::Value value;
+    std::unique_ptr<TimerWheel::Timeout> timeout;
+  };
+
+  // TTL refresh state of each key with finite TTL
   std::unordered_map<
       std::string /* area */,
-      std::unordered_map<
-          std::string /* key */,
-          std::pair<
-              thrift::Value /* value */,
-              ExponentialBackoff<std::chrono::milliseconds>>>>
-      keyTtlBackoffs_;
+      std::unordered_map<std::string /* key */, TtlRefresh>>
+      keyTtlRefreshes_;
+
+  // Keys whose TTL refresh is due, advertised together by next
+  // `advertiseTtlUpdates`
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_set<std::string /* key */>>
+      keyTtlsDue_;
 
   // Set of local keys to be re-advertised.
   std::unordered_map<
@@ -508,11 +618,17 @@ class KvStoreClient {
   // Timer to advertised pending key-vals
   std::unique_ptr<fbzmq::ZmqTimeout> advertiseKeyValsTimer_;
 
-  // Timer to advertise ttl updates for key-vals
+  // Timer to advertise ttl updates of keys due, in single batch per area
   std::unique_ptr<fbzmq::ZmqTimeout> ttlTimer_;
 
   // prefix key filter to apply for key updates
   KvStoreFilters keyPrefixFilter_{{}, {}};
+
+  // Topics subscribed to for key prefix filter
+  std::vector<std::string> keyPrefixFilterTopics_;
+
+  // Keys subscribed to on filtered pub socket
+  std::unordered_set<std::string> subscribedKeys_;
 };
 
 } // namespace openr
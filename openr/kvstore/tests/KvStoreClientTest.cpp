@@ -723,6 +723,248 @@ TEST(KvStoreClient, PersistKeyTest) {
   store->stop();
 }
 
+/**
+ * Verify bulk persistKeys/clearKeys
+ * - keys already in KvStore are advertised with version bumped from existing
+ * - more keys than fit in single KEY_SET request are all advertised
+ * - cleared keys get their given values with version bumped
+ */
+TEST(KvStoreClient, PersistKeysBulkTest) {
+  fbzmq::Context context;
+  const std::string nodeId{"test_store"};
+  const size_t numKeys = Constants::kMaxKeysPerKeySet * 2 + 10;
+
+  auto store = std::make_shared<KvStoreWrapper>(
+      context,
+      nodeId,
+      std::chrono::seconds(60) /* db sync interval */,
+      std::chrono::seconds(600) /* counter submit interval */,
+      std::unordered_map<std::string, thrift::PeerSpec>{});
+  store->run();
+
+  // key advertised by someone else before
+  thrift::Value existingVal{apache::thrift::FRAGILE,
+                            5,
+                            "other_node",
+                            "other_value",
+                            Constants::kTtlInfinity,
+                            0 /* ttl version */,
+                            0 /* hash */};
+  store->setKey("key-0", existingVal);
+
+  fbzmq::ZmqEventLoop evl;
+  auto client1 = std::make_shared<KvStoreClient>(
+      context, &evl, nodeId, store->localCmdUrl, store->localPubUrl);
+
+  std::unordered_map<std::string, std::string> keyVals;
+  for (size_t i = 0; i < numKeys; ++i) {
+    keyVals.emplace(folly::sformat("key-{}", i), folly::sformat("val-{}", i));
+  }
+
+  evl.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    client1->persistKeys(keyVals);
+  });
+
+  evl.scheduleTimeout(std::chrono::milliseconds(100), [&]() noexcept {
+    auto dump = store->dumpAll();
+    EXPECT_EQ(numKeys, dump.size());
+    for (const auto& kv : keyVals) {
+      ASSERT_EQ(1, dump.count(kv.first));
+      EXPECT_EQ(kv.second, dump.at(kv.first).value);
+      EXPECT_EQ(nodeId, dump.at(kv.first).originatorId);
+    }
+    EXPECT_EQ(6, dump.at("key-0").version);
+    EXPECT_EQ(1, dump.at("key-1").version);
+
+    // persisting same values again is no-op
+    client1->persistKeys(keyVals);
+    client1->clearKeys({{"key-0", "cleared-0"},
+                        {"key-1", "cleared-1"},
+                        {"non-existing-key", "cleared"}});
+  });
+
+  evl.scheduleTimeout(std::chrono::milliseconds(200), [&]() noexcept {
+    auto dump = store->dumpAll();
+    EXPECT_EQ(numKeys, dump.size());
+    EXPECT_EQ("cleared-0", dump.at("key-0").value);
+    EXPECT_EQ(7, dump.at("key-0").version);
+    EXPECT_EQ("cleared-1", dump.at("key-1").value);
+    EXPECT_EQ(2, dump.at("key-1").version);
+    EXPECT_EQ("val-2", dump.at("key-2").value);
+    EXPECT_EQ(1, dump.at("key-2").version);
+    evl.stop();
+  });
+
+  std::thread evlThread([&]() { evl.run(); });
+  evl.waitUntilRunning();
+  evl.waitUntilStopped();
+  evlThread.join();
+
+  store->stop();
+}
+
+/**
+ * Verify TTL refresh of many keys with finite TTL
+ * - keys persisted together outlive their TTL
+ * - unset key stops being refreshed and expires
+ */
+TEST(KvStoreClient, TtlRefreshManyKeysTest) {
+  fbzmq::Context context;
+  const std::string nodeId{"test_store"};
+  const size_t numKeys = 100;
+
+  auto store = std::make_shared<KvStoreWrapper>(
+      context,
+      nodeId,
+      std::chrono::seconds(60) /* db sync interval */,
+      std::chrono::seconds(600) /* counter submit interval */,
+      std::unordered_map<std::string, thrift::PeerSpec>{});
+  store->run();
+
+  fbzmq::ZmqEventLoop evl;
+  auto client1 = std::make_shared<KvStoreClient>(
+      context, &evl, nodeId, store->localCmdUrl, store->localPubUrl);
+
+  std::unordered_map<std::string, std::string> keyVals;
+  for (size_t i = 0; i < numKeys; ++i) {
+    keyVals.emplace(folly::sformat("key-{}", i), folly::sformat("val-{}", i));
+  }
+
+  evl.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    client1->persistKeys(keyVals, kTtl);
+  });
+
+  evl.scheduleTimeout(kTtl / 2, [&]() noexcept { client1->unsetKey("key-0"); });
+
+  evl.scheduleTimeout(kTtl * 5 / 2, [&]() noexcept {
+    auto dump = store->dumpAll();
+    EXPECT_EQ(numKeys - 1, dump.size());
+    EXPECT_EQ(0, dump.count("key-0"));
+    for (const auto& kv : dump) {
+      EXPECT_EQ(keyVals.at(kv.first), kv.second.value);
+      EXPECT_EQ(1, kv.second.version);
+      EXPECT_LT(0, kv.second.ttlVersion);
+    }
+    evl.stop();
+  });
+
+  std::thread evlThread([&]() { evl.run(); });
+  evl.waitUntilRunning();
+  evl.waitUntilStopped();
+  evlThread.join();
+
+  store->stop();
+}
+
+/**
+ * Verify publications on filtered pub socket
+ * - subscriber gets only keys matching its topics
+ * - keys are batched per longest subscribed topic, each key is sent once
+ * - client callbacks still fire for subscribed key and key prefix filter
+ */
+TEST(KvStoreClient, FilteredPublicationTest) {
+  fbzmq::Context context;
+  const std::string nodeId{"test_store"};
+  apache::thrift::CompactSerializer serializer;
+
+  auto store = std::make_shared<KvStoreWrapper>(
+      context,
+      nodeId,
+      std::chrono::seconds(60) /* db sync interval */,
+      std::chrono::seconds(600) /* counter submit interval */,
+      std::unordered_map<std::string, thrift::PeerSpec>{});
+  store->run();
+
+  const auto filteredPubUrl = KvStore::getFilteredPubUrl(store->localPubUrl);
+  ASSERT_TRUE(filteredPubUrl.hasValue());
+  EXPECT_FALSE(KvStore::getFilteredPubUrl("tcp://[::1]:60001").hasValue());
+
+  fbzmq::Socket<ZMQ_SUB, fbzmq::ZMQ_CLIENT> subSock(context);
+  ASSERT_TRUE(subSock.connect(fbzmq::SocketUrl{*filteredPubUrl}).hasValue());
+  ASSERT_TRUE(subSock.setSockOpt(ZMQ_SUBSCRIBE, "key1", 4).hasValue());
+
+  fbzmq::ZmqEventLoop evl;
+  auto client1 = std::make_shared<KvStoreClient>(
+      context, &evl, nodeId, store->localCmdUrl, store->localPubUrl);
+
+  std::vector<std::string> keyUpdates;
+  std::vector<std::string> filterUpdates;
+  evl.runInEventLoop([&]() noexcept {
+    client1->subscribeKey(
+        "key1",
+        [&](std::string const& key, folly::Optional<thrift::Value>) noexcept {
+          keyUpdates.push_back(key);
+        });
+    client1->subscribeKeyFilter(
+        KvStoreFilters({"prefix:"}, {}),
+        [&](std::string const& key, folly::Optional<thrift::Value>) noexcept {
+          filterUpdates.push_back(key);
+        });
+  });
+  std::thread evlThread([&]() { evl.run(); });
+  evl.waitUntilRunning();
+
+  // let subscriptions propagate
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  auto const thriftVal = createThriftValue(
+      1, "node1", std::string("value"), Constants::kTtlInfinity);
+  store->setKey("key1", thriftVal);
+  store->setKey("key2", thriftVal);
+  store->setKey("prefix:1", thriftVal);
+
+  auto const recvBatch = [&](std::string const& expectedTopic) {
+    auto topic = subSock.recvOne(std::chrono::milliseconds(1000));
+    EXPECT_TRUE(topic.hasValue());
+    EXPECT_EQ(expectedTopic, topic->read<std::string>().value());
+    auto msg = subSock.recvOne(std::chrono::milliseconds(1000));
+    EXPECT_TRUE(msg.hasValue());
+    return msg->readThriftObj<thrift::Publication>(serializer).value();
+  };
+
+  // raw subscriber gets just key1
+  auto publication = recvBatch("key1");
+  EXPECT_EQ(1, publication.keyVals.size());
+  EXPECT_EQ(1, publication.keyVals.count("key1"));
+  EXPECT_FALSE(subSock.recvOne(std::chrono::milliseconds(100)).hasValue());
+
+  // keys of one update matching same topic come in one batch. key1 is also
+  // covered by "key" but only goes out in batch of longer topic "key1".
+  ASSERT_TRUE(subSock.setSockOpt(ZMQ_SUBSCRIBE, "key", 3).hasValue());
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto const thriftVal2 = createThriftValue(
+      2, "node1", std::string("value"), Constants::kTtlInfinity);
+  store->setKeys(
+      {{"key1", thriftVal2}, {"key2", thriftVal2}, {"key3", thriftVal2}});
+  std::map<std::string, thrift::Publication> batches;
+  for (int i = 0; i < 2; ++i) {
+    auto topic = subSock.recvOne(std::chrono::milliseconds(1000));
+    ASSERT_TRUE(topic.hasValue());
+    auto msg = subSock.recvOne(std::chrono::milliseconds(1000));
+    ASSERT_TRUE(msg.hasValue());
+    batches.emplace(
+        topic->read<std::string>().value(),
+        msg->readThriftObj<thrift::Publication>(serializer).value());
+  }
+  EXPECT_FALSE(subSock.recvOne(std::chrono::milliseconds(100)).hasValue());
+  ASSERT_EQ(1, batches.count("key1"));
+  ASSERT_EQ(1, batches.count("key"));
+  EXPECT_EQ(1, batches.at("key1").keyVals.size());
+  EXPECT_EQ(2, batches.at("key").keyVals.size());
+  EXPECT_EQ(1, batches.at("key").keyVals.count("key2"));
+  EXPECT_EQ(1, batches.at("key").keyVals.count("key3"));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  evl.stop();
+  evl.waitUntilStopped();
+  evlThread.join();
+
+  EXPECT_EQ((std::vector<std::string>{"key1", "key1"}), keyUpdates);
+  EXPECT_EQ(std::vector<std::string>{"prefix:1"}, filterUpdates);
+
+  store->stop();
+}
+
 /**
  * Test ttl change with persist key while keeping value and version same
  * - Set key with ttl 1s
@@ -1301,6 +1543,98 @@ TEST(KvStoreClient, SubscribeKeyFilterApiTest) {
   store->stop();
 }
 
+TEST(KvStoreClient, SubscribeKeyPrefixApiTest) {
+  fbzmq::Context context;
+  const std::string nodeId{"test_store"};
+
+  // Initialize and start KvStore with empty peer
+  const std::unordered_map<std::string, thrift::PeerSpec> emptyPeers;
+  auto store = std::make_shared<KvStoreWrapper>(
+      context,
+      nodeId,
+      std::chrono::seconds(60) /* db sync interval */,
+      std::chrono::seconds(3600) /* counter submit interval */,
+      emptyPeers);
+  store->run();
+
+  // Create another ZmqEventLoop instance for looping clients
+  fbzmq::ZmqEventLoop evl;
+
+  auto client1 = std::make_shared<KvStoreClient>(
+      context, &evl, nodeId, store->localCmdUrl, store->localPubUrl);
+
+  thrift::Value testValue = createThriftValue(
+      1,
+      nodeId,
+      std::string("test_key_val"),
+      10000, /* ttl in msec */
+      500 /* ttl version */,
+      0 /* hash */);
+
+  // multiple prefixes, each with its own callback. Same prefix can be
+  // subscribed to more than once.
+  std::vector<std::string> fooKeys;
+  std::vector<std::string> barKeys;
+  std::vector<std::string> fooKeys2;
+  KvStoreClient::KeyPrefixSubscription fooSubscription{0};
+  evl.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    fooSubscription = client1->subscribeKeyPrefix(
+        "foo:", [&](std::string const& k, folly::Optional<thrift::Value> v) {
+          EXPECT_TRUE(v.hasValue());
+          fooKeys.emplace_back(k);
+        });
+    client1->subscribeKeyPrefix(
+        "bar:", [&](std::string const& k, folly::Optional<thrift::Value> v) {
+          EXPECT_TRUE(v.hasValue());
+          barKeys.emplace_back(k);
+        });
+    client1->subscribeKeyPrefix(
+        "foo:", [&](std::string const& k, folly::Optional<thrift::Value> v) {
+          EXPECT_TRUE(v.hasValue());
+          fooKeys2.emplace_back(k);
+        });
+  });
+
+  evl.scheduleTimeout(std::chrono::milliseconds(25), [&]() noexcept {
+    store->setKey("foo:1", testValue);
+    store->setKey("bar:1", testValue);
+    store->setKey("baz:1", testValue);
+  });
+
+  // updates after unsubscribing are not reported, other subscription of
+  // same prefix stays
+  evl.scheduleTimeout(std::chrono::milliseconds(100), [&]() noexcept {
+    client1->unsubscribeKeyPrefix(fooSubscription);
+  });
+
+  evl.scheduleTimeout(std::chrono::milliseconds(150), [&]() noexcept {
+    store->setKey("foo:2", testValue);
+    store->setKey("bar:2", testValue);
+  });
+
+  evl.scheduleTimeout(
+      std::chrono::milliseconds(150 + kSyncMaxWaitTime.count()),
+      [&]() noexcept { evl.stop(); });
+
+  // Start the event loop
+  std::thread evlThread([&]() {
+    LOG(INFO) << "ZmqEventLoop main loop starting.";
+    evl.run();
+    LOG(INFO) << "ZmqEventLoop main loop terminating.";
+  });
+  evl.waitUntilRunning();
+  evl.waitUntilStopped();
+  evlThread.join();
+
+  EXPECT_EQ(std::vector<std::string>({"foo:1"}), fooKeys);
+  EXPECT_EQ(std::vector<std::string>({"bar:1", "bar:2"}), barKeys);
+  EXPECT_EQ(std::vector<std::string>({"foo:1", "foo:2"}), fooKeys2);
+
+  // Stop server
+  LOG(INFO) << "Stopping store";
+  store->stop();
+}
+
 /*
  * area related tests for KvStoreClient. Things to test:
  * - Flooding is contained within area - basic verification
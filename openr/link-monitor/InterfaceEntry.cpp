@@ -8,6 +8,7 @@
 #include "InterfaceEntry.h"
 
 #include <folly/gen/Base.h>
+#include <glog/logging.h>
 
 #include <openr/common/NetworkUtil.h>
 
@@ -18,11 +19,16 @@ InterfaceEntry::InterfaceEntry(
     std::chrono::milliseconds const& initBackoff,
     std::chrono::milliseconds const& maxBackoff,
     fbzmq::ZmqThrottle& updateCallback,
-    fbzmq::ZmqTimeout& updateTimeout)
+    fbzmq::ZmqTimeout& updateTimeout,
+    folly::Optional<FlapDampeningConfig> const& dampeningConfig)
     : ifName_(ifName),
       backoff_(initBackoff, maxBackoff),
       updateCallback_(updateCallback),
-      updateTimeout_(updateTimeout) {}
+      updateTimeout_(updateTimeout) {
+  if (dampeningConfig.hasValue()) {
+    dampener_.emplace(dampeningConfig.value());
+  }
+}
 
 bool
 InterfaceEntry::updateAttrs(int ifIndex, bool isUp, uint64_t weight) {
@@ -36,7 +42,14 @@ InterfaceEntry::updateAttrs(int ifIndex, bool isUp, uint64_t weight) {
   // Look for specific case of interface state transition to DOWN
   if (wasUp != isUp and wasUp) {
     // Penalize backoff on transitioning to DOWN state
-    backoff_.reportError();
+    if (dampener_) {
+      if (dampener_->reportFlap()) {
+        LOG(WARNING) << "Suppressing flapping interface " << ifName_ << " for "
+                     << dampener_->getTimeUntilReuse().count() << "ms";
+      }
+    } else {
+      backoff_.reportError();
+    }
   }
 
   // Look for active to down transition
@@ -58,6 +71,10 @@ InterfaceEntry::isActive() {
     return false;
   }
 
+  if (dampener_) {
+    return not dampener_->isSuppressed();
+  }
+
   const auto lastErrorTime = backoff_.getLastErrorTime();
   const auto now = std::chrono::steady_clock::now();
   if (now - lastErrorTime > backoff_.getMaxBackoff()) {
@@ -68,6 +85,9 @@ InterfaceEntry::isActive() {
 
 std::chrono::milliseconds
 InterfaceEntry::getBackoffDuration() const {
+  if (dampener_) {
+    return dampener_->getTimeUntilReuse();
+  }
   return backoff_.getTimeRemainingUntilRetry();
 }
 
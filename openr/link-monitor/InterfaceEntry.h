@@ -12,9 +12,11 @@
 #include <fbzmq/async/ZmqThrottle.h>
 #include <fbzmq/async/ZmqTimeout.h>
 #include <folly/IPAddress.h>
+#include <folly/Optional.h>
 #include <folly/String.h>
 
 #include <openr/common/ExponentialBackoff.h>
+#include <openr/common/FlapDampener.h>
 #include <openr/if/gen-cpp2/Lsdb_types.h>
 
 namespace openr {
@@ -27,6 +29,9 @@ namespace openr {
  * - Any change will always trigger throttled callback
  * - Interface transition from Active to Inactive schedules immediate timeout
  *   for fast reactions to down events.
+ *
+ * Flaps are dampened with exponential backoff, or with penalty based
+ * dampening (see FlapDampener) if `dampeningConfig` is given.
  */
 class InterfaceEntry final {
  public:
@@ -35,7 +40,9 @@ class InterfaceEntry final {
       std::chrono::milliseconds const& initBackoff,
       std::chrono::milliseconds const& maxBackoff,
       fbzmq::ZmqThrottle& updateCallback,
-      fbzmq::ZmqTimeout& updateTimeout);
+      fbzmq::ZmqTimeout& updateTimeout,
+      folly::Optional<FlapDampeningConfig> const& dampeningConfig =
+          folly::none);
 
   // Update attributes
   bool updateAttrs(int ifIndex, bool isUp, uint64_t weight);
@@ -44,12 +51,18 @@ class InterfaceEntry final {
   bool updateAddr(folly::CIDRNetwork const& ipNetwork, bool isValid);
 
   // Is interface active. Interface is active only when it is in UP state and
-  // it's not backed off
+  // it's not backed off or suppressed
   bool isActive();
 
-  // Get backoff time
+  // Get backoff time, or remaining suppression time with dampening
   std::chrono::milliseconds getBackoffDuration() const;
 
+  // Flap dampening state, nullptr unless dampening is enabled
+  const FlapDampener* FOLLY_NULLABLE
+  getFlapDampener() const {
+    return dampener_.get_pointer();
+  }
+
   // Used to check for updates if doing a re-sync
   bool
   operator==(const InterfaceEntry& interfaceEntry) {
@@ -121,6 +134,9 @@ class InterfaceEntry final {
   // Backoff variables
   ExponentialBackoff<std::chrono::milliseconds> backoff_;
 
+  // Flap dampening, replaces backoff if set
+  folly::Optional<FlapDampener> dampener_;
+
   // Update callback
   fbzmq::ZmqThrottle& updateCallback_;
   fbzmq::ZmqTimeout& updateTimeout_;
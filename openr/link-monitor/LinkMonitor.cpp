@@ -63,6 +63,84 @@ printLinkMonitorConfig(openr::thrift::LinkMonitorConfig const& config) {
 
 namespace openr {
 
+namespace detail {
+
+PlatformEventOrder
+checkPlatformEventSeqNum(
+    thrift::PlatformEvent const& event,
+    folly::Optional<int64_t>& publisherId,
+    std::unordered_map<int32_t, int64_t>& seqNums) {
+  if (not event.seqNum.hasValue() or not event.publisherId.hasValue()) {
+    return PlatformEventOrder::UNSEQUENCED;
+  }
+
+  const auto eventType = static_cast<int32_t>(event.eventType);
+  const auto seqNum = event.seqNum.value();
+  if (publisherId != event.publisherId) {
+    // Events published before we subscribed are covered by initial sync, but
+    // anything published by new instance before we got here is lost
+    const bool isRestart = publisherId.hasValue();
+    publisherId = event.publisherId;
+    seqNums.clear();
+    seqNums[eventType] = seqNum;
+    return isRestart ? PlatformEventOrder::PUBLISHER_CHANGED
+                     : PlatformEventOrder::IN_ORDER;
+  }
+
+  auto it = seqNums.find(eventType);
+  if (it == seqNums.end()) {
+    seqNums.emplace(eventType, seqNum);
+    return PlatformEventOrder::IN_ORDER;
+  }
+  if (seqNum <= it->second) {
+    return PlatformEventOrder::DUPLICATE;
+  }
+  const bool isGap = seqNum != it->second + 1;
+  it->second = seqNum;
+  return isGap ? PlatformEventOrder::GAP : PlatformEventOrder::IN_ORDER;
+}
+
+PlatformEventOrder
+checkPlatformHeartbeat(
+    thrift::PlatformEvent const& event,
+    thrift::PlatformHeartbeat const& heartbeat,
+    folly::Optional<int64_t>& publisherId,
+    std::unordered_map<int32_t, int64_t>& seqNums) {
+  if (not event.publisherId.hasValue()) {
+    return PlatformEventOrder::UNSEQUENCED;
+  }
+
+  if (publisherId != event.publisherId) {
+    const bool isRestart = publisherId.hasValue();
+    publisherId = event.publisherId;
+    seqNums.clear();
+    for (auto const& kv : heartbeat.seqNums) {
+      seqNums[static_cast<int32_t>(kv.first)] = kv.second;
+    }
+    return isRestart ? PlatformEventOrder::PUBLISHER_CHANGED
+                     : PlatformEventOrder::IN_ORDER;
+  }
+
+  // Publisher reports every event type, so ones not seen yet are recorded
+  // and any later event of those is checked against them
+  bool isGap{false};
+  for (auto const& kv : heartbeat.seqNums) {
+    const auto eventType = static_cast<int32_t>(kv.first);
+    auto it = seqNums.find(eventType);
+    if (it == seqNums.end()) {
+      seqNums.emplace(eventType, kv.second);
+      continue;
+    }
+    if (kv.second > it->second) {
+      isGap = true;
+      it->second = kv.second;
+    }
+  }
+  return isGap ? PlatformEventOrder::GAP : PlatformEventOrder::IN_ORDER;
+}
+
+} // namespace detail
+
 //
 // LinkMonitor code
 //
@@ -97,7 +175,9 @@ LinkMonitor::LinkMonitor(
     std::chrono::seconds adjHoldTime,
     std::chrono::milliseconds flapInitialBackoff,
     std::chrono::milliseconds flapMaxBackoff,
-    std::chrono::milliseconds ttlKeyInKvStore)
+    std::chrono::milliseconds ttlKeyInKvStore,
+    bool perAdjacencyKeys,
+    folly::Optional<FlapDampeningConfig> linkFlapDampening)
     : OpenrEventLoop(nodeId, thrift::OpenrModuleType::LINK_MONITOR, zmqContext),
       nodeId_(nodeId),
       platformThriftPort_(platformThriftPort),
@@ -120,7 +200,9 @@ LinkMonitor::LinkMonitor(
       linkMonitorGlobalPubUrl_(linkMonitorGlobalPubUrl),
       flapInitialBackoff_(flapInitialBackoff),
       flapMaxBackoff_(flapMaxBackoff),
+      linkFlapDampening_(std::move(linkFlapDampening)),
       ttlKeyInKvStore_(ttlKeyInKvStore),
+      perAdjacencyKeys_(perAdjacencyKeys),
       adjHoldUntilTimePoint_(std::chrono::steady_clock::now() + adjHoldTime),
       // mutable states
       linkMonitorPubSock_(
@@ -217,7 +299,11 @@ LinkMonitor::LinkMonitor(
   tData_.addStatExportType("link_monitor.neighbor_up", fbzmq::SUM);
   tData_.addStatExportType("link_monitor.neighbor_down", fbzmq::SUM);
   tData_.addStatExportType("link_monitor.advertise_adjacencies", fbzmq::SUM);
+  tData_.addStatExportType(
+      "link_monitor.advertise_adjacency_keys", fbzmq::SUM);
+  tData_.addStatExportType("link_monitor.withdraw_adjacency_keys", fbzmq::SUM);
   tData_.addStatExportType("link_monitor.advertise_links", fbzmq::SUM);
+  tData_.addStatExportType("link_monitor.platform_event_gaps", fbzmq::SUM);
 }
 
 void
@@ -273,6 +359,8 @@ LinkMonitor::prepare() noexcept {
       static_cast<uint16_t>(thrift::PlatformEventType::LINK_EVENT);
   const auto addrEventType =
       static_cast<uint16_t>(thrift::PlatformEventType::ADDRESS_EVENT);
+  const auto heartbeatEventType =
+      static_cast<uint16_t>(thrift::PlatformEventType::HEARTBEAT_EVENT);
   auto nlLinkSubOpt =
       nlEventSub_.setSockOpt(ZMQ_SUBSCRIBE, &linkEventType, sizeof(uint16_t));
   if (nlLinkSubOpt.hasError()) {
@@ -285,6 +373,12 @@ LinkMonitor::prepare() noexcept {
     LOG(FATAL) << "Error setting ZMQ_SUBSCRIBE to " << addrEventType << " "
                << nlAddrSubOpt.error();
   }
+  auto nlHeartbeatSubOpt = nlEventSub_.setSockOpt(
+      ZMQ_SUBSCRIBE, &heartbeatEventType, sizeof(uint16_t));
+  if (nlHeartbeatSubOpt.hasError()) {
+    LOG(FATAL) << "Error setting ZMQ_SUBSCRIBE to " << heartbeatEventType
+               << " " << nlHeartbeatSubOpt.error();
+  }
   const auto nlSub = nlEventSub_.connect(fbzmq::SocketUrl{platformPubUrl_});
   if (nlSub.hasError()) {
     LOG(FATAL) << "Error connecting to URL '" << platformPubUrl_ << "' "
@@ -411,6 +505,9 @@ LinkMonitor::prepare() noexcept {
         CHECK_EQ(
             static_cast<uint16_t>(eventType),
             eventHeader.read<uint16_t>().value());
+        if (not processPlatformEventSeqNum(eventMsg.value())) {
+          return;
+        }
 
         switch (eventType) {
         case thrift::PlatformEventType::LINK_EVENT: {
@@ -424,6 +521,7 @@ LinkMonitor::prepare() noexcept {
               const bool wasUp = interfaceEntry->isUp();
               interfaceEntry->updateAttrs(
                   linkEvt.ifIndex, linkEvt.isUp, linkEvt.weight);
+              trackUnstableInterface(*interfaceEntry);
               logLinkEvent(
                   interfaceEntry->getIfName(),
                   wasUp,
@@ -454,6 +552,10 @@ LinkMonitor::prepare() noexcept {
           }
         } break;
 
+        case thrift::PlatformEventType::HEARTBEAT_EVENT:
+          // Only carries sequence numbers, already checked
+          break;
+
         default:
           LOG(ERROR) << "Wrong eventType received on " << nodeId_
                      << ", eventType: " << static_cast<uint16_t>(eventType);
@@ -485,8 +587,14 @@ LinkMonitor::prepare() noexcept {
     if (success) {
       VLOG(2) << "InterfaceDb Sync is successful";
       expBackoff_.reportSuccess();
+      // Heartbeats from publisher we receive events from reveal missed
+      // events, so periodic sync is only a safety net
+      const bool hasHeartbeats = platformHeartbeatPublisherId_.hasValue() and
+          platformHeartbeatPublisherId_ == platformPublisherId_;
       interfaceDbSyncTimer_->scheduleTimeout(
-          Constants::kPlatformSyncInterval, isPeriodic);
+          hasHeartbeats ? Constants::kPlatformSafetySyncInterval
+                        : Constants::kPlatformSyncInterval,
+          isPeriodic);
     } else {
       tData_.addStatValue(
           "link_monitor.thrift.failure.getAllLinks", 1, fbzmq::SUM);
@@ -712,55 +820,175 @@ LinkMonitor::advertiseAdjacencies() {
     return;
   }
 
-  // Update KvStore
-  auto adjDb = thrift::AdjacencyDatabase();
-  adjDb.thisNodeName = nodeId_;
-  adjDb.isOverloaded = config_.isOverloaded;
-  adjDb.nodeLabel = config_.nodeLabel;
-  for (const auto& adjKv : adjacencies_) {
-    // 'second.second' is the adj object for this peer
-    // NOTE: copy on purpose
-    auto adj = adjKv.second.adjacency;
+  if (perAdjacencyKeys_) {
+    advertiseAdjacencyKeys();
+  } else {
+    // Update KvStore
+    auto adjDb = thrift::AdjacencyDatabase();
+    adjDb.thisNodeName = nodeId_;
+    adjDb.isOverloaded = config_.isOverloaded;
+    adjDb.nodeLabel = config_.nodeLabel;
+    for (const auto& adjKv : adjacencies_) {
+      adjDb.adjacencies.emplace_back(
+          getAdvertisedAdjacency(adjKv.second.adjacency));
+    }
 
-    // Set link overload bit
-    adj.isOverloaded = config_.overloadedLinks.count(adj.ifName) > 0;
+    // Add perf information if enabled
+    if (enablePerfMeasurement_) {
+      thrift::PerfEvents perfEvents;
+      addPerfEvent(perfEvents, nodeId_, "ADJ_DB_UPDATED");
+      adjDb.perfEvents = perfEvents;
+    } else {
+      DCHECK(!adjDb.perfEvents.hasValue());
+    }
 
-    // Override metric with link metric if it exists
-    adj.metric =
-        folly::get_default(config_.linkMetricOverrides, adj.ifName, adj.metric);
+    LOG(INFO) << "Updating adjacency database in KvStore with "
+              << adjDb.adjacencies.size() << " entries.";
+    const auto keyName = adjacencyDbMarker_ + nodeId_;
+    std::string adjDbStr = fbzmq::util::writeThriftObjStr(adjDb, serializer_);
+    kvStoreClient_->persistKey(keyName, adjDbStr, ttlKeyInKvStore_);
+  }
+  tData_.addStatValue("link_monitor.advertise_adjacencies", 1, fbzmq::SUM);
 
-    // Override metric with adj metric if it exists
-    thrift::AdjKey adjKey;
-    adjKey.nodeName = adj.otherNodeName;
-    adjKey.ifName = adj.ifName;
-    adj.metric =
-        folly::get_default(config_.adjMetricOverrides, adjKey, adj.metric);
+  // Config is most likely to have changed. Update it in `ConfigStore`, which
+  // skips writing it to disk if it is unchanged.
+  configStoreClient_->storeThriftObj(kConfigKey, config_);
 
-    adjDb.adjacencies.emplace_back(std::move(adj));
+  // Cancel throttle timeout if scheduled
+  if (advertiseAdjacenciesThrottled_->isActive()) {
+    advertiseAdjacenciesThrottled_->cancel();
   }
+}
+
+thrift::Adjacency
+LinkMonitor::getAdvertisedAdjacency(thrift::Adjacency adj) const {
+  // Set link overload bit
+  adj.isOverloaded = config_.overloadedLinks.count(adj.ifName) > 0;
+
+  // Override metric with link metric if it exists
+  adj.metric =
+      folly::get_default(config_.linkMetricOverrides, adj.ifName, adj.metric);
+
+  // Override metric with adj metric if it exists
+  thrift::AdjKey adjKey;
+  adjKey.nodeName = adj.otherNodeName;
+  adjKey.ifName = adj.ifName;
+  adj.metric =
+      folly::get_default(config_.adjMetricOverrides, adjKey, adj.metric);
+  return adj;
+}
 
-  // Add perf information if enabled
+void
+LinkMonitor::advertiseAdjacencyKeys() {
+  folly::Optional<thrift::PerfEvents> perfEvents;
   if (enablePerfMeasurement_) {
-    thrift::PerfEvents perfEvents;
-    addPerfEvent(perfEvents, nodeId_, "ADJ_DB_UPDATED");
-    adjDb.perfEvents = perfEvents;
-  } else {
-    DCHECK(!adjDb.perfEvents.hasValue());
+    perfEvents = thrift::PerfEvents();
+    addPerfEvent(*perfEvents, nodeId_, "ADJ_DB_UPDATED");
   }
 
-  LOG(INFO) << "Updating adjacency database in KvStore with "
-            << adjDb.adjacencies.size() << " entries.";
-  const auto keyName = adjacencyDbMarker_ + nodeId_;
-  std::string adjDbStr = fbzmq::util::writeThriftObjStr(adjDb, serializer_);
-  kvStoreClient_->persistKey(keyName, adjDbStr, ttlKeyInKvStore_);
-  tData_.addStatValue("link_monitor.advertise_adjacencies", 1, fbzmq::SUM);
+  const bool isFirstAdvertisement = !advertisedNodeAdjDb_.hasValue();
+
+  // Node attributes go first so that adjacencies are never merged into a
+  // database which isn't marked for per adjacency keys
+  auto nodeAdjDb = thrift::AdjacencyDatabase();
+  nodeAdjDb.thisNodeName = nodeId_;
+  nodeAdjDb.isOverloaded = config_.isOverloaded;
+  nodeAdjDb.nodeLabel = config_.nodeLabel;
+  nodeAdjDb.perAdjacencyKey = true;
+  if (advertisedNodeAdjDb_ != nodeAdjDb) {
+    advertisedNodeAdjDb_ = nodeAdjDb;
+    nodeAdjDb.perfEvents = perfEvents;
+    LOG(INFO) << "Updating node attributes of adjacency database in KvStore";
+    kvStoreClient_->persistKey(
+        adjacencyDbMarker_ + nodeId_,
+        fbzmq::util::writeThriftObjStr(nodeAdjDb, serializer_),
+        ttlKeyInKvStore_);
+  }
 
-  // Config is most likely to have changed. Update it in `ConfigStore`
-  configStoreClient_->storeThriftObj(kConfigKey, config_);
+  // Advertise new and changed adjacencies
+  std::unordered_map<std::string, thrift::Adjacency> newAdjacencies;
+  size_t numUpdated{0};
+  for (const auto& adjKv : adjacencies_) {
+    auto adj = getAdvertisedAdjacency(adjKv.second.adjacency);
+    auto key = PerAdjacencyKey(nodeId_, adj.otherNodeName, adj.ifName)
+                   .getAdjacencyKey();
+    auto it = advertisedAdjacencies_.find(key);
+    if (it == advertisedAdjacencies_.end() || it->second != adj) {
+      auto adjDb = thrift::AdjacencyDatabase();
+      adjDb.thisNodeName = nodeId_;
+      adjDb.isOverloaded = config_.isOverloaded;
+      adjDb.nodeLabel = config_.nodeLabel;
+      adjDb.adjacencies = {adj};
+      adjDb.perAdjacencyKey = true;
+      adjDb.perfEvents = perfEvents;
+      VLOG(1) << "Advertising adjacency " << key << " to KvStore";
+      kvStoreClient_->persistKey(
+          key,
+          fbzmq::util::writeThriftObjStr(adjDb, serializer_),
+          ttlKeyInKvStore_);
+      ++numUpdated;
+    }
+    newAdjacencies.emplace(std::move(key), std::move(adj));
+  }
 
-  // Cancel throttle timeout if scheduled
-  if (advertiseAdjacenciesThrottled_->isActive()) {
-    advertiseAdjacenciesThrottled_->cancel();
+  // Adjacency keys left in KvStore by previous incarnation of this node are
+  // unknown to us, withdraw the ones which are gone on first advertisement
+  if (isFirstAdvertisement) {
+    addStaleAdjacencyKeys(newAdjacencies);
+  }
+
+  // Withdraw adjacencies which are gone
+  size_t numWithdrawn{0};
+  for (const auto& kv : advertisedAdjacencies_) {
+    if (newAdjacencies.count(kv.first)) {
+      continue;
+    }
+    auto adjDb = thrift::AdjacencyDatabase();
+    adjDb.thisNodeName = nodeId_;
+    adjDb.adjacencies = {kv.second};
+    adjDb.perAdjacencyKey = true;
+    adjDb.deleteAdjacency = true;
+    adjDb.perfEvents = perfEvents;
+    VLOG(1) << "Withdrawing adjacency " << kv.first << " from KvStore";
+    kvStoreClient_->clearKey(
+        kv.first,
+        fbzmq::util::writeThriftObjStr(adjDb, serializer_),
+        ttlKeyInKvStore_);
+    ++numWithdrawn;
+  }
+  advertisedAdjacencies_ = std::move(newAdjacencies);
+
+  LOG(INFO) << "Updated " << numUpdated << " and withdrew " << numWithdrawn
+            << " adjacency keys in KvStore, " << advertisedAdjacencies_.size()
+            << " adjacencies advertised.";
+  tData_.addStatValue(
+      "link_monitor.advertise_adjacency_keys", numUpdated, fbzmq::SUM);
+  tData_.addStatValue(
+      "link_monitor.withdraw_adjacency_keys", numWithdrawn, fbzmq::SUM);
+}
+
+void
+LinkMonitor::addStaleAdjacencyKeys(
+    std::unordered_map<std::string, thrift::Adjacency> const& newAdjacencies) {
+  const auto keyVals = kvStoreClient_->dumpAllWithPrefix(
+      folly::sformat("{}{}:", adjacencyDbMarker_, nodeId_));
+  if (keyVals.hasError()) {
+    LOG(ERROR) << "Failed to dump adjacency keys of " << nodeId_
+               << " from KvStore: " << keyVals.error();
+    return;
+  }
+
+  for (const auto& kv : keyVals.value()) {
+    if (newAdjacencies.count(kv.first) || !kv.second.value.hasValue()) {
+      continue;
+    }
+    const auto adjDb =
+        KvStoreClient::parseThriftValue<thrift::AdjacencyDatabase>(kv.second);
+    if (adjDb.deleteAdjacency.value_or(false) || adjDb.adjacencies.empty()) {
+      continue;
+    }
+    LOG(INFO) << "Found stale adjacency key " << kv.first << " in KvStore";
+    advertisedAdjacencies_.emplace(kv.first, adjDb.adjacencies.at(0));
   }
 }
 
@@ -884,24 +1112,45 @@ LinkMonitor::advertiseRedistAddrs() {
 
 std::chrono::milliseconds
 LinkMonitor::getRetryTimeOnUnstableInterfaces() {
-  bool hasUnstableInterface = false;
-  std::chrono::milliseconds minRemainMs = flapMaxBackoff_;
-  for (auto& kv : interfaces_) {
-    auto& interface = kv.second;
-    if (interface.isActive()) {
-      continue;
-    }
+  // Pop interfaces whose time is up, earliest remaining one is next to
+  // retry. NOTE: suppression with dampening can outlast max backoff
+  const auto now = std::chrono::steady_clock::now();
+  while (not unstableInterfaces_.empty() and
+         unstableInterfaces_.begin()->first <= now) {
+    const auto ifName = unstableInterfaces_.begin()->second;
+    unstableInterfaces_.erase(unstableInterfaces_.begin());
+    unstableInterfaceReuseTimes_.erase(ifName);
+    // Backoff is reported in whole milliseconds, re-check
+    trackUnstableInterface(interfaces_.at(ifName));
+  }
+  if (unstableInterfaces_.empty()) {
+    return std::chrono::milliseconds(0);
+  }
 
-    const auto& curRemainMs = interface.getBackoffDuration();
-    if (curRemainMs.count() > 0) {
-      VLOG(2) << "Interface " << interface.getIfName()
-              << " is in backoff state for " << curRemainMs.count() << "ms";
-      minRemainMs = std::min(minRemainMs, curRemainMs);
-      hasUnstableInterface = true;
-    }
+  const auto& next = *unstableInterfaces_.begin();
+  const auto remainMs =
+      std::chrono::ceil<std::chrono::milliseconds>(next.first - now);
+  VLOG(2) << "Interface " << next.second << " is in backoff state for "
+          << remainMs.count() << "ms";
+  return remainMs;
+}
+
+void
+LinkMonitor::trackUnstableInterface(InterfaceEntry const& interface) {
+  const auto& ifName = interface.getIfName();
+  auto it = unstableInterfaceReuseTimes_.find(ifName);
+  if (it != unstableInterfaceReuseTimes_.end()) {
+    unstableInterfaces_.erase(std::make_pair(it->second, ifName));
+    unstableInterfaceReuseTimes_.erase(it);
   }
 
-  return hasUnstableInterface ? minRemainMs : std::chrono::milliseconds(0);
+  const auto backoff = interface.getBackoffDuration();
+  if (backoff.count() == 0) {
+    return;
+  }
+  const auto reuseTime = std::chrono::steady_clock::now() + backoff;
+  unstableInterfaces_.emplace(reuseTime, ifName);
+  unstableInterfaceReuseTimes_.emplace(ifName, reuseTime);
 }
 
 InterfaceEntry* FOLLY_NULLABLE
@@ -927,7 +1176,8 @@ LinkMonitor::getOrCreateInterfaceEntry(const std::string& ifName) {
           flapInitialBackoff_,
           flapMaxBackoff_,
           *advertiseIfaceAddrThrottled_,
-          *advertiseIfaceAddrTimer_));
+          *advertiseIfaceAddrTimer_,
+          linkFlapDampening_));
 
   return &(res.first->second);
 }
@@ -1002,6 +1252,7 @@ LinkMonitor::syncInterfaces() {
     // Update link attributes
     const bool wasUp = interfaceEntry->isUp();
     interfaceEntry->updateAttrs(link.ifIndex, link.isUp, link.weight);
+    trackUnstableInterface(*interfaceEntry);
     logLinkEvent(
         interfaceEntry->getIfName(),
         wasUp,
@@ -1026,6 +1277,60 @@ LinkMonitor::syncInterfaces() {
   return true;
 }
 
+bool
+LinkMonitor::processPlatformEventSeqNum(thrift::PlatformEvent const& event) {
+  using detail::PlatformEventOrder;
+
+  PlatformEventOrder order;
+  if (event.eventType == thrift::PlatformEventType::HEARTBEAT_EVENT) {
+    thrift::PlatformHeartbeat heartbeat;
+    try {
+      heartbeat = fbzmq::util::readThriftObjStr<thrift::PlatformHeartbeat>(
+          event.eventData, serializer_);
+    } catch (std::exception const& e) {
+      LOG(ERROR) << "Error parsing heartbeat. Reason: "
+                 << folly::exceptionStr(e);
+      return false;
+    }
+    // We don't subscribe to neighbor events
+    heartbeat.seqNums.erase(thrift::PlatformEventType::NEIGHBOR_EVENT);
+    order = detail::checkPlatformHeartbeat(
+        event, heartbeat, platformPublisherId_, platformEventSeqNums_);
+    platformHeartbeatPublisherId_ = event.publisherId;
+  } else {
+    order = detail::checkPlatformEventSeqNum(
+        event, platformPublisherId_, platformEventSeqNums_);
+  }
+
+  switch (order) {
+  case PlatformEventOrder::UNSEQUENCED:
+  case PlatformEventOrder::IN_ORDER:
+    return true;
+  case PlatformEventOrder::DUPLICATE:
+    VLOG(2) << "Ignoring already seen event " << event.seqNum.value()
+            << " from PlatformPublisher";
+    return false;
+  case PlatformEventOrder::GAP:
+    LOG(WARNING) << "Missed events from PlatformPublisher before "
+                 << (event.seqNum.hasValue()
+                         ? folly::to<std::string>(event.seqNum.value())
+                         : "heartbeat")
+                 << ", syncing interfaces";
+    break;
+  case PlatformEventOrder::PUBLISHER_CHANGED:
+    LOG(WARNING) << "PlatformPublisher restarted, syncing interfaces";
+    break;
+  }
+
+  tData_.addStatValue("link_monitor.platform_event_gaps", 1, fbzmq::SUM);
+  // Sync right away unless we are backing off after failed sync, in which
+  // case scheduled retry will take care of it
+  if (expBackoff_.canTryNow()) {
+    interfaceDbSyncTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  }
+  return true;
+}
+
 folly::Expected<fbzmq::Message, fbzmq::Error>
 LinkMonitor::processRequestMsg(fbzmq::Message&& request) {
   const auto maybeReq =
@@ -1258,6 +1563,18 @@ LinkMonitor::submitCounters() {
     auto& adj = kv.second.adjacency;
     counters["link_monitor.metric." + adj.otherNodeName] = adj.metric;
   }
+  for (const auto& kv : interfaces_) {
+    const auto dampener = kv.second.getFlapDampener();
+    if (not dampener) {
+      continue;
+    }
+    const auto prefix = "link_monitor.dampening." + kv.first;
+    counters[prefix + ".penalty"] = dampener->getPenalty();
+    counters[prefix + ".suppressed"] =
+        dampener->getTimeUntilReuse().count() > 0 ? 1 : 0;
+    counters[prefix + ".flaps"] = dampener->getNumFlaps();
+    counters[prefix + ".suppressions"] = dampener->getNumSuppressions();
+  }
 
   zmqMonitorClient_->setCounters(prepareSubmitCounters(std::move(counters)));
 }
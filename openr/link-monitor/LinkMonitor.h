@@ -9,6 +9,7 @@
 
 #include <chrono>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -46,6 +47,34 @@
 
 namespace openr {
 
+namespace detail {
+
+// order of event received from PlatformPublisher among ones seen before
+enum class PlatformEventOrder {
+  UNSEQUENCED,
+  IN_ORDER,
+  DUPLICATE,
+  GAP,
+  PUBLISHER_CHANGED,
+};
+
+// check sequence number of event against last ones seen from publisher,
+// per event type, and record it
+PlatformEventOrder checkPlatformEventSeqNum(
+    thrift::PlatformEvent const& event,
+    folly::Optional<int64_t>& publisherId,
+    std::unordered_map<int32_t /* PlatformEventType */, int64_t>& seqNums);
+
+// check last sequence numbers reported by publisher heartbeat against last
+// ones seen, and record them. Heartbeat is never DUPLICATE.
+PlatformEventOrder checkPlatformHeartbeat(
+    thrift::PlatformEvent const& event,
+    thrift::PlatformHeartbeat const& heartbeat,
+    folly::Optional<int64_t>& publisherId,
+    std::unordered_map<int32_t /* PlatformEventType */, int64_t>& seqNums);
+
+} // namespace detail
+
 // Pair <remoteNodeName, interface>
 using AdjacencyKey = std::pair<std::string, std::string>;
 
@@ -122,7 +151,12 @@ class LinkMonitor final : public OpenrEventLoop {
       std::chrono::milliseconds flapInitalBackoff,
       std::chrono::milliseconds flapMaxBackoff,
       // ttl for a key in the keyvalue store
-      std::chrono::milliseconds ttlKeyInKvStore);
+      std::chrono::milliseconds ttlKeyInKvStore,
+      // advertise each adjacency under its own key instead of full
+      // adjacency database under single key
+      bool perAdjacencyKeys = false,
+      // dampen link flaps with penalty based dampening instead of backoffs
+      folly::Optional<FlapDampeningConfig> linkFlapDampening = folly::none);
 
   ~LinkMonitor() override = default;
 
@@ -167,6 +201,12 @@ class LinkMonitor final : public OpenrEventLoop {
   // return true if sync is successful
   bool syncInterfaces();
 
+  // Check sequence number of event received from PlatformPublisher against
+  // last one seen. Missed events or restarted publisher trigger full sync of
+  // interfaces right away instead of waiting for periodic one. Returns false
+  // for already seen events, which must not be applied again.
+  bool processPlatformEventSeqNum(thrift::PlatformEvent const& event);
+
   // derive current peer-spec info from current adjacencies_
   // calculate delta and announce them to KvStore (peer add/remove) if any
   //
@@ -181,6 +221,21 @@ class LinkMonitor final : public OpenrEventLoop {
   // Advertise my adjacencies_ to the KvStore
   void advertiseAdjacencies();
 
+  // advertise adjacencies changed since last advertisement under their own
+  // keys and withdraw removed ones. Node attributes are advertised under
+  // node's adjacency database key without any adjacencies.
+  void advertiseAdjacencyKeys();
+
+  // add adjacency keys of this node found in KvStore, but not among
+  // newAdjacencies, to advertised ones so that they get withdrawn
+  void addStaleAdjacencyKeys(
+      std::unordered_map<std::string, thrift::Adjacency> const&
+          newAdjacencies);
+
+  // adjacency as it should be advertised, with link overload bit and metric
+  // overrides from config applied
+  thrift::Adjacency getAdvertisedAdjacency(thrift::Adjacency adj) const;
+
   // Advertise interfaces and addresses to Spark/Fib and PrefixManager
   // respectively
   void advertiseIfaceAddr();
@@ -192,6 +247,10 @@ class LinkMonitor final : public OpenrEventLoop {
   // return 0 if no more unstable interface
   std::chrono::milliseconds getRetryTimeOnUnstableInterfaces();
 
+  // Keep track of when interface is usable again after it got backed off or
+  // suppressed by flap. Called after every link state update.
+  void trackUnstableInterface(InterfaceEntry const& interface);
+
   // Get or create InterfaceEntry object. Returns nullptr if ifName doesn't
   // qualify regex match
   InterfaceEntry* FOLLY_NULLABLE
@@ -269,8 +328,12 @@ class LinkMonitor final : public OpenrEventLoop {
   // Backoff timers
   const std::chrono::milliseconds flapInitialBackoff_;
   const std::chrono::milliseconds flapMaxBackoff_;
+  // Link flap dampening, replaces backoffs if set
+  const folly::Optional<FlapDampeningConfig> linkFlapDampening_;
   // ttl for kvstore
   const std::chrono::milliseconds ttlKeyInKvStore_;
+  // advertise adjacencies with per adjacency keys
+  const bool perAdjacencyKeys_{false};
   // Timepoint used to hold off advertisement of link adjancecy on restart.
   const std::chrono::steady_clock::time_point adjHoldUntilTimePoint_;
   // The IO primitives provider; this is used for mocking
@@ -289,6 +352,11 @@ class LinkMonitor final : public OpenrEventLoop {
   // LinkMonitor config attributes (defined in LinkMonitor.thrift)
   thrift::LinkMonitorConfig config_;
 
+  // adjacencies last advertised with per adjacency keys, keyed by
+  // adjacency key, and node attributes last advertised along with them
+  std::unordered_map<std::string, thrift::Adjacency> advertisedAdjacencies_;
+  folly::Optional<thrift::AdjacencyDatabase> advertisedNodeAdjDb_;
+
   // publish our own events (interfaces up/down)
   fbzmq::Socket<ZMQ_PUB, fbzmq::ZMQ_SERVER> linkMonitorPubSock_;
   // socket to control the spark
@@ -314,6 +382,13 @@ class LinkMonitor final : public OpenrEventLoop {
   // Keyed by interface Name
   std::unordered_map<std::string, InterfaceEntry> interfaces_;
 
+  // Backed off or suppressed interfaces ordered by time they are usable
+  // again, and that time keyed by interface name
+  std::set<std::pair<std::chrono::steady_clock::time_point, std::string>>
+      unstableInterfaces_;
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+      unstableInterfaceReuseTimes_;
+
   // Throttled versions of "advertise<>" functions. It batches
   // up multiple calls and send them in one go!
   std::unique_ptr<fbzmq::ZmqThrottle> advertiseAdjacenciesThrottled_;
@@ -329,6 +404,18 @@ class LinkMonitor final : public OpenrEventLoop {
   std::unique_ptr<fbzmq::ZmqTimeout> interfaceDbSyncTimer_;
   ExponentialBackoff<std::chrono::milliseconds> expBackoff_;
 
+  // PlatformPublisher instance we receive events from and sequence number of
+  // last event received per event type. Set only if publisher sequences its
+  // events.
+  folly::Optional<int64_t> platformPublisherId_;
+  std::unordered_map<int32_t /* PlatformEventType */, int64_t>
+      platformEventSeqNums_;
+
+  // PlatformPublisher instance we receive heartbeats from. While it is the
+  // one we receive events from, missed events show up as gaps and we only
+  // sync interfaces every kPlatformSafetySyncInterval.
+  folly::Optional<int64_t> platformHeartbeatPublisherId_;
+
   // DS to hold local stats/counters
   fbzmq::ThreadData tData_;
 
@@ -229,6 +229,66 @@ TEST(InterfaceEntry, BackoffTest) {
   timeout->cancelTimeout();
 }
 
+/**
+ * Test penalty based dampening of InterfaceEntry. Single flap is absorbed,
+ * repeated flaps suppress interface until penalty decays.
+ */
+TEST(InterfaceEntry, DampeningTest) {
+  fbzmq::ZmqEventLoop evl;
+  fbzmq::ZmqThrottle throttle(&evl, std::chrono::milliseconds(1), []() {});
+  auto timeout = fbzmq::ZmqTimeout::make(&evl, []() {});
+  FlapDampeningConfig config;
+  config.flapPenalty = 1000;
+  config.suppressThreshold = 1500;
+  config.reuseThreshold = 750;
+  config.halfLife = std::chrono::milliseconds(100);
+  config.maxSuppressTime = std::chrono::milliseconds(1000);
+  InterfaceEntry interface(
+      "iface1",
+      std::chrono::milliseconds(8),
+      std::chrono::milliseconds(512),
+      throttle,
+      *timeout,
+      config);
+  ASSERT_NE(nullptr, interface.getFlapDampener());
+
+  // 1. Set interface to UP
+  EXPECT_TRUE(interface.updateAttrs(1, true, 1));
+  EXPECT_TRUE(interface.isActive());
+  EXPECT_EQ(std::chrono::milliseconds(0), interface.getBackoffDuration());
+
+  // 2. Single flap is absorbed
+  EXPECT_TRUE(interface.updateAttrs(1, false, 1));
+  EXPECT_FALSE(interface.isActive());
+  EXPECT_TRUE(timeout->isScheduled());
+  timeout->cancelTimeout();
+  EXPECT_TRUE(interface.updateAttrs(1, true, 1));
+  EXPECT_TRUE(interface.isActive());
+  EXPECT_EQ(std::chrono::milliseconds(0), interface.getBackoffDuration());
+
+  // 3. Second flap suppresses interface though it is UP
+  EXPECT_TRUE(interface.updateAttrs(1, false, 1));
+  EXPECT_TRUE(timeout->isScheduled());
+  timeout->cancelTimeout();
+  EXPECT_TRUE(interface.updateAttrs(1, true, 1));
+  EXPECT_TRUE(interface.isUp());
+  EXPECT_FALSE(interface.isActive());
+  auto backoff = interface.getBackoffDuration();
+  // ~2000 decays below 750 in about 1.4 half lives
+  EXPECT_LT(std::chrono::milliseconds(100), backoff);
+  EXPECT_GE(std::chrono::milliseconds(150), backoff);
+  EXPECT_EQ(2, interface.getFlapDampener()->getNumFlaps());
+  EXPECT_EQ(1, interface.getFlapDampener()->getNumSuppressions());
+  throttle.cancel();
+
+  // 4. Interface is usable again once penalty decayed
+  /* sleep override */
+  std::this_thread::sleep_for(backoff + std::chrono::milliseconds(1));
+  EXPECT_TRUE(interface.isActive());
+  EXPECT_EQ(std::chrono::milliseconds(0), interface.getBackoffDuration());
+  EXPECT_EQ(1, interface.getFlapDampener()->getNumSuppressions());
+}
+
 } // namespace openr
 
 int
@@ -512,6 +512,89 @@ class LinkMonitorTestFixture : public ::testing::Test {
     }
   }
 
+  // restart link monitor with per adjacency keys or link flap dampening
+  void
+  restartLinkMonitor(
+      bool perAdjacencyKeys,
+      folly::Optional<FlapDampeningConfig> linkFlapDampening = folly::none) {
+    openrThriftServerWrapper_->stop();
+    linkMonitor->stop();
+    linkMonitorThread->join();
+    linkMonitor.reset();
+
+    std::string regexErr;
+    auto includeRegexList =
+        std::make_unique<re2::RE2::Set>(regexOpts, re2::RE2::ANCHOR_BOTH);
+    includeRegexList->Add(kTestVethNamePrefix + ".*", &regexErr);
+    includeRegexList->Add("iface.*", &regexErr);
+    includeRegexList->Compile();
+
+    linkMonitor = make_shared<LinkMonitor>(
+        context,
+        "node-1",
+        port, /* thrift service port */
+        KvStoreLocalCmdUrl{kvStoreWrapper->localCmdUrl},
+        KvStoreLocalPubUrl{kvStoreWrapper->localPubUrl},
+        std::move(includeRegexList),
+        nullptr /* exclude regex list */,
+        nullptr /* redistribute regex list */,
+        std::vector<thrift::IpPrefix>{},
+        false /* useRttMetric */,
+        false /* enable perf measurement */,
+        true /* enable v4 */,
+        true /* enable segment routing */,
+        false /* prefix type mpls */,
+        false /* prefix fwd algo KSP2_ED_ECMP */,
+        AdjacencyDbMarker{"adj:"},
+        SparkCmdUrl{"inproc://spark-req"},
+        SparkReportUrl{"inproc://spark-report"},
+        MonitorSubmitUrl{"inproc://monitor-rep"},
+        PersistentStoreUrl{kConfigStoreUrl},
+        false,
+        PrefixManagerLocalCmdUrl{prefixManager->inprocCmdUrl},
+        PlatformPublisherUrl{"inproc://platform-pub-url"},
+        LinkMonitorGlobalPubUrl{"inproc://link-monitor-pub-url2"},
+        std::chrono::seconds(1),
+        std::chrono::milliseconds(1),
+        std::chrono::milliseconds(8),
+        Constants::kKvStoreDbTtl,
+        perAdjacencyKeys,
+        std::move(linkFlapDampening));
+
+    linkMonitorThread = std::make_unique<std::thread>([this]() {
+      LOG(INFO) << "LinkMonitor thread starting";
+      linkMonitor->run();
+      LOG(INFO) << "LinkMonitor thread finishing";
+    });
+    linkMonitor->waitUntilRunning();
+
+    openrThriftServerWrapper_->addModuleType(
+        thrift::OpenrModuleType::LINK_MONITOR, linkMonitor);
+    openrThriftServerWrapper_->run();
+  }
+
+  // poll KvStore until adjacency database advertised in per adjacency key
+  // format under key is (or is not) withdrawn
+  thrift::AdjacencyDatabase
+  waitForAdjKey(std::string const& key, bool withdrawn) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (true) {
+      auto value = kvStoreWrapper->getKey(key);
+      if (value.hasValue() and value->value.hasValue()) {
+        auto adjDb = fbzmq::util::readThriftObjStr<thrift::AdjacencyDatabase>(
+            value->value.value(), serializer);
+        if (adjDb.perAdjacencyKey.value_or(false) and
+            adjDb.deleteAdjacency.value_or(false) == withdrawn) {
+          return adjDb;
+        }
+      }
+      CHECK(std::chrono::steady_clock::now() < deadline)
+          << "Timed out waiting for " << key;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
   int port{0};
   std::shared_ptr<ThriftServer> server;
   ScopedServerThread systemThriftThread;
@@ -1106,6 +1189,85 @@ TEST_F(LinkMonitorTestFixture, ParallelAdj) {
   checkPeerDump(adj_2_2.otherNodeName, peerSpec_2_2);
 }
 
+// Adjacencies are advertised and withdrawn under their own keys, node key
+// only carries node attributes. Adjacency keys left over by previous
+// incarnation of the node are withdrawn on start.
+TEST_F(LinkMonitorTestFixture, PerAdjacencyKeys) {
+  const std::string clientId = Constants::kSparkReportClientId.toString();
+  const std::string staleKey =
+      PerAdjacencyKey("node-1", "node-3", "iface_3_1").getAdjacencyKey();
+  const std::string adjKey =
+      PerAdjacencyKey("node-1", "node-2", "iface_2_1").getAdjacencyKey();
+
+  {
+    auto adjDb = createAdjDatabase("node-1", {adj_2_1}, kNodeLabel);
+    adjDb.adjacencies.at(0).otherNodeName = "node-3";
+    adjDb.adjacencies.at(0).ifName = "iface_3_1";
+    adjDb.perAdjacencyKey = true;
+    EXPECT_TRUE(kvStoreWrapper->setKey(
+        staleKey,
+        createThriftValue(
+            1,
+            "node-1",
+            fbzmq::util::writeThriftObjStr(adjDb, serializer),
+            Constants::kKvStoreDbTtl.count())));
+  }
+
+  restartLinkMonitor(true /* per adjacency keys */);
+
+  // node attributes, no adjacencies
+  {
+    auto nodeAdjDb = waitForAdjKey("adj:node-1", false);
+    EXPECT_TRUE(nodeAdjDb.perAdjacencyKey.value_or(false));
+    EXPECT_EQ(0, nodeAdjDb.adjacencies.size());
+  }
+  waitForAdjKey(staleKey, true /* withdrawn */);
+
+  // neighbor up
+  {
+    auto neighborEvent = createNeighborEvent(
+        thrift::SparkNeighborEventType::NEIGHBOR_UP,
+        "iface_2_1",
+        nb2,
+        100 /* rtt-us */,
+        1 /* label */);
+    sparkReport.sendMultiple(
+        fbzmq::Message::from(clientId).value(),
+        fbzmq::Message(),
+        fbzmq::Message::fromThriftObj(neighborEvent, serializer).value());
+  }
+  {
+    auto adjDb = waitForAdjKey(adjKey, false);
+    EXPECT_TRUE(adjDb.perAdjacencyKey.value_or(false));
+    ASSERT_EQ(1, adjDb.adjacencies.size());
+    auto adj = adjDb.adjacencies.at(0);
+    adj.timestamp = kTimestamp;
+    EXPECT_EQ(adj_2_1, adj);
+
+    // node key is left alone
+    EXPECT_EQ(0, waitForAdjKey("adj:node-1", false).adjacencies.size());
+  }
+
+  // neighbor down
+  {
+    auto neighborEvent = createNeighborEvent(
+        thrift::SparkNeighborEventType::NEIGHBOR_DOWN,
+        "iface_2_1",
+        nb2,
+        100 /* rtt-us */,
+        1 /* label */);
+    sparkReport.sendMultiple(
+        fbzmq::Message::from(clientId).value(),
+        fbzmq::Message(),
+        fbzmq::Message::fromThriftObj(neighborEvent, serializer).value());
+  }
+  {
+    auto adjDb = waitForAdjKey(adjKey, true /* withdrawn */);
+    ASSERT_EQ(1, adjDb.adjacencies.size());
+    EXPECT_EQ("node-2", adjDb.adjacencies.at(0).otherNodeName);
+  }
+}
+
 // Verify neighbor-restarting event (including parallel case)
 TEST_F(LinkMonitorTestFixture, NeighborRestart) {
   std::string clientId = Constants::kSparkReportClientId.toString();
@@ -1513,6 +1675,66 @@ TEST_F(LinkMonitorTestFixture, DampenLinkFlaps) {
   }
 }
 
+// Flapping interface gets suppressed with penalty based dampening and is
+// advertised UP again once penalty decays, without any further link event
+TEST_F(LinkMonitorTestFixture, DampenLinkFlapsWithPenalty) {
+  const std::string linkX = kTestVethNamePrefix + "X";
+
+  FlapDampeningConfig dampening;
+  dampening.flapPenalty = 1000;
+  dampening.suppressThreshold = 1500;
+  dampening.reuseThreshold = 750;
+  dampening.halfLife = std::chrono::milliseconds(3000);
+  dampening.maxSuppressTime = std::chrono::milliseconds(10000);
+  restartLinkMonitor(false /* per adjacency keys */, dampening);
+
+  mockNlHandler->sendLinkEvent(
+      linkX /* link name */,
+      kTestVethIfIndex[0] /* ifIndex */,
+      false /* is up */);
+  recvAndReplyIfUpdate(std::chrono::seconds(1));
+  EXPECT_EQ(1, collateIfUpdates(sparkIfDb).at(linkX).isDownCount);
+
+  // Flap twice, single flap is absorbed but second one suppresses link for
+  // ~4.2s (penalty ~2000 decaying below 750 with 3s half life)
+  for (int i = 0; i < 2; ++i) {
+    mockNlHandler->sendLinkEvent(
+        linkX /* link name */,
+        kTestVethIfIndex[0] /* ifIndex */,
+        true /* is up */);
+    mockNlHandler->sendLinkEvent(
+        linkX /* link name */,
+        kTestVethIfIndex[0] /* ifIndex */,
+        false /* is up */);
+  }
+  mockNlHandler->sendLinkEvent(
+      linkX /* link name */,
+      kTestVethIfIndex[0] /* ifIndex */,
+      true /* is up */);
+
+  // Link is UP but reported DOWN while suppressed
+  recvAndReplyIfUpdate(std::chrono::seconds(1));
+  EXPECT_EQ(1, collateIfUpdates(sparkIfDb).at(linkX).isDownCount);
+  auto openrCtrlHandler = openrThriftServerWrapper_->getOpenrCtrlHandler();
+  {
+    auto links = openrCtrlHandler->semifuture_getInterfaces().get();
+    const auto& details = links->interfaceDetails.at(linkX);
+    EXPECT_TRUE(details.info.isUp);
+    ASSERT_TRUE(details.linkFlapBackOffMs.hasValue());
+    EXPECT_LT(0, details.linkFlapBackOffMs.value());
+    EXPECT_GE(5000, details.linkFlapBackOffMs.value());
+  }
+
+  // Link is advertised UP once penalty decays
+  EXPECT_LT(0, recvAndReplyIfUpdate(std::chrono::seconds(6)));
+  EXPECT_EQ(1, collateIfUpdates(sparkIfDb).at(linkX).isUpCount);
+  {
+    auto links = openrCtrlHandler->semifuture_getInterfaces().get();
+    EXPECT_FALSE(
+        links->interfaceDetails.at(linkX).linkFlapBackOffMs.hasValue());
+  }
+}
+
 // Test Interface events to Spark
 TEST_F(LinkMonitorTestFixture, verifyLinkEventSubscription) {
   const std::string linkX = kTestVethNamePrefix + "X";
@@ -2037,6 +2259,107 @@ TEST(LinkMonitor, getPeersFromAdjacencies) {
   EXPECT_EQ(peers, LinkMonitor::getPeersFromAdjacencies(adjacencies));
 }
 
+TEST(LinkMonitor, checkPlatformEventSeqNum) {
+  using Order = detail::PlatformEventOrder;
+  folly::Optional<int64_t> publisherId;
+  std::unordered_map<int32_t, int64_t> seqNums;
+
+  auto check = [&](thrift::PlatformEventType eventType,
+                   folly::Optional<int64_t> pubId,
+                   folly::Optional<int64_t> seqNum) {
+    thrift::PlatformEvent event;
+    event.eventType = eventType;
+    event.publisherId = pubId;
+    event.seqNum = seqNum;
+    return detail::checkPlatformEventSeqNum(event, publisherId, seqNums);
+  };
+  const auto linkEvent = thrift::PlatformEventType::LINK_EVENT;
+  const auto addrEvent = thrift::PlatformEventType::ADDRESS_EVENT;
+
+  // publisher not sequencing its events
+  EXPECT_EQ(Order::UNSEQUENCED, check(linkEvent, folly::none, folly::none));
+  EXPECT_FALSE(publisherId.hasValue());
+
+  // first events seen from publisher, whatever their sequence number
+  EXPECT_EQ(Order::IN_ORDER, check(linkEvent, 1, 5));
+  EXPECT_EQ(Order::IN_ORDER, check(addrEvent, 1, 10));
+  EXPECT_EQ(Order::IN_ORDER, check(linkEvent, 1, 6));
+  EXPECT_EQ(Order::IN_ORDER, check(addrEvent, 1, 11));
+
+  // duplicate and stale events don't move sequence number back
+  EXPECT_EQ(Order::DUPLICATE, check(linkEvent, 1, 6));
+  EXPECT_EQ(Order::DUPLICATE, check(linkEvent, 1, 2));
+  EXPECT_EQ(Order::IN_ORDER, check(linkEvent, 1, 7));
+
+  // gap in one event type only
+  EXPECT_EQ(Order::GAP, check(linkEvent, 1, 9));
+  EXPECT_EQ(Order::IN_ORDER, check(linkEvent, 1, 10));
+  EXPECT_EQ(Order::IN_ORDER, check(addrEvent, 1, 12));
+
+  // restarted publisher starts over
+  EXPECT_EQ(Order::PUBLISHER_CHANGED, check(addrEvent, 2, 1));
+  EXPECT_EQ(2, publisherId.value());
+  EXPECT_EQ(Order::IN_ORDER, check(linkEvent, 2, 1));
+  EXPECT_EQ(Order::IN_ORDER, check(addrEvent, 2, 2));
+  EXPECT_EQ(Order::GAP, check(addrEvent, 2, 4));
+}
+
+TEST(LinkMonitor, checkPlatformHeartbeat) {
+  using Order = detail::PlatformEventOrder;
+  folly::Optional<int64_t> publisherId;
+  std::unordered_map<int32_t, int64_t> seqNums;
+
+  const auto linkEvent = thrift::PlatformEventType::LINK_EVENT;
+  const auto addrEvent = thrift::PlatformEventType::ADDRESS_EVENT;
+  auto checkEvent = [&](thrift::PlatformEventType eventType,
+                        int64_t pubId,
+                        int64_t seqNum) {
+    thrift::PlatformEvent event;
+    event.eventType = eventType;
+    event.publisherId = pubId;
+    event.seqNum = seqNum;
+    return detail::checkPlatformEventSeqNum(event, publisherId, seqNums);
+  };
+  auto checkHeartbeat = [&](folly::Optional<int64_t> pubId,
+                            int64_t linkSeqNum,
+                            int64_t addrSeqNum) {
+    thrift::PlatformEvent event;
+    event.eventType = thrift::PlatformEventType::HEARTBEAT_EVENT;
+    event.publisherId = pubId;
+    thrift::PlatformHeartbeat heartbeat;
+    heartbeat.seqNums[linkEvent] = linkSeqNum;
+    heartbeat.seqNums[addrEvent] = addrSeqNum;
+    return detail::checkPlatformHeartbeat(
+        event, heartbeat, publisherId, seqNums);
+  };
+
+  // heartbeat without publisher is ignored
+  EXPECT_EQ(Order::UNSEQUENCED, checkHeartbeat(folly::none, 1, 1));
+  EXPECT_FALSE(publisherId.hasValue());
+
+  // first heartbeat records every event type, including ones not published
+  EXPECT_EQ(Order::IN_ORDER, checkHeartbeat(1, 3, 0));
+  EXPECT_EQ(1, publisherId.value());
+  EXPECT_EQ(Order::IN_ORDER, checkEvent(linkEvent, 1, 4));
+  EXPECT_EQ(Order::IN_ORDER, checkEvent(addrEvent, 1, 1));
+  EXPECT_EQ(Order::IN_ORDER, checkHeartbeat(1, 4, 1));
+
+  // lost last event only shows up with heartbeat
+  EXPECT_EQ(Order::GAP, checkHeartbeat(1, 5, 1));
+  EXPECT_EQ(Order::IN_ORDER, checkHeartbeat(1, 5, 1));
+  EXPECT_EQ(Order::DUPLICATE, checkEvent(linkEvent, 1, 5));
+  EXPECT_EQ(Order::IN_ORDER, checkEvent(linkEvent, 1, 6));
+
+  // first event type ever published getting lost shows up too
+  EXPECT_EQ(Order::GAP, checkHeartbeat(1, 6, 2));
+
+  // restarted publisher detected by heartbeat alone
+  EXPECT_EQ(Order::PUBLISHER_CHANGED, checkHeartbeat(2, 0, 0));
+  EXPECT_EQ(2, publisherId.value());
+  EXPECT_EQ(Order::IN_ORDER, checkEvent(linkEvent, 2, 1));
+  EXPECT_EQ(Order::GAP, checkEvent(addrEvent, 2, 2));
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -123,10 +123,22 @@ NetlinkMessage::setMessageType(NetlinkMessage::MessageType type) {
   messageType_ = type;
 }
 
-NetlinkProtocolSocket::NetlinkProtocolSocket(fbzmq::ZmqEventLoop* evl)
-    : evl_(evl) {
+NetlinkProtocolSocket::NetlinkProtocolSocket(
+    fbzmq::ZmqEventLoop* evl,
+    std::shared_ptr<NetlinkTransport> transport,
+    std::chrono::milliseconds requestTimeout)
+    : evl_(evl),
+      transport_(
+          transport ? std::move(transport)
+                    : std::make_shared<NetlinkTransport>()),
+      requestTimeout_(requestTimeout),
+      routeParser_(std::make_unique<NetlinkRouteMessage>()),
+      linkParser_(std::make_unique<NetlinkLinkMessage>()),
+      addrParser_(std::make_unique<NetlinkAddrMessage>()),
+      neighborParser_(std::make_unique<NetlinkNeighborMessage>()) {
+  allocateRecvBuffers(kNlRecvBufSize);
   nlMessageTimer_ = fbzmq::ZmqTimeout::make(evl_, [this]() noexcept {
-    LOG(INFO) << "Did not receive last ack " << lastSeqNo_;
+    expireInflightMessages();
     sendNetlinkMessage();
   });
 }
@@ -136,14 +148,15 @@ NetlinkProtocolSocket::init() {
   pid_ = static_cast<int>(
       std::hash<std::thread::id>{}(std::this_thread::get_id()));
 
-  nlSock_ = ::socket(PF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  nlSock_ = transport_->socket(PF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
   if (nlSock_ < 0) {
     LOG(FATAL) << "Netlink socket create failed.";
   }
   VLOG(1) << "Netlink socket created." << nlSock_;
   int size = kNetlinkSockRecvBuf;
   // increase socket recv buffer size
-  if (setsockopt(nlSock_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
+  if (transport_->setsockopt(
+          nlSock_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
     LOG(FATAL) << "Netlink socket set recv buffer failed.";
   };
 
@@ -158,7 +171,8 @@ NetlinkProtocolSocket::init() {
       | RTMGRP_IPV6_IFADDR // listen for IPv6 address events
       | RTMGRP_NEIGH; // listen for Neighbor (ARP) events
 
-  if (bind(nlSock_, (struct sockaddr*)&saddr_, sizeof(saddr_)) != 0) {
+  if (transport_->bind(nlSock_, (struct sockaddr*)&saddr_, sizeof(saddr_)) !=
+      0) {
     LOG(FATAL) << "Failed to bind netlink socket: " << folly::errnoStr(errno);
   };
 
@@ -191,76 +205,128 @@ NetlinkProtocolSocket::setNeighborEventCB(
 }
 
 void
-NetlinkProtocolSocket::processAck(uint32_t ack) {
-  if (ack == lastSeqNo_) {
-    VLOG(2) << "Last ack received " << ack;
-    // cancel active message timer
-    if (nlMessageTimer_->isScheduled()) {
-      nlMessageTimer_->cancelTimeout();
+NetlinkProtocolSocket::sendNetlinkMessage() {
+  evl_->runImmediatelyOrInEventLoop([this]() {
+    // Keep the ack window full. Messages are sent in chunks of kMaxIovMsg
+    // until either the queue is drained or kMaxNlInflightMsg requests are
+    // awaiting a response. More messages are sent as responses arrive.
+    while (!msgQueue_.empty() && nlSeqNoMap_.size() < kMaxNlInflightMsg) {
+      sendNetlinkMessageChunk(kMaxNlInflightMsg - nlSeqNoMap_.size());
     }
-    // continue sending next set of messages
-    sendNetlinkMessage();
-  }
+    updateMessageTimer();
+  });
 }
 
 void
-NetlinkProtocolSocket::sendNetlinkMessage() {
-  evl_->runImmediatelyOrInEventLoop([this]() {
-    struct sockaddr_nl nladdr = {
-        .nl_family = AF_NETLINK, .nl_pad = 0, .nl_pid = 0, .nl_groups = 0};
-    uint32_t count{0};
-    uint32_t iovSize = std::min(msgQueue_.size(), kMaxIovMsg);
+NetlinkProtocolSocket::sendNetlinkMessageChunk(size_t maxMsgs) {
+  struct sockaddr_nl nladdr = {
+      .nl_family = AF_NETLINK, .nl_pad = 0, .nl_pid = 0, .nl_groups = 0};
+  uint32_t count{0};
+  const size_t iovSize = std::min({msgQueue_.size(), kMaxIovMsg, maxMsgs});
 
-    if (!iovSize) {
-      return;
-    }
+  if (!iovSize) {
+    return;
+  }
 
-    auto iov = std::make_unique<struct iovec[]>(iovSize);
+  auto iov = std::make_unique<struct iovec[]>(iovSize);
+  std::vector<uint32_t> seqNos;
+  seqNos.reserve(iovSize);
 
-    while (count < iovSize && !msgQueue_.empty()) {
-      auto m = std::move(msgQueue_.front());
-      msgQueue_.pop();
+  while (count < iovSize && !msgQueue_.empty()) {
+    auto m = std::move(msgQueue_.front());
+    msgQueue_.pop();
 
-      struct nlmsghdr* nlmsg_hdr = m->getMessagePtr();
-      iov[count].iov_base = reinterpret_cast<void*>(m->getMessagePtr());
-      iov[count].iov_len = m->getDataLength();
+    struct nlmsghdr* nlmsg_hdr = m->getMessagePtr();
+    iov[count].iov_base = reinterpret_cast<void*>(m->getMessagePtr());
+    iov[count].iov_len = m->getDataLength();
 
-      // fill sequence number and PID
-      nlmsg_hdr->nlmsg_seq = ++gSequenceNumber;
-      nlmsg_hdr->nlmsg_pid = pid_;
+    // fill sequence number and PID
+    nlmsg_hdr->nlmsg_seq = ++gSequenceNumber;
+    nlmsg_hdr->nlmsg_pid = pid_;
 
-      // check if one request per message
-      if ((nlmsg_hdr->nlmsg_flags & NLM_F_MULTI) != 0) {
-        LOG(ERROR) << "Error: multipart netlink message not supported";
-      }
+    // check if one request per message
+    if ((nlmsg_hdr->nlmsg_flags & NLM_F_MULTI) != 0) {
+      LOG(ERROR) << "Error: multipart netlink message not supported";
+    }
+
+    // Add seq number -> netlink request mapping
+    nlSeqNoMap_.insert({gSequenceNumber, std::move(m)});
+    seqNos.emplace_back(gSequenceNumber);
+    count++;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + requestTimeout_;
+  for (const auto seqNo : seqNos) {
+    requestDeadlines_.emplace_back(seqNo, deadline);
+  }
 
-      // Add seq number -> netlink request mapping
-      nlSeqNoMap_.insert({gSequenceNumber, std::move(m)});
-      count++;
+  auto outMsg = std::make_unique<struct msghdr>();
+  outMsg->msg_name = &nladdr;
+  outMsg->msg_namelen = sizeof(nladdr);
+  outMsg->msg_iov = &iov[0];
+  outMsg->msg_iovlen = count;
+
+  VLOG(2) << "Sending " << outMsg->msg_iovlen << " netlink messages";
+  auto status = transport_->sendmsg(nlSock_, outMsg.get(), 0);
+
+  if (status < 0) {
+    const int err = errno;
+    LOG(ERROR) << "Error sending on NL socket " << folly::errnoStr(err)
+               << " Number of messages:" << outMsg->msg_iovlen;
+    ++errors_;
+    // None of these requests reached the kernel, fail them right away so
+    // that they don't hold up the window
+    for (const auto seqNo : seqNos) {
+      setReturnStatusValue(seqNo, -err);
     }
-    lastSeqNo_ = gSequenceNumber;
-    VLOG(2) << "Last seq sent:" << lastSeqNo_;
-
-    auto outMsg = std::make_unique<struct msghdr>();
-    outMsg->msg_name = &nladdr;
-    outMsg->msg_namelen = sizeof(nladdr);
-    outMsg->msg_iov = &iov[0];
-    outMsg->msg_iovlen = count;
-
-    VLOG(2) << "Sending " << outMsg->msg_iovlen << " netlink messages";
-    auto status = sendmsg(nlSock_, outMsg.get(), 0);
-
-    if (status < 0) {
-      LOG(ERROR) << "Error sending on NL socket "
-                 << folly::errnoStr(std::abs(status))
-                 << " Number of messages:" << outMsg->msg_iovlen;
-      ++errors_;
+  }
+}
+
+void
+NetlinkProtocolSocket::expireInflightMessages() {
+  const auto now = std::chrono::steady_clock::now();
+  uint32_t expired{0};
+  while (!requestDeadlines_.empty() &&
+         requestDeadlines_.front().second <= now) {
+    auto it = nlSeqNoMap_.find(requestDeadlines_.front().first);
+    requestDeadlines_.pop_front();
+    if (it == nlSeqNoMap_.end()) {
+      continue;
     }
+    it->second->setReturnStatus(-ETIMEDOUT);
+    nlSeqNoMap_.erase(it);
+    ++expired;
+  }
+  if (expired) {
+    LOG(ERROR) << "Did not receive response for " << expired
+               << " netlink requests in " << requestTimeout_.count() << "ms";
+    errors_ += expired;
+  }
+}
 
-    // Schedule timer to wait for acks and send next set of messages
-    nlMessageTimer_->scheduleTimeout(
-        std::chrono::milliseconds(kNlMessageAckTimer));
-  });
+void
+NetlinkProtocolSocket::updateMessageTimer() {
+  while (!requestDeadlines_.empty() &&
+         nlSeqNoMap_.count(requestDeadlines_.front().first) == 0) {
+    requestDeadlines_.pop_front();
+  }
+  if (requestDeadlines_.empty()) {
+    if (nlMessageTimer_->isScheduled()) {
+      nlMessageTimer_->cancelTimeout();
+    }
+    return;
+  }
+
+  // Oldest request is still waiting, keep its deadline
+  const auto& oldest = requestDeadlines_.front();
+  if (nlMessageTimer_->isScheduled() && nlMessageTimerSeqNo_ == oldest.first) {
+    return;
+  }
+  nlMessageTimerSeqNo_ = oldest.first;
+  nlMessageTimer_->scheduleTimeout(std::max(
+      std::chrono::milliseconds(0),
+      std::chrono::ceil<std::chrono::milliseconds>(
+          oldest.second - std::chrono::steady_clock::now())));
 }
 
 void
@@ -276,10 +342,9 @@ NetlinkProtocolSocket::setReturnStatusValue(uint32_t seq, int status) {
 }
 
 void
-NetlinkProtocolSocket::processMessage(
-    const std::array<char, kMaxNlPayloadSize>& rxMsg, uint32_t bytesRead) {
+NetlinkProtocolSocket::processMessage(const char* rxMsg, uint32_t bytesRead) {
   // first netlink message header
-  struct nlmsghdr* nlh = (struct nlmsghdr*)rxMsg.data();
+  struct nlmsghdr* nlh = (struct nlmsghdr*)rxMsg;
   do {
     if (!NLMSG_OK(nlh, bytesRead)) {
       break;
@@ -287,23 +352,27 @@ NetlinkProtocolSocket::processMessage(
 
     VLOG(2) << "Received Netlink message of type " << nlh->nlmsg_type
             << " seq no " << nlh->nlmsg_seq;
+    if (!abortedSeqNos_.empty() && abortedSeqNos_.count(nlh->nlmsg_seq)) {
+      // Remainder of an aborted dump
+      if (nlh->nlmsg_type == NLMSG_DONE || nlh->nlmsg_type == NLMSG_ERROR) {
+        abortedSeqNos_.erase(nlh->nlmsg_seq);
+      }
+      continue;
+    }
     switch (nlh->nlmsg_type) {
     case RTM_NEWROUTE:
     case RTM_DELROUTE: {
-      // next RTM message to be processed
-      auto rtmMessage = std::make_unique<NetlinkRouteMessage>();
-      auto route = rtmMessage->parseMessage(nlh);
+      // Synchronous event - do not generate route events. No route
+      // multicast groups are subscribed, so skip parsing anything else
       if (nlSeqNoMap_.count(nlh->nlmsg_seq) > 0) {
-        // Synchronous event - do not generate route events
-        routeCache_.emplace_back(route);
+        routeCache_.emplace_back(routeParser_->parseMessage(nlh));
       }
     } break;
 
     case RTM_DELLINK:
     case RTM_NEWLINK: {
       // process link information received from netlink
-      auto linkMessage = std::make_unique<NetlinkLinkMessage>();
-      fbnl::Link link = linkMessage->parseMessage(nlh);
+      fbnl::Link link = linkParser_->parseMessage(nlh);
 
       if (nlSeqNoMap_.count(nlh->nlmsg_seq) > 0) {
         // Synchronous event - do not generate link events
@@ -318,8 +387,7 @@ NetlinkProtocolSocket::processMessage(
     case RTM_DELADDR:
     case RTM_NEWADDR: {
       // process interface address information received from netlink
-      auto addrMessage = std::make_unique<NetlinkAddrMessage>();
-      fbnl::IfAddress addr = addrMessage->parseMessage(nlh);
+      fbnl::IfAddress addr = addrParser_->parseMessage(nlh);
 
       if (!addr.getPrefix().hasValue()) {
         break;
@@ -355,8 +423,7 @@ NetlinkProtocolSocket::processMessage(
     case RTM_DELNEIGH:
     case RTM_NEWNEIGH: {
       // process neighbor information received from netlink
-      auto neighMessage = std::make_unique<NetlinkNeighborMessage>();
-      fbnl::Neighbor neighbor = neighMessage->parseMessage(nlh);
+      fbnl::Neighbor neighbor = neighborParser_->parseMessage(nlh);
 
       if (nlSeqNoMap_.count(nlh->nlmsg_seq) > 0) {
         // Synchronous event - do not generate neighbor events
@@ -381,7 +448,6 @@ NetlinkProtocolSocket::processMessage(
       if (ack->error == 0) {
         ++acks_;
       }
-      processAck(ack->msg.nlmsg_seq);
     } break;
 
     case NLMSG_NOOP:
@@ -389,7 +455,6 @@ NetlinkProtocolSocket::processMessage(
 
     case NLMSG_DONE: {
       // End of multipart message
-      processAck(nlh->nlmsg_seq);
       setReturnStatusValue(nlh->nlmsg_seq, 0);
     } break;
 
@@ -400,23 +465,156 @@ NetlinkProtocolSocket::processMessage(
   } while ((nlh = NLMSG_NEXT(nlh, bytesRead)));
 }
 
+void
+NetlinkProtocolSocket::allocateRecvBuffers(uint32_t bufSize) {
+  recvBufSize_ = bufSize;
+  recvBuf_.resize(static_cast<size_t>(kNlRecvBatchSize) * bufSize);
+  recvIov_.resize(kNlRecvBatchSize);
+  recvMsgHdrs_.resize(kNlRecvBatchSize);
+  for (uint32_t i = 0; i < kNlRecvBatchSize; ++i) {
+    recvIov_[i].iov_base = recvBuf_.data() + static_cast<size_t>(i) * bufSize;
+    recvIov_[i].iov_len = bufSize;
+  }
+}
+
+void
+NetlinkProtocolSocket::abortTruncatedRequest(const char* buf, uint32_t len) {
+  if (len < sizeof(struct nlmsghdr)) {
+    return;
+  }
+  // All parts of a response carry sequence number of the request
+  const auto* nlh = reinterpret_cast<const struct nlmsghdr*>(buf);
+  const uint32_t seq = nlh->nlmsg_seq;
+  if (nlSeqNoMap_.count(seq) == 0) {
+    LOG(ERROR) << "Dropped truncated netlink event(s)";
+    return;
+  }
+  LOG(ERROR) << "Failing netlink request Seq#" << seq
+             << " as its response got truncated";
+  if (nlh->nlmsg_flags & NLM_F_MULTI) {
+    abortedSeqNos_.insert(seq);
+  }
+  setReturnStatusValue(seq, -EMSGSIZE);
+}
+
 void
 NetlinkProtocolSocket::recvNetlinkMessage() {
-  // messages buffer
-  std::array<char, kMaxNlPayloadSize> recvMsg = {};
+  int64_t eventSyscalls{0};
+  int64_t eventBytes{0};
+
+  // Drain the socket with batched reads into reusable buffers, bounded per
+  // event so that we return to the event loop under a multicast storm
+  for (uint32_t batch = 0; batch < kMaxNlRecvBatchesPerEvent; ++batch) {
+    for (uint32_t i = 0; i < kNlRecvBatchSize; ++i) {
+      auto& hdr = recvMsgHdrs_[i].msg_hdr;
+      ::memset(&hdr, 0, sizeof(hdr));
+      hdr.msg_iov = &recvIov_[i];
+      hdr.msg_iovlen = 1;
+      recvMsgHdrs_[i].msg_len = 0;
+    }
+
+    // MSG_TRUNC makes kernel report real datagram length, which we use to
+    // size buffers for subsequent reads
+    int numMsgs = transport_->recvmmsg(
+        nlSock_,
+        recvMsgHdrs_.data(),
+        kNlRecvBatchSize,
+        MSG_DONTWAIT | MSG_TRUNC);
+    ++eventSyscalls;
+
+    if (numMsgs < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      if (errno == ENOBUFS) {
+        // Kernel dropped messages because socket buffer overflowed. Stall
+        // timer will expire requests whose responses were lost
+        LOG(ERROR) << "Netlink socket receive buffer overrun";
+        ++recvOverruns_;
+        ++errors_;
+        continue;
+      }
+      LOG(INFO) << "Error in netlink socket receive: " << numMsgs
+                << " err: " << folly::errnoStr(std::abs(errno));
+      break;
+    }
+
+    uint32_t maxLen{0};
+    for (int i = 0; i < numMsgs; ++i) {
+      const auto& mmsg = recvMsgHdrs_[i];
+      const uint32_t msgLen = mmsg.msg_len;
+      VLOG(4) << "Message received with size: " << msgLen;
+      maxLen = std::max(maxLen, msgLen);
+      eventBytes += msgLen;
+      if (mmsg.msg_hdr.msg_flags & MSG_TRUNC) {
+        LOG(ERROR) << "Netlink message of size " << msgLen
+                   << " truncated to receive buffer size " << recvBufSize_;
+        ++recvTruncated_;
+        ++errors_;
+        abortTruncatedRequest(
+            static_cast<const char*>(mmsg.msg_hdr.msg_iov->iov_base),
+            std::min(msgLen, recvBufSize_));
+        continue;
+      }
+      processMessage(
+          static_cast<const char*>(mmsg.msg_hdr.msg_iov->iov_base), msgLen);
+    }
+    recvDatagrams_ += numMsgs;
 
-  int32_t bytesRead = ::recv(nlSock_, recvMsg.data(), kMaxNlPayloadSize, 0);
-  VLOG(4) << "Message received with size: " << bytesRead;
+    // Grow buffers if kernel sent anything larger than we could hold
+    if (maxLen > recvBufSize_ && recvBufSize_ < kMaxNlRecvBufSize) {
+      uint32_t newSize = recvBufSize_;
+      while (newSize < maxLen && newSize < kMaxNlRecvBufSize) {
+        newSize *= 2;
+      }
+      LOG(INFO) << "Growing netlink receive buffer size from " << recvBufSize_
+                << " to " << newSize;
+      allocateRecvBuffers(std::min(newSize, kMaxNlRecvBufSize));
+    }
 
-  if (bytesRead < 0) {
-    if (errno == EINTR || errno == EAGAIN) {
-      return;
+    if (static_cast<uint32_t>(numMsgs) < kNlRecvBatchSize) {
+      // Socket drained
+      break;
     }
-    LOG(INFO) << "Error in netlink socket receive: " << bytesRead
-              << " err: " << folly::errnoStr(std::abs(errno));
-    return;
   }
-  processMessage(recvMsg, static_cast<uint32_t>(bytesRead));
+
+  ++recvEvents_;
+  recvSyscalls_ += eventSyscalls;
+  recvBytes_ += eventBytes;
+  if (eventSyscalls > recvMaxSyscallsPerEvent_) {
+    recvMaxSyscallsPerEvent_ = eventSyscalls;
+  }
+  if (eventBytes > recvMaxBytesPerEvent_) {
+    recvMaxBytesPerEvent_ = eventBytes;
+  }
+  VLOG(3) << "Netlink receive event: " << eventSyscalls << " syscalls, "
+          << eventBytes << " bytes";
+
+  // Responses free up the window, send more queued messages if any
+  sendNetlinkMessage();
+}
+
+std::map<std::string, int64_t>
+NetlinkProtocolSocket::getCounters() const {
+  std::map<std::string, int64_t> counters;
+  const int64_t events = recvEvents_;
+  counters["netlink.recv_events"] = events;
+  counters["netlink.recv_syscalls"] = recvSyscalls_;
+  counters["netlink.recv_datagrams"] = recvDatagrams_;
+  counters["netlink.recv_bytes"] = recvBytes_;
+  counters["netlink.recv_truncated"] = recvTruncated_;
+  counters["netlink.dump_restarts"] = dumpRestarts_;
+  counters["netlink.recv_overruns"] = recvOverruns_;
+  counters["netlink.recv_syscalls_per_event.max"] = recvMaxSyscallsPerEvent_;
+  counters["netlink.recv_bytes_per_event.max"] = recvMaxBytesPerEvent_;
+  if (events) {
+    counters["netlink.recv_syscalls_per_event.avg"] = recvSyscalls_ / events;
+    counters["netlink.recv_bytes_per_event.avg"] = recvBytes_ / events;
+  }
+  return counters;
 }
 
 uint32_t
@@ -429,9 +627,18 @@ NetlinkProtocolSocket::getAckCount() const {
   return acks_;
 }
 
+size_t
+NetlinkProtocolSocket::getInflightCount() const {
+  folly::Promise<size_t> promise;
+  auto future = promise.getFuture();
+  evl_->runImmediatelyOrInEventLoop(
+      [this, &promise]() { promise.setValue(nlSeqNoMap_.size()); });
+  return std::move(future).get();
+}
+
 NetlinkProtocolSocket::~NetlinkProtocolSocket() {
   LOG(INFO) << "Closing netlink socket.";
-  close(nlSock_);
+  transport_->close(nlSock_);
 }
 
 void
@@ -449,10 +656,8 @@ NetlinkProtocolSocket::addNetlinkMessage(
             break;
           }
         }
-        // call send messages API if no timers are scheduled
-        if (!nlMessageTimer_->isScheduled()) {
-          sendNetlinkMessage();
-        }
+        // send as much as the ack window allows
+        sendNetlinkMessage();
       });
   return;
 }
@@ -490,6 +695,33 @@ NetlinkProtocolSocket::getReturnStatus(
   }
 }
 
+ResultCode
+NetlinkProtocolSocket::getReturnStatus(
+    folly::SemiFuture<std::vector<int>> statuses,
+    std::unordered_set<int> ignoredErrors,
+    std::chrono::milliseconds timeout) {
+  statuses.wait(timeout);
+  if (!statuses.isReady()) {
+    LOG(ERROR) << "One or more Netlink requests timed out";
+    return ResultCode::TIMEOUT;
+  }
+
+  size_t failures{0};
+  int lastError{0};
+  for (const auto status : statuses.value()) {
+    if (std::abs(status) != 0 && ignoredErrors.count(std::abs(status)) == 0) {
+      ++failures;
+      lastError = std::abs(status);
+    }
+  }
+  if (failures) {
+    LOG(ERROR) << failures << " Netlink requests failed, last error code:"
+               << lastError << " -- " << folly::errnoStr(lastError);
+    return ResultCode::SYSERR;
+  }
+  return ResultCode::SUCCESS;
+}
+
 ResultCode
 NetlinkProtocolSocket::addRoute(const openr::fbnl::Route& route) {
   auto rtmMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
@@ -508,29 +740,65 @@ NetlinkProtocolSocket::addRoute(const openr::fbnl::Route& route) {
 
 ResultCode
 NetlinkProtocolSocket::addRoutes(const std::vector<openr::fbnl::Route> routes) {
+  return getReturnStatus(
+      addRoutesAsync(routes),
+      std::unordered_set<int>{EEXIST},
+      kNlRequestTimeout);
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::addRoutesAsync(
+    const std::vector<openr::fbnl::Route>& routes) {
+  return sendRouteMessages(routes, true /* isAdd */);
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::deleteRoutesAsync(
+    const std::vector<openr::fbnl::Route>& routes) {
+  return sendRouteMessages(routes, false /* isAdd */);
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::sendRouteMessages(
+    const std::vector<openr::fbnl::Route>& routes, bool isAdd) {
   std::vector<std::unique_ptr<NetlinkMessage>> msg;
   std::vector<folly::Future<int>> futures;
+  msg.reserve(routes.size());
+  futures.reserve(routes.size());
 
   for (const auto& route : routes) {
     auto rtmMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
     ResultCode status{ResultCode::SUCCESS};
     if (route.getFamily() == AF_MPLS) {
-      status = rtmMsg->addLabelRoute(route);
+      status = isAdd ? rtmMsg->addLabelRoute(route)
+                     : rtmMsg->deleteLabelRoute(route);
     } else {
-      status = rtmMsg->addRoute(route);
+      status = isAdd ? rtmMsg->addRoute(route) : rtmMsg->deleteRoute(route);
     }
     if (status == ResultCode::SUCCESS) {
       futures.emplace_back(rtmMsg->getFuture());
       msg.emplace_back(std::move(rtmMsg));
     } else {
-      LOG(ERROR) << "Error adding route " << route.str();
+      LOG(ERROR) << "Error " << (isAdd ? "adding" : "deleting") << " route "
+                 << route.str();
+      // Request never reaches the kernel, report it as invalid
+      futures.emplace_back(folly::makeFuture<int>(-EINVAL));
     }
   }
   if (msg.size()) {
     addNetlinkMessage(std::move(msg));
   }
-  return getReturnStatus(
-      futures, std::unordered_set<int>{EEXIST}, kNlRequestTimeout);
+
+  return folly::collectAllSemiFuture(futures.begin(), futures.end())
+      .deferValue([](std::vector<folly::Try<int>>&& results) {
+        std::vector<int> statuses;
+        statuses.reserve(results.size());
+        for (const auto& result : results) {
+          // Exception implies request was dropped before kernel responded
+          statuses.emplace_back(result.hasValue() ? *result : -ECANCELED);
+        }
+        return statuses;
+      });
 }
 
 ResultCode
@@ -588,30 +856,9 @@ NetlinkProtocolSocket::deleteLabelRoute(const openr::fbnl::Route& route) {
 ResultCode
 NetlinkProtocolSocket::deleteRoutes(
     const std::vector<openr::fbnl::Route> routes) {
-  std::vector<std::unique_ptr<NetlinkMessage>> msg;
-  std::vector<folly::Future<int>> futures;
-
-  for (const auto& route : routes) {
-    auto rtmMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
-    ResultCode status{ResultCode::SUCCESS};
-    if (route.getFamily() == AF_MPLS) {
-      status = rtmMsg->deleteLabelRoute(route);
-    } else {
-      status = rtmMsg->deleteRoute(route);
-    }
-    if (status == ResultCode::SUCCESS) {
-      futures.emplace_back(rtmMsg->getFuture());
-      msg.emplace_back(std::move(rtmMsg));
-    } else {
-      LOG(ERROR) << "Error deleting route " << route.str();
-    }
-  }
-  if (msg.size()) {
-    addNetlinkMessage(std::move(msg));
-  }
   // Ignore EEXIST, ESRCH, EINVAL errors in delete operation
   return getReturnStatus(
-      futures,
+      deleteRoutesAsync(routes),
       std::unordered_set<int>{EEXIST, ESRCH, EINVAL},
       kNlRequestTimeout);
 }
@@ -657,69 +904,82 @@ NetlinkProtocolSocket::deleteIfAddress(const openr::fbnl::IfAddress& ifAddr) {
   return getReturnStatus(futures, std::unordered_set<int>{EADDRNOTAVAIL});
 }
 
+void
+NetlinkProtocolSocket::sendDumpRequest(
+    const std::function<std::unique_ptr<NetlinkMessage>()>& buildRequest,
+    const std::function<void()>& clearCache) {
+  for (uint32_t attempt = 0; attempt <= kMaxNlDumpRetries; ++attempt) {
+    // Refresh internal cache
+    clearCache();
+    auto request = buildRequest();
+    std::vector<folly::Future<int>> futures;
+    futures.emplace_back(request->getFuture());
+    std::vector<std::unique_ptr<NetlinkMessage>> msg;
+    msg.emplace_back(std::move(request));
+    addNetlinkMessage(std::move(msg));
+    getReturnStatus(futures, std::unordered_set<int>{}, kNlRequestTimeout);
+    if (!futures.front().isReady() || futures.front().value() != -EMSGSIZE) {
+      return;
+    }
+    LOG(WARNING) << "Restarting netlink dump truncated at receive buffer "
+                 << "size, attempt " << attempt + 1;
+    ++dumpRestarts_;
+  }
+  LOG(ERROR) << "Netlink dump still truncated after " << kMaxNlDumpRetries
+             << " restarts, returning partial result";
+}
+
 std::vector<fbnl::Link>
 NetlinkProtocolSocket::getAllLinks() {
-  // Refresh internal cache
-  linkCache_.clear();
-  // Send Netlink message to get links
-  auto linkMsg = std::make_unique<openr::fbnl::NetlinkLinkMessage>();
-  std::vector<folly::Future<int>> futures;
-  futures.emplace_back(linkMsg->getFuture());
-  linkMsg->init(RTM_GETLINK, 0);
-  std::vector<std::unique_ptr<NetlinkMessage>> msg;
-  msg.emplace_back(std::move(linkMsg));
-  addNetlinkMessage(std::move(msg));
-  getReturnStatus(futures, std::unordered_set<int>{}, kNlRequestTimeout);
+  sendDumpRequest(
+      []() {
+        // Send Netlink message to get links
+        auto linkMsg = std::make_unique<openr::fbnl::NetlinkLinkMessage>();
+        linkMsg->init(RTM_GETLINK, 0);
+        return linkMsg;
+      },
+      [this]() { linkCache_.clear(); });
   return std::move(linkCache_);
 }
 
 std::vector<fbnl::IfAddress>
 NetlinkProtocolSocket::getAllIfAddresses() {
-  // Refresh internal cache
-  addressCache_.clear();
-  auto addrMsg = std::make_unique<openr::fbnl::NetlinkAddrMessage>();
-  std::vector<folly::Future<int>> futures;
-  futures.emplace_back(addrMsg->getFuture());
-
-  // Initialize Netlink message fields to get all addresses
-  addrMsg->init(RTM_GETADDR);
-  addrMsg->setMessageType(NetlinkMessage::MessageType::GET_ALL_ADDRS);
-
-  std::vector<std::unique_ptr<NetlinkMessage>> msg;
-  msg.emplace_back(std::move(addrMsg));
-  addNetlinkMessage(std::move(msg));
-  getReturnStatus(futures, std::unordered_set<int>{}, kNlRequestTimeout);
+  sendDumpRequest(
+      []() {
+        // Initialize Netlink message fields to get all addresses
+        auto addrMsg = std::make_unique<openr::fbnl::NetlinkAddrMessage>();
+        addrMsg->init(RTM_GETADDR);
+        addrMsg->setMessageType(NetlinkMessage::MessageType::GET_ALL_ADDRS);
+        return addrMsg;
+      },
+      [this]() { addressCache_.clear(); });
   return std::move(addressCache_);
 }
 
 std::vector<fbnl::Neighbor>
 NetlinkProtocolSocket::getAllNeighbors() {
-  // Refresh internal cache
-  neighborCache_.clear();
-  // Send Netlink message to get neighbors
-  auto neighMsg = std::make_unique<openr::fbnl::NetlinkNeighborMessage>();
-  std::vector<folly::Future<int>> futures;
-  futures.emplace_back(neighMsg->getFuture());
-  neighMsg->init(RTM_GETNEIGH, 0);
-  std::vector<std::unique_ptr<NetlinkMessage>> msg;
-  msg.emplace_back(std::move(neighMsg));
-  addNetlinkMessage(std::move(msg));
-  getReturnStatus(futures, std::unordered_set<int>{}, kNlRequestTimeout);
+  sendDumpRequest(
+      []() {
+        // Send Netlink message to get neighbors
+        auto neighMsg =
+            std::make_unique<openr::fbnl::NetlinkNeighborMessage>();
+        neighMsg->init(RTM_GETNEIGH, 0);
+        return neighMsg;
+      },
+      [this]() { neighborCache_.clear(); });
   return std::move(neighborCache_);
 }
 
 std::vector<fbnl::Route>
 NetlinkProtocolSocket::getAllRoutes() {
-  routeCache_.clear();
-  auto routeMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
-  std::vector<folly::Future<int>> futures;
-  futures.emplace_back(routeMsg->getFuture());
-  fbnl::RouteBuilder builder; // to create empty route
-  routeMsg->init(RTM_GETROUTE, 0, builder.build());
-  std::vector<std::unique_ptr<NetlinkMessage>> msg;
-  msg.emplace_back(std::move(routeMsg));
-  addNetlinkMessage(std::move(msg));
-  getReturnStatus(futures, std::unordered_set<int>{}, kNlRequestTimeout);
+  sendDumpRequest(
+      []() {
+        auto routeMsg = std::make_unique<openr::fbnl::NetlinkRouteMessage>();
+        fbnl::RouteBuilder builder; // to create empty route
+        routeMsg->init(RTM_GETROUTE, 0, builder.build());
+        return routeMsg;
+      },
+      [this]() { routeCache_.clear(); });
   return std::move(routeCache_);
 }
 
@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <queue>
+#include <string>
 
 #include <limits.h>
 #include <linux/lwtunnel.h>
@@ -22,17 +26,39 @@
 #include <folly/IPAddress.h>
 #include <folly/futures/Future.h>
 
+#include <openr/nl/NetlinkTransport.h>
 #include <openr/nl/NetlinkTypes.h>
 
 namespace openr {
 namespace fbnl {
 class NetlinkSocket;
+class NetlinkRouteMessage;
+class NetlinkLinkMessage;
+class NetlinkAddrMessage;
+class NetlinkNeighborMessage;
 
 constexpr uint16_t kMaxNlPayloadSize{4096};
 constexpr uint32_t kNetlinkSockRecvBuf{1 * 1024 * 1024};
 
+// Size of a single receive buffer. Kernel sizes dump skbs after the largest
+// buffer it has seen us read with (capped at 32KB), so large buffers also
+// mean fewer, fuller dump datagrams
+constexpr uint32_t kNlRecvBufSize{32 * 1024};
+// Upper bound on receive buffer size when growing it on truncation
+constexpr uint32_t kMaxNlRecvBufSize{256 * 1024};
+// Number of times a dump is restarted after its response got truncated
+constexpr uint32_t kMaxNlDumpRetries{3};
+// Number of datagrams read with a single recvmmsg
+constexpr uint32_t kNlRecvBatchSize{32};
+// Maximum recvmmsg calls per socket readiness event, so that a multicast
+// storm cannot starve the rest of the event loop
+constexpr uint32_t kMaxNlRecvBatchesPerEvent{16};
+
 constexpr uint32_t kMaxNlMessageQueue{126001};
 constexpr size_t kMaxIovMsg{500};
+// Maximum number of requests sent to the kernel and awaiting an ack. Sized so
+// that acks for a full window fit comfortably in kNetlinkSockRecvBuf
+constexpr size_t kMaxNlInflightMsg{2000};
 constexpr std::chrono::milliseconds kNlMessageAckTimer{1000};
 constexpr std::chrono::milliseconds kNlRequestTimeout{30000};
 
@@ -135,7 +161,14 @@ class NetlinkMessage {
 
 class NetlinkProtocolSocket {
  public:
-  explicit NetlinkProtocolSocket(fbzmq::ZmqEventLoop* evl);
+  // `transport` defaults to the kernel. Tests and benchmarks can pass a fake
+  // one to run without root privileges
+  // Requests the kernel hasn't responded to within `requestTimeout` of being
+  // sent are failed with ETIMEDOUT.
+  explicit NetlinkProtocolSocket(
+      fbzmq::ZmqEventLoop* evl,
+      std::shared_ptr<NetlinkTransport> transport = nullptr,
+      std::chrono::milliseconds requestTimeout = kNlRequestTimeout);
 
   // create socket and add to eventloop
   void init();
@@ -158,9 +191,8 @@ class NetlinkProtocolSocket {
   void setNeighborEventCB(
       std::function<void(fbnl::Neighbor, bool)> neighborEventCB);
 
-  // process message
-  void processMessage(
-      const std::array<char, kMaxNlPayloadSize>& rxMsg, uint32_t bytesRead);
+  // process all netlink messages in a received datagram
+  void processMessage(const char* rxMsg, uint32_t bytesRead);
 
   // synchronous add route and nexthop paths
   ResultCode addRoute(const openr::fbnl::Route& route);
@@ -180,6 +212,17 @@ class NetlinkProtocolSocket {
   // synchronous delete a list of given IP or label routes
   ResultCode deleteRoutes(const std::vector<openr::fbnl::Route> routes);
 
+  // asynchronous add given list of IP or label routes. Returned future is
+  // fulfilled once the kernel has responded to every request and holds the
+  // status of each route (0 or -errno) in the same order as `routes`
+  folly::SemiFuture<std::vector<int>> addRoutesAsync(
+      const std::vector<openr::fbnl::Route>& routes);
+
+  // asynchronous delete a list of given IP or label routes. Same semantics
+  // as addRoutesAsync
+  folly::SemiFuture<std::vector<int>> deleteRoutesAsync(
+      const std::vector<openr::fbnl::Route>& routes);
+
   // synchronous add interface address
   ResultCode addIfAddress(const openr::fbnl::IfAddress& ifAddr);
 
@@ -195,12 +238,25 @@ class NetlinkProtocolSocket {
       std::unordered_set<int> ignoredErrors,
       std::chrono::milliseconds timeout = kNlMessageAckTimer);
 
+  // get status of a bulk request returned by addRoutesAsync/deleteRoutesAsync
+  ResultCode getReturnStatus(
+      folly::SemiFuture<std::vector<int>> statuses,
+      std::unordered_set<int> ignoredErrors,
+      std::chrono::milliseconds timeout = kNlRequestTimeout);
+
   // error count
   uint32_t getErrorCount() const;
 
   // ack count
   uint32_t getAckCount() const;
 
+  // number of requests sent to the kernel and awaiting a response. Read in
+  // event loop, blocks until it is done. Event loop must be running.
+  size_t getInflightCount() const;
+
+  // receive path counters, safe to call from any thread
+  std::map<std::string, int64_t> getCounters() const;
+
   // get all link interfaces from kernel using Netlink
   std::vector<fbnl::Link> getAllLinks();
 
@@ -219,6 +275,9 @@ class NetlinkProtocolSocket {
 
   fbzmq::ZmqEventLoop* evl_{nullptr};
 
+  // transport used for all socket operations
+  std::shared_ptr<NetlinkTransport> transport_{nullptr};
+
   // Event callbacks
   std::function<void(fbnl::Link, bool)> linkEventCB_;
 
@@ -229,11 +288,34 @@ class NetlinkProtocolSocket {
   // netlink message queue
   std::queue<std::unique_ptr<NetlinkMessage>> msgQueue_;
 
-  // timer to send a burst of netlink messages
+  // time kernel is given to respond to a request
+  const std::chrono::milliseconds requestTimeout_;
+
+  // Sequence numbers of sent requests along with their deadlines, in order
+  // they were sent. Entries of requests which already got a response are
+  // dropped lazily from the front.
+  std::deque<std::pair<uint32_t, std::chrono::steady_clock::time_point>>
+      requestDeadlines_;
+
+  // timer to expire requests past their deadline. Armed for deadline of the
+  // oldest request in flight and re-armed only once it got a response
   std::unique_ptr<fbzmq::ZmqTimeout> nlMessageTimer_{nullptr};
+  uint32_t nlMessageTimerSeqNo_{0};
+
+  // send up to `maxMsgs` queued messages with a single sendmsg
+  void sendNetlinkMessageChunk(size_t maxMsgs);
+
+  // fail in-flight requests past their deadline
+  void expireInflightMessages();
+
+  // arm the timer for deadline of the oldest request in flight, or cancel it
+  // if there is none
+  void updateMessageTimer();
 
-  // process ack message
-  void processAck(uint32_t ack);
+  // encode route add/delete requests and queue them, returns per-route
+  // status futures
+  folly::SemiFuture<std::vector<int>> sendRouteMessages(
+      const std::vector<openr::fbnl::Route>& routes, bool isAdd);
 
   // netlink socket
   int nlSock_{-1};
@@ -250,8 +332,49 @@ class NetlinkProtocolSocket {
   // NLMSG acks
   uint32_t acks_{0};
 
-  // last sent sequence number
-  uint32_t lastSeqNo_;
+  // (re)allocate receive buffers for `bufSize` bytes per datagram
+  void allocateRecvBuffers(uint32_t bufSize);
+
+  // Fail the request a truncated datagram belonged to with EMSGSIZE and
+  // discard the rest of its response, so that a dump doesn't wait for a
+  // NLMSG_DONE which may have been lost with the truncated part
+  void abortTruncatedRequest(const char* buf, uint32_t len);
+
+  // Sequence numbers of aborted dumps whose remaining datagrams are dropped
+  // until their NLMSG_DONE shows up
+  std::unordered_set<uint32_t> abortedSeqNos_;
+
+  // Send dump request built by `buildRequest` after `clearCache` and wait for
+  // it. Dump is restarted if it was aborted due to truncation, by which time
+  // receive buffers have been grown.
+  void sendDumpRequest(
+      const std::function<std::unique_ptr<NetlinkMessage>()>& buildRequest,
+      const std::function<void()>& clearCache);
+
+  // Reusable receive buffers, kNlRecvBatchSize slots of recvBufSize_ bytes,
+  // along with the recvmmsg headers pointing into them
+  std::vector<char> recvBuf_;
+  std::vector<struct iovec> recvIov_;
+  std::vector<struct mmsghdr> recvMsgHdrs_;
+  uint32_t recvBufSize_{0};
+
+  // Parsers reused across received messages instead of allocating a message
+  // (and its buffer) for every parsed netlink message
+  std::unique_ptr<NetlinkRouteMessage> routeParser_;
+  std::unique_ptr<NetlinkLinkMessage> linkParser_;
+  std::unique_ptr<NetlinkAddrMessage> addrParser_;
+  std::unique_ptr<NetlinkNeighborMessage> neighborParser_;
+
+  // receive path counters
+  std::atomic<int64_t> recvEvents_{0};
+  std::atomic<int64_t> recvSyscalls_{0};
+  std::atomic<int64_t> recvDatagrams_{0};
+  std::atomic<int64_t> recvBytes_{0};
+  std::atomic<int64_t> recvTruncated_{0};
+  std::atomic<int64_t> dumpRestarts_{0};
+  std::atomic<int64_t> recvOverruns_{0};
+  std::atomic<int64_t> recvMaxSyscallsPerEvent_{0};
+  std::atomic<int64_t> recvMaxBytesPerEvent_{0};
 
   // Sequence number -> NetlinkMesage request Map
   std::unordered_map<uint32_t, std::shared_ptr<NetlinkMessage>> nlSeqNoMap_;
@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/nl/NetlinkRouteCache.h>
+
+#include <algorithm>
+
+#include <boost/functional/hash.hpp>
+#include <folly/hash/SpookyHashV2.h>
+#include <glog/logging.h>
+
+namespace openr {
+namespace fbnl {
+
+size_t
+UnicastRouteCache::PackedPrefixHash::operator()(
+    const PackedPrefix& prefix) const {
+  static_assert(
+      sizeof(PackedPrefix) == 18, "PackedPrefix must not have padding");
+  return folly::hash::SpookyHashV2::Hash64(&prefix, sizeof(prefix), 0);
+}
+
+UnicastRouteCache::PackedPrefix
+UnicastRouteCache::pack(const folly::CIDRNetwork& prefix) {
+  PackedPrefix packed;
+  packed.family = prefix.first.family();
+  packed.len = prefix.second;
+  const auto bytes = prefix.first.bytes();
+  std::copy(
+      bytes, bytes + std::min<size_t>(prefix.first.byteCount(), 16),
+      packed.addr.begin());
+  return packed;
+}
+
+folly::CIDRNetwork
+UnicastRouteCache::unpack(const PackedPrefix& prefix) {
+  const size_t byteCount = prefix.family == AF_INET ? 4 : 16;
+  return {folly::IPAddress::fromBinary(
+              folly::ByteRange(prefix.addr.data(), byteCount)),
+          prefix.len};
+}
+
+size_t
+UnicastRouteCache::hashAttributes(const Route& route) {
+  size_t seed = 0;
+  boost::hash_combine(seed, route.getFamily());
+  boost::hash_combine(seed, route.getType());
+  boost::hash_combine(seed, route.getRouteTable());
+  boost::hash_combine(seed, route.getProtocolId());
+  boost::hash_combine(seed, route.getScope());
+  boost::hash_combine(seed, route.isValid());
+  boost::hash_combine(seed, route.getPriority().value_or(0));
+  boost::hash_combine(seed, route.getFlags().value_or(0));
+  boost::hash_combine(seed, route.getMtu().value_or(0));
+  // NextHopSet is unordered, hence combine nexthop hashes commutatively
+  size_t nhSeed = 0;
+  for (const auto& nh : route.getNextHops()) {
+    nhSeed += NextHopHash()(nh);
+  }
+  boost::hash_combine(seed, nhSeed);
+  return seed;
+}
+
+bool
+UnicastRouteCache::equalAttributes(const Route& lhs, const Route& rhs) {
+  if (!(lhs.getFamily() == rhs.getFamily() &&
+        lhs.getMplsLabel() == rhs.getMplsLabel() &&
+        lhs.getNextHops().size() == rhs.getNextHops().size() &&
+        lhs.getType() == rhs.getType() &&
+        lhs.getRouteTable() == rhs.getRouteTable() &&
+        lhs.getProtocolId() == rhs.getProtocolId() &&
+        lhs.getScope() == rhs.getScope() && lhs.isValid() == rhs.isValid() &&
+        lhs.getFlags() == rhs.getFlags() &&
+        lhs.getPriority() == rhs.getPriority() &&
+        lhs.getTos() == rhs.getTos() && lhs.getMtu() == rhs.getMtu() &&
+        lhs.getAdvMss() == rhs.getAdvMss() &&
+        lhs.getRouteIfName() == rhs.getRouteIfName())) {
+    return false;
+  }
+
+  // NOTE: size of nexthops are same
+  for (const auto& nh : lhs.getNextHops()) {
+    if (!rhs.getNextHops().count(nh)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t
+UnicastRouteCache::acquireBody(const Route& route) {
+  const auto hash = hashAttributes(route);
+  auto range = bodyIndex_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto& body = bodies_.at(it->second);
+    if (equalAttributes(*body.route, route)) {
+      ++body.refCount;
+      return it->second;
+    }
+  }
+
+  // Intern new attributes without destination
+  auto attrs = std::make_shared<Route>(route);
+  attrs->setDestination(folly::CIDRNetwork{folly::IPAddress(), 0});
+
+  uint32_t id;
+  if (!freeIds_.empty()) {
+    id = freeIds_.back();
+    freeIds_.pop_back();
+  } else {
+    id = static_cast<uint32_t>(bodies_.size());
+    bodies_.emplace_back();
+  }
+  auto& body = bodies_[id];
+  body.route = std::move(attrs);
+  body.hash = hash;
+  body.refCount = 1;
+  bodyIndex_.emplace(hash, id);
+  return id;
+}
+
+void
+UnicastRouteCache::releaseBody(uint32_t id) {
+  auto& body = bodies_.at(id);
+  CHECK_GT(body.refCount, 0);
+  if (--body.refCount > 0) {
+    return;
+  }
+
+  auto range = bodyIndex_.equal_range(body.hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == id) {
+      bodyIndex_.erase(it);
+      break;
+    }
+  }
+  body.route.reset();
+  freeIds_.emplace_back(id);
+}
+
+void
+UnicastRouteCache::insert(const Route& route) {
+  const auto key = pack(route.getDestination());
+  // Acquire before release so that re-inserting same attributes doesn't
+  // destroy and re-create the interned body
+  const auto id = acquireBody(route);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    auto& entry = entries_.at(it->second);
+    releaseBody(entry.second);
+    entry.second = id;
+  } else {
+    index_.emplace(key, static_cast<uint32_t>(entries_.size()));
+    entries_.emplace_back(key, id);
+  }
+}
+
+bool
+UnicastRouteCache::erase(const folly::CIDRNetwork& prefix) {
+  auto it = index_.find(pack(prefix));
+  if (it == index_.end()) {
+    return false;
+  }
+  const auto pos = it->second;
+  releaseBody(entries_.at(pos).second);
+  index_.erase(it);
+
+  // Keep entries dense by moving last entry into the hole
+  if (pos != entries_.size() - 1) {
+    entries_[pos] = entries_.back();
+    index_[entries_[pos].first] = pos;
+  }
+  entries_.pop_back();
+  return true;
+}
+
+bool
+UnicastRouteCache::contains(const folly::CIDRNetwork& prefix) const {
+  return index_.count(pack(prefix)) > 0;
+}
+
+bool
+UnicastRouteCache::containsRoute(const Route& route) const {
+  auto it = index_.find(pack(route.getDestination()));
+  if (it == index_.end()) {
+    return false;
+  }
+  const auto& body = bodies_.at(entries_.at(it->second).second);
+  return equalAttributes(*body.route, route);
+}
+
+folly::Optional<Route>
+UnicastRouteCache::find(const folly::CIDRNetwork& prefix) const {
+  auto it = index_.find(pack(prefix));
+  if (it == index_.end()) {
+    return folly::none;
+  }
+  Route route(*bodies_.at(entries_.at(it->second).second).route);
+  route.setDestination(prefix);
+  return route;
+}
+
+void
+UnicastRouteCache::forEach(
+    std::function<void(const folly::CIDRNetwork& prefix, const Route& attrs)>
+        callback) const {
+  forEachInRange(0, entries_.size(), std::move(callback));
+}
+
+size_t
+UnicastRouteCache::forEachInRange(
+    size_t start,
+    size_t count,
+    std::function<void(const folly::CIDRNetwork& prefix, const Route& attrs)>
+        callback) const {
+  if (start >= entries_.size()) {
+    return 0;
+  }
+  const auto end = std::min(entries_.size(), start + count);
+  for (auto pos = start; pos < end; ++pos) {
+    const auto& entry = entries_[pos];
+    callback(unpack(entry.first), *bodies_[entry.second].route);
+  }
+  return end - start;
+}
+
+std::vector<folly::CIDRNetwork>
+UnicastRouteCache::getPrefixes() const {
+  std::vector<folly::CIDRNetwork> prefixes;
+  prefixes.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    prefixes.emplace_back(unpack(entry.first));
+  }
+  return prefixes;
+}
+
+NlUnicastRoutes
+UnicastRouteCache::toRoutes() const {
+  NlUnicastRoutes routes;
+  routes.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    auto prefix = unpack(entry.first);
+    Route route(*bodies_[entry.second].route);
+    route.setDestination(prefix);
+    routes.emplace(std::move(prefix), std::move(route));
+  }
+  return routes;
+}
+
+} // namespace fbnl
+} // namespace openr
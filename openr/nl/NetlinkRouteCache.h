@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/IPAddress.h>
+#include <folly/Optional.h>
+
+#include <openr/nl/NetlinkTypes.h>
+
+namespace openr {
+namespace fbnl {
+
+/**
+ * Compact cache of unicast routes for a single protocol.
+ *
+ * A full routing table has very few distinct sets of route attributes
+ * compared to number of prefixes (most prefixes share same nexthops, protocol,
+ * priority etc). Instead of storing a full `Route` (with its heap allocated
+ * NextHopSet) per prefix, attributes of a route without its destination are
+ * interned once and every prefix refers to it with a 32 bit id. Prefixes
+ * themselves are stored in packed fixed size form in a dense array, which
+ * also allows walking the cache in pages by position.
+ *
+ * Interned attribute sets are reference counted and released when the last
+ * prefix referring to them is removed.
+ *
+ * This class is not thread safe. NetlinkSocket owns it in its event loop and
+ * hands out read-only snapshots (copy-on-write) to other threads.
+ */
+class UnicastRouteCache final {
+ public:
+  UnicastRouteCache() = default;
+
+  // Insert or replace route for its destination
+  void insert(const Route& route);
+
+  // Remove route for prefix. Returns true if prefix existed
+  bool erase(const folly::CIDRNetwork& prefix);
+
+  bool contains(const folly::CIDRNetwork& prefix) const;
+
+  // Returns true if exactly same route (destination and attributes) is cached
+  bool containsRoute(const Route& route) const;
+
+  // Build and return route for prefix if it exists
+  folly::Optional<Route> find(const folly::CIDRNetwork& prefix) const;
+
+  /**
+   * Invoke callback for every cached prefix with its interned attributes.
+   * `attrs` has no destination set and is shared among all prefixes with
+   * same attributes, hence callers can memoize any conversion on its address.
+   */
+  void forEach(
+      std::function<void(const folly::CIDRNetwork& prefix, const Route& attrs)>
+          callback) const;
+
+  /**
+   * Same as `forEach` but only for at most `count` prefixes starting at
+   * position `start`. Positions are stable as long as cache isn't modified.
+   * Returns number of prefixes visited.
+   */
+  size_t forEachInRange(
+      size_t start,
+      size_t count,
+      std::function<void(const folly::CIDRNetwork& prefix, const Route& attrs)>
+          callback) const;
+
+  std::vector<folly::CIDRNetwork> getPrefixes() const;
+
+  // Materialize full routes. Expensive, meant for compatibility APIs only
+  NlUnicastRoutes toRoutes() const;
+
+  size_t
+  size() const {
+    return entries_.size();
+  }
+
+  bool
+  empty() const {
+    return entries_.empty();
+  }
+
+  // Number of distinct interned attribute sets
+  size_t
+  getAttributeSetCount() const {
+    return bodies_.size() - freeIds_.size();
+  }
+
+ private:
+  // IPv4/IPv6 prefix in packed form. IPv4 address occupies first 4 bytes
+  struct PackedPrefix {
+    std::array<uint8_t, 16> addr{};
+    uint8_t family{AF_UNSPEC};
+    uint8_t len{0};
+
+    bool
+    operator==(const PackedPrefix& other) const {
+      return addr == other.addr && family == other.family && len == other.len;
+    }
+  };
+
+  struct PackedPrefixHash {
+    size_t operator()(const PackedPrefix& prefix) const;
+  };
+
+  // Interned route attributes
+  struct RouteBody {
+    std::shared_ptr<const Route> route;
+    size_t hash{0};
+    uint32_t refCount{0};
+  };
+
+  static PackedPrefix pack(const folly::CIDRNetwork& prefix);
+
+  static folly::CIDRNetwork unpack(const PackedPrefix& prefix);
+
+  // Hash of route attributes excluding destination
+  static size_t hashAttributes(const Route& route);
+
+  // Compare route attributes excluding destination
+  static bool equalAttributes(const Route& lhs, const Route& rhs);
+
+  // Find id of interned attributes, or intern new ones, and take a reference
+  uint32_t acquireBody(const Route& route);
+
+  // Drop a reference on interned attributes
+  void releaseBody(uint32_t id);
+
+  // Prefix -> position in entries_
+  std::unordered_map<PackedPrefix, uint32_t, PackedPrefixHash> index_;
+
+  std::vector<std::pair<PackedPrefix, uint32_t /* bodyId */>> entries_;
+
+  std::vector<RouteBody> bodies_;
+
+  // Unused slots in bodies_
+  std::vector<uint32_t> freeIds_;
+
+  // Attribute hash -> body ids for interning lookups
+  std::unordered_multimap<size_t, uint32_t> bodyIndex_;
+};
+
+} // namespace fbnl
+} // namespace openr
@@ -6,6 +6,10 @@
  */
 
 #include <openr/nl/NetlinkSocket.h>
+
+#include <algorithm>
+#include <map>
+
 #include <openr/if/gen-cpp2/Platform_constants.h>
 
 namespace openr {
@@ -225,10 +229,8 @@ NetlinkSocket::doUpdateRouteCache(Route route, bool updateUnicastRoute) {
   }
 
   if (updateUnicastRoute) {
-    auto& unicastRoutes = unicastRoutesCache_[protocol];
     if (route.isValid()) {
-      unicastRoutes.erase(prefix);
-      unicastRoutes.emplace(prefix, std::move(route));
+      getMutableUnicastRoutes(protocol).insert(route);
     }
     // NOTE: We are just updating cache. This called during initialization
   }
@@ -272,6 +274,27 @@ NetlinkSocket::addRoute(Route route) {
   return future;
 }
 
+folly::Future<folly::Unit>
+NetlinkSocket::addRoutes(std::vector<Route> routes) {
+  VLOG(3) << "NetlinkSocket add " << routes.size() << " routes";
+
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+
+  evl_->runImmediatelyOrInEventLoop(
+      [this, p = std::move(promise), rs = std::move(routes)]() mutable {
+        try {
+          doAddUpdateUnicastRoutes(std::move(rs));
+          p.setValue();
+        } catch (std::exception const& ex) {
+          LOG(ERROR) << "Error adding routes. Exception: "
+                     << folly::exceptionStr(ex);
+          p.setException(ex);
+        }
+      });
+  return future;
+}
+
 folly::Future<folly::Unit>
 NetlinkSocket::addMplsRoute(Route mplsRoute) {
   auto prefix = mplsRoute.getDestination();
@@ -397,6 +420,50 @@ NetlinkSocket::getCachedMplsRoutes(uint8_t protocolId) const {
   return future;
 }
 
+folly::Future<std::vector<Route>>
+NetlinkSocket::getCachedMplsRoutesPage(
+    uint8_t protocolId, int32_t startLabel, size_t limit) const {
+  VLOG(3) << "NetlinkSocket get cached MPLS routes page by protocol "
+          << (int)protocolId << " from label " << startLabel;
+  folly::Promise<std::vector<Route>> promise;
+  auto future = promise.getFuture();
+
+  evl_->runImmediatelyOrInEventLoop(
+      [this, p = std::move(promise), protocolId, startLabel, limit]() mutable {
+        std::vector<Route> page;
+        auto iter = mplsRoutesCache_.find(protocolId);
+        if (iter == mplsRoutesCache_.end()) {
+          p.setValue(std::move(page));
+          return;
+        }
+
+        // Select lowest `limit` labels without copying any routes
+        std::vector<std::pair<int32_t, const Route*>> selected;
+        for (const auto& kv : iter->second) {
+          if (kv.first >= startLabel) {
+            selected.emplace_back(kv.first, &kv.second);
+          }
+        }
+        auto cmp = [](const std::pair<int32_t, const Route*>& lhs,
+                      const std::pair<int32_t, const Route*>& rhs) {
+          return lhs.first < rhs.first;
+        };
+        if (selected.size() > limit) {
+          std::nth_element(
+              selected.begin(), selected.begin() + limit, selected.end(), cmp);
+          selected.resize(limit);
+        }
+        std::sort(selected.begin(), selected.end(), cmp);
+
+        page.reserve(selected.size());
+        for (const auto& kv : selected) {
+          page.emplace_back(*kv.second);
+        }
+        p.setValue(std::move(page));
+      });
+  return future;
+}
+
 folly::Future<int64_t>
 NetlinkSocket::getMplsRouteCount() const {
   VLOG(3) << "NetlinkSocket get MPLS routes count";
@@ -416,64 +483,156 @@ NetlinkSocket::getMplsRouteCount() const {
 
 void
 NetlinkSocket::doAddUpdateUnicastRoute(Route route) {
-  checkUnicastRoute(route);
-
-  const auto& dest = route.getDestination();
-
-  // Create new set of nexthops to be programmed. Existing + New ones
-  auto& unicastRoutes = unicastRoutesCache_[route.getProtocolId()];
-  auto iter = unicastRoutes.find(dest);
-  // if user did not speicify priority
-  if (!route.getPriority()) {
-    const auto routePair =
-        openr::thrift::Platform_constants::protocolIdtoPriority().find(
-            route.getProtocolId());
-    if (routePair ==
-        openr::thrift::Platform_constants::protocolIdtoPriority().end()) {
-      route.setPriority(
-          openr::thrift::Platform_constants::kUnknowProtAdminDistance());
-    } else {
-      route.setPriority(routePair->second);
-    }
-  }
-  // Same route
-  if (iter != unicastRoutes.end() && iter->second == route) {
-    return;
+  std::vector<Route> routes;
+  routes.emplace_back(std::move(route));
+  doAddUpdateUnicastRoutes(std::move(routes));
+}
+
+void
+NetlinkSocket::doAddUpdateUnicastRoutes(std::vector<Route> routes) {
+  for (const auto& route : routes) {
+    checkUnicastRoute(route);
   }
 
-  if (dest.first.isV6()) {
-    // We need to explicitly add new V6 routes & remove old routes
-    // With IPv6, if new route being requested has different properties
-    // (like gateway or metric or..) the existing one will not be replaced,
-    // instead a new route will be created, which may cause underlying kernel
-    // crash when releasing netdevices
-    if (iter != unicastRoutes.end()) {
-      int err{0};
+  // Last update of a prefix wins, as if routes were programmed one by one
+  std::map<std::pair<uint8_t, folly::CIDRNetwork>, size_t> latest;
+  for (size_t i = 0; i < routes.size(); ++i) {
+    latest[std::make_pair(
+        routes[i].getProtocolId(), routes[i].getDestination())] = i;
+  }
 
-      err = static_cast<int>(nlSock_->deleteRoute(iter->second));
+  std::vector<Route> toAdd;
+  // Old V6 routes to be removed before their replacement is added, and the
+  // index of the replacement in `toAdd`
+  std::vector<Route> toReplace;
+  std::vector<size_t> replacementIdx;
+  for (auto const& kv : latest) {
+    auto& route = routes.at(kv.second);
+    // if user did not speicify priority
+    if (!route.getPriority()) {
+      const auto routePair =
+          openr::thrift::Platform_constants::protocolIdtoPriority().find(
+              route.getProtocolId());
+      if (routePair ==
+          openr::thrift::Platform_constants::protocolIdtoPriority().end()) {
+        route.setPriority(
+            openr::thrift::Platform_constants::kUnknowProtAdminDistance());
+      } else {
+        route.setPriority(routePair->second);
+      }
+    }
+    // Same route
+    auto& unicastRoutes = getMutableUnicastRoutes(route.getProtocolId());
+    if (unicastRoutes.containsRoute(route)) {
+      continue;
+    }
 
-      if (0 != err) {
-        throw fbnl::NlException(folly::sformat(
-            "Failed to delete route\n{}\nError: {}", iter->second.str(), err));
+    if (route.getDestination().first.isV6()) {
+      // We need to explicitly add new V6 routes & remove old routes
+      // With IPv6, if new route being requested has different properties
+      // (like gateway or metric or..) the existing one will not be replaced,
+      // instead a new route will be created, which may cause underlying
+      // kernel crash when releasing netdevices
+      auto oldRoute = unicastRoutes.find(route.getDestination());
+      if (oldRoute.hasValue()) {
+        toReplace.emplace_back(std::move(oldRoute).value());
+        replacementIdx.emplace_back(toAdd.size());
       }
     }
+    toAdd.emplace_back(std::move(route));
   }
 
-  // Remove route from cache
-  unicastRoutes.erase(dest);
+  RouteErrors errors;
+  std::vector<bool> skip(toAdd.size(), false);
+  const auto delStatuses = programRoutes(toReplace, false /* isAdd */);
+  for (size_t i = 0; i < toReplace.size(); ++i) {
+    if (delStatuses[i] != 0) {
+      errors.add(folly::sformat(
+          "Failed to delete route\n{}\nError: {}",
+          toReplace[i].str(),
+          delStatuses[i]));
+      skip[replacementIdx[i]] = true;
+    }
+  }
 
-  // Add new route
-  int err{0};
+  std::vector<Route> newRoutes;
+  newRoutes.reserve(toAdd.size());
+  for (size_t i = 0; i < toAdd.size(); ++i) {
+    if (skip[i]) {
+      continue;
+    }
+    // Remove route from cache
+    getMutableUnicastRoutes(toAdd[i].getProtocolId())
+        .erase(toAdd[i].getDestination());
+    newRoutes.emplace_back(std::move(toAdd[i]));
+  }
+
+  // Add new routes
+  const auto addStatuses = programRoutes(newRoutes, true /* isAdd */);
+  for (size_t i = 0; i < newRoutes.size(); ++i) {
+    if (addStatuses[i] != 0) {
+      errors.add(folly::sformat(
+          "Could not add route\n{}\nError: {}",
+          newRoutes[i].str(),
+          addStatuses[i]));
+      continue;
+    }
+    // Add route entry in cache on successful addition
+    getMutableUnicastRoutes(newRoutes[i].getProtocolId()).insert(newRoutes[i]);
+  }
+  errors.throwIfAny(newRoutes.size() + toReplace.size());
+}
 
-  err = static_cast<int>(nlSock_->addRoute(route));
+std::vector<int>
+NetlinkSocket::programRoutes(const std::vector<Route>& routes, bool isAdd) {
+  if (routes.empty()) {
+    return {};
+  }
 
-  if (0 != err) {
-    throw fbnl::NlException(
-        folly::sformat("Could not add route\n{}\nError: {}", route.str(), err));
+  auto future = isAdd ? nlSock_->addRoutesAsync(routes)
+                      : nlSock_->deleteRoutesAsync(routes);
+  // Each request expires on its own deadline once sent, so the future always
+  // completes. Bound the wait in case the netlink event loop is not running
+  const int64_t numWindows = 1 + routes.size() / kMaxNlInflightMsg;
+  future.wait(kNlRequestTimeout * numWindows);
+  if (!future.isReady()) {
+    throw fbnl::NlException(folly::sformat(
+        "Timed out {} {} routes",
+        isAdd ? "adding" : "deleting",
+        routes.size()));
   }
 
-  // Add route entry in cache on successful addition
-  unicastRoutes.emplace(std::make_pair(dest, std::move(route)));
+  auto statuses = std::move(future).get();
+  for (auto& status : statuses) {
+    // Same errors as ignored by synchronous addRoute/deleteRoute
+    const int err = std::abs(status);
+    if (err == EEXIST || (!isAdd && (err == ESRCH || err == EINVAL))) {
+      status = 0;
+    }
+  }
+  return statuses;
+}
+
+void
+NetlinkSocket::RouteErrors::add(std::string error) {
+  if (numErrors++ == 0) {
+    firstError = std::move(error);
+  }
+}
+
+void
+NetlinkSocket::RouteErrors::throwIfAny(size_t numRequests) const {
+  if (numErrors == 0) {
+    return;
+  }
+  if (numRequests == 1) {
+    throw fbnl::NlException(firstError);
+  }
+  throw fbnl::NlException(folly::sformat(
+      "{} of {} route requests failed. First failure: {}",
+      numErrors,
+      numRequests,
+      firstError));
 }
 
 folly::Future<folly::Unit>
@@ -512,6 +671,27 @@ NetlinkSocket::delRoute(Route route) {
   return future;
 }
 
+folly::Future<folly::Unit>
+NetlinkSocket::delRoutes(std::vector<Route> routes) {
+  VLOG(3) << "NetlinkSocket deleting " << routes.size() << " unicast routes";
+
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+
+  evl_->runImmediatelyOrInEventLoop(
+      [this, p = std::move(promise), rs = std::move(routes)]() mutable {
+        try {
+          doDeleteUnicastRoutes(std::move(rs));
+          p.setValue();
+        } catch (std::exception const& ex) {
+          LOG(ERROR) << "Error deleting routes. Error: "
+                     << folly::exceptionStr(ex);
+          p.setException(ex);
+        }
+      });
+  return future;
+}
+
 void
 NetlinkSocket::checkUnicastRoute(const Route& route) {
   const auto& prefix = route.getDestination();
@@ -574,28 +754,44 @@ NetlinkSocket::doAddUpdateMplsRoute(Route mplsRoute) {
 
 void
 NetlinkSocket::doDeleteUnicastRoute(Route route) {
-  checkUnicastRoute(route);
+  std::vector<Route> routes;
+  routes.emplace_back(std::move(route));
+  doDeleteUnicastRoutes(std::move(routes));
+}
 
-  const auto& prefix = route.getDestination();
-  auto& unicastRoutes = unicastRoutesCache_[route.getProtocolId()];
-  if (unicastRoutes.count(prefix) == 0) {
-    LOG(ERROR) << "Trying to delete non-existing prefix "
-               << folly::IPAddress::networkToString(prefix);
-    return;
+void
+NetlinkSocket::doDeleteUnicastRoutes(std::vector<Route> routes) {
+  for (const auto& route : routes) {
+    checkUnicastRoute(route);
   }
 
-  int err{0};
-
-  err = static_cast<int>(nlSock_->deleteRoute(route));
-  if (err != 0) {
-    throw fbnl::NlException(folly::sformat(
-        "Failed to delete route {} Error: {}",
-        folly::IPAddress::networkToString(route.getDestination()),
-        err));
+  std::vector<Route> toDelete;
+  toDelete.reserve(routes.size());
+  for (auto& route : routes) {
+    const auto& prefix = route.getDestination();
+    if (!getMutableUnicastRoutes(route.getProtocolId()).contains(prefix)) {
+      LOG(ERROR) << "Trying to delete non-existing prefix "
+                 << folly::IPAddress::networkToString(prefix);
+      continue;
+    }
+    toDelete.emplace_back(std::move(route));
   }
 
-  // Update local cache with removed prefix
-  unicastRoutes.erase(route.getDestination());
+  RouteErrors errors;
+  const auto statuses = programRoutes(toDelete, false /* isAdd */);
+  for (size_t i = 0; i < toDelete.size(); ++i) {
+    const auto& prefix = toDelete[i].getDestination();
+    if (statuses[i] != 0) {
+      errors.add(folly::sformat(
+          "Failed to delete route {} Error: {}",
+          folly::IPAddress::networkToString(prefix),
+          statuses[i]));
+      continue;
+    }
+    // Update local cache with removed prefix
+    getMutableUnicastRoutes(toDelete[i].getProtocolId()).erase(prefix);
+  }
+  errors.throwIfAny(toDelete.size());
 }
 
 void
@@ -618,10 +814,7 @@ NetlinkSocket::doAddMulticastRoute(Route route) {
       << "Adding multicast route: " << folly::IPAddress::networkToString(prefix)
       << " for interface: " << ifName;
 
-  int err{0};
-
-  err = static_cast<int>(nlSock_->addRoute(route));
-
+  const int err = programRoutes({route}, true /* isAdd */).at(0);
   if (err != 0) {
     throw fbnl::NlException(folly::sformat(
         "Failed to add multicast route {} Error: {}",
@@ -667,9 +860,7 @@ NetlinkSocket::doDeleteMulticastRoute(Route route) {
           << folly::IPAddress::networkToString(prefix)
           << " for interface: " << ifName;
 
-  int err{0};
-
-  err = static_cast<int>(nlSock_->deleteRoute(iter->second));
+  const int err = programRoutes({iter->second}, false /* isAdd */).at(0);
   if (err != 0) {
     throw fbnl::NlException(folly::sformat(
         "Failed to delete multicast route {} Error: {}",
@@ -707,31 +898,36 @@ NetlinkSocket::syncUnicastRoutes(
 
 void
 NetlinkSocket::doSyncUnicastRoutes(uint8_t protocolId, NlUnicastRoutes syncDb) {
-  auto& unicastRoutes = unicastRoutesCache_[protocolId];
+  auto& unicastRoutes = getMutableUnicastRoutes(protocolId);
 
   // Go over routes that are not in new routeDb, delete
-  std::unordered_set<folly::CIDRNetwork> toDelete;
-  for (auto const& kv : unicastRoutes) {
-    if (syncDb.find(kv.first) == syncDb.end()) {
-      toDelete.insert(kv.first);
+  std::vector<folly::CIDRNetwork> toDelete;
+  for (auto const& prefix : unicastRoutes.getPrefixes()) {
+    if (syncDb.find(prefix) == syncDb.end()) {
+      toDelete.emplace_back(prefix);
     }
   }
   // Delete routes from kernel
   LOG(INFO) << "Sync: number of routes to delete: " << toDelete.size();
-  for (auto it = toDelete.begin(); it != toDelete.end(); ++it) {
-    auto const& prefix = *it;
-    auto iter = unicastRoutes.find(prefix);
-    if (iter == unicastRoutes.end()) {
+  std::vector<Route> routesToDelete;
+  routesToDelete.reserve(toDelete.size());
+  for (auto const& prefix : toDelete) {
+    auto route = unicastRoutes.find(prefix);
+    if (!route.hasValue()) {
       continue;
     }
-    doDeleteUnicastRoute(iter->second);
+    routesToDelete.emplace_back(std::move(route).value());
   }
+  doDeleteUnicastRoutes(std::move(routesToDelete));
 
   // Go over routes in new routeDb, update/add
   LOG(INFO) << "Sync: number of routes to add: " << syncDb.size();
+  std::vector<Route> routesToAdd;
+  routesToAdd.reserve(syncDb.size());
   for (auto& kv : syncDb) {
-    doAddUpdateUnicastRoute(kv.second);
+    routesToAdd.emplace_back(std::move(kv.second));
   }
+  doAddUpdateUnicastRoutes(std::move(routesToAdd));
 }
 
 folly::Future<folly::Unit>
@@ -764,42 +960,57 @@ NetlinkSocket::doSyncLinkRoutes(uint8_t protocolId, NlLinkRoutes syncDb) {
       toDel.emplace_back(route.first);
     }
   }
+  std::vector<std::pair<folly::CIDRNetwork, std::string>> keysToDel;
+  std::vector<Route> routesToDel;
   for (const auto& routeToDel : toDel) {
     auto iter = linkRoutes.find(routeToDel);
     if (iter == linkRoutes.end()) {
       continue;
     }
-
-    int err{0};
-
-    err = static_cast<int>(nlSock_->deleteRoute(iter->second));
-
-    if (err != 0) {
-      throw fbnl::NlException(folly::sformat(
-          "Could not del link Route to: {} dev {} Error: {}",
-          folly::IPAddress::networkToString(routeToDel.first),
-          routeToDel.second,
-          err));
-    }
+    keysToDel.emplace_back(routeToDel);
+    routesToDel.emplace_back(iter->second);
   }
 
+  std::vector<std::pair<folly::CIDRNetwork, std::string>> keysToAdd;
+  std::vector<Route> routesToAdd;
   for (auto& routeToAdd : syncDb) {
     if (linkRoutes.count(routeToAdd.first)) {
       continue;
     }
+    keysToAdd.emplace_back(routeToAdd.first);
+    routesToAdd.emplace_back(routeToAdd.second);
+  }
 
-    int err{0};
-
-    err = static_cast<int>(nlSock_->addRoute(routeToAdd.second));
+  RouteErrors errors;
+  const auto delStatuses = programRoutes(routesToDel, false /* isAdd */);
+  for (size_t i = 0; i < routesToDel.size(); ++i) {
+    const auto& key = keysToDel[i];
+    if (delStatuses[i] != 0) {
+      errors.add(folly::sformat(
+          "Could not del link Route to: {} dev {} Error: {}",
+          folly::IPAddress::networkToString(key.first),
+          key.second,
+          delStatuses[i]));
+      continue;
+    }
+    linkRoutes.erase(key);
+  }
 
-    if (err != 0) {
-      throw fbnl::NlException(folly::sformat(
+  const auto addStatuses = programRoutes(routesToAdd, true /* isAdd */);
+  for (size_t i = 0; i < routesToAdd.size(); ++i) {
+    if (addStatuses[i] != 0) {
+      errors.add(folly::sformat(
           "Could not add link Route to: {} dev {} Error: {}",
-          folly::IPAddress::networkToString(routeToAdd.first.first),
-          routeToAdd.first.second,
-          err));
+          folly::IPAddress::networkToString(keysToAdd[i].first),
+          keysToAdd[i].second,
+          addStatuses[i]));
+      continue;
     }
+    linkRoutes.emplace(keysToAdd[i], std::move(routesToAdd[i]));
   }
+  // On failure cache only holds changes kernel accepted
+  errors.throwIfAny(routesToDel.size() + routesToAdd.size());
+
   linkRoutes.swap(syncDb);
 }
 
@@ -814,7 +1025,7 @@ NetlinkSocket::getCachedUnicastRoutes(uint8_t protocolId) const {
       [this, p = std::move(promise), protocolId]() mutable {
         auto iter = unicastRoutesCache_.find(protocolId);
         if (iter != unicastRoutesCache_.end()) {
-          p.setValue(iter->second);
+          p.setValue(iter->second->toRoutes());
         } else {
           p.setValue(NlUnicastRoutes{});
         }
@@ -822,6 +1033,37 @@ NetlinkSocket::getCachedUnicastRoutes(uint8_t protocolId) const {
   return future;
 }
 
+folly::Future<std::shared_ptr<const UnicastRouteCache>>
+NetlinkSocket::getCachedUnicastRoutesView(uint8_t protocolId) const {
+  VLOG(3) << "NetlinkSocket getCachedUnicastRoutesView by protocol "
+          << (int)protocolId;
+  folly::Promise<std::shared_ptr<const UnicastRouteCache>> promise;
+  auto future = promise.getFuture();
+
+  evl_->runImmediatelyOrInEventLoop(
+      [this, p = std::move(promise), protocolId]() mutable {
+        auto iter = unicastRoutesCache_.find(protocolId);
+        if (iter != unicastRoutesCache_.end()) {
+          p.setValue(iter->second);
+        } else {
+          p.setValue(std::make_shared<const UnicastRouteCache>());
+        }
+      });
+  return future;
+}
+
+UnicastRouteCache&
+NetlinkSocket::getMutableUnicastRoutes(uint8_t protocolId) {
+  auto& cache = unicastRoutesCache_[protocolId];
+  if (!cache) {
+    cache = std::make_shared<UnicastRouteCache>();
+  } else if (cache.use_count() > 1) {
+    // Snapshot is held by a reader. Leave it untouched and modify a copy
+    cache = std::make_shared<UnicastRouteCache>(*cache);
+  }
+  return *cache;
+}
+
 folly::Future<NlMulticastRoutes>
 NetlinkSocket::getCachedMulticastRoutes(uint8_t protocolId) const {
   VLOG(3) << "NetlinkSocket getCachedMulticastRoutes by protocol "
@@ -861,6 +1103,11 @@ NetlinkSocket::getCachedLinkRoutes(uint8_t protocolId) const {
   return future;
 }
 
+std::map<std::string, int64_t>
+NetlinkSocket::getProtocolSocketCounters() const {
+  return nlSock_->getCounters();
+}
+
 folly::Future<int64_t>
 NetlinkSocket::getRouteCount() const {
   VLOG(3) << "NetlinkSocket get routes number";
@@ -871,7 +1118,7 @@ NetlinkSocket::getRouteCount() const {
   evl_->runImmediatelyOrInEventLoop([this, p = std::move(promise)]() mutable {
     int64_t count = 0;
     for (const auto& routes : unicastRoutesCache_) {
-      count += routes.second.size();
+      count += routes.second->size();
     }
     p.setValue(count);
   });
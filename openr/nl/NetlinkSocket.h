@@ -14,6 +14,7 @@
 #include <folly/String.h>
 #include <folly/futures/Future.h>
 #include <openr/nl/NetlinkMessage.h>
+#include <openr/nl/NetlinkRouteCache.h>
 #include <openr/nl/NetlinkTypes.h>
 
 namespace openr {
@@ -185,6 +186,14 @@ class NetlinkSocket {
    */
   virtual folly::Future<folly::Unit> addRoute(Route route);
 
+  /**
+   * Add/Update a batch of unicast routes, see addRoute(). All routes are
+   * sent to kernel in one ack-windowed request and local cache is updated
+   * for every route kernel accepted
+   * @throws fbnl::NlException if any of the routes failed
+   */
+  virtual folly::Future<folly::Unit> addRoutes(std::vector<Route> routes);
+
   /**
    * Add MPLS label route, nexthop semantics is same as route nexthop
    */
@@ -200,6 +209,12 @@ class NetlinkSocket {
    */
   virtual folly::Future<folly::Unit> delRoute(Route route);
 
+  /**
+   * Delete a batch of unicast routes, see delRoute() and addRoutes()
+   * @throws fbnl::NlException if any of the routes failed
+   */
+  virtual folly::Future<folly::Unit> delRoutes(std::vector<Route> routes);
+
   /**
    * delete MPLS route. Only label is needed to delete the label route
    */
@@ -238,6 +253,15 @@ class NetlinkSocket {
   virtual folly::Future<NlUnicastRoutes> getCachedUnicastRoutes(
       uint8_t protocolId) const;
 
+  /**
+   * Get read-only snapshot of cached unicast routes by protocol ID. Snapshot
+   * is shared with the cache (no copy) and stays valid and unchanged while
+   * held; cache is copied on next write if snapshot is still referenced.
+   * Prefer this over `getCachedUnicastRoutes` for large route tables.
+   */
+  virtual folly::Future<std::shared_ptr<const UnicastRouteCache>>
+  getCachedUnicastRoutesView(uint8_t protocolId) const;
+
   /**
    * Get cached MPLS routes by protocol ID
    * @throws fbnl::NlException
@@ -245,6 +269,14 @@ class NetlinkSocket {
   virtual folly::Future<NlMplsRoutes> getCachedMplsRoutes(
       uint8_t protocolId) const;
 
+  /**
+   * Get at most `limit` cached MPLS routes by protocol ID with top label
+   * greater than or equal to `startLabel`, in increasing label order. Meant
+   * for paginated readers, only the requested page is copied out of cache.
+   */
+  virtual folly::Future<std::vector<Route>> getCachedMplsRoutesPage(
+      uint8_t protocolId, int32_t startLabel, size_t limit) const;
+
   /**
    * Get cached multicast routing by protocol ID
    * @throws fbnl::NlException
@@ -271,6 +303,11 @@ class NetlinkSocket {
    */
   virtual folly::Future<int64_t> getMplsRouteCount() const;
 
+  /**
+   * Get counters of the underlying netlink protocol socket
+   */
+  virtual std::map<std::string, int64_t> getProtocolSocketCounters() const;
+
   /**
    * Add Interface address e.g. ip addr add 192.168.1.1/24 dev em1
    * @throws fbnl::NlException
@@ -386,8 +423,29 @@ class NetlinkSocket {
 
   void doAddUpdateUnicastRoute(Route route);
 
+  void doAddUpdateUnicastRoutes(std::vector<Route> routes);
+
   void doDeleteUnicastRoute(Route route);
 
+  void doDeleteUnicastRoutes(std::vector<Route> routes);
+
+  // Add or delete routes in kernel with a single bulk request and wait for
+  // it. Returns status of each route (0 or -errno) with errors that are
+  // harmless for the operation (e.g. EEXIST) already cleared
+  std::vector<int> programRoutes(const std::vector<Route>& routes, bool isAdd);
+
+  // Failures of a bulk route operation. Reported after every route has been
+  // processed so that local cache reflects whatever kernel accepted
+  struct RouteErrors {
+    void add(std::string error);
+
+    // @throws fbnl::NlException if any error was added
+    void throwIfAny(size_t numRequests) const;
+
+    size_t numErrors{0};
+    std::string firstError;
+  };
+
   void doAddUpdateMplsRoute(Route route);
 
   void doDeleteMplsRoute(Route route);
@@ -398,6 +456,10 @@ class NetlinkSocket {
 
   void doSyncUnicastRoutes(uint8_t protocolId, NlUnicastRoutes syncDb);
 
+  // Get unicast route cache of protocol for modification. Cache is cloned
+  // first if snapshot of it is still held by a reader
+  UnicastRouteCache& getMutableUnicastRoutes(uint8_t protocolId);
+
   void doSyncLinkRoutes(uint8_t protocolId, NlLinkRoutes syncDb);
 
   void checkMulticastRoute(const Route& route);
@@ -425,9 +487,11 @@ class NetlinkSocket {
 
   /**
    * Local cache. We do not use this to enforce any checks
-   * for incoming requests. Merely an optimization for get cached routes
+   * for incoming requests. Merely an optimization for get cached routes.
+   * Stored in compact form and shared copy-on-write with readers.
    */
-  NlUnicastRoutesDb unicastRoutesCache_;
+  std::unordered_map<uint8_t, std::shared_ptr<UnicastRouteCache>>
+      unicastRoutesCache_;
 
   /**
    * MPLS label route cache
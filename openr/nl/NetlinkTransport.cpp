@@ -0,0 +1,49 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "openr/nl/NetlinkTransport.h"
+
+#include <unistd.h>
+
+namespace openr {
+namespace fbnl {
+
+int
+NetlinkTransport::socket(int domain, int type, int protocol) {
+  return ::socket(domain, type, protocol);
+}
+
+int
+NetlinkTransport::setsockopt(
+    int sockfd, int level, int optname, const void* optval, socklen_t optlen) {
+  return ::setsockopt(sockfd, level, optname, optval, optlen);
+}
+
+int
+NetlinkTransport::bind(
+    int sockfd, const struct sockaddr* addr, socklen_t addrlen) {
+  return ::bind(sockfd, addr, addrlen);
+}
+
+ssize_t
+NetlinkTransport::sendmsg(int sockfd, const struct msghdr* msg, int flags) {
+  return ::sendmsg(sockfd, msg, flags);
+}
+
+int
+NetlinkTransport::recvmmsg(
+    int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  return ::recvmmsg(sockfd, msgvec, vlen, flags, nullptr);
+}
+
+int
+NetlinkTransport::close(int fd) {
+  return ::close(fd);
+}
+
+} // namespace fbnl
+} // namespace openr
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+namespace openr {
+namespace fbnl {
+
+//
+// Transport underneath NetlinkProtocolSocket. It wraps the syscalls used to
+// talk to the kernel so that they can be replaced in tests and benchmarks
+// (see FakeNetlinkTransport). The default version simply forwards to the
+// system implementation
+//
+class NetlinkTransport {
+ public:
+  NetlinkTransport() = default;
+  virtual ~NetlinkTransport() {}
+
+  virtual int socket(int domain, int type, int protocol);
+
+  virtual int setsockopt(
+      int sockfd, int level, int optname, const void* optval, socklen_t optlen);
+
+  virtual int bind(int sockfd, const struct sockaddr* addr, socklen_t addrlen);
+
+  virtual ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags);
+
+  virtual int recvmmsg(
+      int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags);
+
+  virtual int close(int fd);
+
+ private:
+  NetlinkTransport(NetlinkTransport const&) = delete;
+  NetlinkTransport& operator=(NetlinkTransport const&) = delete;
+};
+
+} // namespace fbnl
+} // namespace openr
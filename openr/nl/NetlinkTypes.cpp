@@ -480,6 +480,11 @@ Route::setPriority(uint32_t priority) {
   priority_ = priority;
 }
 
+void
+Route::setDestination(const folly::CIDRNetwork& dst) {
+  dst_ = dst;
+}
+
 /*=================================NextHop====================================*/
 
 NextHop
@@ -319,6 +319,8 @@ class Route final {
 
   void setPriority(uint32_t priority);
 
+  void setDestination(const folly::CIDRNetwork& dst);
+
   std::string str() const;
 
  private:
@@ -0,0 +1,309 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "openr/nl/tests/FakeNetlinkTransport.h"
+
+#include <linux/rtnetlink.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <folly/String.h>
+#include <glog/logging.h>
+
+#include <openr/nl/NetlinkMessage.h>
+
+namespace openr {
+namespace fbnl {
+
+namespace {
+// socket buffer size for both ends of the socketpair
+constexpr int kFakeSockBufSize{4 * 1024 * 1024};
+} // namespace
+
+FakeNetlinkTransport::FakeNetlinkTransport() {
+  if (::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds_) != 0) {
+    LOG(FATAL) << "Failed to create socketpair: " << folly::errnoStr(errno);
+  }
+  for (auto fd : fds_) {
+    int size = kFakeSockBufSize;
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+  }
+  responderThread_ = std::thread([this]() { run(); });
+}
+
+FakeNetlinkTransport::~FakeNetlinkTransport() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    isRunning_ = false;
+  }
+  cv_.notify_all();
+  responderThread_.join();
+  ::close(fds_[0]);
+  ::close(fds_[1]);
+}
+
+int
+FakeNetlinkTransport::socket(
+    int /* domain */, int /* type */, int /* protocol */) {
+  return fds_[0];
+}
+
+int
+FakeNetlinkTransport::setsockopt(
+    int /* sockfd */,
+    int /* level */,
+    int /* optname */,
+    const void* /* optval */,
+    socklen_t /* optlen */) {
+  return 0;
+}
+
+int
+FakeNetlinkTransport::bind(
+    int /* sockfd */,
+    const struct sockaddr* /* addr */,
+    socklen_t /* addrlen */) {
+  return 0;
+}
+
+ssize_t
+FakeNetlinkTransport::sendmsg(
+    int /* sockfd */, const struct msghdr* msg, int /* flags */) {
+  ssize_t bytes{0};
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto dueTime = std::chrono::steady_clock::now() + latency_;
+  // every iovec carries exactly one netlink request
+  for (size_t i = 0; i < msg->msg_iovlen; ++i) {
+    const auto& iov = msg->msg_iov[i];
+    pendingRequests_.emplace_back(PendingRequest{
+        dueTime, std::string(static_cast<const char*>(iov.iov_base),
+                             iov.iov_len)});
+    bytes += iov.iov_len;
+  }
+  cv_.notify_one();
+  return bytes;
+}
+
+int
+FakeNetlinkTransport::close(int fd) {
+  // socketpair is owned and closed by us
+  return fd == fds_[0] ? 0 : ::close(fd);
+}
+
+void
+FakeNetlinkTransport::setResponseLatency(std::chrono::microseconds latency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  latency_ = latency;
+}
+
+void
+FakeNetlinkTransport::setErrorInjector(
+    std::function<int(const struct nlmsghdr&)> injector) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  errorInjector_ = std::move(injector);
+}
+
+void
+FakeNetlinkTransport::setDumpDatagramSize(size_t size) {
+  dumpDatagramSize_ = size;
+}
+
+size_t
+FakeNetlinkTransport::getRouteCount() const {
+  return routeCount_;
+}
+
+size_t
+FakeNetlinkTransport::getRequestCount() const {
+  return requestCount_;
+}
+
+void
+FakeNetlinkTransport::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() {
+      return !isRunning_ || !pendingRequests_.empty();
+    });
+    if (!isRunning_) {
+      break;
+    }
+    const auto dueTime = pendingRequests_.front().dueTime;
+    if (dueTime > std::chrono::steady_clock::now()) {
+      cv_.wait_until(lock, dueTime);
+      continue;
+    }
+    auto request = std::move(pendingRequests_.front().request);
+    pendingRequests_.pop_front();
+    auto injector = errorInjector_;
+
+    lock.unlock();
+    const auto* nlh = reinterpret_cast<const struct nlmsghdr*>(request.data());
+    const int error = injector ? injector(*nlh) : 0;
+    if (error) {
+      ++requestCount_;
+      sendAck(nlh, -std::abs(error));
+    } else {
+      processRequest(request);
+    }
+    lock.lock();
+  }
+}
+
+void
+FakeNetlinkTransport::processRequest(const std::string& request) {
+  const auto* nlh = reinterpret_cast<const struct nlmsghdr*>(request.data());
+  ++requestCount_;
+
+  int error{0};
+  switch (nlh->nlmsg_type) {
+  case RTM_NEWROUTE:
+    error = addRoute(nlh);
+    break;
+  case RTM_DELROUTE:
+    error = deleteRoute(nlh);
+    break;
+  case RTM_GETROUTE:
+    sendRouteDump(nlh);
+    return;
+  case RTM_GETLINK:
+  case RTM_GETADDR:
+  case RTM_GETNEIGH: {
+    std::string buf;
+    sendDone(nlh, buf);
+    return;
+  }
+  case RTM_NEWADDR:
+  case RTM_DELADDR:
+    break;
+  default:
+    error = -EOPNOTSUPP;
+  }
+  sendAck(nlh, error);
+}
+
+std::string
+FakeNetlinkTransport::getRouteKey(const struct nlmsghdr* nlh) {
+  const auto* rtm = reinterpret_cast<const struct rtmsg*>(NLMSG_DATA(nlh));
+  std::string key;
+  key.push_back(static_cast<char>(rtm->rtm_family));
+  key.push_back(static_cast<char>(rtm->rtm_dst_len));
+  key.push_back(static_cast<char>(rtm->rtm_table));
+
+  const struct rtattr* rta = RTM_RTA(rtm);
+  int len = RTM_PAYLOAD(nlh);
+  for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    if (rta->rta_type == RTA_DST) {
+      key.append(
+          static_cast<const char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+      break;
+    }
+  }
+  return key;
+}
+
+int
+FakeNetlinkTransport::addRoute(const struct nlmsghdr* nlh) {
+  auto key = getRouteKey(nlh);
+  auto it = routes_.find(key);
+  if (it != routes_.end() && (nlh->nlmsg_flags & NLM_F_EXCL)) {
+    return -EEXIST;
+  }
+  if (it == routes_.end() && !(nlh->nlmsg_flags & NLM_F_CREATE)) {
+    return -ENOENT;
+  }
+  routes_[std::move(key)] =
+      std::string(reinterpret_cast<const char*>(nlh), nlh->nlmsg_len);
+  routeCount_ = routes_.size();
+  return 0;
+}
+
+int
+FakeNetlinkTransport::deleteRoute(const struct nlmsghdr* nlh) {
+  if (routes_.erase(getRouteKey(nlh)) == 0) {
+    return -ESRCH;
+  }
+  routeCount_ = routes_.size();
+  return 0;
+}
+
+void
+FakeNetlinkTransport::sendRouteDump(const struct nlmsghdr* nlh) {
+  const size_t datagramSize = dumpDatagramSize_;
+  std::string buf;
+  buf.reserve(datagramSize);
+  for (const auto& kv : routes_) {
+    const auto& route = kv.second;
+    if (buf.size() + NLMSG_ALIGN(route.size()) > datagramSize) {
+      writeDatagram(buf);
+      buf.clear();
+    }
+    const size_t offset = buf.size();
+    buf.append(route);
+    buf.resize(offset + NLMSG_ALIGN(route.size()), '\0');
+    auto* hdr = reinterpret_cast<struct nlmsghdr*>(&buf[offset]);
+    hdr->nlmsg_type = RTM_NEWROUTE;
+    hdr->nlmsg_flags = NLM_F_MULTI;
+    hdr->nlmsg_seq = nlh->nlmsg_seq;
+    hdr->nlmsg_pid = nlh->nlmsg_pid;
+  }
+  sendDone(nlh, buf);
+}
+
+void
+FakeNetlinkTransport::sendDone(const struct nlmsghdr* nlh, std::string& buf) {
+  const size_t len = NLMSG_SPACE(sizeof(int));
+  if (buf.size() + len > dumpDatagramSize_) {
+    writeDatagram(buf);
+    buf.clear();
+  }
+  const size_t offset = buf.size();
+  buf.resize(offset + len, '\0');
+  auto* hdr = reinterpret_cast<struct nlmsghdr*>(&buf[offset]);
+  hdr->nlmsg_len = NLMSG_LENGTH(sizeof(int));
+  hdr->nlmsg_type = NLMSG_DONE;
+  hdr->nlmsg_flags = NLM_F_MULTI;
+  hdr->nlmsg_seq = nlh->nlmsg_seq;
+  hdr->nlmsg_pid = nlh->nlmsg_pid;
+  writeDatagram(buf);
+}
+
+void
+FakeNetlinkTransport::sendAck(const struct nlmsghdr* nlh, int error) {
+  std::string buf(NLMSG_SPACE(sizeof(struct nlmsgerr)), '\0');
+  auto* hdr = reinterpret_cast<struct nlmsghdr*>(&buf[0]);
+  hdr->nlmsg_len = NLMSG_LENGTH(sizeof(struct nlmsgerr));
+  hdr->nlmsg_type = NLMSG_ERROR;
+  hdr->nlmsg_flags = 0;
+  hdr->nlmsg_seq = nlh->nlmsg_seq;
+  hdr->nlmsg_pid = nlh->nlmsg_pid;
+  // like NETLINK_CAP_ACK, only header of the request is echoed back
+  auto* err = reinterpret_cast<struct nlmsgerr*>(NLMSG_DATA(hdr));
+  err->error = error;
+  err->msg = *nlh;
+  writeDatagram(buf);
+}
+
+void
+FakeNetlinkTransport::writeDatagram(const std::string& buf) {
+  while (isRunning_) {
+    if (::send(fds_[1], buf.data(), buf.size(), MSG_DONTWAIT) >= 0) {
+      return;
+    }
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+      LOG(ERROR) << "Fake netlink transport failed to send response: "
+                 << folly::errnoStr(errno);
+      return;
+    }
+    // receiver is behind, wait for it to drain the socket
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+} // namespace fbnl
+} // namespace openr
@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <linux/netlink.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <openr/nl/NetlinkTransport.h>
+
+namespace openr {
+namespace fbnl {
+
+/**
+ * FakeNetlinkTransport stands in for the kernel rtnetlink socket so that
+ * NetlinkProtocolSocket can be tested and benchmarked without root or network
+ * namespaces.
+ *
+ * A unix datagram socketpair replaces the netlink socket. One end is handed
+ * to NetlinkProtocolSocket (via socket()) and used for polling and receiving
+ * as usual. Requests sent with sendmsg() are queued to a responder thread,
+ * which after the configured latency writes kernel-like responses onto the
+ * other end:
+ *  - RTM_NEWROUTE/RTM_DELROUTE update an in-memory route table and are acked
+ *    (EEXIST/ENOENT/ESRCH follow NLM_F_EXCL/NLM_F_CREATE semantics)
+ *  - RTM_GETROUTE dumps the route table as multipart messages
+ *  - other dumps are answered with an empty multipart reply
+ *  - address add/delete requests are simply acked
+ *
+ * Error injector, if set, is consulted for every request and a non zero
+ * errno returned by it is sent back in the ack instead of processing the
+ * request.
+ */
+class FakeNetlinkTransport final : public NetlinkTransport {
+ public:
+  FakeNetlinkTransport();
+  ~FakeNetlinkTransport() override;
+
+  //
+  // mocked syscalls
+  //
+  int socket(int domain, int type, int protocol) override;
+
+  int setsockopt(
+      int sockfd,
+      int level,
+      int optname,
+      const void* optval,
+      socklen_t optlen) override;
+
+  int bind(int sockfd, const struct sockaddr* addr, socklen_t addrlen) override;
+
+  ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags) override;
+
+  int close(int fd) override;
+
+  //
+  // fake kernel configuration and introspection
+  //
+
+  // delay between request and its response
+  void setResponseLatency(std::chrono::microseconds latency);
+
+  // return errno (positive) to fail a request, 0 to process it normally
+  void setErrorInjector(std::function<int(const struct nlmsghdr&)> injector);
+
+  // maximum size of a dump datagram, kNlRecvBufSize by default. Larger sizes
+  // make dumps truncate at the initial receive buffer size
+  void setDumpDatagramSize(size_t size);
+
+  // number of routes in fake route table
+  size_t getRouteCount() const;
+
+  // number of requests processed so far
+  size_t getRequestCount() const;
+
+ private:
+  struct PendingRequest {
+    std::chrono::steady_clock::time_point dueTime;
+    std::string request;
+  };
+
+  // responder thread main loop
+  void run();
+
+  // process one request and write its response(s)
+  void processRequest(const std::string& request);
+
+  // route table operations, return 0 or negative errno
+  int addRoute(const struct nlmsghdr* nlh);
+  int deleteRoute(const struct nlmsghdr* nlh);
+
+  // send all routes as a multipart reply to dump request
+  void sendRouteDump(const struct nlmsghdr* nlh);
+
+  // send NLMSG_DONE for dump request
+  void sendDone(const struct nlmsghdr* nlh, std::string& buf);
+
+  // send NLMSG_ERROR (ack when error is 0) for request
+  void sendAck(const struct nlmsghdr* nlh, int error);
+
+  // write one datagram to NetlinkProtocolSocket
+  void writeDatagram(const std::string& buf);
+
+  // key identifying route in fake route table
+  static std::string getRouteKey(const struct nlmsghdr* nlh);
+
+  // socketpair, [0] is handed to NetlinkProtocolSocket
+  int fds_[2]{-1, -1};
+
+  std::thread responderThread_;
+  std::atomic<bool> isRunning_{true};
+
+  // pending requests and configuration, protected by mutex_
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<PendingRequest> pendingRequests_;
+  std::chrono::microseconds latency_{0};
+  std::function<int(const struct nlmsghdr&)> errorInjector_;
+
+  // route key -> request message used to install the route. Only accessed
+  // from responder thread except for size which is mirrored in routeCount_
+  std::unordered_map<std::string, std::string> routes_;
+  std::atomic<size_t> routeCount_{0};
+  std::atomic<size_t> requestCount_{0};
+  std::atomic<size_t> dumpDatagramSize_{kNlRecvBufSize};
+};
+
+} // namespace fbnl
+} // namespace openr
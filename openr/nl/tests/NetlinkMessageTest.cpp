@@ -974,6 +974,39 @@ TEST_F(NlMessageFixture, MultipleIpRoutesLabelNexthop) {
   EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), 0);
 }
 
+TEST_F(NlMessageFixture, AsyncRoutesPerRouteStatus) {
+  // Bulk asynchronous add, more routes than ack window so that sending is
+  // driven by incoming acks. Per-route status is reported in request order
+
+  const uint32_t count{10 * fbnl::kMaxNlInflightMsg};
+  auto routes = buildV6RouteDb(count);
+  // duplicate of first route. Adds are sent with NLM_F_REPLACE so it
+  // succeeds, but its delete fails as the route is already gone
+  routes.emplace_back(routes.front());
+
+  auto statuses = nlSock->addRoutesAsync(routes).get();
+  ASSERT_EQ(routes.size(), statuses.size());
+  for (const auto status : statuses) {
+    EXPECT_EQ(0, status);
+  }
+  EXPECT_EQ(0, nlSock->getInflightCount());
+
+  auto kernelRoutes = nlSock->getAllRoutes();
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), count + 1);
+
+  // delete all routes, second delete of duplicate fails with ESRCH
+  statuses = nlSock->deleteRoutesAsync(routes).get();
+  ASSERT_EQ(routes.size(), statuses.size());
+  for (uint32_t i = 0; i < count; i++) {
+    EXPECT_EQ(0, statuses.at(i));
+  }
+  EXPECT_EQ(-ESRCH, statuses.back());
+  EXPECT_EQ(0, nlSock->getInflightCount());
+
+  kernelRoutes = nlSock->getAllRoutes();
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), 0);
+}
+
 TEST_F(NlMessageFixture, LabelRouteV4Nexthop) {
   // Add label route with single path label with PHP nexthop
 
@@ -0,0 +1,294 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <array>
+#include <memory>
+#include <thread>
+
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+
+#include <openr/nl/NetlinkMessage.h>
+#include <openr/nl/NetlinkSocket.h>
+#include <openr/nl/NetlinkTypes.h>
+#include <openr/nl/tests/FakeNetlinkTransport.h>
+
+DEFINE_int32(
+    fake_nl_latency_us, 0, "Response latency of fake netlink transport");
+DEFINE_int32(num_nexthops, 4, "Number of ECMP nexthops per route");
+DEFINE_int32(num_labels, 3, "Size of MPLS label stack pushed per nexthop");
+
+using namespace openr::fbnl;
+
+namespace {
+const uint8_t kRouteProtoId = 99;
+const int kIfIndex{2};
+// first label of label routes
+const uint32_t kBaseLabel{100000};
+
+NextHop
+buildNextHop(uint32_t index, bool pushLabels) {
+  NextHopBuilder nhBuilder;
+  nhBuilder.setGateway(folly::IPAddress(folly::sformat("fe80::{}", index + 1)))
+      .setIfIndex(kIfIndex);
+  if (pushLabels) {
+    std::vector<int32_t> labels;
+    for (int32_t l = 0; l < FLAGS_num_labels; l++) {
+      labels.emplace_back(kBaseLabel + index * FLAGS_num_labels + l);
+    }
+    nhBuilder.setPushLabels(labels).setLabelAction(
+        openr::thrift::MplsActionCode::PUSH);
+  }
+  return nhBuilder.build();
+}
+
+// IPv6 unicast routes with ECMP nexthops pushing label stacks
+std::vector<Route>
+buildUnicastRoutes(uint32_t count) {
+  std::vector<NextHop> nextHops;
+  for (int32_t i = 0; i < FLAGS_num_nexthops; i++) {
+    nextHops.emplace_back(buildNextHop(i, FLAGS_num_labels > 0));
+  }
+
+  std::vector<Route> routes;
+  routes.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    std::array<uint8_t, 16> bytes{0xfc, 0x00};
+    bytes[4] = (i >> 24) & 0xff;
+    bytes[5] = (i >> 16) & 0xff;
+    bytes[6] = (i >> 8) & 0xff;
+    bytes[7] = i & 0xff;
+    RouteBuilder builder;
+    builder.setDestination({folly::IPAddressV6(bytes), 64})
+        .setProtocolId(kRouteProtoId)
+        .setValid(true);
+    for (const auto& nh : nextHops) {
+      builder.addNextHop(nh);
+    }
+    routes.emplace_back(builder.build());
+  }
+  return routes;
+}
+
+// MPLS label routes with ECMP swap nexthops
+std::vector<Route>
+buildLabelRoutes(uint32_t count) {
+  std::vector<NextHop> nextHops;
+  for (int32_t i = 0; i < FLAGS_num_nexthops; i++) {
+    NextHopBuilder nhBuilder;
+    nhBuilder.setGateway(folly::IPAddress(folly::sformat("fe80::{}", i + 1)))
+        .setIfIndex(kIfIndex)
+        .setSwapLabel(kBaseLabel + i)
+        .setLabelAction(openr::thrift::MplsActionCode::SWAP);
+    nextHops.emplace_back(nhBuilder.build());
+  }
+
+  std::vector<Route> routes;
+  routes.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    RouteBuilder builder;
+    // stay within 20 bit label space
+    builder.setMplsLabel(16 + (i % 0xFFF00))
+        .setProtocolId(kRouteProtoId)
+        .setValid(true);
+    for (const auto& nh : nextHops) {
+      builder.addNextHop(nh);
+    }
+    routes.emplace_back(builder.build());
+  }
+  return routes;
+}
+} // namespace
+
+namespace openr {
+
+// NetlinkProtocolSocket running over fake transport in its own event loop
+class NetlinkProtocolSocketWrapper {
+ public:
+  NetlinkProtocolSocketWrapper()
+      : fakeTransport(std::make_shared<fbnl::FakeNetlinkTransport>()) {
+    fakeTransport->setResponseLatency(
+        std::chrono::microseconds(FLAGS_fake_nl_latency_us));
+    auto nlProtocolSocket =
+        std::make_unique<fbnl::NetlinkProtocolSocket>(&evl, fakeTransport);
+    nlSock = nlProtocolSocket.get();
+    eventThread = std::thread([&, sock = nlProtocolSocket.get()]() {
+      sock->init();
+      evl.run();
+    });
+    evl.waitUntilRunning();
+    nlProtocolSocket_ = std::move(nlProtocolSocket);
+  }
+
+  ~NetlinkProtocolSocketWrapper() {
+    if (evl2Thread.joinable()) {
+      evl2.stop();
+      evl2Thread.join();
+    }
+    evl.stop();
+    eventThread.join();
+    // NetlinkSocket owns protocol socket once created
+    nlSocket.reset();
+    nlProtocolSocket_.reset();
+  }
+
+  // Create NetlinkSocket on top of the protocol socket
+  void
+  createNetlinkSocket() {
+    evl2Thread = std::thread([&]() { evl2.run(); });
+    evl2.waitUntilRunning();
+    nlSocket = std::make_unique<fbnl::NetlinkSocket>(
+        &evl2, nullptr, std::move(nlProtocolSocket_));
+  }
+
+  fbzmq::ZmqEventLoop evl;
+  fbzmq::ZmqEventLoop evl2;
+  std::thread eventThread;
+  std::thread evl2Thread;
+  std::shared_ptr<fbnl::FakeNetlinkTransport> fakeTransport;
+  fbnl::NetlinkProtocolSocket* nlSock{nullptr};
+  std::unique_ptr<fbnl::NetlinkSocket> nlSocket;
+
+ private:
+  std::unique_ptr<fbnl::NetlinkProtocolSocket> nlProtocolSocket_;
+};
+
+/**
+ * Benchmark bulk add of unicast routes with ECMP label push nexthops
+ * 1. Create NetlinkProtocolSocket over fake transport
+ * 2. Generate routes
+ * 3. Add routes in bulk and wait for all acks
+ */
+static void
+BM_NetlinkAddUnicastRoutes(uint32_t iters, size_t numOfRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkProtocolSocketWrapper>();
+  const auto routes = buildUnicastRoutes(numOfRoutes);
+
+  for (uint32_t i = 0; i < iters; i++) {
+    suspender.dismiss(); // Start measuring benchmark time
+    CHECK(ResultCode::SUCCESS == wrapper->nlSock->addRoutes(routes));
+    suspender.rehire(); // Stop measuring time again
+    CHECK(ResultCode::SUCCESS == wrapper->nlSock->deleteRoutes(routes));
+  }
+}
+
+/**
+ * Benchmark bulk delete of unicast routes
+ */
+static void
+BM_NetlinkDeleteUnicastRoutes(uint32_t iters, size_t numOfRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkProtocolSocketWrapper>();
+  const auto routes = buildUnicastRoutes(numOfRoutes);
+
+  for (uint32_t i = 0; i < iters; i++) {
+    CHECK(ResultCode::SUCCESS == wrapper->nlSock->addRoutes(routes));
+    suspender.dismiss(); // Start measuring benchmark time
+    CHECK(ResultCode::SUCCESS == wrapper->nlSock->deleteRoutes(routes));
+    suspender.rehire(); // Stop measuring time again
+  }
+}
+
+/**
+ * Benchmark bulk add of MPLS label routes with ECMP swap nexthops
+ */
+static void
+BM_NetlinkAddMplsRoutes(uint32_t iters, size_t numOfRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkProtocolSocketWrapper>();
+  const auto routes = buildLabelRoutes(numOfRoutes);
+
+  for (uint32_t i = 0; i < iters; i++) {
+    suspender.dismiss(); // Start measuring benchmark time
+    CHECK(ResultCode::SUCCESS == wrapper->nlSock->addRoutes(routes));
+    suspender.rehire(); // Stop measuring time again
+    CHECK(ResultCode::SUCCESS == wrapper->nlSock->deleteRoutes(routes));
+  }
+}
+
+/**
+ * Benchmark route table dump
+ */
+static void
+BM_NetlinkGetAllRoutes(uint32_t iters, size_t numOfRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkProtocolSocketWrapper>();
+  const auto routes = buildUnicastRoutes(numOfRoutes);
+  CHECK(ResultCode::SUCCESS == wrapper->nlSock->addRoutes(routes));
+
+  for (uint32_t i = 0; i < iters; i++) {
+    suspender.dismiss(); // Start measuring benchmark time
+    auto kernelRoutes = wrapper->nlSock->getAllRoutes();
+    suspender.rehire(); // Stop measuring time again
+    CHECK_EQ(numOfRoutes, kernelRoutes.size());
+  }
+}
+
+/**
+ * Benchmark NetlinkSocket::syncUnicastRoutes
+ * 1. Create NetlinkSocket over fake transport
+ * 2. Sync full route table into empty kernel
+ * 3. Sync again with half of the routes replaced
+ */
+static void
+BM_NetlinkSyncUnicastRoutes(uint32_t iters, size_t numOfRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkProtocolSocketWrapper>();
+  wrapper->createNetlinkSocket();
+  const auto routes = buildUnicastRoutes(numOfRoutes * 3 / 2);
+
+  fbnl::NlUnicastRoutes routeDb1;
+  fbnl::NlUnicastRoutes routeDb2;
+  for (size_t i = 0; i < routes.size(); i++) {
+    if (i < numOfRoutes) {
+      routeDb1.emplace(routes[i].getDestination(), routes[i]);
+    }
+    if (i >= numOfRoutes / 2) {
+      routeDb2.emplace(routes[i].getDestination(), routes[i]);
+    }
+  }
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto db1 = routeDb1;
+    auto db2 = routeDb2;
+    suspender.dismiss(); // Start measuring benchmark time
+    wrapper->nlSocket->syncUnicastRoutes(kRouteProtoId, std::move(db1)).get();
+    wrapper->nlSocket->syncUnicastRoutes(kRouteProtoId, std::move(db2)).get();
+    suspender.rehire(); // Stop measuring time again
+    wrapper->nlSocket->syncUnicastRoutes(kRouteProtoId, {}).get();
+  }
+}
+
+// The parameter is the number of routes
+BENCHMARK_PARAM(BM_NetlinkAddUnicastRoutes, 10000);
+BENCHMARK_PARAM(BM_NetlinkAddUnicastRoutes, 100000);
+BENCHMARK_PARAM(BM_NetlinkAddUnicastRoutes, 1000000);
+BENCHMARK_PARAM(BM_NetlinkDeleteUnicastRoutes, 10000);
+BENCHMARK_PARAM(BM_NetlinkDeleteUnicastRoutes, 100000);
+BENCHMARK_PARAM(BM_NetlinkDeleteUnicastRoutes, 1000000);
+BENCHMARK_PARAM(BM_NetlinkAddMplsRoutes, 10000);
+BENCHMARK_PARAM(BM_NetlinkAddMplsRoutes, 100000);
+BENCHMARK_PARAM(BM_NetlinkAddMplsRoutes, 1000000);
+BENCHMARK_PARAM(BM_NetlinkGetAllRoutes, 10000);
+BENCHMARK_PARAM(BM_NetlinkGetAllRoutes, 100000);
+BENCHMARK_PARAM(BM_NetlinkGetAllRoutes, 1000000);
+BENCHMARK_PARAM(BM_NetlinkSyncUnicastRoutes, 10000);
+BENCHMARK_PARAM(BM_NetlinkSyncUnicastRoutes, 100000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <array>
+#include <memory>
+#include <thread>
+
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <folly/IPAddress.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/nl/NetlinkMessage.h>
+#include <openr/nl/NetlinkRoute.h>
+#include <openr/nl/NetlinkTypes.h>
+#include <openr/nl/tests/FakeNetlinkTransport.h>
+
+extern "C" {
+#include <linux/rtnetlink.h>
+}
+
+using namespace openr;
+using namespace openr::fbnl;
+
+namespace {
+const uint8_t kRouteProtoId = 99;
+const folly::IPAddress kNextHop1{"fe80::1"};
+const folly::IPAddress kNextHop2{"fe80::2"};
+const int kIfIndex{2};
+// Short request timeout so that expiry can be tested quickly
+const std::chrono::milliseconds kRequestTimeout{500};
+
+std::vector<Route>
+buildRoutes(uint32_t count) {
+  std::vector<Route> routes;
+  routes.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    std::array<uint8_t, 16> bytes{0xfc, 0x00};
+    bytes[4] = (i >> 24) & 0xff;
+    bytes[5] = (i >> 16) & 0xff;
+    bytes[6] = (i >> 8) & 0xff;
+    bytes[7] = i & 0xff;
+    RouteBuilder builder;
+    builder.setDestination({folly::IPAddressV6(bytes), 64})
+        .setProtocolId(kRouteProtoId)
+        .setValid(true);
+    for (const auto& gw : {kNextHop1, kNextHop2}) {
+      NextHopBuilder nhBuilder;
+      nhBuilder.setGateway(gw).setIfIndex(kIfIndex);
+      builder.addNextHop(nhBuilder.build());
+    }
+    routes.emplace_back(builder.build());
+  }
+  return routes;
+}
+} // namespace
+
+class NetlinkProtocolSocketFixture : public ::testing::Test {
+ public:
+  void
+  SetUp() override {
+    fakeTransport = std::make_shared<FakeNetlinkTransport>();
+    nlSock = std::make_unique<NetlinkProtocolSocket>(
+        &evl, fakeTransport, kRequestTimeout);
+    eventThread = std::thread([&]() {
+      nlSock->init();
+      evl.run();
+    });
+    evl.waitUntilRunning();
+  }
+
+  void
+  TearDown() override {
+    evl.stop();
+    evl.waitUntilStopped();
+    eventThread.join();
+    nlSock.reset();
+    fakeTransport.reset();
+  }
+
+  fbzmq::ZmqEventLoop evl;
+  std::thread eventThread;
+  std::shared_ptr<FakeNetlinkTransport> fakeTransport;
+  std::unique_ptr<NetlinkProtocolSocket> nlSock;
+};
+
+TEST_F(NetlinkProtocolSocketFixture, AddDeleteDumpRoutes) {
+  // More routes than ack window and receive batch
+  const uint32_t count = 3 * kMaxNlInflightMsg;
+  const auto routes = buildRoutes(count);
+
+  EXPECT_EQ(ResultCode::SUCCESS, nlSock->addRoutes(routes));
+  EXPECT_EQ(count, fakeTransport->getRouteCount());
+  EXPECT_EQ(0, nlSock->getInflightCount());
+  EXPECT_EQ(0, nlSock->getErrorCount());
+
+  // Dump spans many datagrams
+  auto kernelRoutes = nlSock->getAllRoutes();
+  EXPECT_EQ(count, kernelRoutes.size());
+
+  EXPECT_EQ(ResultCode::SUCCESS, nlSock->deleteRoutes(routes));
+  EXPECT_EQ(0, fakeTransport->getRouteCount());
+  EXPECT_EQ(0, nlSock->getAllRoutes().size());
+
+  // Deleting again fails with ESRCH for each route, which is ignored
+  auto statuses = nlSock->deleteRoutesAsync(routes).get();
+  ASSERT_EQ(count, statuses.size());
+  for (const auto status : statuses) {
+    EXPECT_EQ(-ESRCH, status);
+  }
+  EXPECT_EQ(ResultCode::SUCCESS, nlSock->deleteRoutes(routes));
+
+  auto counters = nlSock->getCounters();
+  EXPECT_LT(0, counters.at("netlink.recv_bytes"));
+  EXPECT_EQ(0, counters.at("netlink.recv_truncated"));
+}
+
+TEST_F(NetlinkProtocolSocketFixture, ErrorInjection) {
+  const auto routes = buildRoutes(100);
+
+  // Fail every other route
+  fakeTransport->setErrorInjector([](const struct nlmsghdr& nlh) {
+    return (nlh.nlmsg_type == RTM_NEWROUTE && nlh.nlmsg_seq % 2) ? ENOMEM : 0;
+  });
+  auto statuses = nlSock->addRoutesAsync(routes).get();
+  ASSERT_EQ(routes.size(), statuses.size());
+  size_t failed{0};
+  for (const auto status : statuses) {
+    EXPECT_TRUE(status == 0 || status == -ENOMEM);
+    failed += status ? 1 : 0;
+  }
+  EXPECT_EQ(routes.size() / 2, failed);
+  EXPECT_EQ(routes.size() - failed, fakeTransport->getRouteCount());
+  EXPECT_EQ(failed, nlSock->getErrorCount());
+
+  // Synchronous API reports failure
+  EXPECT_EQ(ResultCode::SYSERR, nlSock->addRoutes(routes));
+
+  fakeTransport->setErrorInjector(nullptr);
+  EXPECT_EQ(ResultCode::SUCCESS, nlSock->addRoutes(routes));
+  EXPECT_EQ(routes.size(), fakeTransport->getRouteCount());
+}
+
+TEST_F(NetlinkProtocolSocketFixture, TruncatedDump) {
+  const uint32_t count = 2000;
+  const auto routes = buildRoutes(count);
+  EXPECT_EQ(ResultCode::SUCCESS, nlSock->addRoutes(routes));
+
+  // Dump datagrams larger than receive buffer get truncated. Dump must be
+  // restarted with grown buffers instead of waiting for lost NLMSG_DONE
+  fakeTransport->setDumpDatagramSize(4 * kNlRecvBufSize);
+  const auto start = std::chrono::steady_clock::now();
+  auto kernelRoutes = nlSock->getAllRoutes();
+  EXPECT_EQ(count, kernelRoutes.size());
+  EXPECT_GT(kRequestTimeout, std::chrono::steady_clock::now() - start);
+
+  auto counters = nlSock->getCounters();
+  EXPECT_LT(0, counters.at("netlink.recv_truncated"));
+  EXPECT_EQ(1, counters.at("netlink.dump_restarts"));
+
+  // Buffers were grown, no more truncation
+  kernelRoutes = nlSock->getAllRoutes();
+  EXPECT_EQ(count, kernelRoutes.size());
+  EXPECT_EQ(1, nlSock->getCounters().at("netlink.dump_restarts"));
+}
+
+TEST_F(NetlinkProtocolSocketFixture, ResponseLatency) {
+  const auto routes = buildRoutes(10);
+
+  // Responses within request timeout are waited for, even when nothing else
+  // is received meanwhile
+  fakeTransport->setResponseLatency(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          kRequestTimeout / 2));
+  EXPECT_EQ(ResultCode::SUCCESS, nlSock->addRoutes(routes));
+  EXPECT_EQ(0, nlSock->getErrorCount());
+  EXPECT_EQ(routes.size(), fakeTransport->getRouteCount());
+  const auto numRequests = fakeTransport->getRequestCount();
+
+  // Responses slower than request timeout expire in-flight requests
+  fakeTransport->setResponseLatency(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          kRequestTimeout * 2));
+  auto statuses = nlSock->addRoutesAsync(routes).get();
+  for (const auto status : statuses) {
+    EXPECT_EQ(-ETIMEDOUT, status);
+  }
+  EXPECT_EQ(0, nlSock->getInflightCount());
+
+  // Late responses of expired requests are ignored
+  while (fakeTransport->getRequestCount() < numRequests + routes.size()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  fakeTransport->setResponseLatency(std::chrono::microseconds(100));
+  EXPECT_EQ(ResultCode::SUCCESS, nlSock->addRoutes(routes));
+  EXPECT_EQ(routes.size(), fakeTransport->getRouteCount());
+  EXPECT_EQ(routes.size(), nlSock->getErrorCount());
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
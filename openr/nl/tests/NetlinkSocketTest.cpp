@@ -1004,6 +1004,59 @@ TEST_F(NetlinkSocketFixture, MultiPathTest) {
   EXPECT_EQ(0, count);
 }
 
+// - Add and update many routes with single bulk requests
+// - Verify cache and kernel
+// - Delete them with single bulk request
+TEST_F(NetlinkSocketFixture, BulkRouteTest) {
+  const int numRoutes = 100;
+  std::vector<folly::IPAddress> nexthops1{folly::IPAddress("fe80::1")};
+  std::vector<folly::IPAddress> nexthops2{
+      folly::IPAddress("fe80::2"), folly::IPAddress("fe80::3")};
+  int ifIndex = netlinkSocket->getIfIndex(kVethNameY).get();
+
+  auto buildRoutes = [&](const std::vector<folly::IPAddress>& nexthops) {
+    std::vector<Route> routes;
+    for (int i = 0; i < numRoutes; i++) {
+      folly::CIDRNetwork prefix{
+          folly::IPAddress(folly::sformat("fc00:cafe:4:{:x}::", i)), 64};
+      routes.emplace_back(
+          buildRoute(ifIndex, kAqRouteProtoId, nexthops, prefix));
+    }
+    return routes;
+  };
+
+  auto countKernelRoutes = [&](size_t numNexthops) {
+    int count = 0;
+    for (const auto& r : netlinkSocket->getAllRoutes()) {
+      if (r.getProtocolId() == kAqRouteProtoId &&
+          r.getNextHops().size() == numNexthops) {
+        count++;
+      }
+    }
+    return count;
+  };
+
+  netlinkSocket->addRoutes(buildRoutes(nexthops1)).get();
+  auto routes = netlinkSocket->getCachedUnicastRoutes(kAqRouteProtoId).get();
+  EXPECT_EQ(numRoutes, routes.size());
+  EXPECT_EQ(numRoutes, countKernelRoutes(1));
+
+  // Update replaces old V6 routes rather than appending nexthops
+  netlinkSocket->addRoutes(buildRoutes(nexthops2)).get();
+  routes = netlinkSocket->getCachedUnicastRoutes(kAqRouteProtoId).get();
+  EXPECT_EQ(numRoutes, routes.size());
+  for (const auto& kv : routes) {
+    EXPECT_TRUE(CompareNextHops(nexthops2, kv.second));
+  }
+  EXPECT_EQ(0, countKernelRoutes(1));
+  EXPECT_EQ(numRoutes, countKernelRoutes(2));
+
+  netlinkSocket->delRoutes(buildRoutes(nexthops2)).get();
+  routes = netlinkSocket->getCachedUnicastRoutes(kAqRouteProtoId).get();
+  EXPECT_EQ(0, routes.size());
+  EXPECT_EQ(0, countKernelRoutes(2));
+}
+
 // - Add a simple unicast route with single path
 // - Verify it is added
 // - Try deleting route but with an invalid path
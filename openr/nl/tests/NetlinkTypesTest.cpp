@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <openr/nl/NetlinkRouteCache.h>
 #include <openr/nl/NetlinkTypes.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -554,6 +555,81 @@ TEST(NetlinkTypes, LinkCopyTest) {
   EXPECT_EQ(link, link2);
 }
 
+TEST(NetlinkTypes, UnicastRouteCacheTest) {
+  folly::IPAddress gateway1("fc00:cafe:3::3");
+  folly::IPAddress gateway2("fc00:cafe:3::4");
+  NextHopBuilder nhBuilder;
+  auto nh1 = nhBuilder.setIfIndex(kIfIndex).setGateway(gateway1).build();
+  nhBuilder.reset();
+  auto nh2 = nhBuilder.setIfIndex(kIfIndex).setGateway(gateway2).build();
+
+  auto buildRoute = [&](const folly::CIDRNetwork& dst,
+                        std::vector<NextHop> nhs) {
+    RouteBuilder builder;
+    builder.setDestination(dst).setProtocolId(kProtocolId).setValid(true);
+    for (const auto& nh : nhs) {
+      builder.addNextHop(nh);
+    }
+    return builder.build();
+  };
+
+  const auto dst1 = folly::IPAddress::createNetwork("fc00:cafe:1::/64");
+  const auto dst2 = folly::IPAddress::createNetwork("fc00:cafe:2::/64");
+  const auto dst3 = folly::IPAddress::createNetwork("10.0.0.0/24");
+  auto route1 = buildRoute(dst1, {nh1, nh2});
+  // Same attributes as route1, nexthops in different order
+  auto route2 = buildRoute(dst2, {nh2, nh1});
+  auto route3 = buildRoute(dst3, {nh1});
+
+  UnicastRouteCache cache;
+  cache.insert(route1);
+  cache.insert(route2);
+  cache.insert(route3);
+  EXPECT_EQ(3, cache.size());
+  EXPECT_EQ(2, cache.getAttributeSetCount());
+  EXPECT_TRUE(cache.contains(dst1));
+  EXPECT_TRUE(cache.containsRoute(route2));
+  EXPECT_FALSE(cache.containsRoute(buildRoute(dst2, {nh1})));
+  ASSERT_TRUE(cache.find(dst3).hasValue());
+  EXPECT_EQ(route3, cache.find(dst3).value());
+  EXPECT_FALSE(cache.find(folly::IPAddress::createNetwork("10.0.1.0/24"))
+                   .hasValue());
+
+  // Materialized routes match inserted ones
+  auto routes = cache.toRoutes();
+  ASSERT_EQ(3, routes.size());
+  EXPECT_EQ(route1, routes.at(dst1));
+  EXPECT_EQ(route2, routes.at(dst2));
+  EXPECT_EQ(route3, routes.at(dst3));
+
+  // Walk cache in pages
+  std::unordered_set<folly::CIDRNetwork> walked;
+  auto visit = [&](const folly::CIDRNetwork& prefix, const Route&) {
+    walked.emplace(prefix);
+  };
+  EXPECT_EQ(2, cache.forEachInRange(0, 2, visit));
+  EXPECT_EQ(1, cache.forEachInRange(2, 2, visit));
+  EXPECT_EQ(0, cache.forEachInRange(4, 2, visit));
+  EXPECT_EQ(3, walked.size());
+
+  // Copy is independent of original
+  UnicastRouteCache snapshot(cache);
+
+  // Replace route and release unused attributes
+  cache.insert(buildRoute(dst3, {nh1, nh2}));
+  EXPECT_EQ(3, cache.size());
+  EXPECT_EQ(1, cache.getAttributeSetCount());
+  EXPECT_TRUE(cache.erase(dst1));
+  EXPECT_FALSE(cache.erase(dst1));
+  EXPECT_TRUE(cache.erase(dst2));
+  EXPECT_TRUE(cache.erase(dst3));
+  EXPECT_TRUE(cache.empty());
+  EXPECT_EQ(0, cache.getAttributeSetCount());
+
+  EXPECT_EQ(3, snapshot.size());
+  EXPECT_EQ(route3, snapshot.find(dst3).value());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
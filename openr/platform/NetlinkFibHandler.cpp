@@ -11,6 +11,7 @@
 #include <functional>
 #include <iterator>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 
 #include <folly/Format.h>
@@ -34,6 +35,15 @@ const std::chrono::seconds kSyncStaticRouteTimeout{30};
 const uint8_t kMinRouteProtocolId = 17;
 const uint8_t kMaxRouteProtocolId = 253;
 
+size_t
+getPageSize(int32_t limit) {
+  if (limit <= 0) {
+    return Constants::kFibRouteTablePageSize;
+  }
+  return std::min(
+      static_cast<size_t>(limit), Constants::kFibRouteTablePageSize);
+}
+
 std::string
 getClientName(const int16_t clientId) {
   auto it = thrift::_FibClient_VALUES_TO_NAMES.find(
@@ -47,8 +57,10 @@ getClientName(const int16_t clientId) {
 
 NetlinkFibHandler::NetlinkFibHandler(
     fbzmq::ZmqEventLoop* zmqEventLoop,
-    std::shared_ptr<fbnl::NetlinkSocket> netlinkSocket)
+    std::shared_ptr<fbnl::NetlinkSocket> netlinkSocket,
+    std::chrono::milliseconds routeTableWalkTtl)
     : netlinkSocket_(netlinkSocket),
+      routeTableWalkTtl_(routeTableWalkTtl),
       startTime_(std::chrono::duration_cast<std::chrono::seconds>(
                      std::chrono::system_clock::now().time_since_epoch())
                      .count()),
@@ -120,15 +132,32 @@ NetlinkFibHandler::buildNextHops(const fbnl::NextHopSet& nextHops) {
 }
 
 std::vector<thrift::UnicastRoute>
-NetlinkFibHandler::toThriftUnicastRoutes(const fbnl::NlUnicastRoutes& routeDb) {
+NetlinkFibHandler::toThriftUnicastRoutes(
+    const fbnl::UnicastRouteCache& routeDb, size_t start, size_t count) {
   std::vector<thrift::UnicastRoute> routes;
-
-  for (auto const& kv : routeDb) {
-    thrift::UnicastRoute route;
-    route.dest = toIpPrefix(kv.first);
-    route.nextHops = buildNextHops(kv.second.getNextHops());
-    routes.emplace_back(std::move(route));
+  if (start < routeDb.size()) {
+    routes.reserve(std::min(count, routeDb.size() - start));
   }
+
+  // Route attributes are shared among prefixes in cache. Convert nexthops of
+  // each distinct attribute set only once
+  std::unordered_map<const fbnl::Route*, std::vector<thrift::NextHopThrift>>
+      nextHopsCache;
+  routeDb.forEachInRange(
+      start,
+      count,
+      [&](const folly::CIDRNetwork& prefix, const fbnl::Route& attrs) {
+        auto it = nextHopsCache.find(&attrs);
+        if (it == nextHopsCache.end()) {
+          it = nextHopsCache
+                   .emplace(&attrs, buildNextHops(attrs.getNextHops()))
+                   .first;
+        }
+        thrift::UnicastRoute route;
+        route.dest = toIpPrefix(prefix);
+        route.nextHops = it->second;
+        routes.emplace_back(std::move(route));
+      });
   return routes;
 }
 
@@ -151,14 +180,9 @@ NetlinkFibHandler::future_addUnicastRoute(
     int16_t clientId, std::unique_ptr<thrift::UnicastRoute> route) {
   VLOG(1) << "Adding/Updating route for " << toString(route->dest);
 
-  folly::Promise<folly::Unit> promise;
-  auto future = promise.getFuture();
-  auto protocol = getProtocol(promise, clientId);
-  if (protocol.hasError()) {
-    return future;
-  }
-
-  return netlinkSocket_->addRoute(buildRoute(*route, protocol.value()));
+  auto routes = std::make_unique<std::vector<thrift::UnicastRoute>>();
+  routes->emplace_back(std::move(*route));
+  return future_addUnicastRoutes(clientId, std::move(routes));
 }
 
 folly::Future<folly::Unit>
@@ -166,17 +190,9 @@ NetlinkFibHandler::future_deleteUnicastRoute(
     int16_t clientId, std::unique_ptr<thrift::IpPrefix> prefix) {
   VLOG(1) << "Deleting route for " << toString(*prefix);
 
-  folly::Promise<folly::Unit> promise;
-  auto future = promise.getFuture();
-  auto protocol = getProtocol(promise, clientId);
-  if (protocol.hasError()) {
-    return future;
-  }
-
-  fbnl::RouteBuilder rtBuilder;
-  rtBuilder.setDestination(toIPNetwork(*prefix))
-      .setProtocolId(protocol.value());
-  return netlinkSocket_->delRoute(rtBuilder.build());
+  auto prefixes = std::make_unique<std::vector<thrift::IpPrefix>>();
+  prefixes->emplace_back(std::move(*prefix));
+  return future_deleteUnicastRoutes(clientId, std::move(prefixes));
 }
 
 folly::Future<folly::Unit>
@@ -187,27 +203,18 @@ NetlinkFibHandler::future_addUnicastRoutes(
 
   folly::Promise<folly::Unit> promise;
   auto future = promise.getFuture();
+  auto protocol = getProtocol(promise, clientId);
+  if (protocol.hasError()) {
+    return future;
+  }
 
-  // Run all route updates in a single eventloop
-  evl_->runImmediatelyOrInEventLoop([this,
-                                     clientId,
-                                     promise = std::move(promise),
-                                     routes = std::move(routes)]() mutable {
-    for (auto& route : *routes) {
-      auto ptr = std::make_unique<thrift::UnicastRoute>(std::move(route));
-      try {
-        // This is going to be synchronous call as we are invoking from
-        // within event loop
-        future_addUnicastRoute(clientId, std::move(ptr)).get();
-      } catch (std::exception const& e) {
-        promise.setException(e);
-        return;
-      }
-    }
-    promise.setValue();
-  });
-
-  return future;
+  // Program all routes with a single bulk netlink request
+  std::vector<fbnl::Route> nlRoutes;
+  nlRoutes.reserve(routes->size());
+  for (auto const& route : *routes) {
+    nlRoutes.emplace_back(buildRoute(route, protocol.value()));
+  }
+  return netlinkSocket_->addRoutes(std::move(nlRoutes));
 }
 
 folly::Future<folly::Unit>
@@ -217,24 +224,20 @@ NetlinkFibHandler::future_deleteUnicastRoutes(
 
   folly::Promise<folly::Unit> promise;
   auto future = promise.getFuture();
+  auto protocol = getProtocol(promise, clientId);
+  if (protocol.hasError()) {
+    return future;
+  }
 
-  evl_->runImmediatelyOrInEventLoop([this,
-                                     clientId,
-                                     promise = std::move(promise),
-                                     prefixes = std::move(prefixes)]() mutable {
-    for (auto& prefix : *prefixes) {
-      auto ptr = std::make_unique<thrift::IpPrefix>(std::move(prefix));
-      try {
-        future_deleteUnicastRoute(clientId, std::move(ptr)).get();
-      } catch (std::exception const& e) {
-        promise.setException(e);
-        return;
-      }
-    }
-    promise.setValue();
-  });
-
-  return future;
+  std::vector<fbnl::Route> nlRoutes;
+  nlRoutes.reserve(prefixes->size());
+  for (auto const& prefix : *prefixes) {
+    fbnl::RouteBuilder rtBuilder;
+    rtBuilder.setDestination(toIPNetwork(prefix))
+        .setProtocolId(protocol.value());
+    nlRoutes.emplace_back(rtBuilder.build());
+  }
+  return netlinkSocket_->delRoutes(std::move(nlRoutes));
 }
 
 folly::Future<folly::Unit>
@@ -402,11 +405,12 @@ NetlinkFibHandler::future_getRouteTableByClient(int16_t clientId) {
     return future;
   }
 
-  return netlinkSocket_->getCachedUnicastRoutes(protocol.value())
-      .thenValue([this](fbnl::NlUnicastRoutes res) mutable {
-        return std::make_unique<std::vector<openr::thrift::UnicastRoute>>(
-            toThriftUnicastRoutes(res));
-      })
+  return netlinkSocket_->getCachedUnicastRoutesView(protocol.value())
+      .thenValue(
+          [this](std::shared_ptr<const fbnl::UnicastRouteCache> res) mutable {
+            return std::make_unique<std::vector<openr::thrift::UnicastRoute>>(
+                toThriftUnicastRoutes(*res));
+          })
       .thenError<std::runtime_error>([](std::exception const& ex) {
         LOG(ERROR) << "Failed to get unicast routing table by client: "
                    << ex.what() << ", returning empty table instead";
@@ -438,6 +442,141 @@ NetlinkFibHandler::future_getMplsRouteTableByClient(int16_t clientId) {
         return std::make_unique<std::vector<openr::thrift::MplsRoute>>();
       });
 }
+
+folly::Future<std::unique_ptr<openr::thrift::UnicastRouteTablePage>>
+NetlinkFibHandler::future_getRouteTableByClientPaged(
+    int16_t clientId, int64_t cursor, int32_t limit) {
+  VLOG(2) << "Get unicast routes page from FIB for clientId " << clientId
+          << ", cursor " << cursor;
+
+  // promise here is used only for error case
+  folly::Promise<std::unique_ptr<openr::thrift::UnicastRouteTablePage>>
+      promise;
+  auto future = promise.getFuture();
+  auto protocol = getProtocol(promise, clientId);
+  if (protocol.hasError()) {
+    return future;
+  }
+  const auto protocolId = protocol.value();
+  const auto pageSize = getPageSize(limit);
+
+  // Continue an existing walk
+  if (cursor != 0) {
+    return folly::makeFutureWith([this, protocolId, cursor, pageSize]() {
+      return getUnicastRoutePage(protocolId, cursor, pageSize);
+    });
+  }
+
+  // Start a new walk over current snapshot of route table
+  return netlinkSocket_->getCachedUnicastRoutesView(protocolId)
+      .thenValue([this, protocolId, pageSize](
+                     std::shared_ptr<const fbnl::UnicastRouteCache> snapshot) {
+        const int64_t walkId = nextRouteTableWalkId_++;
+        routeTableWalks_.withWLock([&](auto& walks) {
+          const auto now = std::chrono::steady_clock::now();
+          for (auto it = walks.begin(); it != walks.end();) {
+            if (now - it->second.lastAccess > routeTableWalkTtl_) {
+              it = walks.erase(it);
+            } else {
+              ++it;
+            }
+          }
+          // Evict least recently used walk if there are too many
+          if (walks.size() >= Constants::kFibMaxRouteTableWalks) {
+            auto lru = std::min_element(
+                walks.begin(), walks.end(), [](const auto& a, const auto& b) {
+                  return a.second.lastAccess < b.second.lastAccess;
+                });
+            LOG(WARNING) << "Too many route table walks. Dropping walk "
+                         << lru->first;
+            walks.erase(lru);
+          }
+          walks.emplace(
+              walkId, RouteTableWalk{protocolId, std::move(snapshot), now});
+        });
+        // Cursor is walk id in upper and offset in lower 32 bits
+        return getUnicastRoutePage(protocolId, walkId << 32, pageSize);
+      });
+}
+
+std::unique_ptr<thrift::UnicastRouteTablePage>
+NetlinkFibHandler::getUnicastRoutePage(
+    int16_t protocolId, int64_t cursor, size_t limit) {
+  const int64_t walkId = cursor >> 32;
+  const size_t offset = cursor & 0xffffffff;
+
+  // Walks are only dropped once expired, not after their last page is
+  // served, so that any page can be retried
+  std::shared_ptr<const fbnl::UnicastRouteCache> snapshot;
+  routeTableWalks_.withWLock([&](auto& walks) {
+    const auto now = std::chrono::steady_clock::now();
+    auto it = walks.find(walkId);
+    if (it != walks.end() && now - it->second.lastAccess > routeTableWalkTtl_) {
+      walks.erase(it);
+      it = walks.end();
+    }
+    if (it == walks.end() || it->second.protocolId != protocolId ||
+        offset > it->second.snapshot->size()) {
+      throw thrift::PlatformError(folly::sformat(
+          "Invalid or expired route table cursor {}. Restart the walk with "
+          "cursor 0",
+          cursor));
+    }
+    snapshot = it->second.snapshot;
+    it->second.lastAccess = now;
+  });
+
+  auto page = std::make_unique<thrift::UnicastRouteTablePage>();
+  page->routes = toThriftUnicastRoutes(*snapshot, offset, limit);
+  if (offset + limit < snapshot->size()) {
+    page->nextCursor = (walkId << 32) | (offset + limit);
+  }
+  return page;
+}
+
+folly::Future<std::unique_ptr<openr::thrift::MplsRouteTablePage>>
+NetlinkFibHandler::future_getMplsRouteTableByClientPaged(
+    int16_t clientId, int64_t cursor, int32_t limit) {
+  VLOG(2) << "Get Mpls routes page from FIB for clientId " << clientId
+          << ", cursor " << cursor;
+
+  // promise here is used only for error case
+  folly::Promise<std::unique_ptr<openr::thrift::MplsRouteTablePage>> promise;
+  auto future = promise.getFuture();
+  auto protocol = getProtocol(promise, clientId);
+  if (protocol.hasError()) {
+    return future;
+  }
+
+  // Cursor is next label to start from plus one, so that 0 means start
+  if (cursor < 0 ||
+      cursor > static_cast<int64_t>(std::numeric_limits<int32_t>::max()) + 1) {
+    promise.setException(thrift::PlatformError(
+        folly::sformat("Invalid Mpls route table cursor {}", cursor)));
+    return future;
+  }
+  const int32_t startLabel = cursor == 0 ? 0 : cursor - 1;
+  const auto pageSize = getPageSize(limit);
+
+  return netlinkSocket_
+      ->getCachedMplsRoutesPage(protocol.value(), startLabel, pageSize)
+      .thenValue([this, pageSize](std::vector<fbnl::Route> routes) mutable {
+        auto page = std::make_unique<thrift::MplsRouteTablePage>();
+        page->routes.reserve(routes.size());
+        for (const auto& route : routes) {
+          thrift::MplsRoute mplsRoute;
+          mplsRoute.topLabel = route.getMplsLabel().value();
+          mplsRoute.nextHops = buildNextHops(route.getNextHops());
+          page->routes.emplace_back(std::move(mplsRoute));
+        }
+        // Full page, there may be more routes after last label
+        if (routes.size() == pageSize && !page->routes.empty()) {
+          page->nextCursor =
+              static_cast<int64_t>(page->routes.back().topLabel) + 2;
+        }
+        return page;
+      });
+}
 void
 NetlinkFibHandler::buildMplsAction(
     fbnl::NextHopBuilder& nhBuilder, const thrift::NextHopThrift& nhop) const {
@@ -518,6 +657,9 @@ NetlinkFibHandler::buildMplsRoute(
 void
 NetlinkFibHandler::getCounters(std::map<std::string, int64_t>& counters) {
   counters["fibagent.num_of_routes"] = netlinkSocket_->getRouteCount().get();
+  for (auto const& kv : netlinkSocket_->getProtocolSocketCounters()) {
+    counters[kv.first] = kv.second;
+  }
 }
 
 void
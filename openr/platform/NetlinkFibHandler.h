@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -15,6 +17,7 @@
 
 #include <fbzmq/async/ZmqTimeout.h>
 #include <folly/Expected.h>
+#include <folly/Synchronized.h>
 #include <folly/futures/Future.h>
 #include <thrift/lib/cpp/async/TAsyncSocket.h>
 
@@ -34,9 +37,13 @@ namespace openr {
  */
 class NetlinkFibHandler : public thrift::FibServiceSvIf {
  public:
+  // Paginated unicast route table walks not accessed for `routeTableWalkTtl`
+  // are dropped and their cursors rejected
   explicit NetlinkFibHandler(
       fbzmq::ZmqEventLoop* zmqEventLoop,
-      std::shared_ptr<fbnl::NetlinkSocket> netlinkSocket);
+      std::shared_ptr<fbnl::NetlinkSocket> netlinkSocket,
+      std::chrono::milliseconds routeTableWalkTtl =
+          Constants::kFibRouteTableWalkTtl);
   ~NetlinkFibHandler() override;
 
   folly::Future<folly::Unit> future_addUnicastRoute(
@@ -95,6 +102,14 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf {
   folly::Future<std::unique_ptr<std::vector<openr::thrift::MplsRoute>>>
   future_getMplsRouteTableByClient(int16_t clientId) override;
 
+  folly::Future<std::unique_ptr<openr::thrift::UnicastRouteTablePage>>
+  future_getRouteTableByClientPaged(
+      int16_t clientId, int64_t cursor, int32_t limit) override;
+
+  folly::Future<std::unique_ptr<openr::thrift::MplsRouteTablePage>>
+  future_getMplsRouteTableByClientPaged(
+      int16_t clientId, int64_t cursor, int32_t limit) override;
+
   std::shared_ptr<fbnl::NetlinkSocket>
   getNetlinkSocket() {
     return netlinkSocket_;
@@ -128,7 +143,9 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf {
       folly::Promise<A>& promise, int16_t clientId);
 
   std::vector<thrift::UnicastRoute> toThriftUnicastRoutes(
-      const fbnl::NlUnicastRoutes& routeDb);
+      const fbnl::UnicastRouteCache& routeDb,
+      size_t start = 0,
+      size_t count = std::numeric_limits<size_t>::max());
 
   std::vector<thrift::MplsRoute> toThriftMplsRoutes(
       const fbnl::NlMplsRoutes& routeDb);
@@ -149,9 +166,30 @@ class NetlinkFibHandler : public thrift::FibServiceSvIf {
       fbnl::RouteBuilder& rtBuilder,
       const std::vector<thrift::NextHopThrift>& nhop) const;
 
+  // Serve page of unicast route table walk identified by cursor
+  std::unique_ptr<thrift::UnicastRouteTablePage> getUnicastRoutePage(
+      int16_t protocolId, int64_t cursor, size_t limit);
+
   // Used to interact with Linux kernel routing table
   std::shared_ptr<fbnl::NetlinkSocket> netlinkSocket_;
 
+  // Paginated walk over a snapshot of unicast route table. Snapshot is
+  // shared with NetlinkSocket cache, which is copied on write only while
+  // a walk is in progress.
+  struct RouteTableWalk {
+    int16_t protocolId{0};
+    std::shared_ptr<const fbnl::UnicastRouteCache> snapshot;
+    std::chrono::steady_clock::time_point lastAccess;
+  };
+
+  // Ongoing route table walks keyed by walk id
+  folly::Synchronized<std::unordered_map<int64_t, RouteTableWalk>>
+      routeTableWalks_;
+
+  std::atomic<int64_t> nextRouteTableWalkId_{1};
+
+  const std::chrono::milliseconds routeTableWalkTtl_;
+
   // Time when service started, in number of seconds, since epoch
   const int64_t startTime_{0};
 
@@ -12,6 +12,7 @@
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/IPAddress.h>
 #include <folly/MapUtil.h>
+#include <folly/Random.h>
 #include <folly/gen/Base.h>
 #include <folly/system/ThreadName.h>
 #include <glog/logging.h>
@@ -26,8 +27,11 @@ using apache::thrift::FRAGILE;
 namespace openr {
 
 PlatformPublisher::PlatformPublisher(
-    fbzmq::Context& context, const PlatformPublisherUrl& platformPubUrl)
-    : platformPubUrl_(platformPubUrl) {
+    fbzmq::Context& context,
+    const PlatformPublisherUrl& platformPubUrl,
+    fbzmq::ZmqEventLoop* evl)
+    : platformPubUrl_(platformPubUrl),
+      publisherId_(static_cast<int64_t>(folly::Random::rand64())) {
   // Initialize ZMQ sockets
   platformPubSock_ = fbzmq::Socket<ZMQ_PUB, fbzmq::ZMQ_SERVER>(
       context, folly::none, folly::none, fbzmq::NonblockingFlag{true});
@@ -38,6 +42,15 @@ PlatformPublisher::PlatformPublisher(
     LOG(FATAL) << "Error binding to URL '" << platformPubUrl_ << "' "
                << platformPub.error();
   }
+
+  if (evl) {
+    heartbeatTimer_ =
+        fbzmq::ZmqTimeout::make(evl, [this]() noexcept { publishHeartbeat(); });
+    evl->runInEventLoop([this]() noexcept {
+      heartbeatTimer_->scheduleTimeout(
+          Constants::kPlatformHeartbeatInterval, true /* isPeriodic */);
+    });
+  }
 }
 
 void
@@ -70,14 +83,48 @@ PlatformPublisher::publishNeighborEvent(const thrift::NeighborEntry& neighbor) {
   publishPlatformEvent(msg);
 }
 
+void
+PlatformPublisher::publishHeartbeat() {
+  // report every event type we publish, 0 if none was published yet
+  thrift::PlatformHeartbeat heartbeat;
+  for (const auto eventType :
+       {thrift::PlatformEventType::LINK_EVENT,
+        thrift::PlatformEventType::ADDRESS_EVENT,
+        thrift::PlatformEventType::NEIGHBOR_EVENT}) {
+    heartbeat.seqNums[eventType] =
+        folly::get_default(seqNums_, static_cast<int32_t>(eventType), 0);
+  }
+
+  // heartbeat is not sequenced itself, only carries publisherId
+  thrift::PlatformEvent msg;
+  msg.eventType = thrift::PlatformEventType::HEARTBEAT_EVENT;
+  msg.eventData = fbzmq::util::writeThriftObjStr(heartbeat, serializer_);
+  msg.publisherId = publisherId_;
+  platformPubSock_.sendMore(
+      fbzmq::Message::from(static_cast<uint16_t>(msg.eventType)).value());
+  const auto sendHeartbeat = platformPubSock_.sendThriftObj(msg, serializer_);
+  if (sendHeartbeat.hasError()) {
+    LOG(ERROR) << "Error in sending PlatformEvent heartbeat: "
+               << sendHeartbeat.error();
+  }
+}
+
 void
 PlatformPublisher::publishPlatformEvent(const thrift::PlatformEvent& msg) {
   VLOG(3) << "Publishing PlatformEvent...";
   thrift::PlatformEventType eventType = msg.eventType;
+
+  // Stamp event with its sequence number. Number is consumed even if send
+  // fails so that subscribers see the gap and resync.
+  auto seqMsg = msg;
+  seqMsg.seqNum = ++seqNums_[static_cast<int32_t>(eventType)];
+  seqMsg.publisherId = publisherId_;
+
   // send header of event in the first 2 byte
   platformPubSock_.sendMore(
       fbzmq::Message::from(static_cast<uint16_t>(eventType)).value());
-  const auto sendNeighEntry = platformPubSock_.sendThriftObj(msg, serializer_);
+  const auto sendNeighEntry =
+      platformPubSock_.sendThriftObj(seqMsg, serializer_);
   if (sendNeighEntry.hasError()) {
     LOG(ERROR) << "Error in sending PlatformEventType Entry, event Type: "
                << folly::get_default(
@@ -131,6 +178,9 @@ PlatformPublisher::neighborEventFunc(
 
 void
 PlatformPublisher::stop() {
+  if (heartbeatTimer_) {
+    heartbeatTimer_->cancelTimeout();
+  }
   platformPubSock_.close();
 }
 
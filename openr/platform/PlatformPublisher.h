@@ -12,8 +12,11 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <fbzmq/async/ZmqTimeout.h>
 #include <fbzmq/zmq/Zmq.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
@@ -29,6 +32,10 @@ namespace openr {
  * message passing mechanism. Event will be sent over Zmq PUB socket which
  * OpenR modules can subscribe through SUB socket. The subscriber modules is
  * LinkMonitor from Open/R side.
+ *
+ * If event loop is given, publisher also sends periodic heartbeat with last
+ * sequence numbers it published, so that subscribers notice events lost at
+ * the tail. Events must then be published from that event loop.
  */
 class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
  public:
@@ -37,7 +44,8 @@ class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
       // Immutable state initializers
       //
       fbzmq::Context& context,
-      const PlatformPublisherUrl& platformPubUrl);
+      const PlatformPublisherUrl& platformPubUrl,
+      fbzmq::ZmqEventLoop* evl = nullptr);
 
   ~PlatformPublisher() = default;
 
@@ -53,6 +61,8 @@ class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
 
   void publishNeighborEvent(const thrift::NeighborEntry& neighbor);
 
+  void publishHeartbeat();
+
   void stop();
 
  private:
@@ -77,6 +87,15 @@ class PlatformPublisher final : public fbnl::NetlinkSocket::EventsHandler {
 
   // used for communicating over thrift/zmq sockets
   apache::thrift::CompactSerializer serializer_;
+
+  // identifies this publisher instance to subscribers
+  const int64_t publisherId_{0};
+
+  // sequence number of last event published, per event type
+  std::unordered_map<int32_t /* PlatformEventType */, int64_t> seqNums_;
+
+  // timer for publishing heartbeats, if any
+  std::unique_ptr<fbzmq::ZmqTimeout> heartbeatTimer_;
 };
 
 } // namespace openr
@@ -0,0 +1,268 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <memory>
+#include <set>
+#include <thread>
+
+#include <fbzmq/async/ZmqEventLoop.h>
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/nl/NetlinkMessage.h>
+#include <openr/nl/NetlinkSocket.h>
+#include <openr/nl/tests/FakeNetlinkTransport.h>
+#include <openr/platform/NetlinkFibHandler.h>
+
+using namespace openr;
+
+namespace {
+const int16_t kFibId{static_cast<int16_t>(thrift::FibClient::OPENR)};
+
+// Short walk TTL so that expiry can be tested quickly
+const std::chrono::milliseconds kWalkTtl{200};
+
+std::vector<thrift::UnicastRoute>
+buildUnicastRoutes(int count) {
+  std::vector<thrift::UnicastRoute> routes;
+  for (int i = 0; i < count; i++) {
+    routes.emplace_back(createUnicastRoute(
+        toIpPrefix(folly::sformat("fc00:{:x}::/64", i)),
+        {createNextHop(toBinaryAddress(folly::IPAddress("fe80::1")))}));
+  }
+  return routes;
+}
+
+std::vector<thrift::MplsRoute>
+buildMplsRoutes(int32_t firstLabel, int count) {
+  std::vector<thrift::MplsRoute> routes;
+  for (int i = 0; i < count; i++) {
+    routes.emplace_back(createMplsRoute(
+        firstLabel + i,
+        {createNextHop(
+            toBinaryAddress(folly::IPAddress("fe80::1")),
+            folly::none,
+            0,
+            createMplsAction(thrift::MplsActionCode::SWAP, 1000 + i))}));
+  }
+  return routes;
+}
+} // namespace
+
+class NetlinkFibHandlerFixture : public ::testing::Test {
+ public:
+  void
+  SetUp() override {
+    fakeTransport = std::make_shared<fbnl::FakeNetlinkTransport>();
+    auto nlProtocolSocket =
+        std::make_unique<fbnl::NetlinkProtocolSocket>(&nlEvl, fakeTransport);
+    auto nlProtocolSocketPtr = nlProtocolSocket.get();
+    nlEventThread = std::thread([this, nlProtocolSocketPtr]() {
+      nlProtocolSocketPtr->init();
+      nlEvl.run();
+    });
+    nlEvl.waitUntilRunning();
+
+    nlSocket = std::make_shared<fbnl::NetlinkSocket>(
+        &evl, nullptr, std::move(nlProtocolSocket));
+    eventThread = std::thread([this]() { evl.run(); });
+    evl.waitUntilRunning();
+
+    fibHandler = std::make_shared<NetlinkFibHandler>(&evl, nlSocket, kWalkTtl);
+  }
+
+  void
+  TearDown() override {
+    evl.stop();
+    evl.waitUntilStopped();
+    eventThread.join();
+    nlEvl.stop();
+    nlEvl.waitUntilStopped();
+    nlEventThread.join();
+    fibHandler.reset();
+    nlSocket.reset();
+    fakeTransport.reset();
+  }
+
+  std::unique_ptr<thrift::UnicastRouteTablePage>
+  getPage(int64_t cursor, int32_t limit) {
+    return fibHandler->future_getRouteTableByClientPaged(kFibId, cursor, limit)
+        .get();
+  }
+
+  // Walk unicast route table from the start with pages of `limit` routes
+  std::vector<thrift::UnicastRoute>
+  walkUnicastRoutes(int32_t limit) {
+    std::vector<thrift::UnicastRoute> routes;
+    int64_t cursor = 0;
+    do {
+      auto page = getPage(cursor, limit);
+      EXPECT_GE(limit, page->routes.size());
+      routes.insert(routes.end(), page->routes.begin(), page->routes.end());
+      cursor = page->nextCursor;
+    } while (cursor != 0);
+    return routes;
+  }
+
+  fbzmq::ZmqEventLoop evl;
+  fbzmq::ZmqEventLoop nlEvl;
+  std::thread eventThread;
+  std::thread nlEventThread;
+  std::shared_ptr<fbnl::FakeNetlinkTransport> fakeTransport;
+  std::shared_ptr<fbnl::NetlinkSocket> nlSocket;
+  std::shared_ptr<NetlinkFibHandler> fibHandler;
+};
+
+TEST_F(NetlinkFibHandlerFixture, UnicastRoutePaging) {
+  const int count = 1000;
+  const int32_t limit = 64;
+  fibHandler
+      ->future_addUnicastRoutes(
+          kFibId,
+          std::make_unique<std::vector<thrift::UnicastRoute>>(
+              buildUnicastRoutes(count)))
+      .get();
+  EXPECT_EQ(count, fakeTransport->getRouteCount());
+
+  // Every route is returned exactly once
+  auto routes = walkUnicastRoutes(limit);
+  EXPECT_EQ(count, routes.size());
+  std::set<std::string> prefixes;
+  for (const auto& route : routes) {
+    prefixes.emplace(toString(route.dest));
+  }
+  EXPECT_EQ(count, prefixes.size());
+
+  // Pages of a walk come from the snapshot taken when it started
+  auto firstPage = getPage(0, limit);
+  ASSERT_NE(0, firstPage->nextCursor);
+  auto toDelete = std::make_unique<std::vector<thrift::IpPrefix>>();
+  for (const auto& route : routes) {
+    toDelete->emplace_back(route.dest);
+  }
+  fibHandler->future_deleteUnicastRoutes(kFibId, std::move(toDelete)).get();
+  EXPECT_EQ(0, fakeTransport->getRouteCount());
+  EXPECT_EQ(0, walkUnicastRoutes(limit).size());
+
+  size_t numRoutes = firstPage->routes.size();
+  int64_t cursor = firstPage->nextCursor;
+  int64_t lastCursor{0};
+  while (cursor != 0) {
+    auto page = getPage(cursor, limit);
+    // Retrying a page returns the same routes
+    auto retry = getPage(cursor, limit);
+    EXPECT_EQ(page->routes, retry->routes);
+    EXPECT_EQ(page->nextCursor, retry->nextCursor);
+    numRoutes += page->routes.size();
+    lastCursor = cursor;
+    cursor = page->nextCursor;
+  }
+  EXPECT_EQ(count, numRoutes);
+
+  // Walk is kept after its last page was served, until it expires
+  EXPECT_EQ(count % limit, getPage(lastCursor, limit)->routes.size());
+}
+
+TEST_F(NetlinkFibHandlerFixture, UnicastRouteWalkExpiry) {
+  fibHandler
+      ->future_addUnicastRoutes(
+          kFibId,
+          std::make_unique<std::vector<thrift::UnicastRoute>>(
+              buildUnicastRoutes(100)))
+      .get();
+
+  auto page = getPage(0, 10);
+  ASSERT_NE(0, page->nextCursor);
+  page = getPage(page->nextCursor, 10);
+  ASSERT_NE(0, page->nextCursor);
+
+  // Cursor of an expired walk is rejected with a thrift error
+  std::this_thread::sleep_for(kWalkTtl * 2);
+  EXPECT_THROW(getPage(page->nextCursor, 10), thrift::PlatformError);
+
+  // So are cursors which never existed
+  EXPECT_THROW(getPage(12345LL << 32, 10), thrift::PlatformError);
+
+  // Walk can be restarted
+  EXPECT_EQ(100, walkUnicastRoutes(10).size());
+}
+
+TEST_F(NetlinkFibHandlerFixture, UnicastRouteWalkEviction) {
+  fibHandler
+      ->future_addUnicastRoutes(
+          kFibId,
+          std::make_unique<std::vector<thrift::UnicastRoute>>(
+              buildUnicastRoutes(100)))
+      .get();
+
+  // Open as many walks as allowed
+  std::vector<int64_t> cursors;
+  for (size_t i = 0; i < Constants::kFibMaxRouteTableWalks; i++) {
+    cursors.emplace_back(getPage(0, 10)->nextCursor);
+  }
+  // Access first walk, second one becomes least recently used
+  cursors[0] = getPage(cursors[0], 10)->nextCursor;
+
+  // New walk evicts least recently used one
+  getPage(0, 10);
+  EXPECT_THROW(getPage(cursors[1], 10), thrift::PlatformError);
+  EXPECT_NE(0, getPage(cursors[0], 10)->nextCursor);
+  for (size_t i = 2; i < cursors.size(); i++) {
+    EXPECT_NE(0, getPage(cursors[i], 10)->nextCursor);
+  }
+}
+
+TEST_F(NetlinkFibHandlerFixture, MplsRoutePaging) {
+  const int count = 100;
+  const int32_t firstLabel = 100;
+  fibHandler
+      ->future_addMplsRoutes(
+          kFibId,
+          std::make_unique<std::vector<thrift::MplsRoute>>(
+              buildMplsRoutes(firstLabel, count)))
+      .get();
+
+  // Routes come in increasing label order
+  std::vector<int32_t> labels;
+  int64_t cursor = 0;
+  do {
+    auto page =
+        fibHandler->future_getMplsRouteTableByClientPaged(kFibId, cursor, 30)
+            .get();
+    EXPECT_GE(30, page->routes.size());
+    for (const auto& route : page->routes) {
+      labels.emplace_back(route.topLabel);
+    }
+    cursor = page->nextCursor;
+  } while (cursor != 0);
+  ASSERT_EQ(count, labels.size());
+  for (int i = 0; i < count; i++) {
+    EXPECT_EQ(firstLabel + i, labels[i]);
+  }
+
+  EXPECT_THROW(
+      fibHandler->future_getMplsRouteTableByClientPaged(kFibId, -1, 30).get(),
+      thrift::PlatformError);
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
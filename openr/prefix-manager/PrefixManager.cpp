@@ -19,6 +19,8 @@ namespace openr {
 namespace {
 // key for the persist config on disk
 const std::string kConfigKey{"prefix-manager-config"};
+// key for changes of persist config since it was last written out in full
+const std::string kConfigDeltaKey{"prefix-manager-config-delta"};
 // various error messages
 const std::string kErrorNoChanges{"No changes in prefixes to be advertised"};
 const std::string kErrorNoPrefixToRemove{"No prefix to remove"};
@@ -41,7 +43,8 @@ PrefixManager::PrefixManager(
     : OpenrEventLoop(
           nodeId, thrift::OpenrModuleType::PREFIX_MANAGER, zmqContext),
       nodeId_(nodeId),
-      configStoreClient_{persistentStoreUrl, zmqContext},
+      configStoreClient_{
+          persistentStoreUrl, zmqContext, this /* write behind */},
       prefixDbMarker_{prefixDbMarker},
       perPrefixKeys_{perPrefixKeys},
       enablePerfMeasurement_{enablePerfMeasurement},
@@ -50,7 +53,7 @@ PrefixManager::PrefixManager(
       ttlKeyInKvStore_(ttlKeyInKvStore),
       kvStoreClient_{
           zmqContext, this, nodeId_, kvStoreLocalCmdUrl, kvStoreLocalPubUrl} {
-  // pick up prefixes from disk
+  // pick up prefixes from disk, full prefix database
   auto maybePrefixDb =
       configStoreClient_.loadThriftObj<thrift::PrefixDatabase>(kConfigKey);
   if (maybePrefixDb.hasValue()) {
@@ -61,9 +64,37 @@ PrefixManager::PrefixManager(
                 << apache::thrift::TEnumTraits<thrift::PrefixType>::findName(
                        entry.type);
       prefixMap_[entry.prefix].emplace(entry.type, entry);
+      prefixesToUpdate_.emplace(entry.prefix);
+    }
+    numPersistedPrefixEntries_ = maybePrefixDb->prefixEntries.size();
+  }
+  // and changes written out since, which stay changes till next full write
+  auto maybePrefixDbDelta =
+      configStoreClient_.loadThriftObj<thrift::PrefixDatabaseDelta>(
+          kConfigDeltaKey);
+  if (maybePrefixDbDelta.hasValue()) {
+    LOG(INFO) << "Successfully loaded "
+              << maybePrefixDbDelta->updatedEntries.size() << " updated and "
+              << maybePrefixDbDelta->withdrawnEntries.size()
+              << " withdrawn prefixes from disk";
+    for (const auto& entry : maybePrefixDbDelta->withdrawnEntries) {
+      auto it = prefixMap_.find(entry.prefix);
+      if (it != prefixMap_.end() and it->second.erase(entry.type) and
+          it->second.empty()) {
+        prefixMap_.erase(it);
+      }
+      persistentPrefixChanges_[entry.prefix].emplace(entry.type);
+    }
+    for (const auto& entry : maybePrefixDbDelta->updatedEntries) {
+      prefixMap_[entry.prefix][entry.type] = entry;
+      prefixesToUpdate_.emplace(entry.prefix);
+      persistentPrefixChanges_[entry.prefix].emplace(entry.type);
     }
-    // Prefixes will be advertised after prefixHoldUntilTimePoint_
+    numPersistentPrefixChanges_ = maybePrefixDbDelta->updatedEntries.size() +
+        maybePrefixDbDelta->withdrawnEntries.size();
+    prefixDbDeltaStored_ = true;
   }
+  // Prefixes will be advertised after prefixHoldUntilTimePoint_
 
   // register kvstore publication callback
   std::vector<std::string> keyPrefixList;
@@ -85,17 +116,21 @@ PrefixManager::PrefixManager(
         updateKvStore();
       });
 
+  // Create throttled persistPrefixDb
+  persistPrefixDbThrottled_ = std::make_unique<fbzmq::ZmqThrottle>(
+      this, Constants::kPrefixMgrKvThrottleTimeout, [this]() noexcept {
+        persistPrefixDb();
+      });
+
   // Create a timer to update all prefixes after HoldTime (2 * KA) during
   // initial start up
   // Holdtime zero is used during testing to do inline without delay
   if (prefixHoldTime != std::chrono::seconds(0)) {
     scheduleTimeoutAt(prefixHoldUntilTimePoint_, [this]() {
       persistPrefixDb();
-      if (perPrefixKeys_) {
-        // advertise all prefixes
-        for (const auto& kv : prefixMap_) {
-          prefixesToUpdate_.emplace(kv.first);
-        }
+      // advertise all prefixes
+      for (const auto& kv : prefixMap_) {
+        prefixesToUpdate_.emplace(kv.first);
       }
       updateKvStore();
     });
@@ -150,6 +185,7 @@ PrefixManager::processKeyPrefixUpdate(
     }
   } else {
     // old key format, send prefix key update
+    prefixDbAdvertised_ = false;
     updateKvStore();
   }
 }
@@ -160,9 +196,49 @@ PrefixManager::persistPrefixDb() {
     // Too early for updating persistent file. Let timeout handle it
     return;
   }
+  if (persistentPrefixChanges_.empty()) {
+    return;
+  }
 
-  // prefixDb persistent entries have changed,
-  // save the newest persistent entries to disk.
+  // Current state of each persistent entry changed since prefix database was
+  // last written out in full
+  thrift::PrefixDatabaseDelta prefixDbDelta;
+  for (const auto& kv : persistentPrefixChanges_) {
+    const auto it = prefixMap_.find(kv.first);
+    for (const auto type : kv.second) {
+      if (it != prefixMap_.end()) {
+        const auto it2 = it->second.find(type);
+        if (it2 != it->second.end() and
+            not it2->second.ephemeral.value_or(false)) {
+          prefixDbDelta.updatedEntries.emplace_back(it2->second);
+          continue;
+        }
+      }
+      prefixDbDelta.withdrawnEntries.emplace_back(
+          createPrefixEntry(kv.first, type));
+    }
+  }
+
+  if (numPersistentPrefixChanges_ <= numPersistedPrefixEntries_) {
+    // Written out from event loop shortly, `flushPrefixDb` forces it
+    configStoreClient_.storeThriftObjWriteBehind(
+        kConfigDeltaKey, prefixDbDelta);
+    prefixDbDeltaStored_ = true;
+    return;
+  }
+
+  // Changes outgrew prefix database, write it out in full and start over.
+  // Changes on disk are brought up to date first, so that they load the same
+  // prefixes on top of either prefix database if a crash comes in between.
+  if (prefixDbDeltaStored_) {
+    auto ret =
+        configStoreClient_.storeThriftObj(kConfigDeltaKey, prefixDbDelta);
+    if (ret.hasError() or not ret.value()) {
+      LOG(ERROR) << "Error saving persistent prefixDb changes to file. "
+                 << (ret.hasError() ? ret.error().errString : "");
+      return;
+    }
+  }
   thrift::PrefixDatabase persistentPrefixDb;
   persistentPrefixDb.thisNodeName = nodeId_;
   for (const auto& kv : prefixMap_) {
@@ -172,65 +248,143 @@ PrefixManager::persistPrefixDb() {
       }
     }
   }
-
   auto ret = configStoreClient_.storeThriftObj(kConfigKey, persistentPrefixDb);
-  if (ret.hasError()) {
-    LOG(ERROR) << "Error saving persistent prefixDb to file. " << ret.error();
+  if (ret.hasError() or not ret.value()) {
+    LOG(ERROR) << "Error saving persistent prefixDb to file. "
+               << (ret.hasError() ? ret.error().errString : "");
+    return;
   }
+  numPersistedPrefixEntries_ = persistentPrefixDb.prefixEntries.size();
+  // Changes left on disk are overwritten by next ones
+  persistentPrefixChanges_.clear();
+  numPersistentPrefixChanges_ = 0;
 }
 
 void
-PrefixManager::advertisePrefixWithdraw(const thrift::PrefixEntry& prefixEntry) {
+PrefixManager::recordPersistentChange(const thrift::PrefixEntry& prefixEntry) {
+  if (prefixEntry.ephemeral.value_or(false)) {
+    return;
+  }
+  if (persistentPrefixChanges_[prefixEntry.prefix]
+          .emplace(prefixEntry.type)
+          .second) {
+    ++numPersistentPrefixChanges_;
+  }
+  persistPrefixDbThrottled_->operator()();
+}
+
+void
+PrefixManager::flushPrefixDb() {
+  auto flush = [this]() {
+    if (persistPrefixDbThrottled_->isActive()) {
+      persistPrefixDbThrottled_->cancel();
+      persistPrefixDb();
+    }
+    if (not configStoreClient_.flushPendingStores()) {
+      LOG(ERROR) << "Error saving persistent prefixDb to file.";
+    }
+  };
+  if (not isRunning()) {
+    flush();
+    return;
+  }
+  folly::Promise<folly::Unit> promise;
+  auto future = promise.getFuture();
+  runImmediatelyOrInEventLoop(
+      [flush = std::move(flush), promise = std::move(promise)]() mutable {
+        flush();
+        promise.setValue();
+      });
+  std::move(future).get();
+}
+
+void
+PrefixManager::stop() {
+  // Don't ack changes which never make it to disk
+  flushPrefixDb();
+  OpenrEventLoop::stop();
+}
+
+std::pair<std::string, std::string>
+PrefixManager::getPrefixKeyValue(
+    const thrift::PrefixEntry& prefixEntry, bool withdraw) {
   thrift::PrefixDatabase prefixDb;
   prefixDb.thisNodeName = nodeId_;
   prefixDb.prefixEntries = {prefixEntry};
-  prefixDb.deletePrefix = true;
-  auto prefixKey = PrefixKey(
+  prefixDb.deletePrefix = withdraw;
+  const auto prefixKey = PrefixKey(
       nodeId_,
-      folly::IPAddress::createNetwork(toString(prefixEntry.prefix)),
+      toIPNetwork(prefixEntry.prefix),
       thrift::KvStore_constants::kDefaultArea());
-  VLOG(1) << "Withdrawing prefix " << prefixKey.getPrefixKey()
-          << " from KvStore";
+  return std::make_pair(
+      prefixKey.getPrefixKey(), serializePrefixDb(std::move(prefixDb)));
+}
+
+void
+PrefixManager::advertisePrefixWithdraw(const thrift::PrefixEntry& prefixEntry) {
+  auto keyVal = getPrefixKeyValue(prefixEntry, true /* withdraw */);
+  VLOG(1) << "Withdrawing prefix " << keyVal.first << " from KvStore";
   kvStoreClient_.clearKey(
-      prefixKey.getPrefixKey(),
-      serializePrefixDb(std::move(prefixDb)),
-      ttlKeyInKvStore_);
+      keyVal.first, std::move(keyVal.second), ttlKeyInKvStore_);
 }
 
 void
 PrefixManager::advertisePrefix(const thrift::PrefixEntry& prefixEntry) {
-  /* code */
-  thrift::PrefixDatabase prefixDb;
-  prefixDb.thisNodeName = nodeId_;
-  prefixDb.prefixEntries.emplace_back(prefixEntry);
-
-  const auto prefixKey = PrefixKey(
-      nodeId_,
-      folly::IPAddress::createNetwork(toString(prefixEntry.prefix)),
-      thrift::KvStore_constants::kDefaultArea());
-  VLOG(1) << "Advertising prefix " << prefixKey.getPrefixKey()
-          << " to KvStore ";
-  kvStoreClient_.persistKey(
-      prefixKey.getPrefixKey(),
-      serializePrefixDb(std::move(prefixDb)),
-      ttlKeyInKvStore_);
+  const auto keyVal = getPrefixKeyValue(prefixEntry, false /* withdraw */);
+  VLOG(1) << "Advertising prefix " << keyVal.first << " to KvStore ";
+  kvStoreClient_.persistKey(keyVal.first, keyVal.second, ttlKeyInKvStore_);
 }
 
-void
-PrefixManager::updateKvStorePrefixKeys() {
-  // Incremental prefix updates, either add or delete from kvstore
-  // Check prefixMap_ to decide whether to add or delete
+std::pair<std::vector<thrift::PrefixEntry>, std::vector<thrift::IpPrefix>>
+PrefixManager::getPrefixChanges() {
+  std::vector<thrift::PrefixEntry> toAdvertise;
+  std::vector<thrift::IpPrefix> toWithdraw;
   for (const auto& ipPrefix : prefixesToUpdate_) {
     auto it = prefixMap_.find(ipPrefix);
+    auto advertisedIt = advertisedPrefixes_.find(ipPrefix);
     if (it == prefixMap_.end()) {
-      thrift::PrefixEntry prefixEntry;
-      prefixEntry.prefix = ipPrefix;
-      advertisePrefixWithdraw(prefixEntry);
+      // nothing to withdraw if it never made it to kvstore
+      if (advertisedIt != advertisedPrefixes_.end()) {
+        advertisedPrefixes_.erase(advertisedIt);
+        toWithdraw.emplace_back(ipPrefix);
+      }
+      continue;
+    }
+    const auto& bestEntry = it->second.begin()->second;
+    if (advertisedIt == advertisedPrefixes_.end()) {
+      advertisedPrefixes_.emplace(ipPrefix, bestEntry);
+    } else if (advertisedIt->second != bestEntry) {
+      advertisedIt->second = bestEntry;
     } else {
-      advertisePrefix(it->second.begin()->second);
+      continue;
     }
+    toAdvertise.emplace_back(bestEntry);
   }
   prefixesToUpdate_.clear();
+  return std::make_pair(std::move(toAdvertise), std::move(toWithdraw));
+}
+
+void
+PrefixManager::updateKvStorePrefixKeys() {
+  // Incremental prefix updates, either add or delete from kvstore, only for
+  // prefixes whose advertisement changes. All keys are sent in bulk to avoid
+  // KvStore round-trip per prefix.
+  const auto changes = getPrefixChanges();
+  std::unordered_map<std::string, std::string> keysToPersist;
+  std::unordered_map<std::string, std::string> keysToClear;
+  for (const auto& prefixEntry : changes.first) {
+    keysToPersist.emplace(getPrefixKeyValue(prefixEntry, false /* withdraw */));
+  }
+  for (const auto& ipPrefix : changes.second) {
+    thrift::PrefixEntry prefixEntry;
+    prefixEntry.prefix = ipPrefix;
+    keysToClear.emplace(getPrefixKeyValue(prefixEntry, true /* withdraw */));
+  }
+
+  LOG(INFO) << "Advertising " << keysToPersist.size() << " and withdrawing "
+            << keysToClear.size() << " prefix keys";
+  kvStoreClient_.persistKeys(keysToPersist, ttlKeyInKvStore_);
+  kvStoreClient_.clearKeys(keysToClear, ttlKeyInKvStore_);
 }
 
 void
@@ -245,11 +399,22 @@ PrefixManager::updateKvStore() {
   if (perPrefixKeys_) {
     return updateKvStorePrefixKeys();
   }
+  // Skip re-serializing whole prefix DB if burst of changes had no net
+  // effect on what we advertise
+  const auto changes = getPrefixChanges();
+  if (prefixDbAdvertised_ and changes.first.empty() and
+      changes.second.empty()) {
+    VLOG(1) << "No change in advertised prefixes";
+    return;
+  }
+  prefixDbAdvertised_ = true;
+
   // Update the kvstore with both persistent and ephemeral entries
   thrift::PrefixDatabase prefixDb;
   prefixDb.thisNodeName = nodeId_;
-  for (const auto& kv : prefixMap_) {
-    prefixDb.prefixEntries.emplace_back(kv.second.begin()->second);
+  prefixDb.prefixEntries.reserve(advertisedPrefixes_.size());
+  for (const auto& kv : advertisedPrefixes_) {
+    prefixDb.prefixEntries.emplace_back(kv.second);
   }
 
   const auto prefixDbKey = folly::sformat(
@@ -272,14 +437,10 @@ PrefixManager::processRequestMsg(fbzmq::Message&& request) {
 
   const auto& thriftReq = maybeThriftReq.value();
   thrift::PrefixManagerResponse response;
-  bool persistentEntryChange = false;
   bool kvStoreChange = false;
   switch (thriftReq.cmd) {
   case thrift::PrefixManagerCommand::ADD_PREFIXES: {
     tData_.addStatValue("prefix_manager.add_prefixes", 1, fbzmq::COUNT);
-    if (isAnyInputPrefixPersistent(thriftReq.prefixes)) {
-      persistentEntryChange = true;
-    }
     if (addOrUpdatePrefixes(thriftReq.prefixes)) {
       kvStoreChange = true;
       response.success = true;
@@ -291,9 +452,6 @@ PrefixManager::processRequestMsg(fbzmq::Message&& request) {
     break;
   }
   case thrift::PrefixManagerCommand::WITHDRAW_PREFIXES: {
-    if (isAnyExistingPrefixPersistent(thriftReq.prefixes)) {
-      persistentEntryChange = true;
-    }
     if (removePrefixes(thriftReq.prefixes)) {
       kvStoreChange = true;
       response.success = true;
@@ -305,9 +463,6 @@ PrefixManager::processRequestMsg(fbzmq::Message&& request) {
     break;
   }
   case thrift::PrefixManagerCommand::WITHDRAW_PREFIXES_BY_TYPE: {
-    if (isAnyExistingPrefixPersistentByType(thriftReq.type)) {
-      persistentEntryChange = true;
-    }
     if (removePrefixesByType(thriftReq.type)) {
       kvStoreChange = true;
       response.success = true;
@@ -318,10 +473,6 @@ PrefixManager::processRequestMsg(fbzmq::Message&& request) {
     break;
   }
   case thrift::PrefixManagerCommand::SYNC_PREFIXES_BY_TYPE: {
-    if (isAnyExistingPrefixPersistentByType(thriftReq.type) or
-        isAnyInputPrefixPersistent(thriftReq.prefixes)) {
-      persistentEntryChange = true;
-    }
     if (syncPrefixesByType(thriftReq.type, thriftReq.prefixes)) {
       kvStoreChange = true;
       response.success = true;
@@ -360,9 +511,6 @@ PrefixManager::processRequestMsg(fbzmq::Message&& request) {
   }
 
   if (response.success) {
-    if (persistentEntryChange) {
-      persistPrefixDb();
-    }
     if ((kvStoreChange) and
         (std::chrono::steady_clock::now() >= prefixHoldUntilTimePoint_)) {
       // Update kv store only after holdtime. All updates before holdtime
@@ -435,10 +583,10 @@ PrefixManager::addOrUpdatePrefixes(
     const std::vector<thrift::PrefixEntry>& prefixEntries) {
   bool updated{false};
   for (const auto& prefixEntry : prefixEntries) {
-    LOG(INFO) << "Advertising prefix " << toString(prefixEntry.prefix)
-              << ", client: "
-              << apache::thrift::TEnumTraits<thrift::PrefixType>::findName(
-                     prefixEntry.type);
+    VLOG(1) << "Advertising prefix " << toString(prefixEntry.prefix)
+            << ", client: "
+            << apache::thrift::TEnumTraits<thrift::PrefixType>::findName(
+                   prefixEntry.type);
     bool prefixUpdated{false};
 
     auto& prefixes = prefixMap_[prefixEntry.prefix];
@@ -448,13 +596,15 @@ PrefixManager::addOrUpdatePrefixes(
       prefixes.emplace(prefixEntry.type, prefixEntry);
       prefixUpdated = true;
     } else if (it->second != prefixEntry) {
+      recordPersistentChange(it->second);
       it->second = prefixEntry;
       prefixUpdated = true;
     }
 
     updated |= prefixUpdated;
-    if (prefixUpdated and perPrefixKeys_) {
+    if (prefixUpdated) {
       prefixesToUpdate_.emplace(prefixEntry.prefix);
+      recordPersistentChange(prefixEntry);
     }
   }
 
@@ -484,18 +634,19 @@ PrefixManager::removePrefixes(
   }
 
   for (const auto& prefix : prefixes) {
-    LOG(INFO) << "Withdrawing prefix " << toString(prefix.prefix)
-              << ", client: "
-              << apache::thrift::TEnumTraits<thrift::PrefixType>::findName(
-                     prefix.type);
+    VLOG(1) << "Withdrawing prefix " << toString(prefix.prefix)
+            << ", client: "
+            << apache::thrift::TEnumTraits<thrift::PrefixType>::findName(
+                   prefix.type);
     auto& prefixEntries = prefixMap_.at(prefix.prefix);
-    if (prefixEntries.erase(prefix.type)) {
+    auto it = prefixEntries.find(prefix.type);
+    if (it != prefixEntries.end()) {
+      recordPersistentChange(it->second);
+      prefixEntries.erase(it);
       if (not prefixEntries.size()) {
         prefixMap_.erase(prefix.prefix);
       }
-      if (perPrefixKeys_) {
-        prefixesToUpdate_.emplace(prefix.prefix);
-      }
+      prefixesToUpdate_.emplace(prefix.prefix);
     }
   }
   return true;
@@ -523,9 +674,8 @@ PrefixManager::syncPrefixesByType(
 
       // Erase prefixes not present in newPrefixes
       if (newPrefixes.count(it->first) == 0) {
-        if (perPrefixKeys_) {
-          prefixesToUpdate_.emplace(it->first);
-        }
+        prefixesToUpdate_.emplace(it->first);
+        recordPersistentChange(it2->second);
         it2 = it->second.erase(it2);
         updated = true;
       } else {
@@ -551,11 +701,12 @@ bool
 PrefixManager::removePrefixesByType(thrift::PrefixType type) {
   bool changed = false;
   for (auto it = prefixMap_.begin(); it != prefixMap_.end();) {
-    if (it->second.erase(type)) {
+    auto it2 = it->second.find(type);
+    if (it2 != it->second.end()) {
+      recordPersistentChange(it2->second);
+      it->second.erase(it2);
       changed = true;
-      if (perPrefixKeys_) {
-        prefixesToUpdate_.emplace(it->first);
-      }
+      prefixesToUpdate_.emplace(it->first);
     }
     if (not it->second.size()) {
       it = prefixMap_.erase(it);
@@ -566,51 +717,6 @@ PrefixManager::removePrefixesByType(thrift::PrefixType type) {
   return changed;
 }
 
-bool
-PrefixManager::isAnyInputPrefixPersistent(
-    const std::vector<thrift::PrefixEntry>& prefixes) const {
-  for (const auto& prefix : prefixes) {
-    if ((not prefix.ephemeral.hasValue()) || (not prefix.ephemeral.value())) {
-      return true;
-    }
-  }
-  return false;
-}
-
-bool
-PrefixManager::isAnyExistingPrefixPersistentByType(
-    thrift::PrefixType type) const {
-  for (const auto& kv : prefixMap_) {
-    auto it = kv.second.find(type);
-    if (it == kv.second.end()) {
-      continue;
-    }
-
-    if (not it->second.ephemeral.value_or(false)) {
-      return true;
-    }
-  }
-  return false;
-}
-
-bool
-PrefixManager::isAnyExistingPrefixPersistent(
-    const std::vector<thrift::PrefixEntry>& prefixes) const {
-  for (const auto& prefix : prefixes) {
-    auto it = prefixMap_.find(prefix.prefix);
-    if (it == prefixMap_.end()) {
-      continue;
-    }
-    auto it2 = it->second.find(prefix.type);
-    if (it2 != it->second.end()) {
-      if (not it2->second.ephemeral.value_or(false)) {
-        return true;
-      }
-    }
-  }
-  return false;
-}
-
 std::string
 PrefixManager::serializePrefixDb(thrift::PrefixDatabase&& prefixDb) {
   // Add perf information if enabled
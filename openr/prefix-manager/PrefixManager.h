@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <set>
 #include <string>
 #include <unordered_map>
 
@@ -51,16 +52,35 @@ class PrefixManager final : public OpenrEventLoop {
   // get prefix withdraw counter
   int64_t getPrefixWithdrawCounter();
 
+  // Write out persistent prefixes still held back by throttling or
+  // write-behind. Blocks till PersistentStore acked them.
+  void flushPrefixDb();
+
+  // Flushes prefix db before stopping event loop
+  void stop() override;
+
  private:
-  // Update persistent store with non-ephemeral prefix entries
+  // Update persistent store with changes of non-ephemeral prefix entries.
+  // Writes out full prefix database instead once changes outgrow it.
   void persistPrefixDb();
 
+  // Record change of entry in `persistentPrefixChanges_` if it is persistent
+  void recordPersistentChange(const thrift::PrefixEntry& prefixEntry);
+
   // Update kvstore with both ephemeral and non-ephemeral prefixes
   void updateKvStore();
 
   // update all IP keys in KvStore
   void updateKvStorePrefixKeys();
 
+  // Drain change log into `advertisedPrefixes_`. Returns best entries of
+  // prefixes to (re-)advertise and prefixes to withdraw, skipping ones whose
+  // advertised entry is unchanged, e.g. withdrawn and added back in a burst
+  std::pair<
+      std::vector<thrift::PrefixEntry> /* advertise */,
+      std::vector<thrift::IpPrefix> /* withdraw */>
+  getPrefixChanges();
+
   folly::Expected<fbzmq::Message, fbzmq::Error> processRequestMsg(
       fbzmq::Message&& request) override;
 
@@ -73,18 +93,6 @@ class PrefixManager final : public OpenrEventLoop {
       thrift::PrefixType type,
       const std::vector<thrift::PrefixEntry>& prefixes);
 
-  // Determine if any prefix entry is persistent (non-ephemeral) in input
-  bool isAnyInputPrefixPersistent(
-      const std::vector<thrift::PrefixEntry>& prefixes) const;
-
-  // Determine if any prefix entry is persistent (non-ephemeral) in prefixMap_
-  bool isAnyExistingPrefixPersistent(
-      const std::vector<thrift::PrefixEntry>& prefixes) const;
-
-  // Determine if any prefix entry is persistent (non-ephemeral) by type in
-  // prefixMap_
-  bool isAnyExistingPrefixPersistentByType(thrift::PrefixType type) const;
-
   // Submit internal state counters to monitor
   void submitCounters();
 
@@ -95,6 +103,11 @@ class PrefixManager final : public OpenrEventLoop {
   void processKeyPrefixUpdate(
       const std::string& key, folly::Optional<thrift::Value> value) noexcept;
 
+  // per prefix key and serialized prefix DB holding just `prefixEntry`, with
+  // delete prefix DB flag set if withdrawing
+  std::pair<std::string, std::string> getPrefixKeyValue(
+      const thrift::PrefixEntry& prefixEntry, bool withdraw);
+
   // add prefix entry in kvstore
   void advertisePrefix(const thrift::PrefixEntry& prefixEntry);
 
@@ -128,6 +141,10 @@ class PrefixManager final : public OpenrEventLoop {
   // send them in one go!
   std::unique_ptr<fbzmq::ZmqThrottle> updateKvStoreThrottled_;
 
+  // Throttled version of persistPrefixDb, writes out persistent prefix
+  // changes once per burst
+  std::unique_ptr<fbzmq::ZmqThrottle> persistPrefixDbThrottled_;
+
   // TTL for a key in the key value store
   const std::chrono::milliseconds ttlKeyInKvStore_;
 
@@ -154,8 +171,29 @@ class PrefixManager final : public OpenrEventLoop {
   // client to interact with monitor
   std::unique_ptr<fbzmq::ZmqMonitorClient> zmqMonitorClient_;
 
-  // IP perfixes to advertisze to kvstore (either add or delete)
+  // Change log: IP perfixes changed since last update of kvstore (either add
+  // or delete). Repeated changes of a prefix collapse into single entry.
   std::unordered_set<thrift::IpPrefix> prefixesToUpdate_{};
+
+  // Prefix entry currently advertised to kvstore for each prefix
+  std::unordered_map<thrift::IpPrefix, thrift::PrefixEntry>
+      advertisedPrefixes_{};
+
+  // Persistent prefix entries (prefix and type) changed since prefix
+  // database was last written out in full
+  std::unordered_map<thrift::IpPrefix, std::set<thrift::PrefixType>>
+      persistentPrefixChanges_{};
+  size_t numPersistentPrefixChanges_{0};
+
+  // Number of entries in prefix database last written out in full
+  size_t numPersistedPrefixEntries_{0};
+
+  // Whether changes were ever written to PersistentStore
+  bool prefixDbDeltaStored_{false};
+
+  // Whether prefix DB key is advertised and up to date with
+  // `advertisedPrefixes_` (when not using per prefix keys)
+  bool prefixDbAdvertised_{false};
 }; // PrefixManager
 
 } // namespace openr
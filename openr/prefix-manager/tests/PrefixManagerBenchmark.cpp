@@ -0,0 +1,493 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <unordered_set>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/init/Init.h>
+#include <glog/logging.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/config-store/PersistentStore.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/prefix-manager/PrefixManager.h>
+#include <openr/prefix-manager/PrefixManagerClient.h>
+
+/**
+ * Defines a benchmark that allows users to record customized counter during
+ * benchmarking and passes parameters to it. Custom name must be given to
+ * each set of parameters.
+ */
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FB_STRINGIZE(name) "(" FB_STRINGIZE(param_name) ")",             \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
+namespace {
+
+const std::string kNodeName{"node-1"};
+
+// Timeout for receiving publication from KvStore. Spans the maximum duration
+// PrefixManager can take to get update of all prefixes into KvStore
+const std::chrono::seconds kTimeout(100);
+
+/**
+ * Generate `count` distinct prefixes of given type starting at `offset`
+ */
+std::vector<openr::thrift::PrefixEntry>
+generatePrefixEntries(
+    uint32_t offset, uint32_t count, openr::thrift::PrefixType type) {
+  std::vector<openr::thrift::PrefixEntry> prefixEntries;
+  prefixEntries.reserve(count);
+  for (uint32_t i = offset; i < offset + count; ++i) {
+    prefixEntries.emplace_back(openr::createPrefixEntry(
+        openr::toIpPrefix(
+            folly::sformat("fc00:{:x}:{:x}::/64", i >> 16, i & 0xffff)),
+        type));
+  }
+  return prefixEntries;
+}
+
+/**
+ * Reset peak RSS of process to its current RSS, so that peak RSS is accounted
+ * per benchmark rather than across all benchmarks run before
+ */
+void
+resetPeakRss() {
+  LOG_IF(
+      WARNING,
+      not folly::writeFile(std::string("5"), "/proc/self/clear_refs", O_WRONLY))
+      << "Failed to reset peak RSS, it is accounted across benchmarks";
+}
+
+/**
+ * Peak RSS since last reset, -1 if unknown
+ */
+int64_t
+getPeakRssKb() {
+  std::string status;
+  if (not folly::readFile("/proc/self/status", status)) {
+    return -1;
+  }
+  const auto pos = status.find("VmHWM:");
+  if (pos == std::string::npos) {
+    return -1;
+  }
+  return std::strtoll(status.c_str() + pos + 6, nullptr, 10);
+}
+
+} // namespace
+
+namespace openr {
+
+/**
+ * PrefixManager along with in-process KvStore and PersistentStore it writes
+ * to. Prefix changes are driven through PrefixManagerClient, convergence is
+ * observed on KvStore publications.
+ */
+class PrefixManagerBenchmarkFixture {
+ public:
+  explicit PrefixManagerBenchmarkFixture(bool perPrefixKeys)
+      : perPrefixKeys_(perPrefixKeys) {
+    resetPeakRss();
+
+    // Writes to disk are real, backoff kept short so that all of them are
+    // done once benchmark wraps up
+    configStore_ = std::make_unique<PersistentStore>(
+        kNodeName,
+        storageFilePath_,
+        context_,
+        Constants::kPersistentStoreInitialBackoff,
+        Constants::kPersistentStoreInitialBackoff);
+    configStoreThread_ = std::thread([this]() { configStore_->run(); });
+    configStore_->waitUntilRunning();
+
+    kvStoreWrapper_ = std::make_unique<KvStoreWrapper>(
+        context_,
+        "store1",
+        std::chrono::seconds(3600) /* db sync interval */,
+        std::chrono::seconds(3600) /* counter submit interval */,
+        std::unordered_map<std::string, thrift::PeerSpec>{});
+    kvStoreWrapper_->run();
+
+    prefixManager_ = std::make_unique<PrefixManager>(
+        kNodeName,
+        PersistentStoreUrl{configStore_->inprocCmdUrl},
+        KvStoreLocalCmdUrl{kvStoreWrapper_->localCmdUrl},
+        KvStoreLocalPubUrl{kvStoreWrapper_->localPubUrl},
+        MonitorSubmitUrl{"inproc://monitor_submit"},
+        PrefixDbMarker{Constants::kPrefixDbMarker.toString()},
+        perPrefixKeys_,
+        false /* prefix-mananger perf measurement */,
+        std::chrono::seconds(0) /* prefix hold time */,
+        Constants::kKvStoreDbTtl,
+        context_);
+    prefixManagerThread_ = std::thread([this]() { prefixManager_->run(); });
+    prefixManager_->waitUntilRunning();
+
+    prefixManagerClient_ = std::make_unique<PrefixManagerClient>(
+        PrefixManagerLocalCmdUrl{prefixManager_->inprocCmdUrl}, context_);
+  }
+
+  ~PrefixManagerBenchmarkFixture() {
+    prefixManagerClient_.reset();
+    prefixManager_->stop();
+    prefixManagerThread_.join();
+    kvStoreWrapper_->stop();
+    configStore_->stop();
+    configStoreThread_.join();
+    ::unlink(storageFilePath_.c_str());
+  }
+
+  PrefixManagerClient&
+  getClient() {
+    return *prefixManagerClient_;
+  }
+
+  /**
+   * Block until KvStore reflects advertisement of `advertised` and withdrawal
+   * of `withdrawn` prefixes, with `numPrefixes` advertised in total. Returns
+   * number of bytes of values KvStore published meanwhile. Decoding of
+   * publications is not accounted in benchmark time.
+   */
+  uint64_t
+  waitForConvergence(
+      const std::vector<thrift::PrefixEntry>& advertised,
+      const std::vector<thrift::PrefixEntry>& withdrawn,
+      size_t numPrefixes) {
+    // prefix key -> whether it is expected to be withdrawn
+    std::unordered_map<std::string, bool> pendingKeys;
+    if (perPrefixKeys_) {
+      auto suspender = folly::BenchmarkSuspender();
+      for (const auto& entry : advertised) {
+        pendingKeys.emplace(getPrefixKey(entry), false);
+      }
+      for (const auto& entry : withdrawn) {
+        pendingKeys.emplace(getPrefixKey(entry), true);
+      }
+    }
+    const auto prefixDbKey = folly::sformat(
+        "{}{}", Constants::kPrefixDbMarker.toString(), kNodeName);
+
+    uint64_t bytes{0};
+    bool converged{false};
+    while (not converged) {
+      const auto publication = kvStoreWrapper_->recvPublication(kTimeout);
+      auto suspender = folly::BenchmarkSuspender();
+      for (const auto& kv : publication.keyVals) {
+        if (not kv.second.value.hasValue()) {
+          continue;
+        }
+        bytes += kv.first.size() + kv.second.value->size();
+        if (perPrefixKeys_) {
+          auto it = pendingKeys.find(kv.first);
+          if (it != pendingKeys.end() and
+              readPrefixDb(*kv.second.value).deletePrefix == it->second) {
+            pendingKeys.erase(it);
+          }
+        } else if (kv.first == prefixDbKey) {
+          std::unordered_set<thrift::IpPrefix> prefixes;
+          for (const auto& entry :
+               readPrefixDb(*kv.second.value).prefixEntries) {
+            prefixes.emplace(entry.prefix);
+          }
+          converged = prefixes.size() == numPrefixes;
+          for (const auto& entry : advertised) {
+            converged = converged and prefixes.count(entry.prefix) != 0;
+          }
+          for (const auto& entry : withdrawn) {
+            converged = converged and prefixes.count(entry.prefix) == 0;
+          }
+        }
+      }
+      if (perPrefixKeys_) {
+        converged = pendingKeys.empty();
+      }
+    }
+    return bytes;
+  }
+
+  /**
+   * Wait for PrefixManager to persist prefixes and PersistentStore to write
+   * them to disk. Returns number of writes and bytes written to disk so far,
+   * including log compaction.
+   */
+  std::pair<uint64_t, uint64_t>
+  waitForDiskWrites() {
+    std::this_thread::sleep_for(
+        2 * Constants::kPrefixMgrKvThrottleTimeout +
+        2 * Constants::kPersistentStoreWriteBehindDelay +
+        2 * Constants::kPersistentStoreInitialBackoff);
+    return std::make_pair(
+        configStore_->getNumOfDbWritesToDisk(),
+        configStore_->getNumOfBytesWrittenToDisk());
+  }
+
+ private:
+  std::string
+  getPrefixKey(const thrift::PrefixEntry& entry) const {
+    return PrefixKey(
+               kNodeName,
+               toIPNetwork(entry.prefix),
+               thrift::KvStore_constants::kDefaultArea())
+        .getPrefixKey();
+  }
+
+  thrift::PrefixDatabase
+  readPrefixDb(const std::string& value) {
+    return fbzmq::util::readThriftObjStr<thrift::PrefixDatabase>(
+        value, serializer_);
+  }
+
+  const bool perPrefixKeys_{false};
+  const std::string storageFilePath_{folly::sformat(
+      "/tmp/pm_benchmark_config_store.bin.{}",
+      std::hash<std::thread::id>{}(std::this_thread::get_id()))};
+
+  fbzmq::Context context_;
+  apache::thrift::CompactSerializer serializer_;
+
+  std::unique_ptr<PersistentStore> configStore_;
+  std::thread configStoreThread_;
+  std::unique_ptr<KvStoreWrapper> kvStoreWrapper_;
+  std::unique_ptr<PrefixManager> prefixManager_;
+  std::thread prefixManagerThread_;
+  std::unique_ptr<PrefixManagerClient> prefixManagerClient_;
+};
+
+/**
+ * Average per iteration KvStore bytes and convergence time, disk writes and
+ * bytes since `startDiskWrites` and peak RSS of benchmark as user counters
+ */
+void
+insertUserCounters(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint64_t kvStoreBytes,
+    std::chrono::steady_clock::duration convergenceTime,
+    std::pair<uint64_t, uint64_t> const& startDiskWrites,
+    PrefixManagerBenchmarkFixture& fixture) {
+  const auto diskWrites = fixture.waitForDiskWrites();
+  iters = iters == 0 ? 1 : iters;
+  counters["kvstore_bytes"] = kvStoreBytes / iters;
+  counters["convergence_ms"] =
+      std::chrono::duration_cast<std::chrono::milliseconds>(convergenceTime)
+          .count() /
+      iters;
+  counters["disk_writes"] = diskWrites.first - startDiskWrites.first;
+  counters["disk_bytes"] = diskWrites.second - startDiskWrites.second;
+  counters["peak_rss_kb"] = getPeakRssKb();
+}
+
+/**
+ * Benchmark for advertising prefixes
+ * 1. Advertise `numPrefixes` prefixes in one request
+ * 2. Wait until KvStore has all of them
+ * 3. Withdraw them again (not measured)
+ */
+static void
+BM_PrefixManagerAdvertise(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    bool perPrefixKeys,
+    uint32_t numPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  PrefixManagerBenchmarkFixture fixture(perPrefixKeys);
+  const auto prefixes =
+      generatePrefixEntries(0, numPrefixes, thrift::PrefixType::BGP);
+  const auto startDiskWrites = fixture.waitForDiskWrites();
+
+  uint64_t kvStoreBytes{0};
+  std::chrono::steady_clock::duration convergenceTime{0};
+  for (uint32_t i = 0; i < iters; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss();
+    fixture.getClient().addPrefixes(prefixes);
+    kvStoreBytes += fixture.waitForConvergence(prefixes, {}, numPrefixes);
+    suspender.rehire();
+    convergenceTime += std::chrono::steady_clock::now() - start;
+
+    fixture.getClient().withdrawPrefixes(prefixes);
+    fixture.waitForConvergence({}, prefixes, 0);
+  }
+
+  insertUserCounters(
+      counters,
+      iters,
+      kvStoreBytes,
+      convergenceTime,
+      startDiskWrites,
+      fixture);
+}
+
+/**
+ * Benchmark for withdrawing prefixes
+ * 1. Advertise `numPrefixes` prefixes in one request (not measured)
+ * 2. Withdraw them in one request
+ * 3. Wait until KvStore has all of them withdrawn
+ */
+static void
+BM_PrefixManagerWithdraw(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    bool perPrefixKeys,
+    uint32_t numPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  PrefixManagerBenchmarkFixture fixture(perPrefixKeys);
+  const auto prefixes =
+      generatePrefixEntries(0, numPrefixes, thrift::PrefixType::BGP);
+  const auto startDiskWrites = fixture.waitForDiskWrites();
+
+  uint64_t kvStoreBytes{0};
+  std::chrono::steady_clock::duration convergenceTime{0};
+  for (uint32_t i = 0; i < iters; ++i) {
+    fixture.getClient().addPrefixes(prefixes);
+    fixture.waitForConvergence(prefixes, {}, numPrefixes);
+
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss();
+    fixture.getClient().withdrawPrefixes(prefixes);
+    kvStoreBytes += fixture.waitForConvergence({}, prefixes, 0);
+    suspender.rehire();
+    convergenceTime += std::chrono::steady_clock::now() - start;
+  }
+
+  insertUserCounters(
+      counters,
+      iters,
+      kvStoreBytes,
+      convergenceTime,
+      startDiskWrites,
+      fixture);
+}
+
+/**
+ * Benchmark for syncing prefixes of a type, e.g. BGP speaker injecting its
+ * routes
+ * 1. Advertise `numPrefixes` prefixes (not measured)
+ * 2. Sync prefixes by type with half of them replaced by new ones
+ * 3. Wait until KvStore reflects the change
+ */
+static void
+BM_PrefixManagerSyncByType(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    bool perPrefixKeys,
+    uint32_t numPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  PrefixManagerBenchmarkFixture fixture(perPrefixKeys);
+  const uint32_t numChanged = numPrefixes / 2;
+  auto prefixes =
+      generatePrefixEntries(0, numPrefixes, thrift::PrefixType::BGP);
+  fixture.getClient().syncPrefixesByType(thrift::PrefixType::BGP, prefixes);
+  fixture.waitForConvergence(prefixes, {}, numPrefixes);
+  const auto startDiskWrites = fixture.waitForDiskWrites();
+
+  uint64_t kvStoreBytes{0};
+  std::chrono::steady_clock::duration convergenceTime{0};
+  for (uint32_t i = 0; i < iters; ++i) {
+    // slide window of prefixes, oldest half gets replaced
+    const std::vector<thrift::PrefixEntry> withdrawn(
+        prefixes.begin(), prefixes.begin() + numChanged);
+    const auto advertised = generatePrefixEntries(
+        (i + 2) * numChanged, numChanged, thrift::PrefixType::BGP);
+    prefixes.erase(prefixes.begin(), prefixes.begin() + numChanged);
+    prefixes.insert(prefixes.end(), advertised.begin(), advertised.end());
+
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss();
+    fixture.getClient().syncPrefixesByType(thrift::PrefixType::BGP, prefixes);
+    kvStoreBytes +=
+        fixture.waitForConvergence(advertised, withdrawn, prefixes.size());
+    suspender.rehire();
+    convergenceTime += std::chrono::steady_clock::now() - start;
+  }
+
+  insertUserCounters(
+      counters,
+      iters,
+      kvStoreBytes,
+      convergenceTime,
+      startDiskWrites,
+      fixture);
+}
+
+// Parameters are whether to use per prefix keys and number of prefixes
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, SingleKey_1000, false, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, SingleKey_10000, false, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, SingleKey_100000, false, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, SingleKey_500000, false, 500000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, PerPrefixKeys_1000, true, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, PerPrefixKeys_10000, true, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, PerPrefixKeys_100000, true, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAdvertise, counters, PerPrefixKeys_500000, true, 500000);
+
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, SingleKey_1000, false, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, SingleKey_10000, false, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, SingleKey_100000, false, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, SingleKey_500000, false, 500000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, PerPrefixKeys_1000, true, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, PerPrefixKeys_10000, true, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, PerPrefixKeys_100000, true, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerWithdraw, counters, PerPrefixKeys_500000, true, 500000);
+
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, SingleKey_1000, false, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, SingleKey_10000, false, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, SingleKey_100000, false, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, SingleKey_500000, false, 500000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, PerPrefixKeys_1000, true, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, PerPrefixKeys_10000, true, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, PerPrefixKeys_100000, true, 100000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerSyncByType, counters, PerPrefixKeys_500000, true, 500000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <thread>
+
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/Format.h>
 #include <glog/logging.h>
@@ -151,6 +153,7 @@ class PrefixManagerTestFixture : public testing::TestWithParam<bool> {
     PersistentStoreClient configStoreClient{
         PersistentStoreUrl{configStore->inprocCmdUrl}, context};
     configStoreClient.erase("prefix-manager-config");
+    configStoreClient.erase("prefix-manager-config-delta");
 
     // stop config store
     configStore->stop();
@@ -184,6 +187,26 @@ class PrefixManagerTestFixture : public testing::TestWithParam<bool> {
     return prefixEntries;
   }
 
+  // Wait till prefixes advertised by node-1 in KvStore include `prefixEntry`
+  void
+  waitForPrefixEntry(const thrift::PrefixEntry& prefixEntry) {
+    while (true) {
+      const auto prefixDb = getPrefixDb("prefix:node-1");
+      if (std::find(prefixDb.begin(), prefixDb.end(), prefixEntry) !=
+          prefixDb.end()) {
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  // PrefixManager throttles persisting config and writes it behind, make it
+  // write it out now. ConfigStore saves to disk before acking.
+  void
+  waitForConfigStoreWrites() {
+    prefixManager->flushPrefixDb();
+  }
+
   fbzmq::Context context;
 
   fbzmq::ZmqEventLoop evl;
@@ -429,6 +452,39 @@ TEST_P(PrefixManagerTestFixture, VerifyKvStore) {
   }
 }
 
+/**
+ * Changes within throttle window collapse into their net effect. Prefix added
+ * and withdrawn again never makes it to KvStore, not even as withdrawn prefix
+ * key.
+ */
+TEST_P(PrefixManagerTestFixture, CoalescePrefixChanges) {
+  prefixManagerClient->addPrefixes({prefixEntry1});
+  waitForPrefixEntry(prefixEntry1);
+  EXPECT_EQ(1, getPrefixDb("prefix:node-1").size());
+
+  prefixManagerClient->addPrefixes({prefixEntry2});
+  prefixManagerClient->withdrawPrefixes({prefixEntry2});
+  prefixManagerClient->syncPrefixesByType(
+      prefixEntry1.type, {prefixEntry1, prefixEntry3});
+  prefixManagerClient->syncPrefixesByType(prefixEntry1.type, {prefixEntry1});
+  // ends the burst, gets advertised along with rest of it
+  prefixManagerClient->addPrefixes({prefixEntry4});
+  waitForPrefixEntry(prefixEntry4);
+
+  for (const auto& prefixEntry : {prefixEntry2, prefixEntry3}) {
+    const auto prefixKey = PrefixKey(
+        "node-1",
+        toIPNetwork(prefixEntry.prefix),
+        thrift::KvStore_constants::kDefaultArea());
+    EXPECT_FALSE(kvStoreClient->getKey(prefixKey.getPrefixKey()).hasValue());
+  }
+  const auto prefixDb = getPrefixDb("prefix:node-1");
+  ASSERT_EQ(2, prefixDb.size());
+  EXPECT_NE(
+      std::find(prefixDb.begin(), prefixDb.end(), prefixEntry1),
+      prefixDb.end());
+}
+
 /**
  * Test prefix advertisement in KvStore with multiple clients.
  * NOTE: Priority LOOPBACK > DEFAULT > BGP
@@ -901,6 +957,7 @@ TEST_P(PrefixManagerTestFixture, CheckReload) {
   prefixManagerClient->addPrefixes({prefixEntry1});
   prefixManagerClient->addPrefixes({prefixEntry2});
   prefixManagerClient->addPrefixes({ephemeralPrefixEntry9});
+  waitForConfigStoreWrites();
   // spin up a new PrefixManager add verify that it loads the config
   auto prefixManager2 = std::make_unique<PrefixManager>(
       "node-2",
@@ -939,6 +996,56 @@ TEST_P(PrefixManagerTestFixture, CheckReload) {
   prefixManagerThread2->join();
 }
 
+TEST_P(PrefixManagerTestFixture, CheckReloadChanges) {
+  // written out as full prefix database
+  prefixManagerClient->addPrefixes({prefixEntry1, prefixEntry2, prefixEntry3});
+  waitForConfigStoreWrites();
+  EXPECT_EQ(1, configStore->getNumOfDbWritesToDisk());
+  // written out as changes on top of it
+  prefixManagerClient->withdrawPrefixes({prefixEntry1});
+  prefixManagerClient->addPrefixes({prefixEntry4});
+  waitForConfigStoreWrites();
+  EXPECT_EQ(2, configStore->getNumOfDbWritesToDisk());
+
+  // spin up a new PrefixManager add verify that it loads both
+  auto prefixManager2 = std::make_unique<PrefixManager>(
+      "node-2",
+      PersistentStoreUrl{configStore->inprocCmdUrl},
+      KvStoreLocalCmdUrl{kvStoreWrapper->localCmdUrl},
+      KvStoreLocalPubUrl{kvStoreWrapper->localPubUrl},
+      MonitorSubmitUrl{"inproc://monitor_submit"},
+      PrefixDbMarker{Constants::kPrefixDbMarker.toString()},
+      perPrefixKeys_ /* create IP prefix keys */,
+      false /* prefix-mananger perf measurement */,
+      std::chrono::seconds(0),
+      Constants::kKvStoreDbTtl,
+      context);
+
+  auto prefixManagerThread2 = std::make_unique<std::thread>([&]() {
+    LOG(INFO) << "PrefixManager thread starting";
+    prefixManager2->run();
+    LOG(INFO) << "PrefixManager thread finishing";
+  });
+  prefixManager2->waitUntilRunning();
+
+  auto prefixManagerClient2 = std::make_unique<PrefixManagerClient>(
+      PrefixManagerLocalCmdUrl{prefixManager2->inprocCmdUrl}, context);
+
+  auto resp = prefixManagerClient2->getPrefixes();
+  EXPECT_TRUE(resp.value().success);
+  auto& prefixes = resp.value().prefixes;
+  EXPECT_EQ(3, prefixes.size());
+  for (const auto& prefixEntry : {prefixEntry2, prefixEntry3, prefixEntry4}) {
+    EXPECT_NE(
+        std::find(prefixes.begin(), prefixes.end(), prefixEntry),
+        prefixes.end());
+  }
+
+  // cleanup
+  prefixManager2->stop();
+  prefixManagerThread2->join();
+}
+
 TEST_P(PrefixManagerTestFixture, GetPrefixes) {
   prefixManagerClient->addPrefixes({prefixEntry1});
   prefixManagerClient->addPrefixes({prefixEntry2});
@@ -1109,33 +1216,41 @@ TEST_P(PrefixManagerTestFixture, CheckPersistStoreUpdate) {
   // Verify that any action on persistent entries leads to update of store
   prefixManagerClient->addPrefixes({prefixEntry1, prefixEntry2, prefixEntry3});
   // 3 prefixes leads to 1 write
+  waitForConfigStoreWrites();
   ASSERT_EQ(1, configStore->getNumOfDbWritesToDisk());
 
   prefixManagerClient->withdrawPrefixes({prefixEntry1});
+  waitForConfigStoreWrites();
   ASSERT_EQ(2, configStore->getNumOfDbWritesToDisk());
 
   prefixManagerClient->syncPrefixesByType(
       thrift::PrefixType::PREFIX_ALLOCATOR, {prefixEntry2, prefixEntry4});
+  waitForConfigStoreWrites();
   ASSERT_EQ(3, configStore->getNumOfDbWritesToDisk());
 
   prefixManagerClient->withdrawPrefixesByType(
       thrift::PrefixType::PREFIX_ALLOCATOR);
+  waitForConfigStoreWrites();
   ASSERT_EQ(4, configStore->getNumOfDbWritesToDisk());
 
   // Verify that any actions on ephemeral entries does not lead to update of
   // store
   prefixManagerClient->addPrefixes(
       {ephemeralPrefixEntry9, ephemeralPrefixEntry10});
+  waitForConfigStoreWrites();
   ASSERT_EQ(4, configStore->getNumOfDbWritesToDisk());
 
   prefixManagerClient->withdrawPrefixes({ephemeralPrefixEntry9});
+  waitForConfigStoreWrites();
   ASSERT_EQ(4, configStore->getNumOfDbWritesToDisk());
 
   prefixManagerClient->syncPrefixesByType(
       thrift::PrefixType::BGP, {ephemeralPrefixEntry10});
+  waitForConfigStoreWrites();
   ASSERT_EQ(4, configStore->getNumOfDbWritesToDisk());
 
   prefixManagerClient->withdrawPrefixesByType(thrift::PrefixType::BGP);
+  waitForConfigStoreWrites();
   ASSERT_EQ(4, configStore->getNumOfDbWritesToDisk());
 }
 
@@ -1146,40 +1261,49 @@ TEST_P(PrefixManagerTestFixture, CheckEphemeralAndPersistentUpdate) {
   // Verify that any action on persistent entries leads to update of store
   prefixManagerClient->addPrefixes(
       {persistentPrefixEntry9, ephemeralPrefixEntry10});
+  waitForConfigStoreWrites();
   ASSERT_EQ(1, configStore->getNumOfDbWritesToDisk());
 
   // Change persistance characterstic. Expect disk update
   prefixManagerClient->syncPrefixesByType(
       thrift::PrefixType::BGP,
       {ephemeralPrefixEntry9, persistentPrefixEntry10});
+  waitForConfigStoreWrites();
   ASSERT_EQ(2, configStore->getNumOfDbWritesToDisk());
 
   // Only ephemeral entry withdrawn, so no update to disk
   prefixManagerClient->withdrawPrefixes({ephemeralPrefixEntry9});
+  waitForConfigStoreWrites();
   ASSERT_EQ(2, configStore->getNumOfDbWritesToDisk());
 
   // Persistent entry withdrawn, expect update to disk
   prefixManagerClient->withdrawPrefixes({persistentPrefixEntry10});
+  waitForConfigStoreWrites();
   ASSERT_EQ(3, configStore->getNumOfDbWritesToDisk());
 
-  // Restore the state to mix of ephemeral and persistent of a type
+  // Restore the state to mix of ephemeral and persistent of a type. Changes
+  // outgrow prefix database, both are written out.
   prefixManagerClient->addPrefixes(
       {persistentPrefixEntry9, ephemeralPrefixEntry10});
-  ASSERT_EQ(4, configStore->getNumOfDbWritesToDisk());
+  waitForConfigStoreWrites();
+  ASSERT_EQ(5, configStore->getNumOfDbWritesToDisk());
 
   // Verify that withdraw by type, updates disk
   prefixManagerClient->withdrawPrefixesByType(thrift::PrefixType::BGP);
-  ASSERT_EQ(5, configStore->getNumOfDbWritesToDisk());
+  waitForConfigStoreWrites();
+  ASSERT_EQ(6, configStore->getNumOfDbWritesToDisk());
 
   // Restore the state to mix of ephemeral and persistent of a type
   prefixManagerClient->addPrefixes(
       {persistentPrefixEntry9, ephemeralPrefixEntry10});
-  ASSERT_EQ(6, configStore->getNumOfDbWritesToDisk());
+  waitForConfigStoreWrites();
+  ASSERT_EQ(7, configStore->getNumOfDbWritesToDisk());
 
   // Verify that entry in DB being deleted is persistent so file is update
   prefixManagerClient->syncPrefixesByType(
       thrift::PrefixType::BGP, {ephemeralPrefixEntry10});
-  ASSERT_EQ(7, configStore->getNumOfDbWritesToDisk());
+  waitForConfigStoreWrites();
+  ASSERT_EQ(8, configStore->getNumOfDbWritesToDisk());
 }
 
 int
@@ -17,6 +17,7 @@ from openr.LinkMonitor import ttypes as lm_types
 from openr.Lsdb import ttypes as lsdb_types
 from openr.OpenrCtrl import OpenrCtrl
 from openr.OpenrCtrl.ttypes import OpenrError
+from openr.PrefixManager import ttypes as pm_types
 from openr.utils import ipnetwork, printing
 from openr.utils.consts import Consts
 from openr.utils.serializer import deserialize_thrift_object
@@ -128,8 +129,38 @@ class ConfigPrefixManagerCmd(ConfigStoreCmdBase):
         prefix_mgr_config = deserialize_thrift_object(
             prefix_mgr_config_blob, lsdb_types.PrefixDatabase
         )
+
+        # Apply changes written out since full prefix database, if any
+        (prefix_mgr_delta_blob, _) = self.getConfigWrapper(
+            client, Consts.PREFIX_MGR_DELTA_KEY
+        )
+        if prefix_mgr_delta_blob is not None:
+            prefix_mgr_delta = deserialize_thrift_object(
+                prefix_mgr_delta_blob, pm_types.PrefixDatabaseDelta
+            )
+            self.apply_delta(prefix_mgr_config, prefix_mgr_delta)
+
         self.print_config(prefix_mgr_config)
 
+    def apply_delta(
+        self,
+        prefix_mgr_config: lsdb_types.PrefixDatabase,
+        prefix_mgr_delta: pm_types.PrefixDatabaseDelta,
+    ) -> None:
+        def entry_key(entry: lsdb_types.PrefixEntry) -> Tuple[bytes, int, int]:
+            return (
+                entry.prefix.prefixAddress.addr,
+                entry.prefix.prefixLength,
+                entry.type,
+            )
+
+        entries = {entry_key(e): e for e in prefix_mgr_config.prefixEntries}
+        for entry in prefix_mgr_delta.withdrawnEntries:
+            entries.pop(entry_key(entry), None)
+        for entry in prefix_mgr_delta.updatedEntries:
+            entries[entry_key(entry)] = entry
+        prefix_mgr_config.prefixEntries = list(entries.values())
+
     def print_config(self, prefix_mgr_config: lsdb_types.PrefixDatabase):
         print()
         print(utils.sprint_prefixes_db_full(prefix_mgr_config))
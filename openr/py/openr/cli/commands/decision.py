@@ -22,7 +22,6 @@ from openr.Network import ttypes as network_types
 from openr.OpenrCtrl import OpenrCtrl
 from openr.utils import ipnetwork, printing
 from openr.utils.consts import Consts
-from openr.utils.serializer import deserialize_thrift_object
 
 
 class DecisionCmdBase(OpenrCtrlCmd):
@@ -293,7 +292,7 @@ class PathCmd(DecisionCmdBase):
 
         try:
             client = utils.get_fib_agent_client(src_addr, fib_agent_port, timeout)
-            routes = client.getRouteTableByClient(client.client_id)
+            routes = utils.get_fib_unicast_routes(client, client.client_id)
         except Exception:
             return []
         for route in routes:
@@ -411,13 +410,13 @@ class DecisionValidateCmd(DecisionCmdBase):
         kvstore_adj_node_names = set()
         kvstore_prefix_node_names = set()
 
-        for key, value in sorted(kvstore_keyvals.items()):
-            if key.startswith(Consts.ADJ_DB_MARKER):
-                return_code = self.print_db_delta_adj(
-                    key, value, kvstore_adj_node_names, decision_adj_dbs, json
-                )
-                if return_code != 0:
-                    return return_code
+        kvstore_adj_dbs = utils.collate_adj_keys(kvstore_keyvals)
+        for _, kvstore_adj_db in sorted(kvstore_adj_dbs.items()):
+            return_code = self.print_db_delta_adj(
+                kvstore_adj_db, kvstore_adj_node_names, decision_adj_dbs, json
+            )
+            if return_code != 0:
+                return return_code
 
         return_code = self.print_db_delta_prefix(
             kvstore_keyvals, kvstore_prefix_node_names, decision_prefix_dbs, json
@@ -463,13 +462,10 @@ class DecisionValidateCmd(DecisionCmdBase):
         return (decision_adj_dbs, decision_prefix_dbs, kvstore_keyvals)
 
     def print_db_delta_adj(
-        self, key, value, kvstore_adj_node_names, decision_adj_dbs, json
+        self, kvstore_adj_db, kvstore_adj_node_names, decision_adj_dbs, json
     ):
         """ Returns status code. 0 = success, 1 = failure"""
 
-        kvstore_adj_db = deserialize_thrift_object(
-            value.value, lsdb_types.AdjacencyDatabase
-        )
         node_name = kvstore_adj_db.thisNodeName
         kvstore_adj_node_names.add(node_name)
         if node_name not in decision_adj_dbs:
@@ -95,7 +95,7 @@ class FibRoutesInstalledCmd(FibAgentCmd):
         client_id = client_id if client_id is not None else self.client.client_id
 
         try:
-            routes = self.client.getRouteTableByClient(client_id)
+            routes = utils.get_fib_unicast_routes(self.client, client_id)
         except Exception as e:
             print("Failed to get routes from Fib.")
             print("Exception: {}".format(e))
@@ -105,7 +105,7 @@ class FibRoutesInstalledCmd(FibAgentCmd):
             host_id = client.getMyNodeName()
 
         try:
-            mpls_routes = self.client.getMplsRouteTableByClient(client_id)
+            mpls_routes = utils.get_fib_mpls_routes(self.client, client_id)
         except Exception as e:
             print("Pls check Open/R version. Exception: {}".format(e))
 
@@ -190,8 +190,8 @@ class FibValidateRoutesCmd(FibAgentCmd):
             )
             (fib_unicast_routes, fib_mpls_routes) = utils.get_routes(fib_route_db)
             # fetch route from net_agent module
-            agent_unicast_routes = self.client.getRouteTableByClient(
-                self.client.client_id
+            agent_unicast_routes = utils.get_fib_unicast_routes(
+                self.client, self.client.client_id
             )
 
         except Exception as e:
@@ -229,8 +229,8 @@ class FibValidateRoutesCmd(FibAgentCmd):
 
         # for backward compatibily of Open/R binary
         try:
-            agent_mpls_routes = self.client.getMplsRouteTableByClient(
-                self.client.client_id
+            agent_mpls_routes = utils.get_fib_mpls_routes(
+                self.client, self.client.client_id
             )
         except Exception as e:
             print("Pls check Open/R version. Exception: {}".format(e))
@@ -789,7 +789,23 @@ class SnoopCmd(KvStoreCmdBase):
             # Delete key from global DBs
             global_dbs.publications.pop(key, None)
             if key.startswith(Consts.ADJ_DB_MARKER):
-                global_dbs.adjs.pop(key.split(":")[1], None)
+                adj_match = re.match(Consts.PER_ADJ_KEY_REGEX, key)
+                # in case of per adjacency key expire, only that adjacency of
+                # the node goes away
+                if adj_match:
+                    node_name = adj_match.group("node")
+                    if node_name in global_dbs.adjs:
+                        utils.update_global_adj_db(
+                            global_dbs.adjs,
+                            lsdb_types.AdjacencyDatabase(
+                                thisNodeName=node_name,
+                                adjacencies=[],
+                                deleteAdjacency=True,
+                            ),
+                            key,
+                        )
+                else:
+                    global_dbs.adjs.pop(key.split(":")[1], None)
 
             if key.startswith(Consts.PREFIX_DB_MARKER):
                 prefix_match = re.match(Consts.PER_PREFIX_KEY_REGEX, key)
@@ -894,6 +910,7 @@ class SnoopCmd(KvStoreCmdBase):
         new_adj_db = serializer.deserialize_thrift_object(
             value.value, lsdb_types.AdjacencyDatabase
         )
+        new_adj_db = utils.merge_adj_db(global_adj_db, new_adj_db, key)
         if delta:
             old_adj_db = global_adj_db.get(new_adj_db.thisNodeName, None)
             if old_adj_db is None:
@@ -11,10 +11,17 @@
 import time
 import unittest
 
-from openr.cli.utils.utils import find_adj_list_deltas, parse_prefix_database
+from openr.cli.utils.utils import (
+    collate_adj_keys,
+    find_adj_list_deltas,
+    parse_prefix_database,
+    update_global_adj_db,
+)
+from openr.KvStore import ttypes as kv_store_types
 from openr.Lsdb import ttypes as lsdb_types
 from openr.Network import ttypes as network_types
 from openr.utils import ipnetwork
+from openr.utils.serializer import serialize_thrift_object
 
 
 class UtilsTests(unittest.TestCase):
@@ -105,3 +112,89 @@ class UtilsTests(unittest.TestCase):
         data = {}
         parse_prefix_database("2.0.0.0/8", "bgp", data, prefix_db)
         self.assertEqual(data["node1"].prefixEntries, [bgp2])
+
+    def test_collate_adj_keys(self):
+        adj_b = self.create_adjacency("nodeB", "ifaceX")
+        adj_c = self.create_adjacency("nodeC", "ifaceY")
+
+        def _value(adj_db):
+            return kv_store_types.Value(
+                version=1, value=serialize_thrift_object(adj_db)
+            )
+
+        keyvals = {
+            # node advertising per adjacency keys
+            "adj:nodeA": _value(
+                lsdb_types.AdjacencyDatabase(
+                    thisNodeName="nodeA",
+                    isOverloaded=True,
+                    adjacencies=[],
+                    nodeLabel=1,
+                    perAdjacencyKey=True,
+                )
+            ),
+            "adj:nodeA:nodeB:ifaceX": _value(
+                lsdb_types.AdjacencyDatabase(
+                    thisNodeName="nodeA",
+                    adjacencies=[adj_b],
+                    nodeLabel=1,
+                    perAdjacencyKey=True,
+                )
+            ),
+            "adj:nodeA:nodeC:ifaceY": _value(
+                lsdb_types.AdjacencyDatabase(
+                    thisNodeName="nodeA",
+                    adjacencies=[adj_c],
+                    nodeLabel=1,
+                    perAdjacencyKey=True,
+                    deleteAdjacency=True,
+                )
+            ),
+            # node advertising all of its adjacencies under single key
+            "adj:nodeB": _value(
+                lsdb_types.AdjacencyDatabase(
+                    thisNodeName="nodeB", adjacencies=[adj_c], nodeLabel=2
+                )
+            ),
+        }
+
+        adj_dbs = collate_adj_keys(keyvals)
+        self.assertEqual({"nodeA", "nodeB"}, set(adj_dbs.keys()))
+        self.assertTrue(adj_dbs["nodeA"].isOverloaded)
+        self.assertEqual([adj_b], adj_dbs["nodeA"].adjacencies)
+        self.assertEqual([adj_c], adj_dbs["nodeB"].adjacencies)
+
+        # adjacency update and withdrawal only touch that adjacency
+        update_global_adj_db(
+            adj_dbs,
+            lsdb_types.AdjacencyDatabase(
+                thisNodeName="nodeA", adjacencies=[adj_c], perAdjacencyKey=True
+            ),
+            "adj:nodeA:nodeC:ifaceY",
+        )
+        self.assertEqual([adj_b, adj_c], adj_dbs["nodeA"].adjacencies)
+        update_global_adj_db(
+            adj_dbs,
+            lsdb_types.AdjacencyDatabase(
+                thisNodeName="nodeA",
+                adjacencies=[adj_b],
+                perAdjacencyKey=True,
+                deleteAdjacency=True,
+            ),
+            "adj:nodeA:nodeB:ifaceX",
+        )
+        self.assertEqual([adj_c], adj_dbs["nodeA"].adjacencies)
+
+        # node attributes keep adjacencies
+        update_global_adj_db(
+            adj_dbs,
+            lsdb_types.AdjacencyDatabase(
+                thisNodeName="nodeA",
+                isOverloaded=False,
+                adjacencies=[],
+                perAdjacencyKey=True,
+            ),
+            "adj:nodeA",
+        )
+        self.assertFalse(adj_dbs["nodeA"].isOverloaded)
+        self.assertEqual([adj_c], adj_dbs["nodeA"].adjacencies)
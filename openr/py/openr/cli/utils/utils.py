@@ -33,6 +33,7 @@ from openr.utils import ipnetwork, printing
 from openr.utils.consts import Consts
 from openr.utils.serializer import deserialize_thrift_object
 from thrift.protocol import TBinaryProtocol
+from thrift.Thrift import TApplicationException
 from thrift.transport import TSocket, TTransport
 
 
@@ -139,6 +140,59 @@ def get_fib_agent_client(
     return client
 
 
+def _get_paged_routes(get_page, get_all, client_id):
+    """
+    Walk route table of Fib agent page by page. Falls back to fetching whole
+    table at once from agents not supporting paginated API.
+    """
+
+    routes = []
+    cursor = 0
+    try:
+        while True:
+            page = get_page(client_id, cursor, Consts.FIB_ROUTE_TABLE_PAGE_SIZE)
+            routes.extend(page.routes)
+            cursor = page.nextCursor
+            if not cursor:
+                return routes
+    except TApplicationException as e:
+        if e.type != TApplicationException.UNKNOWN_METHOD:
+            raise
+        return get_all(client_id)
+
+
+def get_fib_unicast_routes(client, client_id):
+    """
+    Get unicast routes of client from Fib agent
+
+    :param client: FibService.Client
+    :param client_id: Fib client whose routes are retrieved
+
+    :returns: list of network_types.UnicastRoute
+    """
+
+    return _get_paged_routes(
+        client.getRouteTableByClientPaged, client.getRouteTableByClient, client_id
+    )
+
+
+def get_fib_mpls_routes(client, client_id):
+    """
+    Get MPLS routes of client from Fib agent
+
+    :param client: FibService.Client
+    :param client_id: Fib client whose routes are retrieved
+
+    :returns: list of network_types.MplsRoute
+    """
+
+    return _get_paged_routes(
+        client.getMplsRouteTableByClientPaged,
+        client.getMplsRouteTableByClient,
+        client_id,
+    )
+
+
 def parse_nodes(cli_opts, nodes):
     """ parse nodes from user input
 
@@ -308,6 +362,76 @@ def collate_prefix_keys(
     return prefix_maps
 
 
+def collate_adj_keys(
+    kvstore_keyvals: kv_store_types.KeyVals
+) -> Dict[str, lsdb_types.AdjacencyDatabase]:
+    """ collate adjacencies of nodes advertising per adjacency keys
+        (adj:<node>:<otherNode>:<ifName>) into their node's AdjacencyDatabase
+        and return a map of nodename - AdjacencyDatabase
+    """
+
+    adj_dbs = {}
+    per_key_adjs = {}
+    for key, value in sorted(kvstore_keyvals.items()):
+        if not key.startswith(Consts.ADJ_DB_MARKER) or value.value is None:
+            continue
+
+        adj_db = deserialize_thrift_object(value.value, lsdb_types.AdjacencyDatabase)
+        adj_match = re.match(Consts.PER_ADJ_KEY_REGEX, key)
+        if adj_match:
+            if not adj_db.deleteAdjacency:
+                node_adjs = per_key_adjs.setdefault(adj_match.group("node"), [])
+                node_adjs.extend(adj_db.adjacencies[:1])
+        else:
+            adj_dbs[adj_db.thisNodeName] = adj_db
+
+    # same as Decision, adjacencies of per adjacency keys are only used once
+    # node's own key says it advertises them that way
+    for node_name, adj_db in adj_dbs.items():
+        if adj_db.perAdjacencyKey:
+            adj_db.adjacencies = per_key_adjs.get(node_name, [])
+
+    return adj_dbs
+
+
+def merge_adj_db(global_adj_db, adj_db, key=None):
+    """ merge adjacency database published under key into the node's one
+        from the global adj map
+
+        node advertising per adjacency keys only publishes its attributes
+        under adj:<node> and each adjacency under its own key, so neither of
+        them replaces the whole node's database
+
+        :param global_adj_map map(node, AdjacencyDatabase)
+        :param adj_db lsdb_types.AdjacencyDatabase: publication from single
+            node
+        :param key str: key adj_db was published under
+
+        :return lsdb_types.AdjacencyDatabase: node's database after update
+    """
+
+    old_adj_db = global_adj_db.get(adj_db.thisNodeName, None)
+    adj_match = re.match(Consts.PER_ADJ_KEY_REGEX, key) if key else None
+    if adj_match is None:
+        if adj_db.perAdjacencyKey and old_adj_db is not None:
+            adj_db = copy.copy(adj_db)
+            adj_db.adjacencies = list(old_adj_db.adjacencies)
+        return adj_db
+
+    adj_id = (adj_match.group("other_node"), adj_match.group("if_name"))
+    node_adj_db = copy.copy(old_adj_db if old_adj_db is not None else adj_db)
+    node_adj_db.adjacencies = [
+        adj
+        for adj in (old_adj_db.adjacencies if old_adj_db is not None else [])
+        if (adj.otherNodeName, adj.ifName) != adj_id
+    ]
+    if not adj_db.deleteAdjacency:
+        node_adj_db.adjacencies.extend(adj_db.adjacencies[:1])
+    node_adj_db.perAdjacencyKey = True
+    node_adj_db.deleteAdjacency = None
+    return node_adj_db
+
+
 def prefix_entry_to_dict(prefix_entry):
     """ convert prefixEntry from thrift instance into a dict in strings """
 
@@ -355,18 +479,20 @@ def print_prefixes_json(resp, nodes, prefix, client_type, iter_func):
     print(json_dumps(prefixes_map))
 
 
-def update_global_adj_db(global_adj_db, adj_db):
+def update_global_adj_db(global_adj_db, adj_db, key=None):
     """ update the global adj map based on publication from single node
 
         :param global_adj_map map(node, AdjacencyDatabase)
             the map for all adjacencies in the network - to be updated
         :param adj_db lsdb_types.AdjacencyDatabase: publication from single
             node
+        :param key str: key adj_db was published under, if it is a per
+            adjacency key only that adjacency of the node is updated
     """
 
     assert isinstance(adj_db, lsdb_types.AdjacencyDatabase)
 
-    global_adj_db[adj_db.thisNodeName] = adj_db
+    global_adj_db[adj_db.thisNodeName] = merge_adj_db(global_adj_db, adj_db, key)
 
 
 def build_global_adj_db(resp):
@@ -381,15 +507,7 @@ def build_global_adj_db(resp):
     """
 
     # map: (node) -> AdjacencyDatabase)
-    global_adj_db = {}
-
-    for (key, value) in resp.keyVals.items():
-        if not key.startswith(Consts.ADJ_DB_MARKER):
-            continue
-        adj_db = deserialize_thrift_object(value.value, lsdb_types.AdjacencyDatabase)
-        update_global_adj_db(global_adj_db, adj_db)
-
-    return global_adj_db
+    return collate_adj_keys(resp.keyVals)
 
 
 def build_global_prefix_db(resp):
@@ -495,6 +613,14 @@ def adj_dbs_to_dict(resp, nodes, bidir, iter_func):
     adj_dbs = resp
     if isinstance(adj_dbs, kv_store_types.Publication):
         adj_dbs = build_global_adj_db(resp)
+        # adjacencies of per adjacency keys are collated into their node's
+        # database, only walk node keys
+        resp = copy.copy(resp)
+        resp.keyVals = {
+            key: value
+            for key, value in resp.keyVals.items()
+            if not re.match(Consts.PER_ADJ_KEY_REGEX, key)
+        }
 
     def _parse_adj(adjs_map, adj_db):
         version = None
@@ -503,6 +629,7 @@ def adj_dbs_to_dict(resp, nodes, bidir, iter_func):
             adj_db = deserialize_thrift_object(
                 adj_db.value, lsdb_types.AdjacencyDatabase
             )
+            adj_db = adj_dbs.get(adj_db.thisNodeName, adj_db)
         adj_db_to_dict(adjs_map, adj_dbs, adj_db, bidir, version)
 
     adjs_map = {}
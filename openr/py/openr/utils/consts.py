@@ -31,6 +31,8 @@ class Consts(object):
     MONITOR_PUB_PORT = 60007
     MONITOR_REP_PORT = 60008
     FIB_AGENT_PORT = 60100
+    # Number of routes requested per page from Fib agent
+    FIB_ROUTE_TABLE_PAGE_SIZE = 10000
     CONFIG_STORE_URL = "ipc:///tmp/openr_config_store_cmd"
     FORCE_CRASH_SERVER_URL = "ipc:///tmp/force_crash_server"
 
@@ -39,6 +41,7 @@ class Consts(object):
     PREFIX_ALLOC_KEY = "prefix-allocator-config"
     LINK_MONITOR_KEY = "link-monitor-config"
     PREFIX_MGR_KEY = "prefix-manager-config"
+    PREFIX_MGR_DELTA_KEY = "prefix-manager-config-delta"
 
     # Default serializer/deserializer for communication with OpenR
     PROTO_FACTORY = TCompactProtocolFactory
@@ -57,3 +60,12 @@ class Consts(object):
         + r"\[(?P<ipaddr>[a-fA-F0-9\.\:].*)/"
         + r"(?P<plen>[0-9]{1,3})\]"
     )
+
+    # per adjacency key regex for the following format
+    # adj:e00.0002.node2:e00.0003.node3:po1011
+    PER_ADJ_KEY_REGEX = (
+        re.escape(ADJ_DB_MARKER)
+        + r"(?P<node>[A-Za-z0-9\._-]+):"
+        + r"(?P<other_node>[A-Za-z0-9\._-]+):"
+        + r"(?P<if_name>.+)"
+    )
@@ -7,15 +7,195 @@
 
 #include "IoProvider.h"
 
+#include <linux/errqueue.h>
 #include <net/if.h>
 
+#include <algorithm>
+
 #include <glog/logging.h>
 
 #include <folly/Format.h>
+#include <folly/Optional.h>
 #include <folly/SocketAddress.h>
 
 namespace openr {
 
+namespace {
+
+// cast to int64_t since ts.tv_sec is 32 bits on some platforms like arm
+std::chrono::microseconds
+toMicroseconds(struct timespec const& ts) {
+  return std::chrono::microseconds(
+      static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000);
+}
+
+// Extract ifIndex, hopLimit and kernel receive timestamp from control
+// messages of received message
+void
+parseControlMessages(
+    struct msghdr& msg,
+    int& ifIndex,
+    int& hopLimit,
+    std::chrono::microseconds& recvTs) {
+  struct cmsghdr* cmsg{nullptr};
+
+  // use user space timestamp if kernel timestamp is not found
+  recvTs = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+
+  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == IPPROTO_IPV6) {
+      if (cmsg->cmsg_type == IPV6_PKTINFO) {
+        struct in6_pktinfo pktinfo;
+        memcpy(
+            reinterpret_cast<void*>(&pktinfo),
+            CMSG_DATA(cmsg),
+            sizeof(pktinfo));
+        ifIndex = pktinfo.ipi6_ifindex;
+      } else if (cmsg->cmsg_type == IPV6_HOPLIMIT) {
+        memcpy(
+            reinterpret_cast<void*>(&hopLimit),
+            CMSG_DATA(cmsg),
+            sizeof(hopLimit));
+      }
+    }
+    if (cmsg->cmsg_level != SOL_SOCKET) {
+      continue;
+    }
+
+    // SO_TIMESTAMPING reports software timestamp first, SO_TIMESTAMPNS is
+    // what we get on kernels/sockets without SO_TIMESTAMPING
+    struct timespec ts {
+      0, 0
+    };
+    if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+      struct scm_timestamping tss;
+      memcpy(reinterpret_cast<void*>(&tss), CMSG_DATA(cmsg), sizeof(tss));
+      ts = tss.ts[0];
+    } else if (cmsg->cmsg_type == SO_TIMESTAMPNS) {
+      memcpy(reinterpret_cast<void*>(&ts), CMSG_DATA(cmsg), sizeof(ts));
+    } else {
+      continue;
+    }
+    const auto kernelRecvTs = toMicroseconds(ts);
+    if (kernelRecvTs.count() == 0) {
+      continue;
+    }
+
+    // sanity check
+    DCHECK(recvTs >= kernelRecvTs) << "Time anomaly";
+    VLOG(4) << "Got kernel-timestamp. It took "
+            << (recvTs - kernelRecvTs).count()
+            << " us for the packet to get from kernel to user space";
+    recvTs = kernelRecvTs;
+  } // for
+}
+
+// pack control buffer, aligned by control message hdr
+union SendCtrlBuf {
+  char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+  struct cmsghdr align;
+};
+
+// Build header of message to be sent to dstAddr via given interface and
+// source address. All buffers must outlive the send
+void
+prepareSendHeader(
+    struct msghdr& msg,
+    SendCtrlBuf& ctrlBuf,
+    sockaddr_storage& addrStorage,
+    struct iovec& entry,
+    int ifIndex,
+    folly::IPAddressV6 const& srcAddr,
+    folly::SocketAddress const& dstAddr,
+    std::string const& packet) {
+  struct cmsghdr* cmsg{nullptr};
+
+  // Set the destination address for the message
+  dstAddr.getAddress(&addrStorage);
+
+  ::memset(&msg, 0, sizeof(msg));
+  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
+  msg.msg_namelen = dstAddr.getActualSize();
+
+  // set the source address and source if index for this message
+  // this goes into ancilliary data fields
+  msg.msg_control = ctrlBuf.cbuf;
+  msg.msg_controllen = sizeof(ctrlBuf.cbuf);
+  cmsg = CMSG_FIRSTHDR(&msg);
+
+  cmsg->cmsg_level = IPPROTO_IPV6;
+  cmsg->cmsg_type = IPV6_PKTINFO;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+
+  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+  pktinfo->ipi6_ifindex = ifIndex;
+  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
+
+  // the IO vector for data to be sent
+  msg.msg_iov = &entry;
+  msg.msg_iovlen = 1;
+
+  // write the data here (we need to remove the const qualifier)
+  entry.iov_base = const_cast<char*>(packet.data());
+  entry.iov_len = packet.size();
+}
+
+} // namespace
+
+RecvBatch::RecvBatch(size_t batchSize, size_t msgSize)
+    : msgSize_(msgSize),
+      dataBuf_(batchSize * msgSize),
+      ctrlBufs_(batchSize),
+      addrs_(batchSize),
+      iovs_(batchSize),
+      msgHdrs_(batchSize) {
+  CHECK_GT(batchSize, 0);
+  reset();
+}
+
+void
+RecvBatch::reset() {
+  for (size_t i = 0; i < msgHdrs_.size(); ++i) {
+    iovs_[i].iov_base = dataBuf_.data() + i * msgSize_;
+    iovs_[i].iov_len = msgSize_;
+
+    // this part is important - if we don't zero the buffer,
+    // the CMSG_NXTHDR may burp, because it tries extracting
+    // fields from "next header" in the buffer
+    ::memset(&ctrlBufs_[i], 0, sizeof(CtrlBuf));
+    ::memset(&addrs_[i], 0, sizeof(sockaddr_storage));
+
+    auto& hdr = msgHdrs_[i];
+    ::memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_hdr.msg_iov = &iovs_[i];
+    hdr.msg_hdr.msg_iovlen = 1;
+    hdr.msg_hdr.msg_control = ctrlBufs_[i].u.buf;
+    hdr.msg_hdr.msg_controllen = sizeof(ctrlBufs_[i].u.buf);
+    hdr.msg_hdr.msg_name = &addrs_[i];
+    hdr.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+  }
+}
+
+ReceivedMessage
+RecvBatch::getMessage(size_t i) const {
+  CHECK_LT(i, msgHdrs_.size());
+  // parsing control messages doesn't modify header, CMSG macros want it
+  // non-const though
+  auto& hdr = const_cast<struct mmsghdr&>(msgHdrs_[i]);
+
+  ReceivedMessage message;
+  message.truncated = hdr.msg_hdr.msg_flags & MSG_TRUNC;
+  message.data = folly::ByteRange(
+      dataBuf_.data() + i * msgSize_, std::min<size_t>(hdr.msg_len, msgSize_));
+  parseControlMessages(
+      hdr.msg_hdr, message.ifIndex, message.hopLimit, message.recvTs);
+  // this will throw if sender address was not filled in
+  message.srcAddr.setFromSockaddr(
+      reinterpret_cast<const struct sockaddr*>(&addrs_[i]));
+  return message;
+}
+
 int
 IoProvider::socket(int domain, int type, int protocol) {
   return ::socket(domain, type, protocol);
@@ -70,6 +250,18 @@ IoProvider::sendmsg(int sockfd, const struct msghdr* msg, int flags) {
   return ::sendmsg(sockfd, msg, flags);
 }
 
+int
+IoProvider::recvmmsg(
+    int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  return ::recvmmsg(sockfd, msgvec, vlen, flags, nullptr);
+}
+
+int
+IoProvider::sendmmsg(
+    int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  return ::sendmmsg(sockfd, msgvec, vlen, flags);
+}
+
 std::tuple<
     ssize_t /* size */,
     int /* ifIndex */,
@@ -130,52 +322,13 @@ IoProvider::recvMessage(
     throw std::runtime_error("Message truncated");
   }
 
-  // grab the inIndex we received this packet on and the hopLimit
-  // those are available since we requested them via socket options
-  struct cmsghdr* cmsg{nullptr};
+  // grab the inIndex we received this packet on, the hopLimit and the
+  // kernel timestamp. those are available since we requested them via socket
+  // options
   int ifIndex{-1};
   int hopLimit{0};
-
-  // use user space timestamp if kernel timestamp is not found
-  std::chrono::microseconds recvTs{
-      std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::system_clock::now().time_since_epoch())};
-
-  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
-    if (cmsg->cmsg_level == IPPROTO_IPV6) {
-      if (cmsg->cmsg_type == IPV6_PKTINFO) {
-        struct in6_pktinfo pktinfo;
-        memcpy(
-            reinterpret_cast<void*>(&pktinfo),
-            CMSG_DATA(cmsg),
-            sizeof(pktinfo));
-        ifIndex = pktinfo.ipi6_ifindex;
-      } else if (cmsg->cmsg_type == IPV6_HOPLIMIT) {
-        memcpy(
-            reinterpret_cast<void*>(&hopLimit),
-            CMSG_DATA(cmsg),
-            sizeof(hopLimit));
-      }
-    }
-    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS) {
-      struct timespec ts {
-        0, 0
-      };
-      memcpy(reinterpret_cast<void*>(&ts), CMSG_DATA(cmsg), sizeof(ts));
-
-      // cast to int64_t since ts.tv_sec is 32 bits on some platforms like arm
-      const int64_t usecs =
-          static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
-      const std::chrono::microseconds kernelRecvTs(usecs);
-
-      // sanity check
-      DCHECK(recvTs >= kernelRecvTs) << "Time anomaly";
-      VLOG(4) << "Got kernel-timestamp. It took "
-              << (recvTs - kernelRecvTs).count()
-              << " us for the packet to get from kernel to user space";
-      recvTs = kernelRecvTs;
-    }
-  } // for
+  std::chrono::microseconds recvTs{0};
+  parseControlMessages(msg, ifIndex, hopLimit, recvTs);
 
   // build the source socket address from recvmsg data
   folly::SocketAddress srcAddr{};
@@ -188,6 +341,26 @@ IoProvider::recvMessage(
   return std::make_tuple(bytesRead, ifIndex, srcAddr, hopLimit, recvTs);
 }
 
+size_t
+IoProvider::recvMessages(int fd, RecvBatch& batch, IoProvider* ioProvider) {
+  batch.reset();
+  while (true) {
+    int numMsgs = ioProvider->recvmmsg(
+        fd, batch.msgHdrs_.data(), batch.msgHdrs_.size(), MSG_DONTWAIT);
+    if (numMsgs >= 0) {
+      return numMsgs;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return 0;
+    }
+    throw std::runtime_error(folly::sformat(
+        "Failed reading messages on fd {}: {}", fd, folly::errnoStr(errno)));
+  }
+}
+
 ssize_t
 IoProvider::sendMessage(
     int fd,
@@ -197,46 +370,129 @@ IoProvider::sendMessage(
     std::string const& packet,
     IoProvider* ioProvider) {
   struct msghdr msg;
-  struct cmsghdr* cmsg{nullptr};
-
-  // pack control buffer, aligned by control message hdr
-  union {
-    char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
-    struct cmsghdr align;
-  } u;
-
-  // Set the destination address for the message
+  SendCtrlBuf ctrlBuf;
   sockaddr_storage addrStorage;
-  dstAddr.getAddress(&addrStorage);
-
-  ::memset(&msg, 0, sizeof(msg));
-  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
-  msg.msg_namelen = dstAddr.getActualSize();
+  struct iovec entry;
 
-  // set the source address and source if index for this message
-  // this goes into ancilliary data fields
-  msg.msg_control = u.cbuf;
-  msg.msg_controllen = sizeof(u.cbuf);
-  cmsg = CMSG_FIRSTHDR(&msg);
+  prepareSendHeader(
+      msg, ctrlBuf, addrStorage, entry, ifIndex, srcAddr, dstAddr, packet);
 
-  cmsg->cmsg_level = IPPROTO_IPV6;
-  cmsg->cmsg_type = IPV6_PKTINFO;
-  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+  return ioProvider->sendmsg(fd, &msg, MSG_DONTWAIT);
+}
 
-  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
-  pktinfo->ipi6_ifindex = ifIndex;
-  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
+std::vector<ssize_t>
+IoProvider::sendMessages(
+    int fd,
+    std::vector<OutgoingMessage> const& messages,
+    IoProvider* ioProvider) {
+  const size_t numMsgs = messages.size();
+  std::vector<struct mmsghdr> msgHdrs(numMsgs);
+  std::vector<SendCtrlBuf> ctrlBufs(numMsgs);
+  std::vector<sockaddr_storage> addrs(numMsgs);
+  std::vector<struct iovec> iovs(numMsgs);
+  std::vector<ssize_t> bytesSent(numMsgs, -1);
+
+  for (size_t i = 0; i < numMsgs; ++i) {
+    const auto& message = messages[i];
+    ::memset(&msgHdrs[i], 0, sizeof(struct mmsghdr));
+    prepareSendHeader(
+        msgHdrs[i].msg_hdr,
+        ctrlBufs[i],
+        addrs[i],
+        iovs[i],
+        message.ifIndex,
+        message.srcAddr,
+        message.dstAddr,
+        message.packet);
+  }
 
-  // the IO vector for data to be sent
-  struct iovec entry;
-  msg.msg_iov = &entry;
-  msg.msg_iovlen = 1;
+  // sendmmsg stops at first message which fails. Skip it and carry on with
+  // rest of the messages
+  size_t pos = 0;
+  while (pos < numMsgs) {
+    int numSent = ioProvider->sendmmsg(
+        fd, msgHdrs.data() + pos, numMsgs - pos, MSG_DONTWAIT);
+    if (numSent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      VLOG(1) << "Failed sending message on fd " << fd << " via ifIndex "
+              << messages[pos].ifIndex << ": " << folly::errnoStr(errno);
+      ++pos;
+      continue;
+    }
+    if (numSent == 0) {
+      break;
+    }
+    for (int i = 0; i < numSent; ++i, ++pos) {
+      bytesSent[pos] = msgHdrs[pos].msg_len;
+    }
+  }
+  return bytesSent;
+}
 
-  // write the data here (we need to remove the const qualifier)
-  entry.iov_base = const_cast<char*>(packet.data());
-  entry.iov_len = packet.size();
+std::vector<TxTimestamp>
+IoProvider::recvTxTimestamps(int fd, IoProvider* ioProvider) {
+  std::vector<TxTimestamp> timestamps;
+  while (true) {
+    struct msghdr msg;
+    struct iovec entry;
+    union {
+      char buf[CMSG_SPACE(1024)];
+      struct cmsghdr align;
+    } u;
+    // payload isn't looped back with SOF_TIMESTAMPING_OPT_TSONLY, and we
+    // don't care about it otherwise
+    uint8_t data[64];
+
+    ::memset(&msg, 0, sizeof(msg));
+    entry.iov_base = data;
+    entry.iov_len = sizeof(data);
+    msg.msg_iov = &entry;
+    msg.msg_iovlen = 1;
+    msg.msg_control = u.buf;
+    msg.msg_controllen = sizeof(u.buf);
+
+    if (ioProvider->recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return timestamps;
+      }
+      throw std::runtime_error(folly::sformat(
+          "Failed reading error queue on fd {}: {}",
+          fd,
+          folly::errnoStr(errno)));
+    }
 
-  return ioProvider->sendmsg(fd, &msg, MSG_DONTWAIT);
+    // timestamp and id of datagram it belongs to come in separate control
+    // messages
+    folly::Optional<uint32_t> id;
+    std::chrono::microseconds txTs{0};
+    struct cmsghdr* cmsg{nullptr};
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET &&
+          cmsg->cmsg_type == SCM_TIMESTAMPING) {
+        struct scm_timestamping tss;
+        memcpy(reinterpret_cast<void*>(&tss), CMSG_DATA(cmsg), sizeof(tss));
+        txTs = toMicroseconds(tss.ts[0]);
+      } else if (
+          (cmsg->cmsg_level == IPPROTO_IPV6 &&
+           cmsg->cmsg_type == IPV6_RECVERR) ||
+          (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_RECVERR)) {
+        struct sock_extended_err err;
+        memcpy(reinterpret_cast<void*>(&err), CMSG_DATA(cmsg), sizeof(err));
+        if (err.ee_errno == ENOMSG &&
+            err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING) {
+          id = err.ee_data;
+        }
+      }
+    }
+    if (id.hasValue() && txTs.count() != 0) {
+      timestamps.emplace_back(TxTimestamp{id.value(), txTs});
+    }
+  }
 }
 
 } // namespace openr
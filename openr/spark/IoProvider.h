@@ -13,12 +13,89 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include <folly/IPAddress.h>
+#include <folly/Range.h>
 #include <folly/SocketAddress.h>
 
 namespace openr {
 
+//
+// Datagram received in a batch along with its ancillary data. `data` points
+// into the buffer of the RecvBatch it was received with, and is only valid
+// until next receive on the batch
+//
+struct ReceivedMessage {
+  folly::ByteRange data;
+  int ifIndex{-1};
+  folly::SocketAddress srcAddr;
+  int hopLimit{0};
+  std::chrono::microseconds recvTs{0};
+  bool truncated{false};
+};
+
+//
+// Datagram to be sent with IoProvider::sendMessages
+//
+struct OutgoingMessage {
+  int ifIndex{0};
+  folly::IPAddressV6 srcAddr;
+  folly::SocketAddress dstAddr;
+  std::string packet;
+};
+
+//
+// Kernel timestamp of a sent datagram, read from socket error queue. `id` is
+// sequence number kernel assigned to the datagram on send, counting from 0
+// since SOF_TIMESTAMPING_OPT_ID was enabled on the socket
+//
+struct TxTimestamp {
+  uint32_t id{0};
+  std::chrono::microseconds txTs{0};
+};
+
+//
+// Pre-allocated buffers to receive up to `batchSize` datagrams of at most
+// `msgSize` bytes with a single recvmmsg call. Meant to be created once and
+// reused for every receive to avoid per packet allocations
+//
+class RecvBatch {
+ public:
+  RecvBatch(size_t batchSize, size_t msgSize);
+
+  size_t
+  getBatchSize() const {
+    return msgHdrs_.size();
+  }
+
+  // Parse i-th datagram of last receive
+  ReceivedMessage getMessage(size_t i) const;
+
+ private:
+  friend class IoProvider;
+
+  // Reset headers before next receive
+  void reset();
+
+  // the control message buffer per datagram
+  // XXX: hardcoded, but this hardly should be a problem
+  struct CtrlBuf {
+    union {
+      char buf[CMSG_SPACE(1024)];
+      struct cmsghdr align;
+    } u;
+  };
+
+  const size_t msgSize_{0};
+  std::vector<uint8_t> dataBuf_;
+  std::vector<CtrlBuf> ctrlBufs_;
+  std::vector<sockaddr_storage> addrs_;
+  std::vector<struct iovec> iovs_;
+  std::vector<struct mmsghdr> msgHdrs_;
+};
+
 //
 // This class provides API to mock some syscalls that
 // could be useful for testing. The default version
@@ -59,6 +136,12 @@ class IoProvider {
 
   virtual ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags);
 
+  virtual int recvmmsg(
+      int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags);
+
+  virtual int sendmmsg(
+      int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags);
+
   virtual int setsockopt(
       int sockfd, int level, int optname, const void* optval, socklen_t optlen);
 
@@ -76,6 +159,13 @@ class IoProvider {
       std::chrono::microseconds /* kernel timestamp */>
   recvMessage(int fd, unsigned char* buf, int len, IoProvider* ioProvider);
 
+  /*
+   * Receive as many messages on fd as fit in batch without blocking. Returns
+   * number of messages received, 0 if there are none pending. Throws on
+   * errors other than EAGAIN/EINTR. Use RecvBatch::getMessage to access them
+   */
+  static size_t recvMessages(int fd, RecvBatch& batch, IoProvider* ioProvider);
+
   /*
    * Send message on fd via given interface to the address provided
    * We supply socket address, which has dst IPv6 and port
@@ -88,6 +178,25 @@ class IoProvider {
       std::string const& packet,
       IoProvider* ioProvider);
 
+  /*
+   * Send all messages on fd with as few syscalls as possible. Returns number
+   * of bytes sent per message, or -1 if sending that message failed (errno
+   * of failure is not preserved)
+   */
+  static std::vector<ssize_t> sendMessages(
+      int fd,
+      std::vector<OutgoingMessage> const& messages,
+      IoProvider* ioProvider);
+
+  /*
+   * Read all kernel TX timestamps queued on error queue of fd without
+   * blocking. Socket must have SO_TIMESTAMPING enabled with
+   * SOF_TIMESTAMPING_TX_SOFTWARE and SOF_TIMESTAMPING_OPT_ID. Throws on
+   * errors other than EAGAIN/EINTR
+   */
+  static std::vector<TxTimestamp> recvTxTimestamps(
+      int fd, IoProvider* ioProvider);
+
  private:
   IoProvider(IoProvider const&) = delete;
   IoProvider& operator=(IoProvider const&) = delete;
@@ -8,6 +8,7 @@
 #include "Spark.h"
 
 #include <ifaddrs.h>
+#include <linux/net_tstamp.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <sodium.h>
@@ -22,6 +23,7 @@
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/IPAddress.h>
 #include <folly/MapUtil.h>
+#include <folly/Random.h>
 #include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
@@ -43,6 +45,39 @@ namespace {
 //
 const int kMinIpv6Mtu = 1280;
 
+//
+// Max number of hello packets received with one syscall, and max number of
+// such batches received per wakeup, so that a flood of hellos can't starve
+// other events in the loop
+//
+const size_t kHelloRecvBatchSize = 32;
+const size_t kMaxHelloRecvBatchesPerEvent = 16;
+
+//
+// Resolution of timer wheel driving hello, heartbeat and hold timers. Way
+// below jitter applied to any of them
+//
+const std::chrono::milliseconds kTimerWheelTick{10};
+
+//
+// Reflected neighbor infos of neighbors heard on interface, for hello
+// packet. Timestamp and sequence number are from last hello, 0 if we
+// haven't heard before from the neighbor. Refer to thrift for definition of
+// timestamps.
+//
+template <typename NeighborMap>
+std::map<std::string, openr::thrift::ReflectedNeighborInfo>
+getReflectedNeighborInfos(NeighborMap const& neighbors) {
+  std::map<std::string, openr::thrift::ReflectedNeighborInfo> infos;
+  for (const auto& kv : neighbors) {
+    auto& neighborInfo = infos[kv.first];
+    neighborInfo.seqNum = kv.second.seqNum;
+    neighborInfo.lastNbrMsgSentTsInUs = kv.second.neighborTimestamp.count();
+    neighborInfo.lastMyMsgRcvdTsInUs = kv.second.localTimestamp.count();
+  }
+  return infos;
+}
+
 //
 // The acceptable hop limit, assuming we send packets with this TTL
 //
@@ -66,6 +101,23 @@ const int64_t kAbsThreshold = 500;
 // number of restarting packets to send out per interface before I'm going down
 const int kNumRestartingPktSent = 3;
 
+// kernel timestamping of received and sent packets. Sent packets are numbered
+// and their timestamps looped back on socket error queue without payload
+const int kTimestampingFlags = SOF_TIMESTAMPING_SOFTWARE |
+    SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_TX_SOFTWARE |
+    SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+// hellos waiting for their kernel TX timestamp
+const size_t kMaxTxHellosInFlight = 256;
+
+// kernel TX timestamps of hellos remembered per interface, enough to cover
+// hellos neighbors may still reflect back
+const size_t kMaxHelloTxTimestamps = 8;
+
+// hello can't possibly sit longer in our stack, kernel timestamp further
+// away from hello's own timestamp belongs to some other packet
+const std::chrono::microseconds kMaxTxDelay{1000000};
+
 //
 // Function to get current timestamp in microseconds using steady clock
 // NOTE: we use non-monotonic clock since kernel time-stamps do not support
@@ -128,6 +180,27 @@ toggleMcastGroup(
   return true;
 }
 
+//
+// Export RTT percentiles towards neighbor over interface. Kept to a few
+// counters as they are exported per neighbor
+//
+template <typename CounterMap>
+void
+addRttHistogramCounters(
+    CounterMap& counters,
+    std::string const& neighborName,
+    std::string const& ifName,
+    openr::StreamingHistogram const& histogram) {
+  if (histogram.getNumSamples() == 0) {
+    return;
+  }
+  const auto prefix =
+      folly::sformat("spark.rtt_hist_us.{}.{}", neighborName, ifName);
+  counters[prefix + ".p50"] = histogram.getPercentile(50);
+  counters[prefix + ".p90"] = histogram.getPercentile(90);
+  counters[prefix + ".p99"] = histogram.getPercentile(99);
+}
+
 } // namespace
 
 using namespace fbzmq;
@@ -216,7 +289,7 @@ Spark::Neighbor::Neighbor(
     thrift::SparkNeighbor const& info,
     uint32_t label,
     uint64_t seqNum,
-    std::unique_ptr<fbzmq::ZmqTimeout> holdTimer,
+    std::unique_ptr<TimerWheel::Timeout> holdTimer,
     const std::chrono::milliseconds& samplingPeriod,
     std::function<void(const int64_t&)> rttChangeCb)
     : info(info),
@@ -287,7 +360,9 @@ Spark::Spark(
     bool enableFloodOptimization,
     bool enableSpark2,
     bool increaseHelloInterval,
-    folly::Optional<std::unordered_set<std::string>> areas)
+    folly::Optional<std::unordered_set<std::string>> areas,
+    std::chrono::milliseconds myLivenessTime,
+    uint8_t livenessDetectMultiplier)
     : OpenrEventLoop(myNodeName, thrift::OpenrModuleType::SPARK, zmqContext),
       myDomainName_(myDomainName),
       myNodeName_(myNodeName),
@@ -301,6 +376,8 @@ Spark::Spark(
       myHeartbeatTime_(myHeartbeatTime),
       myNegotiateHoldTime_(myNegotiateHoldTime),
       myHeartbeatHoldTime_(myHeartbeatHoldTime),
+      myLivenessTime_(myLivenessTime),
+      livenessDetectMultiplier_(livenessDetectMultiplier),
       enableV4_(enableV4),
       enableSubnetValidation_(enableSubnetValidation),
       reportUrl_(reportUrl),
@@ -339,6 +416,17 @@ Spark::Spark(
   scheduleTimeout(
       std::chrono::seconds(0), [this, maybeIpTos]() { prepare(maybeIpTos); });
 
+  // Single event loop timer driving all per interface and neighbor timers
+  timerWheel_ = std::make_unique<TimerWheel>(this, kTimerWheelTick);
+
+  // Random initial discriminator, like BFD does, to make collisions with
+  // sessions of a restarted incarnation unlikely
+  nextLivenessDiscriminator_ = folly::Random::rand32();
+
+  // Packets are sent out in batches, once per event loop iteration
+  sendPacketsTimer_ = fbzmq::ZmqTimeout::make(
+      this, [this]() noexcept { flushPendingPackets(); });
+
   zmqMonitorClient_ =
       std::make_unique<fbzmq::ZmqMonitorClient>(zmqContext, monitorSubmitUrl);
 
@@ -352,6 +440,14 @@ Spark::Spark(
   tData_.addStatExportType(
       "spark.invalid_keepalive.different_subnet", fbzmq::SUM);
   tData_.addStatExportType("spark.invalid_keepalive.looped_packet", fbzmq::SUM);
+  tData_.addStatExportType("spark.hello_packet_recv_batches", fbzmq::SUM);
+  tData_.addStatExportType("spark.hello_packet_recv_batch_size", fbzmq::AVG);
+  tData_.addStatExportType("spark.hello_packet_recv_per_event", fbzmq::AVG);
+  tData_.addStatExportType("spark.hello_packet_truncated", fbzmq::SUM);
+  tData_.addStatExportType("spark.packets_sent_per_batch", fbzmq::AVG);
+  tData_.addStatExportType("spark.liveness.packet_recv", fbzmq::SUM);
+  tData_.addStatExportType("spark.liveness.packet_dropped", fbzmq::SUM);
+  tData_.addStatExportType("spark.liveness.neighbor_down", fbzmq::SUM);
 }
 
 // static util function to transform state into str
@@ -391,6 +487,7 @@ Spark::stop() {
       sendHelloPacket(
           ifName, false /* inFastInitState */, true /* restarting */);
     }
+    flushPendingPackets();
   }
 
   LOG(INFO)
@@ -420,6 +517,7 @@ Spark::prepare(folly::Optional<int> maybeIpTos) noexcept {
 
   int fd = ioProvider_->socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
   mcastFd_ = fd;
+  recvBatch_ = std::make_unique<RecvBatch>(kHelloRecvBatchSize, kMinIpv6Mtu);
 
   if (fd < 0) {
     LOG(FATAL) << "Failed creating Spark UDP socket. Error: "
@@ -497,6 +595,13 @@ Spark::prepare(folly::Optional<int> maybeIpTos) noexcept {
                << folly::errnoStr(errno);
   }
 
+  // same for unicast liveness packets
+  if (ioProvider_->setsockopt(
+          fd, IPPROTO_IPV6, IPV6_UNICAST_HOPS, &ttl, sizeof(ttl)) != 0) {
+    LOG(FATAL) << "Failed setting unicast TTL on socket. Error: "
+               << folly::errnoStr(errno);
+  }
+
   // allow reporting the packet TTL to user space
   int recvHopLimit = 1;
   if (ioProvider_->setsockopt(
@@ -517,10 +622,22 @@ Spark::prepare(folly::Optional<int> maybeIpTos) noexcept {
                << folly::errnoStr(errno);
   }
 
-  // enable timestamping for this socket
+  // enable kernel timestamping of received and sent packets for this
+  // socket. Fall back to received packets only if not supported
   const int enabled = 1;
   if (ioProvider_->setsockopt(
-          fd, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled)) != 0) {
+          fd,
+          SOL_SOCKET,
+          SO_TIMESTAMPING,
+          &kTimestampingFlags,
+          sizeof(kTimestampingFlags)) == 0) {
+    txTimestampingEnabled_ = true;
+  } else if (
+      ioProvider_->setsockopt(
+          fd, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled)) == 0) {
+    LOG(WARNING) << "Failed to enable kernel TX timestamping. Measured RTTs "
+                 << "are likely to have more noise in them";
+  } else {
     LOG(ERROR) << "Failed to enable kernel timestamping. Measured RTTs are "
                << "likely to have more noise in them. Error: "
                << folly::errnoStr(errno);
@@ -534,12 +651,14 @@ Spark::prepare(folly::Optional<int> maybeIpTos) noexcept {
       fbzmq::ZmqTimeout::make(this, [this]() noexcept { submitCounters(); });
   monitorTimer_->scheduleTimeout(Constants::kMonitorSubmitInterval, isPeriodic);
 
-  // Listen for incoming messages on multicast FD
-  addSocketFd(mcastFd_, ZMQ_POLLIN, [this](int) noexcept {
+  // Listen for incoming messages on multicast FD. Kernel TX timestamps are
+  // queued on socket error queue and signalled as POLLERR
+  addSocketFd(mcastFd_, ZMQ_POLLIN | ZMQ_POLLERR, [this](int) noexcept {
+    processTxTimestamps();
     try {
-      processHelloPacket();
+      processHelloPackets();
     } catch (std::exception const& err) {
-      LOG(ERROR) << "Spark: error processing hello packet "
+      LOG(ERROR) << "Spark: error receiving hello packets "
                  << folly::exceptionStr(err);
     }
   });
@@ -609,14 +728,15 @@ Spark::validateHelloPacket(
 
   // get the map of tracked neighbors on this interface
   auto& ifNeighbors = neighbors_.at(ifName);
+  invalidateHelloPacket(ifName);
 
   // see if we already track this neighbor
   auto it = ifNeighbors.find(neighborName);
 
   // first time we hear from this guy, add to tracking list
   if (it == ifNeighbors.end()) {
-    auto holdTimer =
-        fbzmq::ZmqTimeout::make(this, [this, ifName, neighborName]() noexcept {
+    auto holdTimer = TimerWheel::Timeout::make(
+        timerWheel_.get(), [this, ifName, neighborName]() noexcept {
           processNeighborHoldTimeout(ifName, neighborName);
         });
 
@@ -727,6 +847,7 @@ Spark::processNeighborHoldTimeout(
   SCOPE_EXIT {
     allocatedLabels_.erase(neighbor.label);
     ifNeighbors.erase(neighborName);
+    invalidateHelloPacket(ifName);
   };
 
   // check if the neighbor was adjacent. if so, report it as neighbor-down
@@ -776,19 +897,15 @@ Spark::shouldProcessHelloPacket(
 
 bool
 Spark::parsePacket(
+    ReceivedMessage const& message,
     thrift::SparkHelloPacket& pkt,
     std::string& ifName,
     std::chrono::microseconds& recvTime) {
-  // the read buffer
-  uint8_t buf[kMinIpv6Mtu];
-
-  ssize_t bytesRead;
-  int ifIndex;
-  folly::SocketAddress clientAddr;
-  int hopLimit;
-
-  std::tie(bytesRead, ifIndex, clientAddr, hopLimit, recvTime) =
-      IoProvider::recvMessage(mcastFd_, buf, kMinIpv6Mtu, ioProvider_.get());
+  const auto bytesRead = message.data.size();
+  const auto ifIndex = message.ifIndex;
+  const auto& clientAddr = message.srcAddr;
+  const auto hopLimit = message.hopLimit;
+  recvTime = message.recvTs;
 
   if (hopLimit < kSparkHopLimit) {
     LOG(ERROR) << "Rejecting packet from " << clientAddr.getAddressStr()
@@ -824,25 +941,19 @@ Spark::parsePacket(
 
   tData_.addStatValue("spark.hello_packet_processed", 1, fbzmq::SUM);
 
-  if (bytesRead >= 0) {
-    VLOG(4) << "Read a total of " << bytesRead << " bytes from fd " << mcastFd_;
+  VLOG(4) << "Read a total of " << bytesRead << " bytes from fd " << mcastFd_;
 
-    if (static_cast<size_t>(bytesRead) > kMinIpv6Mtu) {
-      LOG(ERROR) << "Message from " << clientAddr.getAddressStr()
-                 << " has been truncated";
-      return false;
-    }
-  } else {
-    LOG(ERROR) << "Failed reading from fd " << mcastFd_ << " error "
-               << folly::errnoStr(errno);
+  if (message.truncated) {
+    LOG(ERROR) << "Message from " << clientAddr.getAddressStr()
+               << " has been truncated";
+    tData_.addStatValue("spark.hello_packet_truncated", 1, fbzmq::SUM);
     return false;
   }
 
-  // Copy buffer into string object and parse it into helloPacket.
-  std::string readBuf(reinterpret_cast<const char*>(&buf[0]), bytesRead);
+  // Parse helloPacket directly from receive buffer
   try {
-    pkt =
-        util::readThriftObjStr<thrift::SparkHelloPacket>(readBuf, serializer_);
+    pkt = thrift::SparkHelloPacket();
+    serializer_.deserialize(message.data, pkt);
   } catch (std::exception const& err) {
     LOG(ERROR) << "Failed parsing hello packet " << folly::exceptionStr(err);
     return false;
@@ -922,25 +1033,52 @@ Spark::updateNeighborRtt(
     std::string const& neighborName,
     std::string const& remoteIfName,
     std::string const& ifName) {
+  auto rtt = measureNeighborRtt(
+      myRecvTime,
+      mySentTime,
+      nbrRecvTime,
+      nbrSentTime,
+      neighborName,
+      remoteIfName,
+      ifName);
+  if (rtt.hasValue()) {
+    addRttSample(rtt.value(), myRecvTime, neighborName, ifName);
+  }
+}
+
+folly::Optional<std::chrono::microseconds>
+Spark::measureNeighborRtt(
+    std::chrono::microseconds const& myRecvTime,
+    std::chrono::microseconds const& nominalSentTime,
+    std::chrono::microseconds const& nbrRecvTime,
+    std::chrono::microseconds const& nbrSentTime,
+    std::string const& neighborName,
+    std::string const& remoteIfName,
+    std::string const& ifName) const {
+  // Neighbor reflects timestamp our hello carried, which is taken before
+  // hello is even queued. Use time it actually left us if kernel told us
+  const std::chrono::microseconds mySentTime{
+      getKernelSentTs(ifName, nominalSentTime.count())};
+
   VLOG(4) << "RTT timestamps in order: " << mySentTime.count() << ", "
           << nbrRecvTime.count() << ", " << nbrSentTime.count() << ", "
           << myRecvTime.count();
 
   if (!mySentTime.count() || !nbrRecvTime.count()) {
     LOG(ERROR) << "Missing timestamp to deduce RTT";
-    return;
+    return folly::none;
   }
 
   if (nbrSentTime < nbrRecvTime) {
     LOG(ERROR) << "Time anomaly. nbrSentTime: [" << nbrSentTime.count()
                << "] < nbrRecvTime: [" << nbrRecvTime.count() << "]";
-    return;
+    return folly::none;
   }
 
   if (myRecvTime < mySentTime) {
     LOG(ERROR) << "Time anomaly. myRecvTime: [" << myRecvTime.count()
                << "] < mySentTime: [" << mySentTime.count() << "]";
-    return;
+    return folly::none;
   }
 
   // Measure only if neighbor is reflecting our previous hello packet.
@@ -948,6 +1086,28 @@ Spark::updateNeighborRtt(
   VLOG(3) << "Measured new RTT for neighbor " << neighborName
           << " from remote iface " << remoteIfName << " over interface "
           << ifName << " as " << rtt.count() / 1000.0 << "ms.";
+
+  // It is possible for things to go wrong in RTT calculation because of
+  // clock adjustment.
+  // Next measurements will correct this wrong measurement.
+  if (rtt.count() < 0) {
+    LOG(ERROR) << "Time anomaly. Measured negative RTT. "
+               << rtt.count() / 1000.0 << "ms.";
+    return folly::none;
+  }
+  return rtt;
+}
+
+void
+Spark::addRttSample(
+    std::chrono::microseconds rtt,
+    std::chrono::microseconds const& myRecvTime,
+    std::string const& neighborName,
+    std::string const& ifName) {
+  // Distribution is kept at full accuracy, it is what tells how noisy
+  // measurements are
+  const auto rawRtt = rtt;
+
   // Mask off to millisecond accuracy!
   //
   // Reason => Relying on microsecond accuracy is too inaccurate. For
@@ -960,15 +1120,6 @@ Spark::updateNeighborRtt(
   // to be the same as previous one.
   rtt = std::max(rtt / 1000 * 1000, std::chrono::microseconds(1000));
 
-  // It is possible for things to go wrong in RTT calculation because of
-  // clock adjustment.
-  // Next measurements will correct this wrong measurement.
-  if (rtt.count() < 0) {
-    LOG(ERROR) << "Time anomaly. Measured negative RTT. "
-               << rtt.count() / 1000.0 << "ms.";
-    return;
-  }
-
   // to serve both Spark and Spark2 usage, will feed RTT info to
   // stepDetector whenever it is available.
   if (neighbors_.find(ifName) != neighbors_.end()) {
@@ -981,6 +1132,7 @@ Spark::updateNeighborRtt(
       neighbor.stepDetector.addValue(
           std::chrono::duration_cast<std::chrono::milliseconds>(myRecvTime),
           rtt.count());
+      neighbor.rttHistogram.addValue(rawRtt.count());
       // Set initial value if empty
       if (!neighbor.rtt.count()) {
         VLOG(2) << "Setting initial value for RTT for neighbor "
@@ -1003,6 +1155,7 @@ Spark::updateNeighborRtt(
       spark2Neighbor.stepDetector.addValue(
           std::chrono::duration_cast<std::chrono::milliseconds>(myRecvTime),
           rtt.count());
+      spark2Neighbor.rttHistogram.addValue(rawRtt.count());
       // Set initial value if empty
       if (!spark2Neighbor.rtt.count()) {
         VLOG(2) << "Setting initial value for RTT for spark2Neighbor "
@@ -1025,7 +1178,6 @@ Spark::sendHandshakeMsg(std::string const& ifName, bool isAdjEstablished) {
   // e.g. when iface has not yet auto-configured it, or iface is removed but
   // down event has not arrived yet
   const auto& interfaceEntry = interfaceDb_.at(ifName);
-  const auto ifIndex = interfaceEntry.ifIndex;
   const auto v4Addr = interfaceEntry.v4Network.first;
   const auto v6Addr = interfaceEntry.v6LinkLocalNetwork.first;
 
@@ -1047,27 +1199,13 @@ Spark::sendHandshakeMsg(std::string const& ifName, bool isAdjEstablished) {
 
   auto packet = util::writeThriftObjStr(pkt, serializer_);
 
-  // send the pkt
-  folly::SocketAddress dstAddr(
-      folly::IPAddress(Constants::kSparkMcastAddr.toString()), udpMcastPort_);
-
   if (kMinIpv6Mtu < packet.size()) {
     LOG(ERROR) << "Handshake packet is too big, can't send it out.";
     return;
   }
 
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
-
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
-            << ifName << " failed due to error " << folly::errnoStr(errno);
-    return;
-  }
-
-  // update counters for number of pkts and total size of pkts sent
-  tData_.addStatValue("spark.handshake.bytes_sent", packet.size(), fbzmq::SUM);
-  tData_.addStatValue("spark.handshake.packets_sent", 1, fbzmq::SUM);
+  // send the pkt
+  queuePacket(ifName, interfaceEntry, std::move(packet), handshakeCounters_);
 }
 
 void
@@ -1092,8 +1230,6 @@ Spark::sendHeartbeatMsg(std::string const& ifName) {
   // e.g. when iface has not yet auto-configured it, or iface is removed but
   // down event has not arrived yet
   const auto& interfaceEntry = interfaceDb_.at(ifName);
-  const auto ifIndex = interfaceEntry.ifIndex;
-  const auto v6Addr = interfaceEntry.v6LinkLocalNetwork.first;
 
   // build heartbeat msg
   thrift::SparkHeartbeatMsg heartbeatMsg;
@@ -1105,27 +1241,13 @@ Spark::sendHeartbeatMsg(std::string const& ifName) {
 
   auto packet = util::writeThriftObjStr(pkt, serializer_);
 
-  // send the pkt
-  folly::SocketAddress dstAddr(
-      folly::IPAddress(Constants::kSparkMcastAddr.toString()), udpMcastPort_);
-
   if (kMinIpv6Mtu < packet.size()) {
     LOG(ERROR) << "Handshake packet is too big, can't send it out.";
     return;
   }
 
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
-
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
-            << ifName << " failed due to error " << folly::errnoStr(errno);
-    return;
-  }
-
-  // update counters for number of pkts and total size of pkts sent
-  tData_.addStatValue("spark.heartbeat.bytes_sent", packet.size(), fbzmq::SUM);
-  tData_.addStatValue("spark.heartbeat.packets_sent", 1, fbzmq::SUM);
+  // send the pkt
+  queuePacket(ifName, interfaceEntry, std::move(packet), heartbeatCounters_);
 }
 
 void
@@ -1177,6 +1299,17 @@ Spark::getSparkNeighState(
   return std::move(future).get();
 }
 
+std::unordered_map<std::string, int64_t>
+Spark::getCounters() {
+  folly::Promise<std::unordered_map<std::string, int64_t>> promise;
+  auto future = promise.getFuture();
+
+  runInEventLoop([this, promise = std::move(promise)]() mutable {
+    promise.setValue(tData_.getCounters());
+  });
+  return std::move(future).get();
+}
+
 void
 Spark::neighborUpWrapper(
     Spark2Neighbor& neighbor,
@@ -1189,12 +1322,15 @@ Spark::neighborUpWrapper(
   neighbor.negotiateHoldTimer.reset();
 
   // create heartbeat hold timer when promote to "ESTABLISHED"
-  neighbor.heartbeatHoldTimer =
-      fbzmq::ZmqTimeout::make(this, [this, ifName, neighborName]() noexcept {
+  neighbor.heartbeatHoldTimer = TimerWheel::Timeout::make(
+      timerWheel_.get(), [this, ifName, neighborName]() noexcept {
         processHeartbeatTimeout(ifName, neighborName);
       });
   neighbor.heartbeatHoldTimer->scheduleTimeout(neighbor.heartbeatHoldTime);
 
+  // detect neighbor failure faster than heartbeat hold-time if enabled
+  startLivenessSession(neighbor, ifName, neighborName);
+
   // add neighborName to collection
   ifNameToActiveNeighbors_[ifName].emplace(neighborName);
 
@@ -1246,6 +1382,11 @@ Spark::neighborDownWrapper(
       neighbor.label,
       true /* support flood-optimization */);
 
+  // liveness session itself goes away along with neighbor
+  if (neighbor.liveness) {
+    livenessSessions_.erase(neighbor.liveness->getMyDiscriminator());
+  }
+
   // remove neighborship on this interface
   ifNameToActiveNeighbors_.at(ifName).erase(neighborName);
   if (ifNameToActiveNeighbors_.at(ifName).empty()) {
@@ -1290,6 +1431,7 @@ Spark::processHeartbeatTimeout(
   SCOPE_EXIT {
     allocatedLabels_.erase(neighbor.label);
     ifNeighbors.erase(neighborName);
+    invalidateHelloPacket(ifName);
   };
 
   LOG(INFO) << "Heartbeat timer expired for: " << neighborName
@@ -1342,6 +1484,7 @@ Spark::processGRTimeout(
   SCOPE_EXIT {
     allocatedLabels_.erase(neighbor.label);
     ifNeighbors.erase(neighborName);
+    invalidateHelloPacket(ifName);
   };
 
   LOG(INFO) << "Graceful restart timer expired for: " << neighborName
@@ -1359,6 +1502,146 @@ Spark::processGRTimeout(
   neighborDownWrapper(neighbor, ifName, neighborName);
 }
 
+void
+Spark::startLivenessSession(
+    Spark2Neighbor& neighbor,
+    std::string const& ifName,
+    std::string const& neighborName) {
+  if (myLivenessTime_.count() == 0) {
+    return;
+  }
+  stopLivenessSession(neighbor);
+
+  // 0 is reserved for unknown discriminator
+  auto discriminator = nextLivenessDiscriminator_++;
+  while (discriminator == 0 or livenessSessions_.count(discriminator)) {
+    discriminator = nextLivenessDiscriminator_++;
+  }
+
+  neighbor.liveness = std::make_unique<LivenessSession>(
+      timerWheel_.get(),
+      discriminator,
+      myLivenessTime_,
+      livenessDetectMultiplier_,
+      [this, ifName, neighborName](std::string packet) {
+        // neighbor and interface must exist as long as session does
+        auto const& peer = spark2Neighbors_.at(ifName).at(neighborName);
+        queuePacket(
+            ifName,
+            interfaceDb_.at(ifName),
+            std::move(packet),
+            livenessCounters_,
+            folly::SocketAddress(
+                toIPAddress(peer.transportAddressV6), udpMcastPort_));
+      },
+      [this, ifName, neighborName]() {
+        processLivenessDown(ifName, neighborName);
+      });
+  livenessSessions_.emplace(
+      discriminator, std::make_pair(ifName, neighborName));
+}
+
+void
+Spark::stopLivenessSession(Spark2Neighbor& neighbor) {
+  if (neighbor.liveness) {
+    livenessSessions_.erase(neighbor.liveness->getMyDiscriminator());
+    neighbor.liveness.reset();
+  }
+}
+
+void
+Spark::processLivenessPacket(ReceivedMessage const& message) {
+  const auto& srcAddr = message.srcAddr;
+  auto dropPacket = [&](folly::StringPiece reason) {
+    VLOG(2) << "Dropping liveness packet from " << srcAddr.getAddressStr()
+            << ": " << reason;
+    tData_.addStatValue("spark.liveness.packet_dropped", 1, fbzmq::SUM);
+  };
+
+  tData_.addStatValue("spark.liveness.packet_recv", 1, fbzmq::SUM);
+  if (myLivenessTime_.count() == 0 or not enableSpark2_) {
+    dropPacket("liveness detection is disabled");
+    return;
+  }
+  if (message.hopLimit < kSparkHopLimit) {
+    dropPacket("hop limit check failed");
+    return;
+  }
+  auto maybeIfName = findInterfaceFromIfindex(message.ifIndex);
+  if (not maybeIfName.hasValue()) {
+    dropPacket("unknown interface");
+    return;
+  }
+  auto const& ifName = maybeIfName.value();
+  auto packet = LivenessPacket::decode(message.data);
+  if (not packet.hasValue()) {
+    dropPacket("malformed packet");
+    return;
+  }
+
+  // Find session by our discriminator if neighbor knows it already, else by
+  // source address of neighbor on the interface
+  Spark2Neighbor* neighbor{nullptr};
+  auto& ifNeighbors = spark2Neighbors_.at(ifName);
+  if (packet->yourDiscriminator != 0) {
+    auto it = livenessSessions_.find(packet->yourDiscriminator);
+    if (it != livenessSessions_.end() and it->second.first == ifName) {
+      neighbor = &ifNeighbors.at(it->second.second);
+    }
+  } else {
+    for (auto& kv : ifNeighbors) {
+      if (kv.second.liveness and
+          toIPAddress(kv.second.transportAddressV6) == srcAddr.getIPAddress()) {
+        neighbor = &kv.second;
+        break;
+      }
+    }
+  }
+  if (not neighbor or not neighbor->liveness) {
+    dropPacket("no matching session");
+    return;
+  }
+
+  // Guard against packets from other nodes on multi-access segments
+  if (toIPAddress(neighbor->transportAddressV6) != srcAddr.getIPAddress()) {
+    dropPacket("source address mismatch");
+    return;
+  }
+
+  // NOTE: may bring down and remove neighbor
+  neighbor->liveness->processPacket(packet.value());
+}
+
+void
+Spark::processLivenessDown(
+    std::string const& ifName, std::string const& neighborName) {
+  auto& ifNeighbors = spark2Neighbors_.at(ifName);
+  auto& neighbor = ifNeighbors.at(neighborName);
+
+  // remove from tracked neighbor at the end
+  SCOPE_EXIT {
+    allocatedLabels_.erase(neighbor.label);
+    ifNeighbors.erase(neighborName);
+    invalidateHelloPacket(ifName);
+  };
+
+  LOG(INFO) << "Liveness detection failed for: " << neighborName
+            << " on interface " << ifName;
+  tData_.addStatValue("spark.liveness.neighbor_down", 1, fbzmq::SUM);
+
+  // neighbor must in 'ESTABLISHED' state
+  checkNeighborState(neighbor, SparkNeighState::ESTABLISHED);
+
+  // state transition, same as losing heartbeats
+  SparkNeighState oldState = neighbor.state;
+  neighbor.state =
+      getNextState(oldState, SparkNeighEvent::HEARTBEAT_TIMER_EXPIRE);
+  logStateTransition(neighborName, ifName, oldState, neighbor.state);
+
+  // bring down neighborship and cleanup spark2 neighbor state
+  neighborDownWrapper(neighbor, ifName, neighborName);
+}
+
 void
 Spark::processGRMsg(
     std::string const& neighborName,
@@ -1374,8 +1657,8 @@ Spark::processGRMsg(
       false /* supportDual: doesn't matter in DOWN event*/);
 
   // start graceful-restart timer
-  neighbor.gracefulRestartHoldTimer =
-      fbzmq::ZmqTimeout::make(this, [this, ifName, neighborName]() noexcept {
+  neighbor.gracefulRestartHoldTimer = TimerWheel::Timeout::make(
+      timerWheel_.get(), [this, ifName, neighborName]() noexcept {
         // change the state back to IDLE
         processGRTimeout(ifName, neighborName);
       });
@@ -1389,6 +1672,9 @@ Spark::processGRMsg(
 
   // neihbor is restarting, shutdown heartbeat hold timer
   neighbor.heartbeatHoldTimer.reset();
+
+  // and liveness detection, neighbor's session is gone with restart
+  stopLivenessSession(neighbor);
 }
 
 void
@@ -1476,12 +1762,34 @@ Spark::processHelloMsg(
   // Update timestamps for received hello packet for neighbor
   neighbor.neighborTimestamp = nbrSentTimeInUs;
   neighbor.localTimestamp = myRecvTimeInUs;
+  invalidateHelloPacket(ifName);
+
+  // Neighbor tells when its previous hello actually left it. Correct RTT
+  // sample held back from that hello by time hello spent in neighbor's
+  // stack after being timestamped
+  if (neighbor.pendingRttSample.hasValue()) {
+    auto sample = neighbor.pendingRttSample.value();
+    neighbor.pendingRttSample = folly::none;
+    // neighbor may have missed kernel timestamp of that hello, or we may
+    // have missed hello it reports. Sample is still good, just not corrected
+    if (helloMsg.prevSentTsInUs.hasValue() and
+        helloMsg.prevKernelSentTsInUs.hasValue() and
+        *helloMsg.prevSentTsInUs == sample.nbrSentTsInUs) {
+      const std::chrono::microseconds txDelay(
+          *helloMsg.prevKernelSentTsInUs - *helloMsg.prevSentTsInUs);
+      if (txDelay.count() >= 0 and txDelay < sample.rtt) {
+        sample.rtt -= txDelay;
+        tData_.addStatValue("spark.rtt_kernel_corrected", 1, fbzmq::SUM);
+      }
+    }
+    addRttSample(sample.rtt, sample.myRecvTime, neighborName, ifName);
+  }
 
   // Deduce RTT for this neighbor and update timestamps
   auto tsIt = neighborInfos.find(myNodeName_);
   if (tsIt != neighborInfos.end()) {
     auto& ts = tsIt->second;
-    updateNeighborRtt(
+    auto rtt = measureNeighborRtt(
         // recvTime of neighbor helloPkt
         myRecvTimeInUs,
         // sentTime of my helloPkt recorded by neighbor
@@ -1493,6 +1801,16 @@ Spark::processHelloMsg(
         neighborName,
         remoteIfName,
         ifName);
+    if (rtt.hasValue()) {
+      if (helloMsg.prevKernelSentTsInUs.hasValue()) {
+        // neighbor kernel timestamps its hellos, wait for next one to learn
+        // when this one left
+        neighbor.pendingRttSample = Spark2Neighbor::PendingRttSample{
+            nbrSentTimeInUs.count(), myRecvTimeInUs, rtt.value()};
+      } else {
+        addRttSample(rtt.value(), myRecvTimeInUs, neighborName, ifName);
+      }
+    }
   }
 
   VLOG(3) << "Current state for neighbor: (" << neighborName << ") is: ["
@@ -1515,6 +1833,7 @@ Spark::processHelloMsg(
   } else if (neighbor.state == SparkNeighState::WARM) {
     // Update local seqNum maintained for this neighbor
     neighbor.seqNum = remoteSeqNum;
+    invalidateHelloPacket(ifName);
 
     if (tsIt != neighborInfos.end()) {
       //
@@ -1533,8 +1852,8 @@ Spark::processHelloMsg(
                 << myRemoteSeqNum << "), my Seq#: (" << mySeqNum_ << ").";
       } else {
         // Starts timer to periodically send hankshake msg
-        neighbor.negotiateTimer =
-            fbzmq::ZmqTimeout::make(this, [this, ifName]() noexcept {
+        neighbor.negotiateTimer = TimerWheel::Timeout::make(
+            timerWheel_.get(), [this, ifName]() noexcept {
               // periodically send out handshake msg
               sendHandshakeMsg(ifName, false);
             });
@@ -1542,8 +1861,8 @@ Spark::processHelloMsg(
         neighbor.negotiateTimer->scheduleTimeout(myHandshakeTime_, isPeriodic);
 
         // Starts negotiate hold-timer
-        neighbor.negotiateHoldTimer = fbzmq::ZmqTimeout::make(
-            this, [this, ifName, neighborName]() noexcept {
+        neighbor.negotiateHoldTimer = TimerWheel::Timeout::make(
+            timerWheel_.get(), [this, ifName, neighborName]() noexcept {
               // prevent to stucking in NEGOTIATE forever
               processNegotiateTimeout(ifName, neighborName);
             });
@@ -1559,6 +1878,7 @@ Spark::processHelloMsg(
   } else if (neighbor.state == SparkNeighState::ESTABLISHED) {
     // Update local seqNum maintained for this neighbor
     neighbor.seqNum = remoteSeqNum;
+    invalidateHelloPacket(ifName);
 
     // Check if neighbor is undergoing 'Graceful-Restart'
     if (helloMsg.restarting) {
@@ -1585,6 +1905,7 @@ Spark::processHelloMsg(
       // remove from tracked neighbor at the end
       allocatedLabels_.erase(neighbor.label);
       ifNeighbors.erase(neighborName);
+      invalidateHelloPacket(ifName);
     }
   } else if (neighbor.state == SparkNeighState::RESTART) {
     // Neighbor is undergoing restart. Will reply immediately for hello msg for
@@ -1604,6 +1925,7 @@ Spark::processHelloMsg(
 
         // Update local seqNum maintained for this neighbor
         neighbor.seqNum = remoteSeqNum;
+        invalidateHelloPacket(ifName);
 
         notifySparkNeighborEvent(
             thrift::SparkNeighborEventType::NEIGHBOR_RESTARTED,
@@ -1614,8 +1936,8 @@ Spark::processHelloMsg(
             true /* support flood-optimization */);
 
         // start heartbeat timer again to make sure neighbor is alive
-        neighbor.heartbeatHoldTimer = fbzmq::ZmqTimeout::make(
-            this, [this, ifName, neighborName]() noexcept {
+        neighbor.heartbeatHoldTimer = TimerWheel::Timeout::make(
+            timerWheel_.get(), [this, ifName, neighborName]() noexcept {
               processHeartbeatTimeout(ifName, neighborName);
             });
         neighbor.heartbeatHoldTimer->scheduleTimeout(
@@ -1624,6 +1946,9 @@ Spark::processHelloMsg(
         // stop the graceful-restart hold-timer
         neighbor.gracefulRestartHoldTimer.reset();
 
+        // restart liveness detection with new incarnation of neighbor
+        startLivenessSession(neighbor, ifName, neighborName);
+
         SparkNeighState oldState = neighbor.state;
         neighbor.state =
             getNextState(oldState, SparkNeighEvent::HELLO_RCVD_INFO);
@@ -1741,13 +2066,57 @@ Spark::processHeartbeatMsg(
 }
 
 void
-Spark::processHelloPacket() {
-  // Step 1: receive and parse pkt
+Spark::processHelloPackets() {
+  size_t numBatches{0};
+  size_t numPackets{0};
+
+  // Drain socket until there is nothing pending. A batch which is not full
+  // means socket had no more pending packets (same as EAGAIN)
+  while (numBatches < kMaxHelloRecvBatchesPerEvent) {
+    const auto numMsgs =
+        IoProvider::recvMessages(mcastFd_, *recvBatch_, ioProvider_.get());
+    if (numMsgs == 0) {
+      break;
+    }
+    ++numBatches;
+    numPackets += numMsgs;
+    tData_.addStatValue(
+        "spark.hello_packet_recv_batch_size", numMsgs, fbzmq::AVG);
+
+    for (size_t i = 0; i < numMsgs; ++i) {
+      try {
+        processHelloPacket(recvBatch_->getMessage(i));
+      } catch (std::exception const& err) {
+        LOG(ERROR) << "Spark: error processing hello packet "
+                   << folly::exceptionStr(err);
+      }
+    }
+
+    if (numMsgs < recvBatch_->getBatchSize()) {
+      break;
+    }
+  }
+
+  tData_.addStatValue(
+      "spark.hello_packet_recv_batches", numBatches, fbzmq::SUM);
+  tData_.addStatValue(
+      "spark.hello_packet_recv_per_event", numPackets, fbzmq::AVG);
+}
+
+void
+Spark::processHelloPacket(ReceivedMessage const& message) {
+  // Step 0: liveness packets share socket with hello packets
+  if (LivenessPacket::isLivenessPacket(message.data)) {
+    processLivenessPacket(message);
+    return;
+  }
+
+  // Step 1: parse pkt
   thrift::SparkHelloPacket helloPacket;
   std::string ifName;
   std::chrono::microseconds myRecvTime;
 
-  if (!parsePacket(helloPacket, ifName, myRecvTime)) {
+  if (!parsePacket(message, helloPacket, ifName, myRecvTime)) {
     return;
   }
 
@@ -1795,6 +2164,7 @@ Spark::processHelloPacket() {
   auto nbrSentTime = std::chrono::microseconds(helloPacket.payload.timestamp);
   neighbor.neighborTimestamp = nbrSentTime;
   neighbor.localTimestamp = myRecvTime;
+  invalidateHelloPacket(ifName);
 
   // check if it's a restarting packet
   if (helloPacket.payload.restarting.hasValue() and
@@ -2027,9 +2397,64 @@ Spark::sendHelloPacket(
   // down event has not arrived yet
 
   const auto& interfaceEntry = interfaceDb_.at(ifName);
-  const auto ifIndex = interfaceEntry.ifIndex;
-  const auto v4Addr = interfaceEntry.v4Network.first;
-  const auto v6Addr = interfaceEntry.v6LinkLocalNetwork.first;
+
+  // let neighbors correct RTT they measured off our previous hello by time
+  // it spent in our stack
+  folly::Optional<std::pair<int64_t, int64_t>> prevSentTs;
+  auto txIt = helloTxTimestamps_.find(ifName);
+  if (enableSpark2_ and txIt != helloTxTimestamps_.end() and
+      not txIt->second.empty()) {
+    prevSentTs = txIt->second.back();
+  }
+
+  // serialized hello packet is cached, only sequence number and timestamps
+  // are patched into it. Timestamps are stamped once it is sent
+  auto const& helloTemplate = getHelloPacketTemplate(
+      ifName,
+      interfaceEntry,
+      inFastInitState,
+      restarting,
+      prevSentTs.hasValue());
+  SparkHelloTemplate::TimestampOffsets timestampOffsets;
+  auto packet = helloTemplate.serialize(
+      mySeqNum_,
+      prevSentTs.hasValue() ? prevSentTs->first : 0,
+      prevSentTs.hasValue() ? prevSentTs->second : 0,
+      timestampOffsets);
+
+  if (kMinIpv6Mtu < packet.size()) {
+    LOG(ERROR) << "Hello packet is too big, cannot sent!";
+    return;
+  }
+
+  // send the payload
+  queuePacket(
+      ifName,
+      interfaceEntry,
+      std::move(packet),
+      helloCounters_,
+      folly::none /* dstAddr */,
+      timestampOffsets);
+}
+
+SparkHelloTemplate const&
+Spark::getHelloPacketTemplate(
+    std::string const& ifName,
+    Interface const& interface,
+    bool inFastInitState,
+    bool restarting,
+    bool hasPrevSentTs) {
+  auto it = helloPacketTemplates_.find(ifName);
+  if (it != helloPacketTemplates_.end() and
+      it->second.interface == interface and
+      it->second.inFastInitState == inFastInitState and
+      it->second.restarting == restarting and
+      it->second.hasPrevSentTs == hasPrevSentTs) {
+    return it->second.helloTemplate;
+  }
+
+  const auto v4Addr = interface.v4Network.first;
+  const auto v6Addr = interface.v6LinkLocalNetwork.first;
   thrift::OpenrVersion openrVer(kVersion_.version);
 
   // build the hello packet from payload and empty signature
@@ -2040,31 +2465,22 @@ Spark::sendHelloPacket(
     helloMsg.domainName = myDomainName_;
     helloMsg.nodeName = myNodeName_;
     helloMsg.ifName = ifName;
-    helloMsg.seqNum = mySeqNum_;
-    helloMsg.neighborInfos =
-        std::map<std::string, thrift::ReflectedNeighborInfo>{};
     helloMsg.version = openrVer;
     helloMsg.solicitResponse = inFastInitState;
     helloMsg.restarting = restarting;
-    helloMsg.sentTsInUs = getCurrentTimeInUs().count();
+    if (hasPrevSentTs) {
+      helloMsg.prevSentTsInUs = 0;
+      helloMsg.prevKernelSentTsInUs = 0;
+    }
 
     // bake neighborInfo into helloMsg
-    for (const auto& kv : spark2Neighbors_.at(ifName)) {
-      auto const& neighborName = kv.first;
-      auto const& neighbor = kv.second;
-
-      auto& neighborInfo = helloMsg.neighborInfos[neighborName];
-      neighborInfo.seqNum = neighbor.seqNum;
-      neighborInfo.lastNbrMsgSentTsInUs = neighbor.neighborTimestamp.count();
-      neighborInfo.lastMyMsgRcvdTsInUs = neighbor.localTimestamp.count();
-    }
+    helloMsg.neighborInfos =
+        getReflectedNeighborInfos(spark2Neighbors_.at(ifName));
 
     // fill in helloMsg field
-    helloPacket.helloMsg = helloMsg;
+    helloPacket.helloMsg = std::move(helloMsg);
   }
 
-  // TODO: deprecate the payload setup once old spark msg
-  // no longer is use
   thrift::SparkNeighbor myself = createSparkNeighbor(
       myDomainName_,
       myNodeName_,
@@ -2075,60 +2491,232 @@ Spark::sendHelloPacket(
       kKvStoreCmdPort_,
       ifName);
 
-  // create the hello packet payload
-  auto payload = createSparkPayload(
+  // TODO: deprecate the payload setup once old spark msg
+  // no longer is use
+  //
+  // create the hello packet payload, with all neighbors we have heard from
+  // on this interface
+  helloPacket.payload = createSparkPayload(
       openrVer,
       myself,
       mySeqNum_,
-      std::map<std::string, thrift::ReflectedNeighborInfo>{},
-      getCurrentTimeInUs().count(),
+      getReflectedNeighborInfos(neighbors_.at(ifName)),
+      0 /* timestamp */,
       inFastInitState,
       enableFloodOptimization_,
       restarting,
       areas_);
+  helloPacket.signature = "";
 
-  // add all neighbors we have heard from on this interface
-  for (const auto& kv : neighbors_.at(ifName)) {
-    std::string const& neighborName = kv.first;
-    auto& neighbor = kv.second;
+  helloPacketTemplates_.erase(ifName);
+  auto res = helloPacketTemplates_.emplace(
+      ifName,
+      HelloPacketCacheEntry{interface,
+                            inFastInitState,
+                            restarting,
+                            hasPrevSentTs,
+                            SparkHelloTemplate(helloPacket)});
+  return res.first->second.helloTemplate;
+}
 
-    // Add timestamp and sequence number from last hello. Will be 0 if we
-    // haven't heard before from the neighbor.
-    // Refer to thrift for definition of timestampts.
-    auto& neighborInfo = payload.neighborInfos[neighborName];
-    neighborInfo.seqNum = neighbor.seqNum;
-    neighborInfo.lastNbrMsgSentTsInUs = neighbor.neighborTimestamp.count();
-    neighborInfo.lastMyMsgRcvdTsInUs = neighbor.localTimestamp.count();
-  }
+void
+Spark::invalidateHelloPacket(std::string const& ifName) {
+  helloPacketTemplates_.erase(ifName);
+}
 
-  helloPacket.payload = std::move(payload);
-  helloPacket.signature = "";
+void
+Spark::queuePacket(
+    std::string const& ifName,
+    Interface const& interface,
+    std::string packet,
+    PacketCounters const& counters,
+    folly::Optional<folly::SocketAddress> const& dstAddr,
+    folly::Optional<SparkHelloTemplate::TimestampOffsets> const&
+        helloTimestampOffsets) {
+  OutgoingMessage message;
+  message.ifIndex = interface.ifIndex;
+  message.srcAddr = interface.v6LinkLocalNetwork.first.asV6();
+  message.dstAddr = dstAddr.hasValue()
+      ? dstAddr.value()
+      : folly::SocketAddress(
+            folly::IPAddress(Constants::kSparkMcastAddr.toString()),
+            udpMcastPort_);
+  message.packet = std::move(packet);
 
-  auto packet = util::writeThriftObjStr(helloPacket, serializer_);
+  pendingPackets_.emplace_back(std::move(message));
+  pendingPacketInfos_.emplace_back(
+      PendingPacketInfo{ifName, &counters, helloTimestampOffsets});
 
-  // send the payload
-  folly::SocketAddress dstAddr(
-      folly::IPAddress(Constants::kSparkMcastAddr.toString()), udpMcastPort_);
+  if (!sendPacketsTimer_->isScheduled()) {
+    sendPacketsTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  }
+}
 
-  if (kMinIpv6Mtu < packet.size()) {
-    LOG(ERROR) << "Hello packet is too big, cannot sent!";
+void
+Spark::flushPendingPackets() {
+  if (pendingPackets_.empty()) {
     return;
   }
 
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
+  // hellos carry time they are actually sent at, for neighbors to measure
+  // RTT with as little of our own queueing in it as possible
+  const auto nowInUs = getCurrentTimeInUs().count();
+  for (size_t i = 0; i < pendingPackets_.size(); ++i) {
+    const auto& offsets = pendingPacketInfos_[i].helloTimestampOffsets;
+    if (offsets.hasValue()) {
+      SparkHelloTemplate::stampTimestamps(
+          pendingPackets_[i].packet, offsets.value(), nowInUs);
+    }
+  }
+
+  const auto bytesSent =
+      IoProvider::sendMessages(mcastFd_, pendingPackets_, ioProvider_.get());
+
+  bool sendFailed{false};
+  for (size_t i = 0; i < pendingPackets_.size(); ++i) {
+    const auto& message = pendingPackets_[i];
+    const auto& info = pendingPacketInfos_[i];
+
+    if (bytesSent[i] < 0) {
+      sendFailed = true;
+    } else if (txTimestampingEnabled_) {
+      // kernel numbers every datagram it sends, remember which are hellos
+      const auto txId = nextTxId_++;
+      if (info.helloTimestampOffsets.hasValue()) {
+        txHellosInFlight_.emplace(txId, std::make_pair(info.ifName, nowInUs));
+        if (txHellosInFlight_.size() > kMaxTxHellosInFlight) {
+          txHellosInFlight_.erase(txHellosInFlight_.begin());
+        }
+      }
+    }
+
+    if ((bytesSent[i] < 0) ||
+        (static_cast<size_t>(bytesSent[i]) != message.packet.size())) {
+      VLOG(1) << "Sending multicast to " << message.dstAddr.getAddressStr()
+              << " on " << info.ifName << " failed";
+      continue;
+    }
+
+    // update counters for number of pkts and total size of pkts sent
+    tData_.addStatValue(
+        info.counters->bytesSent, message.packet.size(), fbzmq::SUM);
+    tData_.addStatValue(info.counters->packetsSent, 1, fbzmq::SUM);
+    VLOG(4) << "Sent " << bytesSent[i] << " bytes in " << info.counters->prefix
+            << " packet on " << info.ifName;
+  }
+
+  tData_.addStatValue(
+      "spark.packets_sent_per_batch", pendingPackets_.size(), fbzmq::AVG);
+  pendingPackets_.clear();
+  pendingPacketInfos_.clear();
 
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    VLOG(1) << "Sending multicast to " << dstAddr.getAddressStr() << " on "
-            << ifName << " failed due to error " << folly::errnoStr(errno);
+  // failed send may or may not have used up an id in kernel
+  if (sendFailed and txTimestampingEnabled_) {
+    resetTxTimestampIds();
+  }
+}
+
+void
+Spark::processTxTimestamps() noexcept {
+  if (not txTimestampingEnabled_) {
+    return;
+  }
+
+  std::vector<TxTimestamp> timestamps;
+  try {
+    timestamps = IoProvider::recvTxTimestamps(mcastFd_, ioProvider_.get());
+  } catch (std::exception const& err) {
+    LOG(ERROR) << "Spark: error receiving TX timestamps "
+               << folly::exceptionStr(err);
     return;
   }
 
-  // update counters for number of pkts and total size of pkts sent
-  tData_.addStatValue("spark.hello.bytes_sent", packet.size(), fbzmq::SUM);
-  tData_.addStatValue("spark.hello.packets_sent", 1, fbzmq::SUM);
+  for (auto const& timestamp : timestamps) {
+    auto it = txHellosInFlight_.find(timestamp.id);
+    if (it == txHellosInFlight_.end()) {
+      // not a hello, or we gave up on it
+      continue;
+    }
+    const auto ifName = std::move(it->second.first);
+    const auto sentTsInUs = it->second.second;
+    txHellosInFlight_.erase(it);
+
+    // timestamp way off from when hello was built means we are matching
+    // wrong packets, start over
+    const auto txDelay =
+        std::chrono::microseconds(timestamp.txTs.count() - sentTsInUs);
+    if (txDelay.count() < 0 or txDelay > kMaxTxDelay) {
+      LOG(WARNING) << "Kernel TX timestamp of hello on " << ifName << " is "
+                   << txDelay.count() << "us off. Resetting TX timestamp ids";
+      tData_.addStatValue("spark.tx_timestamp_mismatch", 1, fbzmq::COUNT);
+      resetTxTimestampIds();
+      return;
+    }
+
+    if (interfaceDb_.count(ifName) == 0) {
+      continue;
+    }
+    auto& ifTimestamps = helloTxTimestamps_[ifName];
+    ifTimestamps.emplace_back(sentTsInUs, timestamp.txTs.count());
+    if (ifTimestamps.size() > kMaxHelloTxTimestamps) {
+      ifTimestamps.pop_front();
+    }
+    tData_.addStatValue("spark.hello_tx_delay_us", txDelay.count(), fbzmq::AVG);
+  }
+}
+
+void
+Spark::resetTxTimestampIds() {
+  // Kernel counts ids from zero whenever SOF_TIMESTAMPING_OPT_ID gets
+  // enabled on socket. Drop timestamps queued under old numbering first
+  txTimestampingEnabled_ = false;
+  try {
+    IoProvider::recvTxTimestamps(mcastFd_, ioProvider_.get());
+  } catch (std::exception const& err) {
+    LOG(ERROR) << "Spark: error draining TX timestamps "
+               << folly::exceptionStr(err);
+  }
+  txHellosInFlight_.clear();
+  nextTxId_ = 0;
+
+  const int noIdFlags = kTimestampingFlags & ~SOF_TIMESTAMPING_OPT_ID;
+  if (ioProvider_->setsockopt(
+          mcastFd_,
+          SOL_SOCKET,
+          SO_TIMESTAMPING,
+          &noIdFlags,
+          sizeof(noIdFlags)) != 0 or
+      ioProvider_->setsockopt(
+          mcastFd_,
+          SOL_SOCKET,
+          SO_TIMESTAMPING,
+          &kTimestampingFlags,
+          sizeof(kTimestampingFlags)) != 0) {
+    LOG(ERROR) << "Failed to reset kernel TX timestamping, RTT is measured "
+               << "off user space timestamps. Error: "
+               << folly::errnoStr(errno);
+    // keep RX timestamps but stop kernel queueing TX ones we won't read
+    const int rxFlags =
+        SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_RX_SOFTWARE;
+    ioProvider_->setsockopt(
+        mcastFd_, SOL_SOCKET, SO_TIMESTAMPING, &rxFlags, sizeof(rxFlags));
+    return;
+  }
+  txTimestampingEnabled_ = true;
+}
 
-  VLOG(4) << "Sent " << bytesSent << " bytes in hello packet";
+int64_t
+Spark::getKernelSentTs(std::string const& ifName, int64_t sentTsInUs) const {
+  auto it = helloTxTimestamps_.find(ifName);
+  if (it == helloTxTimestamps_.end()) {
+    return sentTsInUs;
+  }
+  for (auto const& kv : it->second) {
+    if (kv.first == sentTsInUs) {
+      return kv.second;
+    }
+  }
+  return sentTsInUs;
 }
 
 folly::Expected<fbzmq::Message, fbzmq::Error>
@@ -2270,6 +2858,8 @@ Spark::deleteInterfaceFromDb(const std::set<std::string>& toDel) {
       spark2Neighbors_.erase(ifName);
       ifNameToHeartbeatTimers_.erase(ifName);
     }
+    invalidateHelloPacket(ifName);
+    helloTxTimestamps_.erase(ifName);
 
     for (const auto& kv : neighbors_.at(ifName)) {
       auto& neighborName = kv.first;
@@ -2361,8 +2951,9 @@ Spark::addInterfaceToDb(
       CHECK(result.second);
 
       // heartbeatTimers will start as soon as intf is in UP state
-      auto heartbeatTimer = fbzmq::ZmqTimeout::make(
-          this, [this, ifName]() noexcept { sendHeartbeatMsg(ifName); });
+      auto heartbeatTimer = TimerWheel::Timeout::make(
+          timerWheel_.get(),
+          [this, ifName]() noexcept { sendHeartbeatMsg(ifName); });
 
       const bool isPeriodic = true; /* flag indicating periodic pkt sent-out*/
       ifNameToHeartbeatTimers_.emplace(ifName, std::move(heartbeatTimer));
@@ -2392,8 +2983,9 @@ Spark::addInterfaceToDb(
     // this is due to the fact that it may not have yet configured a link-local
     // address. The hello packet will be sent later and will have good chances
     // of making it out if small delay is introduced.
-    auto helloTimer = fbzmq::ZmqTimeout::make(
-        this, [this, ifName, timePoint, roll, rollFast]() mutable noexcept {
+    auto helloTimer = TimerWheel::Timeout::make(
+        timerWheel_.get(),
+        [this, ifName, timePoint, roll, rollFast]() mutable noexcept {
           VLOG(3) << "Sending hello multicast packet on interface " << ifName;
           bool inFastInitState = false;
           if (enableSpark2_ && increaseHelloInterval_) {
@@ -2534,6 +3126,17 @@ Spark::submitCounters() {
       counters["spark.rtt_latest_us." + neighbor.info.nodeName] =
           neighbor.rttLatest.count();
       counters["spark.seq_num." + neighbor.info.nodeName] = neighbor.seqNum;
+      addRttHistogramCounters(
+          counters,
+          neighbor.info.nodeName,
+          ifaceNeighbors.first,
+          neighbor.rttHistogram);
+    }
+  }
+  for (auto const& ifaceNeighbors : spark2Neighbors_) {
+    for (auto const& kv : ifaceNeighbors.second) {
+      addRttHistogramCounters(
+          counters, kv.first, ifaceNeighbors.first, kv.second.rttHistogram);
     }
   }
   counters["spark.num_tracked_interfaces"] = neighbors_.size();
@@ -2541,6 +3144,7 @@ Spark::submitCounters() {
   counters["spark.num_adjacent_neighbors"] = adjacentNeighborCount;
   counters["spark.my_seq_num"] = mySeqNum_;
   counters["spark.pending_timers"] = getNumPendingTimeouts();
+  counters["spark.pending_wheel_timers"] = timerWheel_->getNumScheduled();
   counters["spark.zmq_event_queue_size"] = getEventQueueSize();
 
   zmqMonitorClient_->setCounters(prepareSubmitCounters(std::move(counters)));
@@ -8,7 +8,9 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
 #include <functional>
+#include <map>
 
 #include <boost/serialization/strong_typedef.hpp>
 #include <fbzmq/async/ZmqEventLoop.h>
@@ -24,12 +26,16 @@
 
 #include <openr/common/OpenrEventLoop.h>
 #include <openr/common/StepDetector.h>
+#include <openr/common/StreamingHistogram.h>
+#include <openr/common/TimerWheel.h>
 #include <openr/common/Types.h>
 #include <openr/common/Util.h>
 #include <openr/if/gen-cpp2/KvStore_constants.h>
 #include <openr/if/gen-cpp2/LinkMonitor_types.h>
 #include <openr/if/gen-cpp2/Spark_types.h>
 #include <openr/spark/IoProvider.h>
+#include <openr/spark/SparkHelloTemplate.h>
+#include <openr/spark/SparkLiveness.h>
 
 namespace openr {
 
@@ -103,7 +109,9 @@ class Spark final : public OpenrEventLoop {
       bool enableFloodOptimization = false,
       bool enableSpark2 = false,
       bool increaseHelloInterval = false,
-      folly::Optional<std::unordered_set<std::string>> areas = folly::none);
+      folly::Optional<std::unordered_set<std::string>> areas = folly::none,
+      std::chrono::milliseconds myLivenessTime = std::chrono::milliseconds{0},
+      uint8_t livenessDetectMultiplier = 3);
 
   ~Spark() override = default;
 
@@ -117,6 +125,9 @@ class Spark final : public OpenrEventLoop {
   folly::Optional<SparkNeighState> getSparkNeighState(
       std::string const& ifName, std::string const& neighborName);
 
+  // get counters tracked by spark so far, used for benchmarking
+  std::unordered_map<std::string, int64_t> getCounters();
+
   // override eventloop stop()
   void stop() override;
 
@@ -185,9 +196,12 @@ class Spark final : public OpenrEventLoop {
   bool shouldProcessHelloPacket(
       std::string const& ifName, folly::IPAddress const& addr);
 
+  // receive and process all pending hello packets on mcastFd_ in batches
+  void processHelloPackets();
+
   // process hello packet from a neighbor. we want to see if
   // the neighbor could be added as adjacent peer.
-  void processHelloPacket();
+  void processHelloPacket(ReceivedMessage const& message);
 
   // originate my hello packet on given interface
   void sendHelloPacket(
@@ -195,6 +209,59 @@ class Spark final : public OpenrEventLoop {
       bool inFastInitState = false,
       bool restarting = false);
 
+  // get serialized hello packet for interface, for caller to patch
+  // sequence number and timestamps into. It is cached and only rebuilt when
+  // interface, flags or neighbors heard on it change
+  SparkHelloTemplate const& getHelloPacketTemplate(
+      std::string const& ifName,
+      Interface const& interface,
+      bool inFastInitState,
+      bool restarting,
+      bool hasPrevSentTs);
+
+  // drop cached hello packet of interface, called whenever neighbors heard
+  // on it (or what we reflect back to them) change
+  void invalidateHelloPacket(std::string const& ifName);
+
+  // names of counters updated for every packet of a kind sent out
+  struct PacketCounters {
+    explicit PacketCounters(std::string const& prefix)
+        : prefix(prefix),
+          bytesSent(prefix + ".bytes_sent"),
+          packetsSent(prefix + ".packets_sent") {}
+
+    const std::string prefix;
+    const std::string bytesSent;
+    const std::string packetsSent;
+  };
+
+  // queue serialized packet to be multicasted (or sent to `dstAddr` if
+  // provided) on interface with next batch. `counters` are updated once
+  // packet is sent. Hellos pass offsets of their timestamps, which get
+  // stamped right before sending and are used to learn kernel TX timestamp
+  void queuePacket(
+      std::string const& ifName,
+      Interface const& interface,
+      std::string packet,
+      PacketCounters const& counters,
+      folly::Optional<folly::SocketAddress> const& dstAddr = folly::none,
+      folly::Optional<SparkHelloTemplate::TimestampOffsets> const&
+          helloTimestampOffsets = folly::none);
+
+  // send all queued packets with as few syscalls as possible
+  void flushPendingPackets();
+
+  // read kernel TX timestamps of sent packets off socket error queue and
+  // record ones belonging to hellos
+  void processTxTimestamps() noexcept;
+
+  // restart kernel numbering of sent packets once we lost track of it
+  void resetTxTimestampIds();
+
+  // kernel TX timestamp of hello sent on interface at `sentTsInUs`, or
+  // `sentTsInUs` itself if not known
+  int64_t getKernelSentTs(std::string const& ifName, int64_t sentTsInUs) const;
+
   folly::Expected<fbzmq::Message, fbzmq::Error> processRequestMsg(
       fbzmq::Message&& request) override;
 
@@ -227,8 +294,9 @@ class Spark final : public OpenrEventLoop {
       folly::Optional<std::unordered_set<std::string>> areas,
       const std::string& nodeName);
 
-  // function to receive and parse received pkt
+  // function to parse received pkt
   bool parsePacket(
+      ReceivedMessage const& message /* received datagram */,
       thrift::SparkHelloPacket& pkt /* packet( type will be renamed later) */,
       std::string& ifName /* interface */,
       std::chrono::microseconds& recvTime /* kernel timestamp when recved */);
@@ -247,6 +315,25 @@ class Spark final : public OpenrEventLoop {
       std::string const& remoteIfName,
       std::string const& ifName);
 
+  // deduce RTT from timestamps of last hello exchange with neighbor. Our
+  // sent time is corrected by kernel TX timestamp when known
+  folly::Optional<std::chrono::microseconds> measureNeighborRtt(
+      std::chrono::microseconds const& myRecvTimeInUs,
+      std::chrono::microseconds const& mySentTimeInUs,
+      std::chrono::microseconds const& nbrRecvTimeInUs,
+      std::chrono::microseconds const& nbrSentTimeInUs,
+      std::string const& neighborName,
+      std::string const& remoteIfName,
+      std::string const& ifName) const;
+
+  // account RTT sample measured at `myRecvTimeInUs` towards neighbor's RTT
+  // and RTT distribution
+  void addRttSample(
+      std::chrono::microseconds rtt,
+      std::chrono::microseconds const& myRecvTimeInUs,
+      std::string const& neighborName,
+      std::string const& ifName);
+
   //
   // Spark2 related function call
   //
@@ -295,16 +382,19 @@ class Spark final : public OpenrEventLoop {
     SparkNeighState state;
 
     // timer to periodically send out handshake pkt
-    std::unique_ptr<fbzmq::ZmqTimeout> negotiateTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> negotiateTimer{nullptr};
 
     // negotiate stage hold-timer
-    std::unique_ptr<fbzmq::ZmqTimeout> negotiateHoldTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> negotiateHoldTimer{nullptr};
 
     // heartbeat hold-timer
-    std::unique_ptr<fbzmq::ZmqTimeout> heartbeatHoldTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> heartbeatHoldTimer{nullptr};
 
     // graceful restart hold-timer
-    std::unique_ptr<fbzmq::ZmqTimeout> gracefulRestartHoldTimer{nullptr};
+    std::unique_ptr<TimerWheel::Timeout> gracefulRestartHoldTimer{nullptr};
+
+    // fast liveness detection session, only while in ESTABLISHED state
+    std::unique_ptr<LivenessSession> liveness{nullptr};
 
     // KvStore related port. Info passed to LinkMonitor for neighborEvent
     int32_t kvStorePubPort{0};
@@ -332,6 +422,18 @@ class Spark final : public OpenrEventLoop {
 
     // detect rtt changes
     StepDetector<int64_t, std::chrono::milliseconds> stepDetector;
+
+    // distribution of recent RTT samples
+    StreamingHistogram rttHistogram;
+
+    // RTT sample off last hello, held back until neighbor tells us when
+    // that hello actually left it
+    struct PendingRttSample {
+      int64_t nbrSentTsInUs{0};
+      std::chrono::microseconds myRecvTime{0};
+      std::chrono::microseconds rtt{0};
+    };
+    folly::Optional<PendingRttSample> pendingRttSample;
   };
 
   std::unordered_map<
@@ -415,6 +517,20 @@ class Spark final : public OpenrEventLoop {
   void processGRTimeout(
       std::string const& ifName, std::string const& neighborName);
 
+  // start/stop liveness detection with established neighbor if enabled
+  void startLivenessSession(
+      Spark2Neighbor& neighbor,
+      std::string const& ifName,
+      std::string const& neighborName);
+  void stopLivenessSession(Spark2Neighbor& neighbor);
+
+  // process liveness packet received on hello socket
+  void processLivenessPacket(ReceivedMessage const& message);
+
+  // liveness session to neighbor went down
+  void processLivenessDown(
+      std::string const& ifName, std::string const& neighborName);
+
   // Util function to convert ENUM SparlNeighborState to string
   static std::string sparkNeighborStateToStr(SparkNeighState state);
 
@@ -465,6 +581,11 @@ class Spark final : public OpenrEventLoop {
   // Spark2 heartbeat msg hold time
   const std::chrono::milliseconds myHeartbeatHoldTime_{0};
 
+  // Spark2 liveness packet interval (0 disables liveness detection) and
+  // number of packets missed before declaring neighbor down
+  const std::chrono::milliseconds myLivenessTime_{0};
+  const uint8_t livenessDetectMultiplier_{3};
+
   // This flag indicates that we will also exchange v4 transportAddress in
   // Spark HelloMessage
   const bool enableV4_{false};
@@ -481,6 +602,9 @@ class Spark final : public OpenrEventLoop {
   // the multicast socket we use
   int mcastFd_{-1};
 
+  // reusable buffers to receive hello packets in batches on mcastFd_
+  std::unique_ptr<RecvBatch> recvBatch_;
+
   // state transition matrix for Finite-State-Machine
   static const std::vector<std::vector<folly::Optional<SparkNeighState>>>
       stateMap_;
@@ -513,16 +637,20 @@ class Spark final : public OpenrEventLoop {
   // Map of interface entries keyed by ifName
   std::unordered_map<std::string, Interface> interfaceDb_{};
 
+  // Per interface and per neighbor timers are all multiplexed on this wheel
+  // instead of each registering its own timeout with the event loop
+  std::unique_ptr<TimerWheel> timerWheel_;
+
   // Hello packet send timers for each interface
   std::unordered_map<
       std::string /* ifName */,
-      std::unique_ptr<fbzmq::ZmqTimeout>>
+      std::unique_ptr<TimerWheel::Timeout>>
       ifNameToHelloTimers_;
 
   // heartbeat packet send timers for each interface
   std::unordered_map<
       std::string /* ifName */,
-      std::unique_ptr<fbzmq::ZmqTimeout>>
+      std::unique_ptr<TimerWheel::Timeout>>
       ifNameToHeartbeatTimers_;
 
   // number of active neighbors for each interface
@@ -534,6 +662,13 @@ class Spark final : public OpenrEventLoop {
   // Ordered set to keep track of allocated labels
   std::set<int32_t> allocatedLabels_;
 
+  // Liveness sessions keyed by local discriminator
+  std::unordered_map<
+      uint32_t /* discriminator */,
+      std::pair<std::string /* ifName */, std::string /* neighborName */>>
+      livenessSessions_;
+  uint32_t nextLivenessDiscriminator_{0};
+
   //
   // Neighbor state tracking
   //
@@ -544,7 +679,7 @@ class Spark final : public OpenrEventLoop {
         thrift::SparkNeighbor const& info,
         uint32_t label,
         uint64_t seqNum,
-        std::unique_ptr<fbzmq::ZmqTimeout> holdTimer,
+        std::unique_ptr<TimerWheel::Timeout> holdTimer,
         const std::chrono::milliseconds& samplingPeriod,
         std::function<void(const int64_t&)> rttChangeCb);
 
@@ -552,7 +687,7 @@ class Spark final : public OpenrEventLoop {
     thrift::SparkNeighbor info;
 
     // Hold timer. If expired will declare the neighbor as stopped.
-    const std::unique_ptr<fbzmq::ZmqTimeout> holdTimer{nullptr};
+    const std::unique_ptr<TimerWheel::Timeout> holdTimer{nullptr};
 
     // SR Label to reach Neighbor over this specific adjacency. Generated
     // using ifIndex to this neighbor. Only local within the node.
@@ -581,6 +716,9 @@ class Spark final : public OpenrEventLoop {
 
     // detect rtt changes
     StepDetector<int64_t, std::chrono::milliseconds> stepDetector;
+
+    // distribution of recent RTT samples
+    StreamingHistogram rttHistogram;
   };
 
   std::unordered_map<
@@ -599,6 +737,47 @@ class Spark final : public OpenrEventLoop {
   // Timer for submitting to monitor periodically
   std::unique_ptr<fbzmq::ZmqTimeout> monitorTimer_{nullptr};
 
+  // Cached hello packet per interface, along with what it was built for
+  struct HelloPacketCacheEntry {
+    Interface interface;
+    bool inFastInitState{false};
+    bool restarting{false};
+    bool hasPrevSentTs{false};
+    SparkHelloTemplate helloTemplate;
+  };
+  std::unordered_map<std::string /* ifName */, HelloPacketCacheEntry>
+      helloPacketTemplates_;
+
+  const PacketCounters helloCounters_{"spark.hello"};
+  const PacketCounters handshakeCounters_{"spark.handshake"};
+  const PacketCounters heartbeatCounters_{"spark.heartbeat"};
+  const PacketCounters livenessCounters_{"spark.liveness"};
+
+  // Packets queued in this event loop iteration, sent out in one batch by
+  // sendPacketsTimer_, along with what we need to know once they are sent
+  struct PendingPacketInfo {
+    std::string ifName;
+    PacketCounters const* counters{nullptr};
+    folly::Optional<SparkHelloTemplate::TimestampOffsets> helloTimestampOffsets;
+  };
+  std::vector<OutgoingMessage> pendingPackets_;
+  std::vector<PendingPacketInfo> pendingPacketInfos_;
+  std::unique_ptr<fbzmq::ZmqTimeout> sendPacketsTimer_{nullptr};
+
+  // Kernel TX timestamping. Kernel numbers every packet sent on socket and
+  // reports its TX timestamp along with that id, so we mirror numbering to
+  // tell which hello each timestamp belongs to
+  bool txTimestampingEnabled_{false};
+  uint32_t nextTxId_{0};
+  std::map<uint32_t /* id */, std::pair<std::string /* ifName */, int64_t>>
+      txHellosInFlight_;
+
+  // sentTsInUs and kernel TX timestamp of last few hellos per interface
+  std::unordered_map<
+      std::string /* ifName */,
+      std::deque<std::pair<int64_t, int64_t>>>
+      helloTxTimestamps_;
+
   // vector of BucketedTimeSeries to make sure we don't take too many
   // hello packets from any one iface, address pair
   std::vector<folly::BucketedTimeSeries<int64_t, std::chrono::steady_clock>>
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/spark/SparkHelloTemplate.h>
+
+#include <glog/logging.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+namespace openr {
+
+namespace {
+
+// Longest possible i64 varint, any value fits in slot of this size
+const size_t kVarintSize{10};
+
+using FieldValues = std::array<int64_t, SparkHelloTemplate::NUM_FIELDS>;
+
+// Compact protocol writes i64 as varint of its zigzag encoding
+uint64_t
+toZigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+      static_cast<uint64_t>(value >> 63);
+}
+
+int64_t
+fromZigzag(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// Varint padded to kVarintSize bytes, which decodes as any other
+void
+writeFixedVarint(char* data, int64_t value) {
+  auto encoded = toZigzag(value);
+  for (size_t i = 0; i < kVarintSize - 1; ++i) {
+    data[i] = static_cast<char>((encoded & 0x7f) | 0x80);
+    encoded >>= 7;
+  }
+  data[kVarintSize - 1] = static_cast<char>(encoded);
+}
+
+// Placeholders serialized into patched fields. Both have top bit set, so
+// are serialized as kVarintSize bytes long varints, and differ from each
+// other in every byte but the last one. First byte tells field apart.
+FieldValues
+getPlaceholders(bool ones) {
+  const uint64_t topBit = 1ULL << 63;
+  const uint64_t middleBits = (topBit - 1) & ~0x7fULL;
+  FieldValues values;
+  for (size_t field = 0; field < values.size(); ++field) {
+    values[field] = fromZigzag(
+        ones ? topBit | middleBits | field : topBit | 0x40 | field);
+  }
+  return values;
+}
+
+// Set patched fields present in `packet`
+void
+setFields(thrift::SparkHelloPacket& packet, FieldValues const& values) {
+  packet.payload.seqNum = values[SparkHelloTemplate::PAYLOAD_SEQ_NUM];
+  packet.payload.timestamp = values[SparkHelloTemplate::PAYLOAD_TIMESTAMP];
+  if (not packet.helloMsg.hasValue()) {
+    return;
+  }
+  auto& helloMsg = packet.helloMsg.value();
+  helloMsg.seqNum = values[SparkHelloTemplate::HELLO_SEQ_NUM];
+  helloMsg.sentTsInUs = values[SparkHelloTemplate::HELLO_SENT_TS];
+  if (helloMsg.prevSentTsInUs.hasValue()) {
+    helloMsg.prevSentTsInUs = values[SparkHelloTemplate::HELLO_PREV_SENT_TS];
+  }
+  if (helloMsg.prevKernelSentTsInUs.hasValue()) {
+    helloMsg.prevKernelSentTsInUs =
+        values[SparkHelloTemplate::HELLO_PREV_KERNEL_SENT_TS];
+  }
+}
+
+size_t
+getNumFields(thrift::SparkHelloPacket const& packet) {
+  if (not packet.helloMsg.hasValue()) {
+    return 2;
+  }
+  auto const& helloMsg = packet.helloMsg.value();
+  return 4 + (helloMsg.prevSentTsInUs.hasValue() ? 1 : 0) +
+      (helloMsg.prevKernelSentTsInUs.hasValue() ? 1 : 0);
+}
+
+} // namespace
+
+SparkHelloTemplate::SparkHelloTemplate(thrift::SparkHelloPacket const& packet) {
+  // Serialize packet with two sets of placeholders, patched fields are
+  // where serialized packets differ
+  const auto placeholders = getPlaceholders(true);
+  auto placeholderPacket = packet;
+  setFields(placeholderPacket, placeholders);
+  data_ = apache::thrift::CompactSerializer::serialize<std::string>(
+      placeholderPacket);
+  setFields(placeholderPacket, getPlaceholders(false));
+  const auto otherData =
+      apache::thrift::CompactSerializer::serialize<std::string>(
+          placeholderPacket);
+  CHECK_EQ(data_.size(), otherData.size());
+
+  size_t numFields{0};
+  char expected[kVarintSize];
+  for (size_t i = 0; i < data_.size(); ++i) {
+    if (data_[i] == otherData[i]) {
+      continue;
+    }
+    const auto field = static_cast<uint8_t>(data_[i]) & 0x7f;
+    CHECK_LT(field, NUM_FIELDS);
+    CHECK_EQ(0, offsets_[field]);
+    CHECK_LE(i + kVarintSize, data_.size());
+    writeFixedVarint(expected, placeholders[field]);
+    CHECK_EQ(0, data_.compare(i, kVarintSize, expected, kVarintSize));
+    offsets_[field] = i;
+    ++numFields;
+    i += kVarintSize - 1;
+  }
+  CHECK_EQ(getNumFields(packet), numFields);
+}
+
+std::string
+SparkHelloTemplate::serialize(
+    int64_t seqNum,
+    int64_t prevSentTsInUs,
+    int64_t prevKernelSentTsInUs,
+    TimestampOffsets& timestampOffsets) const {
+  std::string data(data_);
+  FieldValues values{};
+  values[PAYLOAD_SEQ_NUM] = seqNum;
+  values[HELLO_SEQ_NUM] = seqNum;
+  values[HELLO_PREV_SENT_TS] = prevSentTsInUs;
+  values[HELLO_PREV_KERNEL_SENT_TS] = prevKernelSentTsInUs;
+  for (const auto field :
+       {PAYLOAD_SEQ_NUM,
+        HELLO_SEQ_NUM,
+        HELLO_PREV_SENT_TS,
+        HELLO_PREV_KERNEL_SENT_TS}) {
+    if (offsets_[field] != 0) {
+      writeFixedVarint(&data[offsets_[field]], values[field]);
+    }
+  }
+  timestampOffsets = {offsets_[PAYLOAD_TIMESTAMP], offsets_[HELLO_SENT_TS]};
+  return data;
+}
+
+void
+SparkHelloTemplate::stampTimestamps(
+    std::string& data,
+    TimestampOffsets const& timestampOffsets,
+    int64_t tsInUs) {
+  for (const auto offset : timestampOffsets) {
+    if (offset == 0) {
+      continue;
+    }
+    CHECK_LE(offset + kVarintSize, data.size());
+    writeFixedVarint(&data[offset], tsInUs);
+  }
+}
+
+} // namespace openr
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+
+#include <openr/if/gen-cpp2/Spark_types.h>
+
+namespace openr {
+
+/**
+ * Hello packet sent on one interface, serialized with thrift compact
+ * protocol once and reused for every hello sent until it gets rebuilt.
+ *
+ * Only integer fields changing from hello to hello (sequence numbers and
+ * timestamps) are patched into copy of serialized packet. They are
+ * serialized as longest possible varints, so any value fits in their slot.
+ * Everything else, reflected neighbor infos included, is fixed once template
+ * is built, which is what caller rebuilds it for.
+ *
+ * Timestamps (payload.timestamp and helloMsg.sentTsInUs) are left to be
+ * stamped into serialized packet right before it gets sent out.
+ */
+class SparkHelloTemplate final {
+ public:
+  // Fields patched per hello
+  enum Field {
+    PAYLOAD_SEQ_NUM = 0,
+    PAYLOAD_TIMESTAMP = 1,
+    HELLO_SEQ_NUM = 2,
+    HELLO_SENT_TS = 3,
+    HELLO_PREV_SENT_TS = 4,
+    HELLO_PREV_KERNEL_SENT_TS = 5,
+    NUM_FIELDS = 6,
+  };
+
+  // Offsets of timestamps within serialized packet, 0 if not present
+  using TimestampOffsets = std::array<size_t, 2>;
+
+  // Optional fields patched per hello (helloMsg and previous hello
+  // timestamps) are present in every packet if they are in `packet`
+  explicit SparkHelloTemplate(thrift::SparkHelloPacket const& packet);
+
+  // Serialized packet with given sequence number and previous hello
+  // timestamps, current timestamps are left to stampTimestamps()
+  std::string serialize(
+      int64_t seqNum,
+      int64_t prevSentTsInUs,
+      int64_t prevKernelSentTsInUs,
+      TimestampOffsets& timestampOffsets) const;
+
+  // Size of serialized packet
+  size_t
+  size() const {
+    return data_.size();
+  }
+
+  // Write `tsInUs` into timestamps of serialized packet
+  static void stampTimestamps(
+      std::string& data,
+      TimestampOffsets const& timestampOffsets,
+      int64_t tsInUs);
+
+ private:
+  // Packet serialized with placeholders in patched fields
+  std::string data_;
+
+  // Offsets of patched fields within `data_`, 0 if not present
+  std::array<size_t, NUM_FIELDS> offsets_{};
+};
+
+} // namespace openr
@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/spark/SparkLiveness.h>
+
+#include <cstring>
+
+#include <folly/Random.h>
+#include <folly/lang/Bits.h>
+#include <glog/logging.h>
+
+namespace openr {
+
+namespace {
+
+void
+writeU32(uint8_t* buf, uint32_t value) {
+  const auto netValue = folly::Endian::big(value);
+  std::memcpy(buf, &netValue, sizeof(netValue));
+}
+
+uint32_t
+readU32(const uint8_t* buf) {
+  uint32_t netValue;
+  std::memcpy(&netValue, buf, sizeof(netValue));
+  return folly::Endian::big(netValue);
+}
+
+} // namespace
+
+constexpr size_t LivenessPacket::kSize;
+constexpr uint32_t LivenessPacket::kMagic;
+constexpr uint8_t LivenessPacket::kVersion;
+constexpr std::chrono::milliseconds LivenessSession::kSlowTxInterval;
+
+std::string
+LivenessPacket::encode() const {
+  std::string packet(kSize, '\0');
+  auto buf = reinterpret_cast<uint8_t*>(&packet[0]);
+  writeU32(buf, kMagic);
+  buf[4] = kVersion;
+  buf[5] = static_cast<uint8_t>(state);
+  buf[6] = detectMultiplier;
+  buf[7] = 0;
+  writeU32(buf + 8, myDiscriminator);
+  writeU32(buf + 12, yourDiscriminator);
+  writeU32(buf + 16, txIntervalUs);
+  writeU32(buf + 20, minRxIntervalUs);
+  return packet;
+}
+
+bool
+LivenessPacket::isLivenessPacket(folly::ByteRange data) {
+  return data.size() == kSize and readU32(data.data()) == kMagic;
+}
+
+folly::Optional<LivenessPacket>
+LivenessPacket::decode(folly::ByteRange data) {
+  if (not isLivenessPacket(data) or data[4] != kVersion) {
+    return folly::none;
+  }
+
+  LivenessPacket packet;
+  const auto state = data[5];
+  if (state < static_cast<uint8_t>(LivenessState::DOWN) or
+      state > static_cast<uint8_t>(LivenessState::UP)) {
+    return folly::none;
+  }
+  packet.state = static_cast<LivenessState>(state);
+  packet.detectMultiplier = data[6];
+  packet.myDiscriminator = readU32(data.data() + 8);
+  packet.yourDiscriminator = readU32(data.data() + 12);
+  packet.txIntervalUs = readU32(data.data() + 16);
+  packet.minRxIntervalUs = readU32(data.data() + 20);
+
+  // RFC 5880 6.8.6: discard packets with zero multiplier or discriminator
+  if (packet.detectMultiplier == 0 or packet.myDiscriminator == 0) {
+    return folly::none;
+  }
+  return packet;
+}
+
+LivenessSession::LivenessSession(
+    TimerWheel* wheel,
+    uint32_t myDiscriminator,
+    std::chrono::milliseconds txInterval,
+    uint8_t detectMultiplier,
+    SendCallback sendCb,
+    DownCallback downCb)
+    : myDiscriminator_(myDiscriminator),
+      txInterval_(txInterval),
+      detectMultiplier_(detectMultiplier),
+      sendCb_(std::move(sendCb)),
+      downCb_(std::move(downCb)) {
+  CHECK_NE(0, myDiscriminator_);
+  CHECK_GT(txInterval_.count(), 0);
+  CHECK_GT(detectMultiplier_, 0);
+
+  txTimer_ = TimerWheel::Timeout::make(wheel, [this]() noexcept {
+    sendPacket();
+    scheduleTx();
+  });
+  detectTimer_ = TimerWheel::Timeout::make(
+      wheel, [this]() noexcept { processDetectionTimeout(); });
+
+  // first packet goes out after a jittered interval so that sessions created
+  // at same time don't send in lock step
+  scheduleTx();
+}
+
+std::chrono::milliseconds
+LivenessSession::getDetectionTime() const {
+  // Neighbor sends no faster than we agree to receive
+  const auto rxInterval = std::max<std::chrono::microseconds>(
+      txInterval_, remoteTxInterval_);
+  return std::chrono::ceil<std::chrono::milliseconds>(
+      remoteDetectMultiplier_ * rxInterval);
+}
+
+void
+LivenessSession::processPacket(LivenessPacket const& packet) {
+  // Learn neighbor's discriminator and parameters
+  yourDiscriminator_ = packet.myDiscriminator;
+  remoteTxInterval_ = std::chrono::microseconds(packet.txIntervalUs);
+  remoteMinRxInterval_ = std::chrono::microseconds(packet.minRxIntervalUs);
+  remoteDetectMultiplier_ = packet.detectMultiplier;
+
+  // RFC 5880 6.8.6 state machine
+  const auto oldState = state_;
+  bool neighborDown{false};
+  switch (state_) {
+  case LivenessState::DOWN:
+    if (packet.state == LivenessState::DOWN) {
+      state_ = LivenessState::INIT;
+    } else if (packet.state == LivenessState::INIT) {
+      state_ = LivenessState::UP;
+    }
+    break;
+  case LivenessState::INIT:
+    if (packet.state == LivenessState::INIT or
+        packet.state == LivenessState::UP) {
+      state_ = LivenessState::UP;
+    }
+    break;
+  case LivenessState::UP:
+    if (packet.state == LivenessState::DOWN) {
+      state_ = LivenessState::DOWN;
+      neighborDown = true;
+    }
+    break;
+  }
+
+  if (state_ == LivenessState::DOWN) {
+    detectTimer_->cancelTimeout();
+  } else {
+    detectTimer_->scheduleTimeout(getDetectionTime());
+  }
+
+  if (state_ != oldState) {
+    VLOG(2) << "Liveness session " << myDiscriminator_ << " moved from state "
+            << static_cast<int>(oldState) << " to "
+            << static_cast<int>(state_);
+    // let neighbor know about state change right away, and switch between
+    // slow and fast transmission
+    sendPacket();
+    scheduleTx();
+  }
+
+  if (neighborDown) {
+    LOG(INFO) << "Liveness session " << myDiscriminator_
+              << " is reported DOWN by neighbor";
+    downCb_();
+  }
+}
+
+void
+LivenessSession::sendPacket() {
+  LivenessPacket packet;
+  packet.state = state_;
+  packet.detectMultiplier = detectMultiplier_;
+  packet.myDiscriminator = myDiscriminator_;
+  packet.yourDiscriminator = yourDiscriminator_;
+  packet.txIntervalUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(txInterval_)
+          .count();
+  packet.minRxIntervalUs = packet.txIntervalUs;
+  sendCb_(packet.encode());
+}
+
+void
+LivenessSession::scheduleTx() {
+  // Send no faster than neighbor wants to receive, and slowly until UP
+  auto interval = std::max<std::chrono::microseconds>(
+      txInterval_, remoteMinRxInterval_);
+  if (state_ != LivenessState::UP) {
+    interval = std::max<std::chrono::microseconds>(interval, kSlowTxInterval);
+  }
+  const auto intervalMs =
+      std::chrono::ceil<std::chrono::milliseconds>(interval).count();
+  const auto jitter = folly::Random::rand32(intervalMs / 4 + 1);
+  txTimer_->scheduleTimeout(std::chrono::milliseconds(intervalMs - jitter));
+}
+
+void
+LivenessSession::processDetectionTimeout() {
+  const auto oldState = state_;
+  state_ = LivenessState::DOWN;
+  yourDiscriminator_ = 0;
+  remoteMinRxInterval_ = std::chrono::microseconds(0);
+  scheduleTx();
+
+  if (oldState == LivenessState::UP) {
+    LOG(INFO) << "Liveness session " << myDiscriminator_
+              << " detection time of " << getDetectionTime().count()
+              << "ms expired";
+    downCb_();
+  }
+}
+
+} // namespace openr
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+
+#include <openr/common/TimerWheel.h>
+
+namespace openr {
+
+enum class LivenessState : uint8_t {
+  DOWN = 1,
+  INIT = 2,
+  UP = 3,
+};
+
+/**
+ * Fixed size liveness packet, modelled on BFD control packet (RFC 5880).
+ * Encoded in network byte order as
+ *
+ *   magic(4) version(1) state(1) detectMultiplier(1) reserved(1)
+ *   myDiscriminator(4) yourDiscriminator(4) txIntervalUs(4) minRxIntervalUs(4)
+ *
+ * Liveness packets share socket with Spark hello packets and are told apart
+ * by their size and magic.
+ */
+struct LivenessPacket {
+  LivenessState state{LivenessState::DOWN};
+  uint8_t detectMultiplier{0};
+  uint32_t myDiscriminator{0};
+  uint32_t yourDiscriminator{0};
+  // interval at which sender transmits packets
+  uint32_t txIntervalUs{0};
+  // minimum interval at which sender wants to receive packets
+  uint32_t minRxIntervalUs{0};
+
+  static constexpr size_t kSize{24};
+  static constexpr uint32_t kMagic{0x53504c56}; // "SPLV"
+  static constexpr uint8_t kVersion{1};
+
+  std::string encode() const;
+
+  // Returns none if data is not a valid liveness packet
+  static folly::Optional<LivenessPacket> decode(folly::ByteRange data);
+
+  // Cheap check whether received data is meant to be a liveness packet
+  static bool isLivenessPacket(folly::ByteRange data);
+};
+
+/**
+ * Asynchronous liveness session with a single neighbor, BFD style.
+ *
+ * Both ends periodically send fixed size packets carrying their session
+ * state. Session comes UP with a three way handshake (DOWN -> INIT -> UP)
+ * and once UP, it is declared DOWN if no packet is received within detection
+ * time (`detectMultiplier` times the negotiated receive interval) or if
+ * neighbor reports its session DOWN. `downCb` is invoked in both cases.
+ *
+ * Session which never came UP (e.g. neighbor doesn't run liveness detection)
+ * never invokes `downCb`, hence it is safe to run it against any neighbor.
+ *
+ * NOTE: `downCb` is always invoked last and may destroy the session.
+ */
+class LivenessSession final {
+ public:
+  using SendCallback = std::function<void(std::string packet)>;
+  using DownCallback = std::function<void()>;
+
+  LivenessSession(
+      TimerWheel* wheel,
+      uint32_t myDiscriminator,
+      std::chrono::milliseconds txInterval,
+      uint8_t detectMultiplier,
+      SendCallback sendCb,
+      DownCallback downCb);
+
+  LivenessSession(LivenessSession const&) = delete;
+  LivenessSession& operator=(LivenessSession const&) = delete;
+
+  // Process packet received from neighbor of this session
+  void processPacket(LivenessPacket const& packet);
+
+  LivenessState
+  getState() const {
+    return state_;
+  }
+
+  uint32_t
+  getMyDiscriminator() const {
+    return myDiscriminator_;
+  }
+
+  uint32_t
+  getYourDiscriminator() const {
+    return yourDiscriminator_;
+  }
+
+  // Time without packets from neighbor after which session goes DOWN
+  std::chrono::milliseconds getDetectionTime() const;
+
+  // Packets are sent at slow rate while session isn't UP
+  static constexpr std::chrono::milliseconds kSlowTxInterval{1000};
+
+ private:
+  void sendPacket();
+
+  // Schedule next packet with up to 25% jitter below interval
+  void scheduleTx();
+
+  void processDetectionTimeout();
+
+  const uint32_t myDiscriminator_{0};
+  const std::chrono::milliseconds txInterval_;
+  const uint8_t detectMultiplier_{0};
+  const SendCallback sendCb_;
+  const DownCallback downCb_;
+
+  LivenessState state_{LivenessState::DOWN};
+  uint32_t yourDiscriminator_{0};
+
+  // Parameters last advertised by neighbor
+  std::chrono::microseconds remoteTxInterval_{0};
+  std::chrono::microseconds remoteMinRxInterval_{0};
+  uint8_t remoteDetectMultiplier_{0};
+
+  std::unique_ptr<TimerWheel::Timeout> txTimer_;
+  std::unique_ptr<TimerWheel::Timeout> detectTimer_;
+};
+
+} // namespace openr
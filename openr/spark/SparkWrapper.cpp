@@ -7,6 +7,11 @@
 
 #include "SparkWrapper.h"
 
+#include <pthread.h>
+#include <time.h>
+
+#include <folly/Exception.h>
+
 using namespace fbzmq;
 
 namespace openr {
@@ -62,7 +67,8 @@ SparkWrapper::SparkWrapper(
       true,
       enableSpark2,
       increaseHelloInterval,
-      areas);
+      areas,
+      timeConfig.myLivenessTime);
 
   // start spark
   run();
@@ -186,4 +192,27 @@ SparkWrapper::getSparkNeighState(
   return spark_->getSparkNeighState(ifName, neighborName);
 }
 
+std::chrono::nanoseconds
+SparkWrapper::getCpuTime() const {
+  clockid_t clockId;
+  folly::checkPosixError(
+      pthread_getcpuclockid(thread_->native_handle(), &clockId),
+      "pthread_getcpuclockid failed");
+  struct timespec ts;
+  folly::checkUnixError(clock_gettime(clockId, &ts), "clock_gettime failed");
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+std::unordered_map<std::string, int64_t>
+SparkWrapper::getCounters() const {
+  return spark_->getCounters();
+}
+
+int64_t
+SparkWrapper::getNumHellosSent() const {
+  const auto counters = getCounters();
+  const auto it = counters.find("spark.hello.packets_sent.sum.0");
+  return it != counters.end() ? it->second : 0;
+}
+
 } // namespace openr
@@ -29,13 +29,15 @@ struct SparkTimeConfig {
       std::chrono::milliseconds negotiateHoldTime =
           std::chrono::milliseconds{0},
       std::chrono::milliseconds heartbeatHoldTime =
-          std::chrono::milliseconds{0})
+          std::chrono::milliseconds{0},
+      std::chrono::milliseconds livenessTime = std::chrono::milliseconds{0})
       : myHelloTime(helloTime),
         myHelloFastInitTime(helloFastInitTime),
         myHandshakeTime(handshakeTime),
         myHeartbeatTime(heartbeatTime),
         myNegotiateHoldTime(negotiateHoldTime),
-        myHeartbeatHoldTime(heartbeatHoldTime) {}
+        myHeartbeatHoldTime(heartbeatHoldTime),
+        myLivenessTime(livenessTime) {}
 
   std::chrono::milliseconds myHelloTime;
   std::chrono::milliseconds myHelloFastInitTime;
@@ -43,6 +45,8 @@ struct SparkTimeConfig {
   std::chrono::milliseconds myHeartbeatTime;
   std::chrono::milliseconds myNegotiateHoldTime;
   std::chrono::milliseconds myHeartbeatHoldTime;
+  // 0 disables liveness detection
+  std::chrono::milliseconds myLivenessTime;
 };
 
 /**
@@ -103,6 +107,15 @@ class SparkWrapper {
   static std::pair<folly::IPAddress, folly::IPAddress> getTransportAddrs(
       const thrift::SparkNeighborEvent& event);
 
+  // CPU time consumed by Spark thread so far
+  std::chrono::nanoseconds getCpuTime() const;
+
+  // counters tracked by Spark so far
+  std::unordered_map<std::string, int64_t> getCounters() const;
+
+  // number of hello packets Spark sent so far
+  int64_t getNumHellosSent() const;
+
   //
   // Private state
   //
@@ -7,6 +7,8 @@
 
 #include "MockIoProvider.h"
 
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
 #include <unistd.h>
 #include <cerrno>
 #include <chrono>
@@ -14,6 +16,7 @@
 #include <glog/logging.h>
 
 #include <folly/Exception.h>
+#include <folly/Random.h>
 #include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 
@@ -35,6 +38,20 @@ MockIoProvider::setConnectedPairs(ConnectedIfPairs connectedIfPairs) {
   connectedIfPairs_ = std::move(connectedIfPairs);
 }
 
+void
+MockIoProvider::setPacketLossRate(double lossRate) {
+  CHECK(lossRate >= 0 && lossRate <= 1) << "Invalid loss rate " << lossRate;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  lossRate_ = lossRate;
+}
+
+void
+MockIoProvider::setTxTimestampSkew(std::chrono::microseconds skew) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  txTimestampSkew_ = skew;
+}
+
 int
 MockIoProvider::socket(int /* domain */, int /* type */, int /* protocol */) {
   VLOG(4) << "MockIoProvider::socket called";
@@ -71,7 +88,11 @@ MockIoProvider::bind(
 }
 
 ssize_t
-MockIoProvider::recvmsg(int sockFd, struct msghdr* msg, int /* flags */) {
+MockIoProvider::recvmsg(int sockFd, struct msghdr* msg, int flags) {
+  if (flags & MSG_ERRQUEUE) {
+    return recvTxTimestamp(sockFd, msg);
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
 
   SCOPE_FAIL {
@@ -103,6 +124,7 @@ MockIoProvider::recvmsg(int sockFd, struct msghdr* msg, int /* flags */) {
 
   // discard message from queue
   it->second.pop_front();
+  numPacketsReceived_.fetch_add(1, std::memory_order_relaxed);
 
   // deliver the address
   sockaddr_storage addrStorage;
@@ -169,6 +191,108 @@ MockIoProvider::recvmsg(int sockFd, struct msghdr* msg, int /* flags */) {
   return packet.size();
 }
 
+ssize_t
+MockIoProvider::recvTxTimestamp(int sockFd, struct msghdr* msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = txTimestamping_.find(sockFd);
+  if (it == txTimestamping_.end() || it->second.errQueue.empty()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  const auto txTimestamp = it->second.errQueue.front();
+  it->second.errQueue.pop_front();
+
+  // timestamp and packet id come in control messages only, payload is not
+  // looped back (SOF_TIMESTAMPING_OPT_TSONLY)
+  CHECK_GE(
+      msg->msg_controllen,
+      CMSG_SPACE(sizeof(struct scm_timestamping)) +
+          CMSG_SPACE(sizeof(struct sock_extended_err)));
+  msg->msg_controllen = CMSG_SPACE(sizeof(struct scm_timestamping)) +
+      CMSG_SPACE(sizeof(struct sock_extended_err));
+  msg->msg_flags = MSG_ERRQUEUE;
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg);
+  CHECK(cmsg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_TIMESTAMPING;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct scm_timestamping));
+  struct scm_timestamping tss;
+  ::memset(&tss, 0, sizeof(tss));
+  const auto sec =
+      std::chrono::duration_cast<std::chrono::seconds>(txTimestamp.txTs);
+  tss.ts[0].tv_sec = sec.count();
+  tss.ts[0].tv_nsec =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          txTimestamp.txTs - sec)
+          .count();
+  ::memcpy(CMSG_DATA(cmsg), &tss, sizeof(tss));
+
+  cmsg = CMSG_NXTHDR(msg, cmsg);
+  CHECK(cmsg);
+  cmsg->cmsg_level = IPPROTO_IPV6;
+  cmsg->cmsg_type = IPV6_RECVERR;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct sock_extended_err));
+  struct sock_extended_err err;
+  ::memset(&err, 0, sizeof(err));
+  err.ee_errno = ENOMSG;
+  err.ee_origin = SO_EE_ORIGIN_TIMESTAMPING;
+  err.ee_data = txTimestamp.id;
+  ::memcpy(CMSG_DATA(cmsg), &err, sizeof(err));
+
+  return 0;
+}
+
+int
+MockIoProvider::recvmmsg(
+    int sockFd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  VLOG(4) << "MockIoProvider::recvmmsg called ";
+
+  // Deliver messages one by one same as recvmsg does. After first one only
+  // deliver messages that are due, as real socket would
+  unsigned int numMsgs = 0;
+  for (; numMsgs < vlen; ++numMsgs) {
+    if (numMsgs > 0 && !hasActiveMessage(sockFd)) {
+      break;
+    }
+    auto bytesRead = recvmsg(sockFd, &msgvec[numMsgs].msg_hdr, flags);
+    if (bytesRead < 0) {
+      break;
+    }
+    msgvec[numMsgs].msg_len = bytesRead;
+  }
+
+  if (numMsgs == 0) {
+    errno = EAGAIN;
+    return -1;
+  }
+  return numMsgs;
+}
+
+int
+MockIoProvider::sendmmsg(
+    int sockFd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  VLOG(4) << "MockIoProvider::sendmmsg called ";
+
+  for (unsigned int i = 0; i < vlen; ++i) {
+    auto bytesSent = sendmsg(sockFd, &msgvec[i].msg_hdr, flags);
+    if (bytesSent < 0) {
+      return i > 0 ? i : -1;
+    }
+    msgvec[i].msg_len = bytesSent;
+  }
+  return vlen;
+}
+
+bool
+MockIoProvider::hasActiveMessage(int sockFd) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = mailboxes_.find(sockFd);
+  return it != mailboxes_.end() && !it->second.empty() &&
+      it->second.front().isActive();
+}
+
 ssize_t
 MockIoProvider::sendmsg(int sockFd, const struct msghdr* msg, int /* flags */) {
   VLOG(4) << "MockIoProvider::sendmsg called";
@@ -201,6 +325,7 @@ MockIoProvider::sendmsg(int sockFd, const struct msghdr* msg, int /* flags */) {
   auto srcIfName = ifIndexToIfName_.at(srcIfIndex);
 
   VLOG(4) << "MockIoProvider::sendmsg sending message from iface " << srcIfName;
+  numPacketsSent_.fetch_add(1, std::memory_order_relaxed);
 
   // walk over all connected interfaces
   bool sent = false;
@@ -231,6 +356,12 @@ MockIoProvider::sendmsg(int sockFd, const struct msghdr* msg, int /* flags */) {
       LOG(WARNING) << "Src and dst fd is the same. Pkt looped";
     }
 
+    // packet is lost on the wire, sender can't tell
+    sent = true;
+    if (lossRate_ > 0 && folly::Random::randDouble01() < lossRate_) {
+      continue;
+    }
+
     auto& msgQueue = mailboxes_[otherFd];
 
     // copy the data from iov
@@ -243,24 +374,35 @@ MockIoProvider::sendmsg(int sockFd, const struct msghdr* msg, int /* flags */) {
         srcAddr,
         std::move(packet),
         std::chrono::milliseconds(latency));
+  }
 
-    sent = true;
+  if (!sent) {
+    return -1;
   }
 
-  // return the length of single vector sent
-  if (sent) {
-    return msg->msg_iov->iov_len;
+  // loop back kernel TX timestamp of packet, numbered if asked for
+  auto txIt = txTimestamping_.find(sockFd);
+  if (txIt != txTimestamping_.end() && txIt->second.enabled) {
+    auto& txTimestamping = txIt->second;
+    const auto txTs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    txTimestamping.errQueue.emplace_back(TxTimestamp{
+        txTimestamping.withId ? txTimestamping.nextId++ : 0,
+        txTs + txTimestampSkew_});
   }
-  return -1;
+
+  // return the length of single vector sent
+  return msg->msg_iov->iov_len;
 }
 
 //
-// Simply accept all setsockopts, and build fd to ifName mapping
+// Simply accept all setsockopts, build fd to ifName mapping and track kernel
+// TX timestamping settings
 //
 int
 MockIoProvider::setsockopt(
     int sockFd,
-    int /* level */,
+    int level,
     int optname,
     const void* optval,
     socklen_t /* optlen */) {
@@ -284,6 +426,19 @@ MockIoProvider::setsockopt(
     fdToIfName_[sockFd] = ifName;
   }
 
+  // kernel restarts numbering of sent packets whenever OPT_ID gets enabled
+  if (level == SOL_SOCKET && optname == SO_TIMESTAMPING) {
+    const int flags = *static_cast<const int*>(optval);
+    auto& txTimestamping = txTimestamping_[sockFd];
+    const bool withId = flags & SOF_TIMESTAMPING_OPT_ID;
+    if (withId && !txTimestamping.withId) {
+      txTimestamping.nextId = 0;
+      numTxTimestampIdResets_.fetch_add(1, std::memory_order_relaxed);
+    }
+    txTimestamping.withId = withId;
+    txTimestamping.enabled = flags & SOF_TIMESTAMPING_TX_SOFTWARE;
+  }
+
   return 0;
 }
 
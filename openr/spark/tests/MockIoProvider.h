@@ -9,6 +9,7 @@
 
 #include <openr/spark/IoProvider.h>
 
+#include <deque>
 #include <list>
 #include <map>
 #include <mutex>
@@ -83,6 +84,32 @@ class MockIoProvider final : public IoProvider {
   // packet sent off of x will be delivered to y, z
   void setConnectedPairs(ConnectedIfPairs connectedIfPairs);
 
+  // probability with which a packet is dropped on each connected interface
+  // it is sent to. 0 (default) means no loss
+  void setPacketLossRate(double lossRate);
+
+  // number of packets sent by and delivered to sparks so far
+  uint64_t
+  getNumPacketsSent() const {
+    return numPacketsSent_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getNumPacketsReceived() const {
+    return numPacketsReceived_.load(std::memory_order_relaxed);
+  }
+
+  // offset added to kernel TX timestamps looped back for sent packets. Big
+  // enough offset emulates timestamps getting matched to wrong packets
+  void setTxTimestampSkew(std::chrono::microseconds skew);
+
+  // number of times sockets restarted numbering of sent packets, i.e.
+  // SOF_TIMESTAMPING_OPT_ID got enabled on them
+  uint64_t
+  getNumTxTimestampIdResets() const {
+    return numTxTimestampIdResets_.load(std::memory_order_relaxed);
+  }
+
   //
   // The usual IO jazz
   //
@@ -98,6 +125,18 @@ class MockIoProvider final : public IoProvider {
 
   ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags) override;
 
+  int recvmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags) override;
+
+  int sendmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags) override;
+
   int setsockopt(
       int sockfd,
       int level,
@@ -111,6 +150,12 @@ class MockIoProvider final : public IoProvider {
   void addIfNameIfIndex(const IfNameAndifIndex& entries);
 
  private:
+  // recvmsg() off socket error queue, which only holds TX timestamps
+  ssize_t recvTxTimestamp(int sockFd, struct msghdr* msg);
+
+  // Is first message in mailbox of fd ready to be delivered
+  bool hasActiveMessage(int fd);
+
   // Boolean to keep track of running-state of MockIoProvider
   std::atomic<bool> isRunning_{false};
 
@@ -119,6 +164,23 @@ class MockIoProvider final : public IoProvider {
 
   ConnectedIfPairs connectedIfPairs_{};
 
+  double lossRate_{0};
+
+  std::atomic<uint64_t> numPacketsSent_{0};
+  std::atomic<uint64_t> numPacketsReceived_{0};
+
+  // kernel TX timestamping emulation. Timestamps of sent packets are queued
+  // on error queue of socket along with packet id, if enabled for socket
+  struct TxTimestamping {
+    bool enabled{false};
+    bool withId{false};
+    uint32_t nextId{0};
+    std::deque<TxTimestamp> errQueue;
+  };
+  std::map<int /* fd */, TxTimestamping> txTimestamping_;
+  std::chrono::microseconds txTimestampSkew_{0};
+  std::atomic<uint64_t> numTxTimestampIdResets_{0};
+
   // Map of send/recv fds. All fds used below belong to recv-fd which is being
   // polled by Spark (or returned to spark).
   std::map<int /* recv-fd */, int /* send-fd */> pipeFds_;
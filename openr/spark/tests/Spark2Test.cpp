@@ -77,6 +77,35 @@ const std::chrono::milliseconds kNegotiateHoldTime(500);
 
 // the hold time for spark2 heartbeat msg
 const std::chrono::milliseconds kHeartbeatHoldTime(200);
+
+// counters of RTT samples corrected by kernel TX timestamp and of kernel TX
+// timestamps not matching hellos they were reported for
+const std::string kRttKernelCorrected("spark.rtt_kernel_corrected.sum.0");
+const std::string kTxTimestampMismatch("spark.tx_timestamp_mismatch.count.0");
+
+int64_t
+getCounter(SparkWrapper& spark, std::string const& name) {
+  const auto counters = spark.getCounters();
+  const auto it = counters.find(name);
+  return it != counters.end() ? it->second : 0;
+}
+
+// wait until counter of spark reaches `value`
+bool
+waitForCounter(
+    SparkWrapper& spark,
+    std::string const& name,
+    int64_t value,
+    std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (getCounter(spark, name) < value) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
 }; // namespace
 
 class Spark2Fixture : public testing::Test {
@@ -673,6 +702,82 @@ TEST_F(Spark2Fixture, LoopedHelloPktTest) {
   }
 }
 
+TEST_F(SimpleSpark2Fixture, TxTimestampTest) {
+  SCOPE_EXIT {
+    LOG(INFO) << "Spark2Fixture TxTimestampTest finished";
+  };
+
+  // create Spark2 instances and establish connections
+  createAndConnectSpark2Nodes();
+
+  // hellos report kernel TX timestamp of previous hello, which neighbor
+  // corrects its RTT sample with
+  EXPECT_TRUE(waitForCounter(*node1, kRttKernelCorrected, 1));
+  EXPECT_TRUE(waitForCounter(*node2, kRttKernelCorrected, 1));
+  EXPECT_EQ(0, getCounter(*node1, kTxTimestampMismatch));
+  EXPECT_EQ(0, getCounter(*node2, kTxTimestampMismatch));
+
+  // timestamps which can't belong to packets they are reported for make
+  // sparks restart numbering of sent packets
+  const auto numIdResets = mockIoProvider->getNumTxTimestampIdResets();
+  mockIoProvider->setTxTimestampSkew(std::chrono::seconds(-10));
+  EXPECT_TRUE(waitForCounter(*node1, kTxTimestampMismatch, 1));
+  EXPECT_TRUE(waitForCounter(*node2, kTxTimestampMismatch, 1));
+  EXPECT_LT(numIdResets, mockIoProvider->getNumTxTimestampIdResets());
+
+  // once timestamps are sane again numbering is back in sync, RTT samples
+  // get corrected and no more timestamps are mismatched
+  mockIoProvider->setTxTimestampSkew(std::chrono::microseconds(0));
+  auto numCorrected = getCounter(*node1, kRttKernelCorrected);
+  EXPECT_TRUE(waitForCounter(*node1, kRttKernelCorrected, numCorrected + 3));
+  const auto numMismatches = getCounter(*node1, kTxTimestampMismatch);
+  numCorrected = getCounter(*node1, kRttKernelCorrected);
+  EXPECT_TRUE(waitForCounter(*node1, kRttKernelCorrected, numCorrected + 3));
+  EXPECT_EQ(numMismatches, getCounter(*node1, kTxTimestampMismatch));
+}
+
+TEST_F(SimpleSpark2Fixture, RttWithoutTxTimestampTest) {
+  SCOPE_EXIT {
+    LOG(INFO) << "Spark2Fixture RttWithoutTxTimestampTest finished";
+  };
+
+  // create Spark2 instances and establish connections
+  createAndConnectSpark2Nodes();
+  EXPECT_TRUE(waitForCounter(*node1, kRttKernelCorrected, 1));
+  EXPECT_TRUE(waitForCounter(*node2, kRttKernelCorrected, 1));
+
+  // kernel TX timestamps stop matching, hence hellos keep reporting kernel
+  // timestamp of some older hello. RTT samples are taken uncorrected
+  mockIoProvider->setTxTimestampSkew(std::chrono::seconds(-10));
+
+  LOG(INFO) << "Change rtt between nodes to 40ms (asymmetric)";
+
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 15}}},
+      {iface2, {{iface1, 25}}},
+  };
+  mockIoProvider->setConnectedPairs(connectedPairs);
+
+  // wait for spark nodes to detecct Rtt change
+  {
+    auto event = node1->waitForEvent(
+        thrift::SparkNeighborEventType::NEIGHBOR_RTT_CHANGE);
+    ASSERT_TRUE(event.hasValue());
+    // 25% tolerance
+    EXPECT_GE(event->rttUs, (40 - 10) * 1000);
+    EXPECT_LE(event->rttUs, (40 + 10) * 1000);
+  }
+
+  {
+    auto event = node2->waitForEvent(
+        thrift::SparkNeighborEventType::NEIGHBOR_RTT_CHANGE);
+    ASSERT_TRUE(event.hasValue());
+    // 25% tolerance
+    EXPECT_GE(event->rttUs, (40 - 10) * 1000);
+    EXPECT_LE(event->rttUs, (40 + 10) * 1000);
+  }
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -0,0 +1,318 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <thread>
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <openr/spark/tests/SparkSimulator.h>
+
+/**
+ * Defines a benchmark that allows users to record customized counter during
+ * benchmarking and passes a parameter to another one. This is common for
+ * benchmarks that need a "problem size" in addition to "number of iterations".
+ */
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FB_STRINGIZE(name) "(" FB_STRINGIZE(param_name) ")",             \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
+DEFINE_string(
+    sim_topology,
+    "star",
+    "Topology to simulate. `star` emulates a single box with one port per "
+    "neighbor, `ring` a chain of boxes with two ports each");
+DEFINE_int32(sim_link_latency_ms, 1, "One way latency of every link");
+DEFINE_double(
+    sim_loss_rate, 0, "Probability of a packet being lost on a link [0, 1]");
+DEFINE_int32(
+    sim_event_timeout_s,
+    120,
+    "How long to wait for neighbor events before giving up");
+
+// Spark timers
+DEFINE_int32(sim_spark_hold_time_ms, 3000, "Spark hold time");
+DEFINE_int32(sim_spark_keepalive_time_ms, 1000, "Spark keep-alive time");
+DEFINE_int32(
+    sim_spark_fastinit_keepalive_time_ms,
+    100,
+    "Spark keep-alive time during fast init");
+
+// Spark2 timers
+DEFINE_int32(sim_spark2_hello_time_ms, 2000, "Spark2 hello time");
+DEFINE_int32(
+    sim_spark2_hello_fastinit_time_ms, 100, "Spark2 fast init hello time");
+DEFINE_int32(sim_spark2_handshake_time_ms, 100, "Spark2 handshake time");
+DEFINE_int32(sim_spark2_heartbeat_time_ms, 500, "Spark2 heartbeat time");
+DEFINE_int32(
+    sim_spark2_negotiate_hold_time_ms, 2000, "Spark2 negotiate hold time");
+DEFINE_int32(
+    sim_spark2_heartbeat_hold_time_ms, 1500, "Spark2 heartbeat hold time");
+DEFINE_int32(
+    sim_spark2_liveness_time_ms,
+    0,
+    "Spark2 liveness detection interval, 0 to disable");
+
+namespace openr {
+
+namespace {
+// How long to run steady state per iteration to measure CPU usage
+const std::chrono::seconds kSteadyStateWindow{1};
+
+std::chrono::milliseconds
+getEventTimeout() {
+  return std::chrono::seconds(FLAGS_sim_event_timeout_s);
+}
+
+SparkSimulatorConfig
+createConfig(size_t numNodes, bool enableSpark2) {
+  SparkSimulatorConfig config;
+  config.numNodes = numNodes;
+  if (FLAGS_sim_topology == "star") {
+    config.links = createStarTopology(numNodes);
+  } else if (FLAGS_sim_topology == "ring") {
+    config.links = createRingTopology(numNodes);
+  } else {
+    LOG(FATAL) << "Unknown topology " << FLAGS_sim_topology;
+  }
+  config.linkLatency = std::chrono::milliseconds(FLAGS_sim_link_latency_ms);
+  config.lossRate = FLAGS_sim_loss_rate;
+  config.enableSpark2 = enableSpark2;
+
+  config.holdTime = std::chrono::milliseconds(FLAGS_sim_spark_hold_time_ms);
+  config.keepAliveTime =
+      std::chrono::milliseconds(FLAGS_sim_spark_keepalive_time_ms);
+  config.fastInitKeepAliveTime =
+      std::chrono::milliseconds(FLAGS_sim_spark_fastinit_keepalive_time_ms);
+
+  config.timeConfig = SparkTimeConfig(
+      std::chrono::milliseconds(FLAGS_sim_spark2_hello_time_ms),
+      std::chrono::milliseconds(FLAGS_sim_spark2_hello_fastinit_time_ms),
+      std::chrono::milliseconds(FLAGS_sim_spark2_handshake_time_ms),
+      std::chrono::milliseconds(FLAGS_sim_spark2_heartbeat_time_ms),
+      std::chrono::milliseconds(FLAGS_sim_spark2_negotiate_hold_time_ms),
+      std::chrono::milliseconds(FLAGS_sim_spark2_heartbeat_hold_time_ms),
+      std::chrono::milliseconds(FLAGS_sim_spark2_liveness_time_ms));
+  return config;
+}
+
+// Create simulator with all adjacencies formed
+std::unique_ptr<SparkSimulator>
+createSimulatorWithAdjacencies(size_t numNodes, bool enableSpark2) {
+  auto sim =
+      std::make_unique<SparkSimulator>(createConfig(numNodes, enableSpark2));
+  sim->startNodes();
+  sim->addInterfaces();
+  CHECK(sim->waitForAllNeighbors(
+      thrift::SparkNeighborEventType::NEIGHBOR_UP, getEventTimeout()));
+  return sim;
+}
+} // namespace
+
+/**
+ * Time for all nodes to report all of their neighbors up, starting from the
+ * moment interfaces are added to Spark of every node
+ */
+static void
+BM_SparkColdStart(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numNodes,
+    bool enableSpark2) {
+  auto suspender = folly::BenchmarkSuspender();
+  std::chrono::nanoseconds cpuTime{0};
+  uint64_t numPackets{0};
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    SparkSimulator sim(createConfig(numNodes, enableSpark2));
+    sim.startNodes();
+    const auto startCpuTime = sim.getCpuTime();
+    const auto startNumPackets = sim.getNumPacketsSent();
+
+    suspender.dismiss(); // Start measuring benchmark time
+    sim.addInterfaces();
+    CHECK(sim.waitForAllNeighbors(
+        thrift::SparkNeighborEventType::NEIGHBOR_UP, getEventTimeout()));
+    suspender.rehire(); // Stop measuring time again
+
+    cpuTime += sim.getCpuTime() - startCpuTime;
+    numPackets += sim.getNumPacketsSent() - startNumPackets;
+  }
+
+  counters["cpu_ms"] =
+      std::chrono::duration_cast<std::chrono::milliseconds>(cpuTime).count() /
+      iters;
+  counters["packets_sent"] = numPackets / iters;
+}
+
+/**
+ * Time for graceful restart of node 0: from the moment it goes down, until
+ * all its neighbors report it as restarted and it reports all of them up
+ */
+static void
+BM_SparkGracefulRestart(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numNodes,
+    bool enableSpark2) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto sim = createSimulatorWithAdjacencies(numNodes, enableSpark2);
+
+  std::vector<std::pair<size_t, size_t>> neighbors;
+  for (auto neighbor : sim->getNeighbors(0)) {
+    neighbors.emplace_back(neighbor, 1);
+  }
+  const auto startNumPackets = sim->getNumPacketsSent();
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; ++i) {
+    sim->restartNode(0);
+    CHECK(sim->waitForEvents(
+        neighbors,
+        thrift::SparkNeighborEventType::NEIGHBOR_RESTARTED,
+        getEventTimeout()));
+    CHECK(sim->waitForEvents(
+        {{0, neighbors.size()}},
+        thrift::SparkNeighborEventType::NEIGHBOR_UP,
+        getEventTimeout()));
+  }
+  suspender.rehire(); // Stop measuring time again
+
+  counters["packets_sent"] =
+      (sim->getNumPacketsSent() - startNumPackets) / iters;
+}
+
+/**
+ * Time for both ends of a link to report neighbor down once link is cut
+ */
+static void
+BM_SparkNeighborDown(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numNodes,
+    bool enableSpark2) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto sim = createSimulatorWithAdjacencies(numNodes, enableSpark2);
+  const SimLink link{0, sim->getNeighbors(0).front()};
+  const std::vector<std::pair<size_t, size_t>> ends{{link.first, 1},
+                                                    {link.second, 1}};
+  std::chrono::nanoseconds detectionTime{0};
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startTime = std::chrono::steady_clock::now();
+    sim->setLinkUp(link, false);
+    CHECK(sim->waitForEvents(
+        ends,
+        thrift::SparkNeighborEventType::NEIGHBOR_DOWN,
+        getEventTimeout()));
+    detectionTime += std::chrono::steady_clock::now() - startTime;
+    suspender.rehire(); // Stop measuring time again
+
+    sim->setLinkUp(link, true);
+    CHECK(sim->waitForEvents(
+        ends, thrift::SparkNeighborEventType::NEIGHBOR_UP, getEventTimeout()));
+  }
+
+  counters["detection_ms"] =
+      std::chrono::duration_cast<std::chrono::milliseconds>(detectionTime)
+          .count() /
+      iters;
+}
+
+/**
+ * CPU time Spark spends per hello sent once all adjacencies are formed. It
+ * covers everything Spark does meanwhile: building and sending hellos as
+ * well as processing packets (hello, heartbeat, handshake) received
+ */
+static void
+BM_SparkSteadyState(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numNodes,
+    bool enableSpark2) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto sim = createSimulatorWithAdjacencies(numNodes, enableSpark2);
+
+  // Let fast init and handshakes settle down
+  std::this_thread::sleep_for(kSteadyStateWindow);
+  // hello counters are read in Spark threads, keep it out of CPU time
+  const auto startNumHellos = sim->getNumHellosSent();
+  const auto startCpuTime = sim->getCpuTime();
+  const auto startNumPackets = sim->getNumPacketsReceived();
+
+  suspender.dismiss(); // Start measuring benchmark time
+  for (uint32_t i = 0; i < iters; ++i) {
+    std::this_thread::sleep_for(kSteadyStateWindow);
+  }
+  suspender.rehire(); // Stop measuring time again
+
+  const auto cpuTime = sim->getCpuTime() - startCpuTime;
+  const auto numPackets = sim->getNumPacketsReceived() - startNumPackets;
+  const auto numHellos = sim->getNumHellosSent() - startNumHellos;
+  counters["cpu_ns_per_hello"] = numHellos ? cpuTime.count() / numHellos : 0;
+  counters["hellos_per_sec"] = numHellos / iters;
+  counters["packets_per_sec"] = numPackets / iters;
+}
+
+// Parameters are the number of nodes and whether to run Spark2
+BENCHMARK_COUNTERS_NAME_PARAM(BM_SparkColdStart, counters, Spark_10, 10, false);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_SparkColdStart, counters, Spark2_10, 10, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkColdStart, counters, Spark_100, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkColdStart, counters, Spark2_100, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkColdStart, counters, Spark_512, 512, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkColdStart, counters, Spark2_512, 512, true);
+BENCHMARK_DRAW_LINE();
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkGracefulRestart, counters, Spark_100, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkGracefulRestart, counters, Spark2_100, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkGracefulRestart, counters, Spark_512, 512, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkGracefulRestart, counters, Spark2_512, 512, true);
+BENCHMARK_DRAW_LINE();
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkNeighborDown, counters, Spark_100, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkNeighborDown, counters, Spark2_100, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkNeighborDown, counters, Spark_512, 512, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkNeighborDown, counters, Spark2_512, 512, true);
+BENCHMARK_DRAW_LINE();
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkSteadyState, counters, Spark_100, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkSteadyState, counters, Spark2_100, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkSteadyState, counters, Spark_512, 512, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkSteadyState, counters, Spark2_512, 512, true);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <limits>
+
+#include <folly/Format.h>
+#include <folly/IPAddress.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/spark/SparkHelloTemplate.h>
+
+namespace openr {
+
+namespace {
+thrift::SparkHelloPacket
+buildHelloPacket(
+    bool withHelloMsg,
+    folly::Optional<std::unordered_set<std::string>> const& areas) {
+  thrift::SparkHelloPacket packet;
+  packet.payload = createSparkPayload(
+      20200101,
+      createSparkNeighbor(
+          "domain",
+          "node-1",
+          30000,
+          toBinaryAddress(folly::IPAddress("10.0.0.1")),
+          toBinaryAddress(folly::IPAddress("fe80::1")),
+          60001,
+          60002,
+          "eth0"),
+      0 /* seqNum */,
+      {} /* neighborInfos */,
+      0 /* timestamp */,
+      false /* solicitResponse */,
+      true /* supportFloodOptimization */,
+      false /* restarting */,
+      areas);
+  packet.signature = "";
+  if (withHelloMsg) {
+    thrift::SparkHelloMsg helloMsg;
+    helloMsg.domainName = "domain";
+    helloMsg.nodeName = "node-1";
+    helloMsg.ifName = "eth0";
+    helloMsg.version = 20200101;
+    packet.helloMsg = std::move(helloMsg);
+  }
+  return packet;
+}
+
+std::map<std::string, thrift::ReflectedNeighborInfo>
+buildNeighborInfos(int count) {
+  std::map<std::string, thrift::ReflectedNeighborInfo> infos;
+  for (int i = 0; i < count; ++i) {
+    thrift::ReflectedNeighborInfo info;
+    info.seqNum = i;
+    info.lastNbrMsgSentTsInUs = 1000000 * i;
+    info.lastMyMsgRcvdTsInUs = -i;
+    infos.emplace(folly::sformat("node-{}", i + 2), info);
+  }
+  return infos;
+}
+
+// Serialize template of `packet`, stamp timestamps and make sure packet
+// decodes back into `packet` with per hello fields patched in
+void
+checkRoundTrip(
+    thrift::SparkHelloPacket const& packet,
+    int64_t seqNum,
+    int64_t tsInUs,
+    int64_t prevSentTsInUs = 0,
+    int64_t prevKernelSentTsInUs = 0) {
+  SparkHelloTemplate helloTemplate(packet);
+  SparkHelloTemplate::TimestampOffsets offsets;
+  auto data = helloTemplate.serialize(
+      seqNum, prevSentTsInUs, prevKernelSentTsInUs, offsets);
+  EXPECT_EQ(helloTemplate.size(), data.size());
+  SparkHelloTemplate::stampTimestamps(data, offsets, tsInUs);
+  EXPECT_EQ(helloTemplate.size(), data.size());
+
+  auto expected = packet;
+  expected.payload.seqNum = seqNum;
+  expected.payload.timestamp = tsInUs;
+  if (expected.helloMsg.hasValue()) {
+    auto& helloMsg = expected.helloMsg.value();
+    helloMsg.seqNum = seqNum;
+    helloMsg.sentTsInUs = tsInUs;
+    if (helloMsg.prevSentTsInUs.hasValue()) {
+      helloMsg.prevSentTsInUs = prevSentTsInUs;
+    }
+    if (helloMsg.prevKernelSentTsInUs.hasValue()) {
+      helloMsg.prevKernelSentTsInUs = prevKernelSentTsInUs;
+    }
+  }
+  const auto decoded =
+      apache::thrift::CompactSerializer::deserialize<thrift::SparkHelloPacket>(
+          data);
+  EXPECT_EQ(expected, decoded);
+}
+} // namespace
+
+TEST(SparkHelloTemplateTest, PayloadOnly) {
+  auto packet = buildHelloPacket(false, folly::none);
+  checkRoundTrip(packet, 0, 1);
+
+  auto& payload = packet.payload;
+  payload.neighborInfos = buildNeighborInfos(3);
+  payload.solicitResponse = true;
+  payload.restarting = true;
+  checkRoundTrip(packet, 12345678, 1580000000000000);
+
+  payload.restarting = folly::none;
+  checkRoundTrip(packet, 1, 0);
+}
+
+TEST(SparkHelloTemplateTest, HelloMsg) {
+  auto packet =
+      buildHelloPacket(true, std::unordered_set<std::string>{"area-1"});
+  checkRoundTrip(packet, 0, 1);
+
+  packet.payload.neighborInfos = buildNeighborInfos(20);
+  auto& helloMsg = packet.helloMsg.value();
+  helloMsg.neighborInfos = buildNeighborInfos(20);
+  helloMsg.solicitResponse = true;
+  helloMsg.restarting = true;
+  checkRoundTrip(packet, 7, 1580000000000200);
+
+  helloMsg.prevSentTsInUs = 0;
+  helloMsg.prevKernelSentTsInUs = 0;
+  checkRoundTrip(
+      packet, 8, 1580000000000200, 1580000000000000, 1580000000000100);
+
+  // values of any size fit in their slot
+  const auto max = std::numeric_limits<int64_t>::max();
+  const auto min = std::numeric_limits<int64_t>::min();
+  checkRoundTrip(packet, max, max, max, max);
+  checkRoundTrip(packet, min, min, min, min);
+  checkRoundTrip(packet, -1, -1, -1, -1);
+}
+
+TEST(SparkHelloTemplateTest, ManyAreas) {
+  std::unordered_set<std::string> areas;
+  for (int i = 0; i < 20; ++i) {
+    areas.emplace(folly::sformat("area-{}", i));
+  }
+  checkRoundTrip(buildHelloPacket(true, areas), 1, 1580000000000000);
+}
+
+TEST(SparkHelloTemplateTest, PlaceholderLookalikes) {
+  // names holding bytes of serialized placeholders are not mistaken for
+  // patched fields
+  auto packet = buildHelloPacket(true, folly::none);
+  std::string lookalike("\x80\xff\xff\xff\xff\xff\xff\xff\xff\x01", 10);
+  packet.payload.originator.nodeName = lookalike;
+  packet.helloMsg->nodeName = lookalike + lookalike;
+  packet.helloMsg->prevSentTsInUs = 0;
+  checkRoundTrip(packet, 5, 1580000000000000, 1580000000000000);
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
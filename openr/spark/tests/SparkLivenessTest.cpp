@@ -0,0 +1,225 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <deque>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/spark/SparkLiveness.h>
+
+using namespace std::chrono_literals;
+
+namespace openr {
+
+namespace {
+const std::chrono::milliseconds kTick{10};
+const std::chrono::milliseconds kTxInterval{100};
+const uint8_t kDetectMultiplier{3};
+
+folly::ByteRange
+toByteRange(std::string const& data) {
+  return folly::ByteRange(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+} // namespace
+
+TEST(LivenessPacketTest, EncodeDecode) {
+  LivenessPacket packet;
+  packet.state = LivenessState::INIT;
+  packet.detectMultiplier = 3;
+  packet.myDiscriminator = 0xdeadbeef;
+  packet.yourDiscriminator = 1;
+  packet.txIntervalUs = 100000;
+  packet.minRxIntervalUs = 50000;
+
+  const auto data = packet.encode();
+  EXPECT_EQ(LivenessPacket::kSize, data.size());
+  EXPECT_TRUE(LivenessPacket::isLivenessPacket(toByteRange(data)));
+
+  auto decoded = LivenessPacket::decode(toByteRange(data));
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_EQ(LivenessState::INIT, decoded->state);
+  EXPECT_EQ(3, decoded->detectMultiplier);
+  EXPECT_EQ(0xdeadbeef, decoded->myDiscriminator);
+  EXPECT_EQ(1, decoded->yourDiscriminator);
+  EXPECT_EQ(100000, decoded->txIntervalUs);
+  EXPECT_EQ(50000, decoded->minRxIntervalUs);
+
+  // Truncated packet or wrong magic isn't a liveness packet
+  EXPECT_FALSE(LivenessPacket::isLivenessPacket(
+      toByteRange(data).subpiece(0, LivenessPacket::kSize - 1)));
+  auto badData = data;
+  badData[0] = 0;
+  EXPECT_FALSE(LivenessPacket::isLivenessPacket(toByteRange(badData)));
+
+  // Unknown version
+  badData = data;
+  badData[4] = LivenessPacket::kVersion + 1;
+  EXPECT_FALSE(LivenessPacket::decode(toByteRange(badData)).hasValue());
+
+  // Invalid state
+  badData = data;
+  badData[5] = 0;
+  EXPECT_FALSE(LivenessPacket::decode(toByteRange(badData)).hasValue());
+
+  // Zero multiplier and discriminator are invalid
+  packet.detectMultiplier = 0;
+  EXPECT_FALSE(LivenessPacket::decode(toByteRange(packet.encode())).hasValue());
+  packet.detectMultiplier = 3;
+  packet.myDiscriminator = 0;
+  EXPECT_FALSE(LivenessPacket::decode(toByteRange(packet.encode())).hasValue());
+}
+
+/**
+ * Two sessions connected back to back, driven by simulated time
+ */
+class LivenessSessionFixture : public ::testing::Test {
+ protected:
+  void
+  SetUp() override {
+    now_ = std::chrono::steady_clock::now();
+    session1_ = createSession(1, queue2_, numDown1_);
+    session2_ = createSession(2, queue1_, numDown2_);
+  }
+
+  std::unique_ptr<LivenessSession>
+  createSession(
+      uint32_t discriminator,
+      std::deque<std::string>& peerQueue,
+      int& numDown) {
+    return std::make_unique<LivenessSession>(
+        &wheel_,
+        discriminator,
+        kTxInterval,
+        kDetectMultiplier,
+        [this, &peerQueue](std::string packet) {
+          if (not dropPackets_) {
+            peerQueue.push_back(std::move(packet));
+          }
+        },
+        [&numDown]() { ++numDown; });
+  }
+
+  // Advance time by `duration` tick by tick, delivering packets in between
+  void
+  run(std::chrono::milliseconds duration) {
+    for (auto end = now_ + duration; now_ < end;) {
+      now_ += kTick;
+      wheel_.advance(now_);
+      while (not queue1_.empty() or not queue2_.empty()) {
+        deliver(queue1_, *session1_);
+        deliver(queue2_, *session2_);
+      }
+    }
+  }
+
+  void
+  deliver(std::deque<std::string>& queue, LivenessSession& session) {
+    while (not queue.empty()) {
+      auto packet = LivenessPacket::decode(toByteRange(queue.front()));
+      queue.pop_front();
+      ASSERT_TRUE(packet.hasValue());
+      session.processPacket(packet.value());
+    }
+  }
+
+  TimerWheel wheel_{nullptr, kTick};
+  std::chrono::steady_clock::time_point now_;
+  bool dropPackets_{false};
+
+  // packets to be delivered to session1 and session2 respectively
+  std::deque<std::string> queue1_;
+  std::deque<std::string> queue2_;
+
+  int numDown1_{0};
+  int numDown2_{0};
+  std::unique_ptr<LivenessSession> session1_;
+  std::unique_ptr<LivenessSession> session2_;
+};
+
+TEST_F(LivenessSessionFixture, SessionUp) {
+  EXPECT_EQ(LivenessState::DOWN, session1_->getState());
+  EXPECT_EQ(LivenessState::DOWN, session2_->getState());
+
+  // First packets go out at slow rate
+  run(2 * LivenessSession::kSlowTxInterval);
+  EXPECT_EQ(LivenessState::UP, session1_->getState());
+  EXPECT_EQ(LivenessState::UP, session2_->getState());
+  EXPECT_EQ(2, session1_->getYourDiscriminator());
+  EXPECT_EQ(1, session2_->getYourDiscriminator());
+  EXPECT_EQ(kDetectMultiplier * kTxInterval, session1_->getDetectionTime());
+
+  // Stays UP as long as packets flow
+  run(5s);
+  EXPECT_EQ(LivenessState::UP, session1_->getState());
+  EXPECT_EQ(LivenessState::UP, session2_->getState());
+  EXPECT_EQ(0, numDown1_);
+  EXPECT_EQ(0, numDown2_);
+}
+
+TEST_F(LivenessSessionFixture, DetectionTimeout) {
+  run(2 * LivenessSession::kSlowTxInterval);
+  ASSERT_EQ(LivenessState::UP, session1_->getState());
+  ASSERT_EQ(LivenessState::UP, session2_->getState());
+
+  // Both sides detect failure within detection time
+  dropPackets_ = true;
+  run(kDetectMultiplier * kTxInterval + 2 * kTick);
+  EXPECT_EQ(LivenessState::DOWN, session1_->getState());
+  EXPECT_EQ(LivenessState::DOWN, session2_->getState());
+  EXPECT_EQ(1, numDown1_);
+  EXPECT_EQ(1, numDown2_);
+
+  // Sessions come back UP with packets, DOWN is reported only once
+  dropPackets_ = false;
+  run(3 * LivenessSession::kSlowTxInterval);
+  EXPECT_EQ(LivenessState::UP, session1_->getState());
+  EXPECT_EQ(LivenessState::UP, session2_->getState());
+  EXPECT_EQ(1, numDown1_);
+  EXPECT_EQ(1, numDown2_);
+}
+
+TEST_F(LivenessSessionFixture, RemoteDown) {
+  run(2 * LivenessSession::kSlowTxInterval);
+  ASSERT_EQ(LivenessState::UP, session1_->getState());
+
+  // Neighbor reporting DOWN brings session DOWN right away
+  LivenessPacket packet;
+  packet.state = LivenessState::DOWN;
+  packet.detectMultiplier = kDetectMultiplier;
+  packet.myDiscriminator = 2;
+  packet.txIntervalUs = 100000;
+  packet.minRxIntervalUs = 100000;
+  session1_->processPacket(packet);
+  EXPECT_EQ(LivenessState::DOWN, session1_->getState());
+  EXPECT_EQ(1, numDown1_);
+}
+
+TEST_F(LivenessSessionFixture, NeverUp) {
+  // Neighbor not running liveness detection never brings session down
+  dropPackets_ = true;
+  run(10s);
+  EXPECT_EQ(LivenessState::DOWN, session1_->getState());
+  EXPECT_EQ(0, numDown1_);
+  EXPECT_EQ(0, numDown2_);
+}
+
+} // namespace openr
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,282 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/spark/tests/SparkSimulator.h>
+
+#include <algorithm>
+#include <future>
+#include <unordered_set>
+
+#include <folly/Format.h>
+#include <folly/IPAddressV4.h>
+#include <glog/logging.h>
+
+#include <openr/common/Constants.h>
+
+namespace {
+const std::string kDomainName{"spark_simulator"};
+const std::string kSparkReportUrl{"inproc://spark_simulator_report"};
+const std::string kSparkMonitorUrl{"inproc://spark_simulator_monitor"};
+
+// same link regardless of direction
+openr::SimLink
+normalizeLink(openr::SimLink const& link) {
+  return {std::min(link.first, link.second),
+          std::max(link.first, link.second)};
+}
+} // namespace
+
+namespace openr {
+
+std::vector<SimLink>
+createRingTopology(size_t numNodes) {
+  CHECK_GE(numNodes, 3);
+  std::vector<SimLink> links;
+  for (size_t i = 0; i < numNodes; ++i) {
+    links.emplace_back(i, (i + 1) % numNodes);
+  }
+  return links;
+}
+
+std::vector<SimLink>
+createStarTopology(size_t numNodes) {
+  CHECK_GE(numNodes, 2);
+  std::vector<SimLink> links;
+  for (size_t i = 1; i < numNodes; ++i) {
+    links.emplace_back(0, i);
+  }
+  return links;
+}
+
+SparkSimulator::SparkSimulator(SparkSimulatorConfig config)
+    : config_(std::move(config)) {
+  // Create interfaces of all links, ifIndex is unique across all nodes
+  interfaces_.resize(config_.numNodes);
+  IfNameAndifIndex ifIndices;
+  auto addInterface = [&](size_t node, size_t neighbor) {
+    const int ifIndex = ifIndices.size() + 1;
+    SimInterface interface;
+    interface.neighbor = neighbor;
+    interface.entry.ifName = getIfName(node, neighbor);
+    interface.entry.ifIndex = ifIndex;
+    const auto v4Addr = folly::IPAddressV4::fromLongHBO(0x0a000000 + ifIndex);
+    interface.entry.v4Network = {folly::IPAddress(v4Addr), 32};
+    interface.entry.v6LinkLocalNetwork = folly::IPAddress::createNetwork(
+        folly::sformat("fe80::{:x}/128", ifIndex));
+    ifIndices.emplace_back(interface.entry.ifName, ifIndex);
+    interfaces_.at(node).emplace_back(std::move(interface));
+  };
+  for (auto const& link : config_.links) {
+    CHECK_NE(link.first, link.second);
+    addInterface(link.first, link.second);
+    addInterface(link.second, link.first);
+  }
+
+  mockIoProvider_ = std::make_shared<MockIoProvider>();
+  mockIoProvider_->addIfNameIfIndex(ifIndices);
+  mockIoProvider_->setPacketLossRate(config_.lossRate);
+  updateConnectedPairs();
+
+  mockIoProviderThread_ = std::make_unique<std::thread>([this]() {
+    VLOG(1) << "Starting mockIoProvider thread.";
+    mockIoProvider_->start();
+    VLOG(1) << "mockIoProvider thread got stopped.";
+  });
+  mockIoProvider_->waitUntilRunning();
+
+  nodes_.resize(config_.numNodes);
+}
+
+SparkSimulator::~SparkSimulator() {
+  // Sparks must go before IoProvider they are using
+  nodes_.clear();
+
+  mockIoProvider_->stop();
+  mockIoProviderThread_->join();
+}
+
+std::string
+SparkSimulator::getNodeName(size_t node) {
+  return folly::sformat("node-{}", node);
+}
+
+std::string
+SparkSimulator::getIfName(size_t node, size_t neighbor) {
+  return folly::sformat("if_{}_{}", node, neighbor);
+}
+
+std::shared_ptr<SparkWrapper>
+SparkSimulator::createNode(size_t node) {
+  const auto instanceId = nextInstanceId_++;
+  return std::make_shared<SparkWrapper>(
+      kDomainName,
+      getNodeName(node),
+      config_.holdTime,
+      config_.keepAliveTime,
+      config_.fastInitKeepAliveTime,
+      false /* enableV4 */,
+      false /* enableSubnetValidation */,
+      SparkReportUrl{folly::sformat("{}-{}", kSparkReportUrl, instanceId)},
+      MonitorSubmitUrl{folly::sformat("{}-{}", kSparkMonitorUrl, instanceId)},
+      std::make_pair(
+          Constants::kOpenrVersion, Constants::kOpenrSupportedVersion),
+      context_,
+      mockIoProvider_,
+      folly::none /* areas */,
+      config_.enableSpark2,
+      true /* increaseHelloInterval */,
+      config_.timeConfig);
+}
+
+void
+SparkSimulator::startNodes() {
+  for (size_t node = 0; node < config_.numNodes; ++node) {
+    nodes_.at(node) = createNode(node);
+  }
+}
+
+void
+SparkSimulator::addInterfaces() {
+  for (size_t node = 0; node < config_.numNodes; ++node) {
+    addInterfaces(node);
+  }
+}
+
+void
+SparkSimulator::addInterfaces(size_t node) {
+  std::vector<SparkInterfaceEntry> entries;
+  for (auto const& interface : interfaces_.at(node)) {
+    entries.emplace_back(interface.entry);
+  }
+  CHECK(nodes_.at(node)->updateInterfaceDb(entries))
+      << "Failed to add interfaces to " << getNodeName(node);
+}
+
+void
+SparkSimulator::restartNode(size_t node) {
+  // Stop old instance before starting new one, same as process restart
+  nodes_.at(node).reset();
+  nodes_.at(node) = createNode(node);
+  addInterfaces(node);
+}
+
+void
+SparkSimulator::setLinkUp(SimLink const& link, bool isUp) {
+  if (isUp) {
+    downLinks_.erase(normalizeLink(link));
+  } else {
+    downLinks_.insert(normalizeLink(link));
+  }
+  updateConnectedPairs();
+}
+
+void
+SparkSimulator::updateConnectedPairs() {
+  ConnectedIfPairs connectedPairs;
+  for (auto const& link : config_.links) {
+    if (downLinks_.count(normalizeLink(link))) {
+      continue;
+    }
+    const auto ifName1 = getIfName(link.first, link.second);
+    const auto ifName2 = getIfName(link.second, link.first);
+    const int32_t latency = config_.linkLatency.count();
+    connectedPairs[ifName1].emplace_back(ifName2, latency);
+    connectedPairs[ifName2].emplace_back(ifName1, latency);
+  }
+  mockIoProvider_->setConnectedPairs(std::move(connectedPairs));
+}
+
+bool
+SparkSimulator::waitForEvents(
+    std::vector<std::pair<size_t, size_t>> const& expected,
+    thrift::SparkNeighborEventType eventType,
+    std::chrono::milliseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  // Each node reports on its own socket, wait on all of them in parallel
+  std::vector<std::future<bool>> results;
+  for (auto const& kv : expected) {
+    auto node = nodes_.at(kv.first);
+    const auto numEvents = kv.second;
+    results.emplace_back(std::async(
+        std::launch::async, [node, numEvents, eventType, deadline]() {
+          // count interfaces rather than events to not count flaps twice
+          std::unordered_set<std::string> ifNames;
+          while (ifNames.size() < numEvents) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+              return false;
+            }
+            auto maybeEvent = node->recvNeighborEvent(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - now));
+            if (maybeEvent.hasValue() and
+                maybeEvent->eventType == eventType) {
+              ifNames.emplace(maybeEvent->ifName);
+            }
+          }
+          return true;
+        }));
+  }
+
+  bool success{true};
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (not results[i].get()) {
+      LOG(ERROR) << getNodeName(expected[i].first) << " didn't report "
+                 << expected[i].second << " events of type "
+                 << static_cast<int>(eventType) << " in time";
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool
+SparkSimulator::waitForAllNeighbors(
+    thrift::SparkNeighborEventType eventType,
+    std::chrono::milliseconds timeout) {
+  std::vector<std::pair<size_t, size_t>> expected;
+  for (size_t node = 0; node < config_.numNodes; ++node) {
+    if (not interfaces_.at(node).empty()) {
+      expected.emplace_back(node, interfaces_.at(node).size());
+    }
+  }
+  return waitForEvents(expected, eventType, timeout);
+}
+
+std::vector<size_t>
+SparkSimulator::getNeighbors(size_t node) const {
+  std::vector<size_t> neighbors;
+  for (auto const& interface : interfaces_.at(node)) {
+    neighbors.emplace_back(interface.neighbor);
+  }
+  return neighbors;
+}
+
+std::chrono::nanoseconds
+SparkSimulator::getCpuTime() const {
+  std::chrono::nanoseconds cpuTime{0};
+  for (auto const& node : nodes_) {
+    if (node) {
+      cpuTime += node->getCpuTime();
+    }
+  }
+  return cpuTime;
+}
+
+uint64_t
+SparkSimulator::getNumHellosSent() const {
+  uint64_t numHellos{0};
+  for (auto const& node : nodes_) {
+    if (node) {
+      numHellos += node->getNumHellosSent();
+    }
+  }
+  return numHellos;
+}
+
+} // namespace openr
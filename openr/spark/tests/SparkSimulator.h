@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fbzmq/zmq/Zmq.h>
+
+#include <openr/spark/SparkWrapper.h>
+#include <openr/spark/tests/MockIoProvider.h>
+
+namespace openr {
+
+// point-to-point link between two nodes, identified by their index
+using SimLink = std::pair<size_t, size_t>;
+
+struct SparkSimulatorConfig {
+  size_t numNodes{0};
+  std::vector<SimLink> links;
+
+  // one way latency of every link
+  std::chrono::milliseconds linkLatency{1};
+
+  // probability of a packet being lost on a link
+  double lossRate{0};
+
+  // Spark2 if set, Spark otherwise
+  bool enableSpark2{false};
+
+  // Spark timers
+  std::chrono::milliseconds holdTime{3000};
+  std::chrono::milliseconds keepAliveTime{1000};
+  std::chrono::milliseconds fastInitKeepAliveTime{100};
+
+  // Spark2 timers
+  SparkTimeConfig timeConfig{
+      std::chrono::milliseconds{2000}, // hello
+      std::chrono::milliseconds{100}, // hello fast-init
+      std::chrono::milliseconds{100}, // handshake
+      std::chrono::milliseconds{500}, // heartbeat
+      std::chrono::milliseconds{2000}, // negotiate hold
+      std::chrono::milliseconds{1500}, // heartbeat hold
+      std::chrono::milliseconds{0} // liveness (disabled)
+  };
+};
+
+/**
+ * Ring of `numNodes` nodes, each with two links
+ */
+std::vector<SimLink> createRingTopology(size_t numNodes);
+
+/**
+ * Node 0 connected to all other nodes, e.g. a box with `numNodes - 1` ports
+ * connected to single port neighbors
+ */
+std::vector<SimLink> createStarTopology(size_t numNodes);
+
+/**
+ * Runs any number of Spark instances in process on top of MockIoProvider,
+ * connected according to given topology. Used to evaluate Spark and its
+ * timers at scale without hardware.
+ *
+ * Every link is a pair of interfaces, one on each node. Interface of node `a`
+ * towards node `b` is named `if_a_b`.
+ *
+ * NOTE: Not thread safe. Must be used from a single thread.
+ */
+class SparkSimulator {
+ public:
+  explicit SparkSimulator(SparkSimulatorConfig config);
+
+  ~SparkSimulator();
+
+  SparkSimulator(SparkSimulator const&) = delete;
+  SparkSimulator& operator=(SparkSimulator const&) = delete;
+
+  // Start Spark on all nodes, without any interfaces
+  void startNodes();
+
+  // Start tracking interfaces of all links on all nodes. Neighbors are
+  // discovered from here on
+  void addInterfaces();
+
+  // Same as above for a single node
+  void addInterfaces(size_t node);
+
+  // Stop and start Spark of `node` again, same as process restart. Interfaces
+  // are added back right away
+  void restartNode(size_t node);
+
+  // Cut or restore link in both directions
+  void setLinkUp(SimLink const& link, bool isUp);
+
+  /**
+   * Wait until each node in `expected` reports `eventType` for given number
+   * of neighbors. Events of other types are discarded. Returns false if it
+   * didn't happen within `timeout`.
+   */
+  bool waitForEvents(
+      std::vector<std::pair<size_t /* node */, size_t /* numEvents */>> const&
+          expected,
+      thrift::SparkNeighborEventType eventType,
+      std::chrono::milliseconds timeout);
+
+  // Wait until every node reports `eventType` for each of its links
+  bool waitForAllNeighbors(
+      thrift::SparkNeighborEventType eventType,
+      std::chrono::milliseconds timeout);
+
+  // Nodes on other side of links of `node`
+  std::vector<size_t> getNeighbors(size_t node) const;
+
+  // Total CPU time consumed by Spark threads of all nodes
+  std::chrono::nanoseconds getCpuTime() const;
+
+  // Total number of hellos sent by all nodes
+  uint64_t getNumHellosSent() const;
+
+  uint64_t
+  getNumPacketsSent() const {
+    return mockIoProvider_->getNumPacketsSent();
+  }
+
+  uint64_t
+  getNumPacketsReceived() const {
+    return mockIoProvider_->getNumPacketsReceived();
+  }
+
+  size_t
+  getNumNodes() const {
+    return config_.numNodes;
+  }
+
+  static std::string getNodeName(size_t node);
+
+  static std::string getIfName(size_t node, size_t neighbor);
+
+ private:
+  struct SimInterface {
+    size_t neighbor{0};
+    SparkInterfaceEntry entry;
+  };
+
+  std::shared_ptr<SparkWrapper> createNode(size_t node);
+
+  // Push current set of up links to MockIoProvider
+  void updateConnectedPairs();
+
+  const SparkSimulatorConfig config_;
+
+  fbzmq::Context context_;
+
+  std::shared_ptr<MockIoProvider> mockIoProvider_{nullptr};
+  std::unique_ptr<std::thread> mockIoProviderThread_{nullptr};
+
+  // Spark of each node, and interfaces of each node
+  std::vector<std::shared_ptr<SparkWrapper>> nodes_;
+  std::vector<std::vector<SimInterface>> interfaces_;
+
+  // Links which are currently down
+  std::set<SimLink> downLinks_;
+
+  // Spark report url must be unique per instance, including restarts
+  size_t nextInstanceId_{0};
+};
+
+} // namespace openr